@@ -1,5 +1,14 @@
 #include "AliPALPIDEFSRawStreamMS.h"
+#include "../../src/common/TRawEventFile.h"
 #include <iostream>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define MOSAIC_HEADER_LENGTH 64  // MOSAIC board header in front of each recorded event
+#define MOSAIC_TRAILER_LENGTH 1  // MOSAIC board trailer at the end of each recorded event
 
 using namespace std;
 
@@ -10,7 +19,17 @@ AliPALPIDEFSRawStreamMS::AliPALPIDEFSRawStreamMS() :
     fLastEvent(0),
     fHitIter(0),
     fChipType(4),       // default ALPIDE
-    fSkipErrorEvents(1) // default skip error events (row or col < 0)
+    fSkipErrorEvents(1), // default skip error events (row or col < 0)
+    fBinaryInput(0),
+    fMap(0),
+    fMapSize(0),
+    fNextBlock(0),
+    fBlockEntries(0),
+    fBlockData(0),
+    fBlockNEvents(0),
+    fBlockEvent(0),
+    fBoardIndex(-1),
+    fChipId(-1)
 {
     // Construct
     fHitCols.reserve(100);
@@ -22,6 +41,7 @@ AliPALPIDEFSRawStreamMS::AliPALPIDEFSRawStreamMS() :
 AliPALPIDEFSRawStreamMS::~AliPALPIDEFSRawStreamMS()
 {
     fFileInput.close();
+    CloseBinaryInput();
     fHitCols.clear();
     fHitRows.clear();
     fHitBunch.clear();
@@ -29,12 +49,65 @@ AliPALPIDEFSRawStreamMS::~AliPALPIDEFSRawStreamMS()
 //__________________________________________________________
 Bool_t AliPALPIDEFSRawStreamMS::SetInputFile(const char *filename)
 {
+    // a binary raw event file starts with RawEventFile::FILE_MAGIC, otherwise it is read as text
+    CloseBinaryInput();
+    int fd = open(filename, O_RDONLY);
+    if(fd < 0) return kFALSE;
+    struct stat st;
+    char magic[sizeof(RawEventFile::FILE_MAGIC)];
+    if( fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(RawEventFile::TFileHeader)
+        && read(fd, magic, sizeof(magic)) == (ssize_t)sizeof(magic)
+        && !memcmp(magic, RawEventFile::FILE_MAGIC, sizeof(magic)) ) {
+        void *map = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if(map == MAP_FAILED) {
+            cerr << "AliPALPIDEFSRawStreamMS::SetInputFile() : Cannot map binary file " << filename << endl;
+            return kFALSE;
+        }
+        madvise(map, st.st_size, MADV_SEQUENTIAL);
+        const RawEventFile::TFileHeader *header = (const RawEventFile::TFileHeader*)map;
+        if(header->version < 1 || header->version > RawEventFile::VERSION) {
+            cerr << "AliPALPIDEFSRawStreamMS::SetInputFile() : Unknown version of binary file " << filename << endl;
+            munmap(map, st.st_size);
+            return kFALSE;
+        }
+        fMap = (const UChar_t*)map;
+        fMapSize = st.st_size;
+        // skip the firmware versions of the boards (since version 2)
+        fNextBlock = sizeof(RawEventFile::TFileHeader)
+            + ((header->version >= 2) ? (ULong64_t)header->nBoards * sizeof(RawEventFile::TBoardEntry) : 0);
+        fBlockNEvents = 0;
+        fBlockEvent = 0;
+        fBinaryInput = kTRUE;
+        return kTRUE;
+    }
+    close(fd);
     fFileInput.open(filename);
     return fFileInput.is_open();
 }
 
+//__________________________________________________________
+void AliPALPIDEFSRawStreamMS::CloseBinaryInput()
+{
+    if(fMap) munmap((void*)fMap, fMapSize);
+    fMap = 0;
+    fMapSize = 0;
+    fBlockEntries = 0;
+    fBlockData = 0;
+    fBlockNEvents = 0;
+    fBlockEvent = 0;
+    fBinaryInput = kFALSE;
+}
+
 //__________________________________________________________
 Bool_t AliPALPIDEFSRawStreamMS::ReadEvent()
+{
+    if(fBinaryInput) return ReadBinaryEvent();
+    return ReadTextEvent();
+}
+
+//__________________________________________________________
+Bool_t AliPALPIDEFSRawStreamMS::ReadTextEvent()
 {
     // if fSkipErrorEvents = true, events with pixels with dcol/addr/hits < 0 will be ignored
     // if fSkipErrorEvents = false, pixel hit with col = dcol (<0) / row = addr (<0) will be propagated
@@ -93,6 +166,122 @@ Bool_t AliPALPIDEFSRawStreamMS::ReadEvent()
     return kTRUE;
 }
 
+//__________________________________________________________
+Bool_t AliPALPIDEFSRawStreamMS::ReadBinaryEvent()
+{
+    fHitIter = 0;
+    fHitCols.clear();
+    fHitRows.clear();
+    fHitBunch.clear();
+
+    while(kTRUE) {
+        if(fBlockEvent >= fBlockNEvents) {
+            if(!NextBinaryBlock()) {
+                fLastEvent = kTRUE;
+                return kFALSE;
+            }
+            continue;
+        }
+        RawEventFile::TEventEntry entry;
+        memcpy(&entry, fBlockEntries + (fBlockEvent++)*sizeof(entry), sizeof(entry));
+        if(fBoardIndex >= 0 && entry.boardIndex != (UInt_t)fBoardIndex) continue;
+        fCurrentEvent = entry.trgNum ? (Int_t)entry.trgNum : fEventCounter;
+        ++fEventCounter;
+        DecodeBinaryEvent(fBlockData + entry.offset, entry.size);
+        return kTRUE;
+    }
+}
+
+//__________________________________________________________
+Bool_t AliPALPIDEFSRawStreamMS::NextBinaryBlock()
+{
+    // walk to the next block of the binary file, skipping the compressed ones
+    while(kTRUE) {
+        if(fNextBlock + sizeof(RawEventFile::TBlockHeader) > fMapSize) return kFALSE;
+        const RawEventFile::TBlockHeader *header = (const RawEventFile::TBlockHeader*)(fMap + fNextBlock);
+        if(header->magic != RawEventFile::BLOCK_MAGIC) return kFALSE; // block table or end of file
+        const ULong64_t index = fNextBlock + sizeof(RawEventFile::TBlockHeader);
+        const ULong64_t data  = index + header->nEvents*sizeof(RawEventFile::TEventEntry);
+        if(data + header->storedSize > fMapSize) {
+            cerr << "AliPALPIDEFSRawStreamMS::NextBinaryBlock() : Incomplete last block ignored" << endl;
+            return kFALSE;
+        }
+        fNextBlock = data + header->storedSize;
+        fNextBlock += (8 - fNextBlock%8)%8;
+        if(header->compression != RawEventFile::kNONE) {
+            cerr << "AliPALPIDEFSRawStreamMS::NextBinaryBlock() : Compressed block skipped ("
+                 << header->nEvents << " events), record the run without compression" << endl;
+            continue;
+        }
+        fBlockEntries = fMap + index;
+        fBlockData    = fMap + data;
+        fBlockNEvents = header->nEvents;
+        fBlockEvent   = 0;
+        return kTRUE;
+    }
+}
+
+//__________________________________________________________
+void AliPALPIDEFSRawStreamMS::DecodeBinaryEvent(const UChar_t *data, Int_t nbytes)
+{
+    // decode the ALPIDE data words between the MOSAIC header and trailer
+    Int_t   byte  = MOSAIC_HEADER_LENGTH;
+    Int_t   end   = nbytes - MOSAIC_TRAILER_LENGTH;
+    Int_t   chip  = -1;
+    Int_t   region = -1;
+    Short_t bunch = 0;
+    Short_t col, row;
+    while(byte < end) {
+        UChar_t word = data[byte];
+        if(word == 0xff || word == 0xf1 || word == 0xf0) {   // idle, busy on, busy off
+            ++byte;
+        }
+        else if((word & 0xf0) == 0xa0 || (word & 0xf0) == 0xe0) { // chip header, empty frame
+            if(byte+2 > end) break;
+            chip  = word & 0xf;
+            bunch = data[byte+1];
+            byte += 2;
+        }
+        else if((word & 0xf0) == 0xb0) {                      // chip trailer
+            ++byte;
+        }
+        else if((word & 0xe0) == 0xc0) {                      // region header
+            region = word & 0x1f;
+            ++byte;
+        }
+        else if((word & 0xc0) == 0x40 || (word & 0xc0) == 0x0) { // data short, data long
+            Bool_t datalong = ((word & 0xc0) == 0x0);
+            Int_t  length   = datalong ? 3 : 2;
+            if(byte+length > end) break;
+            if(region < 0) {
+                cerr << "AliPALPIDEFSRawStreamMS::DecodeBinaryEvent() : Data word without region, skipped" << endl;
+                byte += length;
+                continue;
+            }
+            if(fChipId < 0 || chip == fChipId) {
+                Int_t   field   = (((Int_t)data[byte]) << 8) + data[byte+1];
+                Short_t dcol    = region*16 + ((field & 0x3c00) >> 10);
+                Short_t address = field & 0x03ff;
+                Int_t   hitmap  = datalong ? ((data[byte+2] << 1) | 1) : 1;
+                for(Int_t i=0; i<8; ++i) {
+                    if(!((hitmap >> i) & 1)) continue;
+                    dblcol_adr_to_col_row(dcol, address+i, &col, &row, fChipType);
+                    fHitCols.push_back(col);
+                    fHitRows.push_back(row);
+                    fHitBunch.push_back(bunch);
+                }
+            }
+            byte += length;
+        }
+        else {
+            cerr << "AliPALPIDEFSRawStreamMS::DecodeBinaryEvent() : Data of unknown type 0x" << hex << (Int_t)word << dec << endl;
+            ++byte;
+        }
+    }
+    if(byte < end)
+        cerr << "AliPALPIDEFSRawStreamMS::DecodeBinaryEvent() : Truncated data word at end of event" << endl;
+}
+
 //__________________________________________________________
 Bool_t AliPALPIDEFSRawStreamMS::GetNextHit(Short_t *col, Short_t* row) {
     if( fHitIter < GetNumHits() ) {
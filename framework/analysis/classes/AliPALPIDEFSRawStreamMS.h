@@ -7,6 +7,14 @@
 #include "Riostream.h"
 #include "TObject.h"
 
+// Hits are read either from a text file (one hit per line: event dcol address bunch),
+// or from a binary raw event file recorded by the framework (scans run with -r 1,
+// see framework/src/common/TRawEventFile.h). The format is found by SetInputFile().
+// The binary file is mapped in memory and the ALPIDE data words of the MOSAIC events
+// are decoded in place, without any text parsing. Only the uncompressed blocks can
+// be read. Each recorded event (one per board receiver and trigger) gives one event,
+// even without hits; its counter is the trigger number if the trigger recorder was on.
+
 class AliPALPIDEFSRawStreamMS: public TObject {
 public:
     AliPALPIDEFSRawStreamMS();
@@ -27,9 +35,17 @@ public:
 
     void   SetChipType(Short_t chiptype) { fChipType = chiptype; }          // see fChipType
     void   SetSkipErrorEvents(Bool_t toggle) { fSkipErrorEvents = toggle; } // see ReadEvent() comment, default = true
+    void   SetBoardIndex(Int_t index) { fBoardIndex = index; } // binary input: read only this board, default = -1 (all)
+    void   SetChipId(Int_t id)        { fChipId = id; }        // binary input: keep only hits of this chip, default = -1 (all)
+    Bool_t IsBinaryInput()     { return fBinaryInput; }
     
 private:
     Bool_t dblcol_adr_to_col_row(Short_t doublecol, Short_t address, Short_t *col, Short_t *row, Short_t chiptype=4);
+    Bool_t ReadTextEvent();
+    Bool_t ReadBinaryEvent();
+    Bool_t NextBinaryBlock();
+    void   DecodeBinaryEvent(const UChar_t *data, Int_t nbytes);
+    void   CloseBinaryInput();
     
     std::ifstream fFileInput;       // input text file
     Bool_t   fFirstEvent;
@@ -40,12 +56,23 @@ private:
 
     Int_t    fChipType;        // chip type 0 = pALPIDE-1/fs, 4 = ALPIDE (default)
     Bool_t   fSkipErrorEvents; // see ReadEvent() comment
+
+    Bool_t         fBinaryInput;    // input is a binary raw event file
+    const UChar_t *fMap;            //! binary input file mapped in memory
+    ULong64_t      fMapSize;        // size of the mapped file
+    ULong64_t      fNextBlock;      // position of the next block in the binary file
+    const UChar_t *fBlockEntries;   //! index of the events of the current block
+    const UChar_t *fBlockData;      //! data of the events of the current block
+    UInt_t         fBlockNEvents;   // number of events in the current block
+    UInt_t         fBlockEvent;     // next event to be read in the current block
+    Int_t          fBoardIndex;     // binary input: board to be read (-1 = all)
+    Int_t          fChipId;         // binary input: chip to be kept (-1 = all)
     
     std::vector<Short_t> fHitCols;
     std::vector<Short_t> fHitRows;
     std::vector<Short_t> fHitBunch;
     
-    ClassDef(AliPALPIDEFSRawStreamMS,2)
+    ClassDef(AliPALPIDEFSRawStreamMS,3)
 };
 
 #endif
@@ -0,0 +1,137 @@
+#include "BinaryClusterizer.hpp"
+#include "Riostream.h"
+#include "TMath.h"
+
+using namespace std;
+
+ClassImp(BinaryClusterizer)
+
+// constructor, <ncols> x <nrows> is the size of the pixel matrix (all sectors)
+//______________________________________________________________________
+BinaryClusterizer::BinaryClusterizer(Int_t ncols, Int_t nrows, Short_t crown)
+:TObject(),
+    fNCols(ncols),
+    fNRows(nrows),
+    fCrown(crown),
+    fNClusters(0)
+{
+    fMap.assign((size_t)fNCols*fNRows, -1);
+}
+
+// add a hit pixel, return kFALSE if it is outside the pixel matrix
+//______________________________________________________________________
+Bool_t BinaryClusterizer::AddPixel(const BinaryPixel& pix) {
+    if(pix.GetCol() < 0 || pix.GetCol() >= fNCols || pix.GetRow() < 0 || pix.GetRow() >= fNRows) {
+        cerr << "BinaryClusterizer::AddPixel() : pixel (" << pix.GetCol() << ", " << pix.GetRow()
+             << ") outside the pixel matrix, ignored" << endl;
+        return kFALSE;
+    }
+    fPixels.push_back(pix);
+    return kTRUE;
+}
+
+// root of the cluster of hit pixel <i> (with path halving)
+//______________________________________________________________________
+Int_t BinaryClusterizer::Find(Int_t i) {
+    while(fParent[i] != i) {
+        fParent[i] = fParent[fParent[i]];
+        i = fParent[i];
+    }
+    return i;
+}
+
+// merge the clusters of hit pixels <i> and <j>, the root is the first pixel of the event
+//______________________________________________________________________
+void BinaryClusterizer::Union(Int_t i, Int_t j) {
+    i = Find(i);
+    j = Find(j);
+    if(i < j)      fParent[j] = i;
+    else if(j < i) fParent[i] = j;
+}
+
+// find the clusters of the hit pixels added since the last Reset()
+//______________________________________________________________________
+Int_t BinaryClusterizer::Clusterize() {
+    const Int_t npix = fPixels.size();
+    fParent.resize(npix);
+    for(Int_t i=0; i<npix; ++i) fParent[i] = i;
+
+    // link each pixel to its neighbours already put in the map
+    for(Int_t i=0; i<npix; ++i) {
+        const Int_t col = fPixels[i].GetCol();
+        const Int_t row = fPixels[i].GetRow();
+        const Int_t cmin = TMath::Max(col-fCrown, 0), cmax = TMath::Min(col+fCrown, fNCols-1);
+        const Int_t rmin = TMath::Max(row-fCrown, 0), rmax = TMath::Min(row+fCrown, fNRows-1);
+        for(Int_t c=cmin; c<=cmax; ++c) {
+            const Int_t* cells = &fMap[(size_t)c*fNRows];
+            for(Int_t r=rmin; r<=rmax; ++r)
+                if(cells[r] >= 0) Union(i, cells[r]);
+        }
+        Int_t& cell = fMap[(size_t)col*fNRows + row];
+        if(cell < 0) cell = i; // a pixel read twice stays in the same cluster
+    }
+
+    // number the clusters in the order of their first pixel
+    fLabel.assign(npix, -1);
+    fOffsets.assign(1, 0);
+    fNClusters = 0;
+    for(Int_t i=0; i<npix; ++i) {
+        const Int_t root = Find(i);
+        if(root == i) {
+            fLabel[i] = fNClusters++;
+            fOffsets.push_back(0);
+        }
+        else fLabel[i] = fLabel[root];
+        fOffsets[fLabel[i]+1]++;
+    }
+
+    // group the pixels by cluster, keeping their order
+    for(Int_t k=0; k<fNClusters; ++k) fOffsets[k+1] += fOffsets[k];
+    fOrder.resize(npix);
+    vector<Int_t> next(fOffsets.begin(), fOffsets.end()-1);
+    for(Int_t i=0; i<npix; ++i) fOrder[next[fLabel[i]]++] = i;
+
+    return fNClusters;
+}
+
+// number of pixels in cluster <idx>
+//______________________________________________________________________
+Int_t BinaryClusterizer::GetClusterSize(Int_t idx) const {
+    if(idx < 0 || idx >= fNClusters) return 0;
+    return fOffsets[idx+1] - fOffsets[idx];
+}
+
+// copy the pixels of cluster <idx> into <cluster>
+//______________________________________________________________________
+void BinaryClusterizer::GetCluster(Int_t idx, BinaryCluster* cluster) {
+    cluster->Reset();
+    const Int_t n = GetClusterSize(idx);
+    if(!n) return;
+    fBuffer.resize(n);
+    for(Int_t k=0; k<n; ++k) fBuffer[k] = fPixels[fOrder[fOffsets[idx]+k]];
+    cluster->SetPixelArray(n, &fBuffer[0]);
+}
+
+// add all clusters to <plane>, optionally without the single hot pixel clusters,
+// return the number of clusters added
+//______________________________________________________________________
+Int_t BinaryClusterizer::FillPlane(BinaryPlane* plane, Bool_t rmSingleHotPix) {
+    BinaryCluster cluster;
+    Int_t nadded = 0;
+    for(Int_t i=0; i<fNClusters; ++i) {
+        GetCluster(i, &cluster);
+        if(rmSingleHotPix && cluster.GetNPixels()==1 && cluster.HasHotPixels()) continue;
+        plane->AddCluster(&cluster);
+        ++nadded;
+    }
+    return nadded;
+}
+
+// clear the map cells of the hit pixels, ready for the next event
+//______________________________________________________________________
+void BinaryClusterizer::Reset() {
+    for(size_t i=0; i<fPixels.size(); ++i)
+        fMap[(size_t)fPixels[i].GetCol()*fNRows + fPixels[i].GetRow()] = -1;
+    fPixels.clear();
+    fNClusters = 0;
+}
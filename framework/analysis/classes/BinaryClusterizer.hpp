@@ -0,0 +1,73 @@
+// Linear-time clustering of the hit pixels of one event
+
+#ifndef BINARYCLUSTERIZER_HPP
+#define BINARYCLUSTERIZER_HPP
+
+#include <vector>
+#include <TObject.h>
+
+#include "BinaryPixel.hpp"
+#include "BinaryCluster.hpp"
+#include "BinaryPlane.hpp"
+
+// Two pixels belong to the same cluster if they are neighbours in the <crown> crown
+// (|dcol| <= crown and |drow| <= crown), or are linked by a chain of such neighbours.
+//
+// Usage, for each event:
+//   clusterizer->Reset();
+//   clusterizer->AddPixel(pix);        // for each hit pixel
+//   Int_t nclu = clusterizer->Clusterize();
+//   clusterizer->GetCluster(i, cluster); // for i < nclu, or FillPlane(plane)
+//
+// The hit pixels are stored in a per-event map of the matrix (index of the pixel in
+// the event, -1 if not hit), so that the neighbours of a pixel are found with
+// (2*crown+1)^2 look-ups, and merged with a union-find. The cost is proportional to
+// the number of hit pixels, instead of its square when all pixel pairs are checked.
+// Only the cells of the hit pixels are cleared by Reset().
+//
+// Clusters are ordered by their first pixel in the event, and the pixels of a cluster
+// are kept in the order they were added.
+//__________________________________________________________________________
+
+class BinaryClusterizer: public TObject {
+
+private:
+
+    Int_t   fNCols;   // number of columns of the pixel map
+    Int_t   fNRows;   // number of rows of the pixel map
+    Short_t fCrown;   // neighbours are all pixels in <crown> crown
+    Int_t   fNClusters; // number of clusters found by the last Clusterize()
+
+    std::vector<Int_t>       fMap;      //! index of the hit pixel in each cell, -1 if none
+    std::vector<BinaryPixel> fPixels;   //! hit pixels of the event
+    std::vector<Int_t>       fParent;   //! union-find parent of each hit pixel
+    std::vector<Int_t>       fLabel;    //! cluster index of each hit pixel
+    std::vector<Int_t>       fOffsets;  //! first entry of each cluster in fOrder (+ end)
+    std::vector<Int_t>       fOrder;    //! hit pixel indices, grouped by cluster
+    std::vector<BinaryPixel> fBuffer;   //! pixels of the cluster being copied
+
+    Int_t  Find (Int_t i);
+    void   Union(Int_t i, Int_t j);
+
+public:
+
+    BinaryClusterizer(Int_t ncols=1024, Int_t nrows=512, Short_t crown=1);
+    virtual ~BinaryClusterizer() {}
+
+    Short_t GetCrown       () const {return fCrown;}
+    Int_t   GetNPixels     () const {return (Int_t)fPixels.size();}
+    Int_t   GetNClusters   () const {return fNClusters;}
+    Int_t   GetClusterSize (Int_t idx) const;
+
+    Bool_t  AddPixel  (const BinaryPixel& pix); // add a hit pixel to the event
+    Int_t   Clusterize();                       // find the clusters, return their number
+    void    GetCluster(Int_t idx, BinaryCluster* cluster); // copy the pixels of cluster <idx>
+    Int_t   FillPlane (BinaryPlane* plane, Bool_t rmSingleHotPix=kFALSE); // add all clusters to <plane>
+    void    Reset     ();                       // forget the pixels of the event
+
+    void    SetCrown  (Short_t crown) {fCrown = crown;}
+
+    ClassDef(BinaryClusterizer,1);
+};
+
+#endif
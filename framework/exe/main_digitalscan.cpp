@@ -80,6 +80,9 @@ int main(int argc, char** argv) {
         sprintf(fName, "digitalScan_%s.dat", suffix);
     }
     theDeviceTestor.SetPrefixFilename( fName );
+    theDeviceTestor.SetRecordRawEvents( mySetup.IsRawEventRecordingEnabled() );
+    theDeviceTestor.SetMonitorSegment( mySetup.GetMonitorSegmentName() );
+    theDeviceTestor.SetBuildEvents( mySetup.IsEventBuildingEnabled() );
     theDeviceTestor.Init();
     sleep(1);
     theDeviceTestor.Go(); // run the digital scan
@@ -89,7 +92,9 @@ int main(int argc, char** argv) {
 
     theDeviceTestor.WriteDataToFile( Recreate );
     theDeviceTestor.WriteCorruptedHitsToFile( Recreate );
-    theDeviceTestor.DrawAndSaveToFile();
+    if ( mySetup.IsPlottingEnabled() ) {
+        theDeviceTestor.DrawAndSaveToFile();
+    }
     
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,97 @@
+/**
+ * \brief This executable fits again the S-curves written by a threshold scan.
+ *
+ * The threshold scan writes, for each chip, a binary S-curve data file next to its
+ * text data file. This executable reads these binary files, fits the S-curve of each
+ * pixel with the same code as the scan, with several threads, and writes the fit
+ * results (same text file as the scan) and the threshold, noise and chi2/ndf maps
+ * (ROOT file) of each chip. See the class TSCurveFitter.
+ *
+ * It replaces the ROOT macros analysis/FitThresholds.C and analysis/ThresholdMap.C
+ * for the data written by the framework.
+ *
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include "TSCurveFitter.h"
+#include "TVerbosity.h"
+
+using namespace std;
+
+// Example of usage : fit the S-curves written in the files
+// ../../data/ThresholdScan_ladder25_180614_101010-B0-ladder25-Rx*-chip*.scurve
+// ./test_fitthresholds -f ThresholdScan_ladder25_180614_101010.dat -j 8
+//
+// If you want to see the available options, do :
+// ./test_fitthresholds -h
+//
+
+//___________________________________________________________________
+void PrintUsage( const char* exeName )
+{
+    cout << endl;
+    cout << "Usage : " << exeName << " -f <file name> [options]" << endl;
+    cout << "-h : Display this message" << endl;
+    cout << "-f <file name> : file name given to the threshold scan (mandatory)" << endl;
+    cout << "-j <nThreads> : number of threads (default = number of cores)" << endl;
+    cout << "-b <nPixels> : number of pixels fitted by a single task (default = 4096)" << endl;
+    cout << "-v <level> : verbosity level (default = 0)" << endl;
+    cout << endl;
+}
+
+//___________________________________________________________________
+int main(int argc, char** argv) {
+
+    string fileName;
+    unsigned int nThreads = thread::hardware_concurrency();
+    unsigned int blockSize = 4096;
+    int verboseLevel = TVerbosity::kSILENT;
+
+    int c;
+    while ( (c = getopt( argc, argv, "hf:j:b:v:" )) != -1 ) {
+        switch ( c ) {
+            case 'h':
+                PrintUsage( argv[0] );
+                return EXIT_SUCCESS;
+            case 'f':
+                fileName = string( optarg );
+                break;
+            case 'j':
+                nThreads = atoi( optarg );
+                break;
+            case 'b':
+                blockSize = atoi( optarg );
+                break;
+            case 'v':
+                verboseLevel = atoi( optarg );
+                break;
+            default:
+                PrintUsage( argv[0] );
+                return EXIT_FAILURE;
+        }
+    }
+    if ( fileName.empty() ) {
+        cerr << "Missing file name, exit!" << endl;
+        PrintUsage( argv[0] );
+        return EXIT_FAILURE;
+    }
+
+    TSCurveFitter theFitter( fileName );
+    theFitter.SetVerboseLevel( verboseLevel );
+    theFitter.SetBlockSize( blockSize );
+    theFitter.FindChips();
+    if ( !theFitter.GetNChips() ) {
+        cout << "No S-curve data file found, exit!" << endl;
+        return EXIT_FAILURE;
+    }
+    const unsigned int nFailed = theFitter.Go( nThreads );
+    if ( nFailed ) {
+        cout << nFailed << " chip(s) could not be fitted." << endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,161 @@
+/**
+ * \brief This executable displays the live monitoring of a running scan.
+ *
+ * A scan started with the option -m <segment> publishes, at most once per second and
+ * per board, a snapshot of the hit map and of the error counters of each chip in a
+ * shared memory segment (see the class TMonitorPublisher). This executable maps the
+ * segment read-only and prints, at each refresh, the number of hits, of hit pixels and
+ * the hit rate of each chip, with its error counters. It never slows down the scan.
+ *
+ * The hit maps of the last snapshot can also be written to a text file (one line
+ * "dcol address hits" per hit pixel), with the same format as the scans.
+ *
+ */
+
+#include <iostream>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "TMonitorReader.h"
+#include "TVerbosity.h"
+
+using namespace std;
+
+// Example of usage : start the noise occupancy scan with the live monitoring
+// ./test_noiseocc -c ../config/ConfigMFTladder_IPHC.cfg -m /mlo-monitor
+// then, in another terminal, refresh the display every 2 seconds
+// ./test_monitor -m /mlo-monitor -t 2000
+//
+// If you want to see the available options, do :
+// ./test_monitor -h
+//
+
+//___________________________________________________________________
+void PrintUsage( const char* exeName )
+{
+    cout << endl;
+    cout << "Usage : " << exeName << " [options]" << endl;
+    cout << "-h : Display this message" << endl;
+    cout << "-m <segment> : name of the shared memory segment of the scan (default = "
+         << MonitorSegment::DEFAULT_NAME << ")" << endl;
+    cout << "-t <period> : time between two refreshes in ms (default = 1000)" << endl;
+    cout << "-n <nRefresh> : number of refreshes, 0 = until the end of the scan (default = 0)" << endl;
+    cout << "-o <file name> : write the hit maps of the last snapshot in a text file (one per chip)" << endl;
+    cout << "-v <level> : verbosity level (default = 0)" << endl;
+    cout << endl;
+}
+
+//___________________________________________________________________
+void WriteHitMaps( const TMonitorReader& reader, const string fileName )
+{
+    TMonitorSnapshot snapshot;
+    for ( unsigned int ichip = 0; ichip < reader.GetNChips(); ichip++ ) {
+        if ( !reader.ReadSnapshot( ichip, snapshot ) ) continue;
+        unsigned int board, receiver, deviceId, chipId;
+        reader.GetChipId( ichip, board, receiver, deviceId, chipId );
+        char name[200];
+        snprintf( name, sizeof(name), "%s-B%d-Rx%d-chip%d.dat", fileName.c_str(), board, receiver, chipId );
+        FILE* fp = fopen( name, "w" );
+        if ( !fp ) {
+            cerr << "Can not open output file " << name << endl;
+            continue;
+        }
+        const unsigned int nBins2 = reader.GetNBins( 1 );
+        for ( unsigned int key = 0; key < snapshot.hits.size(); key++ ) {
+            if ( !snapshot.hits[key] ) continue;
+            fprintf( fp, "%d %d %d\n", key / nBins2, key % nBins2, snapshot.hits[key] );
+        }
+        fclose( fp );
+    }
+}
+
+//___________________________________________________________________
+int main(int argc, char** argv) {
+
+    string segmentName = MonitorSegment::DEFAULT_NAME;
+    string fileName;
+    unsigned int period = 1000;
+    unsigned int nRefresh = 0;
+    int verboseLevel = TVerbosity::kSILENT;
+
+    int c;
+    while ( (c = getopt( argc, argv, "hm:t:n:o:v:" )) != -1 ) {
+        switch ( c ) {
+            case 'h':
+                PrintUsage( argv[0] );
+                return EXIT_SUCCESS;
+            case 'm':
+                segmentName = string( optarg );
+                break;
+            case 't':
+                period = atoi( optarg );
+                break;
+            case 'n':
+                nRefresh = atoi( optarg );
+                break;
+            case 'o':
+                fileName = string( optarg );
+                break;
+            case 'v':
+                verboseLevel = atoi( optarg );
+                break;
+            default:
+                PrintUsage( argv[0] );
+                return EXIT_FAILURE;
+        }
+    }
+
+    TMonitorReader reader;
+    reader.SetVerboseLevel( verboseLevel );
+    try {
+        reader.Attach( segmentName );
+    } catch ( exception& err ) {
+        cerr << err.what() << endl;
+        cerr << "Is a scan running with the option -m " << segmentName << " ?" << endl;
+        return EXIT_FAILURE;
+    }
+
+    const unsigned int nChips = reader.GetNChips();
+    vector<TMonitorSnapshot> last( nChips );
+    TMonitorSnapshot snapshot;
+    const bool withHitMap = false;
+    for ( unsigned int irefresh = 0; !nRefresh || (irefresh < nRefresh); irefresh++ ) {
+        this_thread::sleep_for( chrono::milliseconds( period ) );
+
+        // the scan removes the segment at its end, but the mapping stays valid
+        if ( kill( (pid_t)reader.GetWriterPid(), 0 ) != 0 ) {
+            cout << "The scan is over." << endl;
+            break;
+        }
+        cout << endl << "  board  rx  chip      hits  hit pixels   hits/s  corrupted  prio  8b10b  timeouts" << endl;
+        for ( unsigned int ichip = 0; ichip < nChips; ichip++ ) {
+            unsigned int board, receiver, deviceId, chipId;
+            reader.GetChipId( ichip, board, receiver, deviceId, chipId );
+            if ( !reader.ReadSnapshot( ichip, snapshot, withHitMap ) ) {
+                printf( "  %5d  %2d  %4d   (no snapshot yet)\n", board, receiver, chipId );
+                continue;
+            }
+            double rate = 0;
+            // the hits of a scan stage can be cleared before the next one
+            if ( last.at(ichip).sequence && (snapshot.publishTime > last.at(ichip).publishTime)
+                && (snapshot.nEntries >= last.at(ichip).nEntries) ) {
+                rate = 1000. * (snapshot.nEntries - last.at(ichip).nEntries)
+                    / (snapshot.publishTime - last.at(ichip).publishTime);
+            }
+            printf( "  %5d  %2d  %4d  %8llu  %10d  %7.1f  %9d  %4d  %5d  %8d\n",
+                    board, receiver, chipId, (unsigned long long)snapshot.nEntries,
+                    snapshot.nHitPixels, rate, snapshot.nCorruptedHits, snapshot.nPrioEncoder,
+                    snapshot.n8b10b, snapshot.nTimeout );
+            last.at(ichip) = snapshot;
+        }
+    }
+    if ( !fileName.empty() ) {
+        WriteHitMaps( reader, fileName );
+    }
+    return EXIT_SUCCESS;
+}
@@ -21,6 +21,8 @@ using namespace std;
 
 // Example of usage : for a verbosity level 3
 // ./test_multi_digitalscan 3
+// and to only write the data files, without drawing the plots (see test_plotresults)
+// ./test_multi_digitalscan 3 0
 //
 
 int main(int argc, char** argv) {
@@ -33,6 +35,10 @@ int main(int argc, char** argv) {
     } else {
         myOperator.SetVerboseLevel( 2 );
     }
+    // same as the option -p of the single-device scans
+    if ( argc >= 3 ) {
+        myOperator.SetPlotting( atoi(argv[2]) != 0 );
+    }
 
     char suffix[20], fName[100];
     
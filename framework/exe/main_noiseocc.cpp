@@ -82,6 +82,9 @@ int main(int argc, char** argv) {
         sprintf(fName, "noiseScan_%s.dat", suffix);
     }
     theDeviceTestor.SetPrefixFilename( fName );
+    theDeviceTestor.SetRecordRawEvents( mySetup.IsRawEventRecordingEnabled() );
+    theDeviceTestor.SetMonitorSegment( mySetup.GetMonitorSegmentName() );
+    theDeviceTestor.SetBuildEvents( mySetup.IsEventBuildingEnabled() );
     theDeviceTestor.Init();
     sleep(1);
     theDeviceTestor.Go(); // run the noise scan
@@ -90,7 +93,9 @@ int main(int argc, char** argv) {
     const bool Recreate = true;
 
     theDeviceTestor.WriteDataToFile( Recreate );
-    theDeviceTestor.DrawAndSaveToFile();
+    if ( mySetup.IsPlottingEnabled() ) {
+        theDeviceTestor.DrawAndSaveToFile();
+    }
     
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,117 @@
+/**
+ * \brief This executable draws the plots of a scan from the data files that it wrote.
+ *
+ * The scans (digital scan, threshold scan, noise occupancy scan) can be run without
+ * drawing anything (option -p 0), and the plots be produced afterwards with this
+ * executable, one worker process per chip. See the class TResultPlotter.
+ *
+ * The file name to give is the one used by the scan, e.g. the name printed by the scan
+ * at the end of the run, or the common part of the names of its data files.
+ *
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include "TResultPlotter.h"
+#include "TVerbosity.h"
+
+using namespace std;
+
+// Example of usage : plot the results of the threshold scan written in the files
+// ../../data/ThresholdScan_ladder25_180614_101010-B0-ladder25-Rx*-chip*.dat
+// ./test_plotresults -s threshold -f ThresholdScan_ladder25_180614_101010.dat -j 4
+//
+// If you want to see the available options, do :
+// ./test_plotresults -h
+//
+
+//___________________________________________________________________
+void PrintUsage( const char* exeName )
+{
+    cout << endl;
+    cout << "Usage : " << exeName << " -s <scan> -f <file name> [options]" << endl;
+    cout << "-h : Display this message" << endl;
+    cout << "-s <scan> : type of scan, digital, threshold or noiseocc (mandatory)" << endl;
+    cout << "-f <file name> : file name given to the scan (mandatory)" << endl;
+    cout << "-j <nWorkers> : maximum number of worker processes (default = number of cores)" << endl;
+    cout << "-n <nInjections> : number of injections per pixel in the scan (default = 50)" << endl;
+    cout << "-q <maxCharge> : maximum injected charge in the threshold scan, in DAC units (default = 50)" << endl;
+    cout << "-v <level> : verbosity level (default = 0)" << endl;
+    cout << endl;
+}
+
+//___________________________________________________________________
+int main(int argc, char** argv) {
+
+    string scanName, fileName;
+    unsigned int nWorkers = thread::hardware_concurrency();
+    unsigned int nInjections = 50, maxCharge = 50;
+    int verboseLevel = TVerbosity::kSILENT;
+
+    int c;
+    while ( (c = getopt( argc, argv, "hs:f:j:n:q:v:" )) != -1 ) {
+        switch ( c ) {
+            case 'h':
+                PrintUsage( argv[0] );
+                return EXIT_SUCCESS;
+            case 's':
+                scanName = string( optarg );
+                break;
+            case 'f':
+                fileName = string( optarg );
+                break;
+            case 'j':
+                nWorkers = atoi( optarg );
+                break;
+            case 'n':
+                nInjections = atoi( optarg );
+                break;
+            case 'q':
+                maxCharge = atoi( optarg );
+                break;
+            case 'v':
+                verboseLevel = atoi( optarg );
+                break;
+            default:
+                PrintUsage( argv[0] );
+                return EXIT_FAILURE;
+        }
+    }
+
+    TResultType type;
+    if ( scanName == "digital" ) {
+        type = TResultType::kDIGITAL_SCAN;
+    } else if ( scanName == "threshold" ) {
+        type = TResultType::kTHRESHOLD_SCAN;
+    } else if ( scanName == "noiseocc" ) {
+        type = TResultType::kNOISE_OCC_SCAN;
+    } else {
+        cerr << "Unknown or missing type of scan, exit!" << endl;
+        PrintUsage( argv[0] );
+        return EXIT_FAILURE;
+    }
+    if ( fileName.empty() ) {
+        cerr << "Missing file name, exit!" << endl;
+        PrintUsage( argv[0] );
+        return EXIT_FAILURE;
+    }
+
+    TResultPlotter thePlotter( type, fileName );
+    thePlotter.SetVerboseLevel( verboseLevel );
+    thePlotter.SetNInjections( nInjections );
+    thePlotter.SetMaxInjectedCharge( maxCharge );
+    thePlotter.FindChips();
+    if ( !thePlotter.GetNChips() ) {
+        cout << "No data file found, exit!" << endl;
+        return EXIT_FAILURE;
+    }
+    const unsigned int nFailed = thePlotter.Go( nWorkers );
+    if ( nFailed ) {
+        cout << nFailed << " chip(s) could not be plotted." << endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -66,7 +66,7 @@ int main() {
             float region = floor( ((float)dcol[ip])/((float)common::NDCOL_PER_REGION) );
             pix->SetRegion( (unsigned int)region );
             pix->SetPixFlag( TPixFlag::kDEAD );
-            hitmap->AddDeadPixel( pix );
+            hitmap->AddDeadPixel( pix->GetColumn(), pix->GetRow() );
         }
         hitmap->Draw();
         hitmap->SaveToFile( "plots.pdf" );
@@ -80,6 +80,8 @@ int main(int argc, char** argv) {
         sprintf(fName, "thresholdScan_%s.dat", suffix);
     }
     theDeviceTestor.SetPrefixFilename( fName );
+    theDeviceTestor.SetRecordRawEvents( mySetup.IsRawEventRecordingEnabled() );
+    theDeviceTestor.SetMonitorSegment( mySetup.GetMonitorSegmentName() );
     theDeviceTestor.Init();
     sleep(1);
     theDeviceTestor.Go(); // run the digital scan
@@ -88,7 +90,9 @@ int main(int argc, char** argv) {
     const bool Recreate = true;
 
     theDeviceTestor.WriteDataToFile( Recreate );
-    theDeviceTestor.DrawAndSaveToFile();
+    if ( mySetup.IsPlottingEnabled() ) {
+        theDeviceTestor.DrawAndSaveToFile();
+    }
     
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,227 @@
+/**
+ * \brief This executable decodes the binary trace of the data parser and decoder.
+ *
+ * When the framework is built with cmake -DHOT_TRACE=ON, the hot loops of the MOSAIC
+ * data parser and of the ALPIDE decoder write fixed-size records in a ring buffer per
+ * thread, instead of printing each data word (see the class THotTrace). The scans
+ * write the rings at their end in ../../data/<scan>.trace.bin. This executable prints
+ * the records of such a file as text, and flags the records showing corrupted data
+ * (region or data words out of order, data without region, decoder errors, bad hits).
+ *
+ */
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "THotTrace.h"
+
+using namespace std;
+
+// Example of usage : print the records of board 0 that show corrupted data
+// ./test_tracedump -f ../../data/NoiseOccScan_171212_1012.trace.bin -b 0 -e
+//
+// If you want to see the available options, do :
+// ./test_tracedump -h
+//
+
+//___________________________________________________________________
+void PrintUsage( const char* exeName )
+{
+    cout << endl;
+    cout << "Usage : " << exeName << " -f <file name> [options]" << endl;
+    cout << "-h : Display this message" << endl;
+    cout << "-f <file name> : trace file written by a scan" << endl;
+    cout << "-b <board> : only the records of a given board" << endl;
+    cout << "-r <receiver> : only the records of a given receiver" << endl;
+    cout << "-t <trigger> : only the records of a given trigger number" << endl;
+    cout << "-e : only the records showing corrupted data" << endl;
+    cout << endl;
+}
+
+//___________________________________________________________________
+const char* GetDataTypeName( const uint32_t type )
+{
+    // in the order of the enum class TDataType (see TAlpideDecoder.h)
+    static const char* names[] = { "IDLE", "CHIPHEADER", "CHIPTRAILER", "EMPTYFRAME", "REGIONHEADER",
+                                   "DATASHORT", "DATALONG", "BUSYON", "BUSYOFF", "UNKNOWN" };
+    return ( type < sizeof(names) / sizeof(names[0]) ) ? names[type] : "?";
+}
+
+//___________________________________________________________________
+const char* GetErrorName( const uint32_t code )
+{
+    switch ( code ) {
+        case HotTrace::kTRAILER_BEFORE_HEADER: return "chip trailer before chip header";
+        case HotTrace::kTRAILER_AFTER_END:     return "chip trailer after end of event";
+        case HotTrace::kREGION_OUTSIDE_CHIP:   return "region header outside chip data";
+        case HotTrace::kHIT_OUTSIDE_CHIP:      return "hit data outside chip data";
+        case HotTrace::kHIT_WITHOUT_REGION:    return "hit data without region";
+        case HotTrace::kUNEXPECTED_CHIP_ID:    return "unexpected chip id";
+        case HotTrace::kUNKNOWN_WORD:          return "data word of unknown type";
+        case HotTrace::kEVENT_NOT_FINISHED:    return "event not finished at end of data";
+        case HotTrace::kEVENT_NOT_STARTED:     return "event not started at end of data";
+        default:                               return "unknown error";
+    }
+}
+
+//___________________________________________________________________
+// describe the arguments of a record, return true if it shows corrupted data
+bool DescribeRecord( const HotTrace::TRecord& record, char* text, const size_t size )
+{
+    const uint32_t* a = record.args;
+    bool corrupted = false;
+    switch ( record.site ) {
+        case HotTrace::kPARSER_EMPTYFRAME:
+        case HotTrace::kPARSER_CHIPHEADER:
+            snprintf( text, size, "chip %u , frame start data 0x%02x", a[0], a[1] );
+            break;
+        case HotTrace::kPARSER_CHIPTRAILER:
+            corrupted = ( a[1] != 0 );
+            snprintf( text, size, "readout flags 0x%x , event flags 0x%02x%s%s", a[0], a[1],
+                      (a[1] & 0x1) ? " (header error)" : "", (a[1] & 0x2) ? " (10b8b decoder error)" : "" );
+            break;
+        case HotTrace::kPARSER_REGIONHEADER:
+            corrupted = ( (int32_t)a[1] >= 0 ) && ( a[0] <= a[1] );
+            snprintf( text, size, "region %u , previous %d%s", a[0], (int32_t)a[1],
+                      corrupted ? " (REGION_HEADER ERROR)" : "" );
+            break;
+        case HotTrace::kPARSER_DATASHORT:
+        case HotTrace::kPARSER_DATALONG: {
+            const bool isLong = ( record.site == HotTrace::kPARSER_DATALONG );
+            const int32_t lastDataField = (int32_t)a[isLong ? 2 : 1];
+            const int32_t region = (int32_t)a[isLong ? 3 : 2];
+            const bool noRegion = ( region < 0 );
+            const bool unordered = ( (int32_t)a[0] < lastDataField );
+            corrupted = noRegion || unordered;
+            char hitMap[32] = "";
+            if ( isLong ) snprintf( hitMap, sizeof(hitMap), " , hit map 0x%02x", a[1] );
+            snprintf( text, size, "data 0x%04x%s , previous 0x%x , region %d%s%s", a[0], hitMap,
+                      (uint32_t)lastDataField, region, noRegion ? " (without region header)" : "",
+                      unordered ? " (data not in order)" : "" );
+            break;
+        }
+        case HotTrace::kPARSER_UNKNOWN:
+            corrupted = true;
+            snprintf( text, size, "unknown data header 0x%02x at byte %u", a[0], a[1] );
+            break;
+        case HotTrace::kDECODER_EVENT:
+            snprintf( text, size, "%u bytes , trigger time %llu", a[0],
+                      ((unsigned long long)a[2] << 32) | a[1] );
+            break;
+        case HotTrace::kDECODER_WORD:
+            snprintf( text, size, "byte %u : 0x%02x %s , chip %d", a[0], a[1], GetDataTypeName( a[2] ), (int32_t)a[3] );
+            break;
+        case HotTrace::kDECODER_HIT:
+            // TPixFlag::kOK = 0
+            corrupted = ( a[3] != 0 );
+            snprintf( text, size, "chip %d , region %d , dcol %u , address %u , flag %u", (int32_t)a[0], (int32_t)a[1],
+                      a[2] >> 16, a[2] & 0xffff, a[3] );
+            break;
+        case HotTrace::kDECODER_ERROR:
+            corrupted = true;
+            snprintf( text, size, "%s , byte %u : 0x%02x , chip %d", GetErrorName( a[0] ), a[1], a[2], (int32_t)a[3] );
+            break;
+        case HotTrace::kDECODER_END:
+            corrupted = ( (a[0] & 0x4) != 0 );
+            snprintf( text, size, "started %u , finished %u , corrupt %u , %u hits",
+                      a[0] & 0x1, (a[0] >> 1) & 0x1, (a[0] >> 2) & 0x1, a[1] );
+            break;
+        default:
+            snprintf( text, size, "0x%x 0x%x 0x%x 0x%x", a[0], a[1], a[2], a[3] );
+            break;
+    }
+    return corrupted;
+}
+
+//___________________________________________________________________
+int main(int argc, char** argv) {
+
+    string fileName;
+    int board = -1;
+    int receiver = -1;
+    long long trgNum = -1;
+    bool onlyCorrupted = false;
+
+    int c;
+    while ( (c = getopt( argc, argv, "hf:b:r:t:e" )) != -1 ) {
+        switch ( c ) {
+            case 'h':
+                PrintUsage( argv[0] );
+                return EXIT_SUCCESS;
+            case 'f':
+                fileName = string( optarg );
+                break;
+            case 'b':
+                board = atoi( optarg );
+                break;
+            case 'r':
+                receiver = atoi( optarg );
+                break;
+            case 't':
+                trgNum = atoll( optarg );
+                break;
+            case 'e':
+                onlyCorrupted = true;
+                break;
+            default:
+                PrintUsage( argv[0] );
+                return EXIT_FAILURE;
+        }
+    }
+    if ( fileName.empty() ) {
+        PrintUsage( argv[0] );
+        return EXIT_FAILURE;
+    }
+
+    FILE* fp = fopen( fileName.c_str(), "rb" );
+    if ( !fp ) {
+        cerr << "Can not open trace file " << fileName << endl;
+        return EXIT_FAILURE;
+    }
+    HotTrace::TFileHeader header;
+    if ( (fread( &header, sizeof(header), 1, fp ) != 1)
+        || memcmp( header.magic, HotTrace::FILE_MAGIC, sizeof(header.magic) )
+        || (header.version != HotTrace::VERSION) ) {
+        cerr << fileName << " is not a trace file of a known version" << endl;
+        fclose( fp );
+        return EXIT_FAILURE;
+    }
+
+    vector<HotTrace::TRecord> records;
+    unsigned long long nPrinted = 0, nCorrupted = 0;
+    for ( unsigned int iring = 0; iring < header.nRings; iring++ ) {
+        HotTrace::TRingHeader ringHeader;
+        if ( fread( &ringHeader, sizeof(ringHeader), 1, fp ) != 1 ) {
+            cerr << "Truncated trace file, ring " << iring << endl;
+            break;
+        }
+        records.resize( ringHeader.nRecords );
+        if ( fread( records.data(), sizeof(HotTrace::TRecord), records.size(), fp ) != records.size() ) {
+            cerr << "Truncated trace file, ring " << iring << endl;
+            break;
+        }
+        cout << "Ring " << ringHeader.ring << " : " << ringHeader.nRecords << " record(s) out of "
+             << ringHeader.nWritten << " written" << endl;
+        for ( unsigned int i = 0; i < records.size(); i++ ) {
+            const HotTrace::TRecord& record = records[i];
+            if ( (board >= 0) && (record.board != board) ) continue;
+            if ( (receiver >= 0) && (record.receiver != receiver) ) continue;
+            if ( (trgNum >= 0) && (record.trgNum != trgNum) ) continue;
+            char text[200];
+            const bool corrupted = DescribeRecord( record, text, sizeof(text) );
+            if ( corrupted ) nCorrupted++;
+            if ( onlyCorrupted && !corrupted ) continue;
+            printf( "%c %10llu  board %3u rx %2u trigger %10u  %-20s %s\n", corrupted ? '!' : ' ',
+                    (unsigned long long)record.sequence, record.board, record.receiver, record.trgNum,
+                    THotTrace::GetSiteName( record.site ), text );
+            nPrinted++;
+        }
+    }
+    fclose( fp );
+    cout << nPrinted << " record(s) printed, " << nCorrupted << " showing corrupted data" << endl;
+    return EXIT_SUCCESS;
+}
@@ -1,3 +1,4 @@
+#include <cstdio>
 #include <iomanip>
 #include <iostream>
 #include <string>
@@ -37,6 +38,45 @@ string common::GetFileName( const common::TChipIndex aChipIndex,
     return fileName;
 }
 
+//___________________________________________________________________
+bool common::GetChipIndexFromFileName( const string fileName,
+                                       const string suffix,
+                                       common::TChipIndex& aChipIndex,
+                                       const string fileExtention )
+{
+    const string head = suffix + "-B";
+    if ( fileName.size() <= head.size() + fileExtention.size() ) {
+        return false;
+    }
+    if ( fileName.compare( 0, head.size(), head )
+        || fileName.compare( fileName.size() - fileExtention.size(), fileExtention.size(), fileExtention ) ) {
+        return false;
+    }
+    const string body = fileName.substr( head.size(), fileName.size() - head.size() - fileExtention.size() );
+    unsigned int board = 0, device = 0, receiver = 0, chip = 0;
+    int nchar = -1;
+    TDeviceType dt = TDeviceType::kUNKNOWN;
+    if ( sscanf( body.c_str(), "%u-ladder%u-Rx%u-chip%u%n", &board, &device, &receiver, &chip, &nchar ) == 4 ) {
+        dt = TDeviceType::kMFT_LADDER5;
+    } else if ( sscanf( body.c_str(), "%u-ibhic%u-Rx%u-chip%u%n", &board, &device, &receiver, &chip, &nchar ) == 4 ) {
+        dt = TDeviceType::kIBHIC;
+    } else {
+        nchar = -1;
+        if ( sscanf( body.c_str(), "%u-Rx%u-chip%u%n", &board, &receiver, &chip, &nchar ) != 3 ) {
+            return false;
+        }
+    }
+    if ( nchar != (int)body.size() ) {
+        return false; // e.g. a file name with an optional part
+    }
+    aChipIndex.boardIndex = board;
+    aChipIndex.dataReceiver = receiver;
+    aChipIndex.deviceType = dt;
+    aChipIndex.deviceId = device;
+    aChipIndex.chipId = chip;
+    return true;
+}
+
 //___________________________________________________________________
 bool common::SameChipIndex( const common::TChipIndex lhs, const common::TChipIndex rhs )
 {
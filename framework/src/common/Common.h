@@ -49,6 +49,14 @@ namespace common {
     extern std::string GetFileName( const TChipIndex aChipIndex,
                                    std::string suffix, std::string optional = "",
                                    std::string fileExtention = ".dat");
+
+    /// Function that retrieves the TChipIndex from the name (without directory) of a file
+    /// generated by GetFileName() with no optional part. The device type is only known as
+    /// a generic MFT ladder or IB hic, which is enough to build names and titles.
+    extern bool GetChipIndexFromFileName( const std::string fileName,
+                                          const std::string suffix,
+                                          TChipIndex& aChipIndex,
+                                          const std::string fileExtention = ".dat" );
     
     /// Compare two TChipIndex structures
     extern bool SameChipIndex( const TChipIndex lhs, const TChipIndex rhs );
@@ -0,0 +1,120 @@
+#include "THotTrace.h"
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+using namespace std;
+
+mutex THotTrace::fMutex;
+vector<unique_ptr<THotTrace::TRing>> THotTrace::fRings;
+size_t THotTrace::fRingSize = THotTrace::DEFAULTRINGSIZE;
+thread_local THotTrace::TRing* THotTrace::fLocalRing = nullptr;
+
+//___________________________________________________________________
+THotTrace::TRing* THotTrace::AcquireRing()
+{
+    // gives the ring back when the thread exits
+    struct TRingRelease {
+        TRing* ring = nullptr;
+        ~TRingRelease()
+        {
+            if ( !ring ) return;
+            lock_guard<mutex> lock( fMutex );
+            ring->inUse = false;
+            fLocalRing = nullptr;
+        }
+    };
+    static thread_local TRingRelease release;
+
+    lock_guard<mutex> lock( fMutex );
+    TRing* ring = nullptr;
+    for ( unsigned int i = 0; i < fRings.size(); i++ ) {
+        if ( !fRings.at(i)->inUse ) {
+            ring = fRings.at(i).get();
+            break;
+        }
+    }
+    if ( !ring ) {
+        fRings.push_back( unique_ptr<TRing>( new TRing() ) );
+        ring = fRings.back().get();
+        ring->records.resize( fRingSize );
+        ring->nWritten = 0;
+    }
+    ring->inUse = true;
+    release.ring = ring;
+    fLocalRing = ring;
+    return ring;
+}
+
+//___________________________________________________________________
+void THotTrace::SetRingSize( const size_t nRecords )
+{
+    size_t size = 1;
+    while ( size < nRecords ) size <<= 1;
+    lock_guard<mutex> lock( fMutex );
+    fRingSize = size;
+}
+
+//___________________________________________________________________
+void THotTrace::Reset()
+{
+    lock_guard<mutex> lock( fMutex );
+    for ( unsigned int i = 0; i < fRings.size(); i++ ) {
+        fRings.at(i)->nWritten = 0;
+    }
+}
+
+//___________________________________________________________________
+void THotTrace::WriteToFile( const string fileName )
+{
+    FILE* fp = fopen( fileName.c_str(), "wb" );
+    if ( !fp ) {
+        throw runtime_error( "THotTrace::WriteToFile() - can not open output file " + fileName );
+    }
+    lock_guard<mutex> lock( fMutex );
+    HotTrace::TFileHeader header;
+    memset( &header, 0, sizeof(header) );
+    memcpy( header.magic, HotTrace::FILE_MAGIC, sizeof(header.magic) );
+    header.version = HotTrace::VERSION;
+    header.nRings = fRings.size();
+    fwrite( &header, sizeof(header), 1, fp );
+    for ( unsigned int i = 0; i < fRings.size(); i++ ) {
+        const TRing& ring = *(fRings.at(i));
+        const size_t size = ring.records.size();
+        HotTrace::TRingHeader ringHeader;
+        ringHeader.ring = i;
+        ringHeader.nRecords = ( ring.nWritten < size ) ? ring.nWritten : size;
+        ringHeader.nWritten = ring.nWritten;
+        fwrite( &ringHeader, sizeof(ringHeader), 1, fp );
+        // oldest records first: from the write position to the end, then from the start
+        const size_t first = ( ring.nWritten < size ) ? 0 : ring.nWritten & (size - 1);
+        const size_t nTail = ( ring.nWritten < size ) ? ringHeader.nRecords : size - first;
+        fwrite( ring.records.data() + first, sizeof(HotTrace::TRecord), nTail, fp );
+        fwrite( ring.records.data(), sizeof(HotTrace::TRecord), ringHeader.nRecords - nTail, fp );
+    }
+    const bool success = !ferror( fp );
+    fclose( fp );
+    if ( !success ) {
+        throw runtime_error( "THotTrace::WriteToFile() - failed to write to " + fileName );
+    }
+}
+
+//___________________________________________________________________
+const char* THotTrace::GetSiteName( const uint16_t site )
+{
+    switch ( site ) {
+        case HotTrace::kPARSER_EMPTYFRAME:   return "PARSER_EMPTYFRAME";
+        case HotTrace::kPARSER_CHIPHEADER:   return "PARSER_CHIPHEADER";
+        case HotTrace::kPARSER_CHIPTRAILER:  return "PARSER_CHIPTRAILER";
+        case HotTrace::kPARSER_REGIONHEADER: return "PARSER_REGIONHEADER";
+        case HotTrace::kPARSER_DATASHORT:    return "PARSER_DATASHORT";
+        case HotTrace::kPARSER_DATALONG:     return "PARSER_DATALONG";
+        case HotTrace::kPARSER_UNKNOWN:      return "PARSER_UNKNOWN";
+        case HotTrace::kDECODER_EVENT:       return "DECODER_EVENT";
+        case HotTrace::kDECODER_WORD:        return "DECODER_WORD";
+        case HotTrace::kDECODER_HIT:         return "DECODER_HIT";
+        case HotTrace::kDECODER_ERROR:       return "DECODER_ERROR";
+        case HotTrace::kDECODER_END:         return "DECODER_END";
+        default:                             return "UNKNOWN";
+    }
+}
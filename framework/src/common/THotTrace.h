@@ -0,0 +1,177 @@
+#ifndef HOT_TRACE_H
+#define HOT_TRACE_H
+
+/**
+ * \class THotTrace
+ *
+ * \brief Binary trace of the hot loops of the data parser and decoder: fixed-size
+ * records written in a ring buffer per thread, dumped in a file and decoded offline
+ * (see the executable test_tracedump)
+ *
+ * \author Andry Rakotozafindrabe
+ *
+ * A record holds the trace site, the board, receiver and trigger number of the event,
+ * and up to four integer arguments whose meaning depends on the site. Each thread
+ * writing records gets its own ring (allocated at its first record, then reused by
+ * the next threads once it exits), so that adding a record takes no lock and no
+ * allocation; when a ring is full, the oldest records are overwritten.
+ *
+ * The trace sites (HOT_TRACE macro) are removed at compile time unless
+ * WITH_HOT_TRACE is defined (cmake -DHOT_TRACE=ON): the hot loops then carry no trace
+ * code at all, and their arguments are never evaluated.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace HotTrace {
+
+    /// identifies a trace file
+    static const char FILE_MAGIC[8] = { 'M', 'L', 'O', 'T', 'R', 'A', 'C', 'E' };
+
+    /// current version of the layout
+    static const std::uint32_t VERSION = 1;
+
+    /// trace sites, with the meaning of the arguments of their records
+    enum TSite : std::uint16_t {
+        kPARSER_EMPTYFRAME = 1, ///< chip id, frame start data
+        kPARSER_CHIPHEADER,     ///< chip id, frame start data
+        kPARSER_CHIPTRAILER,    ///< readout flags, event flags
+        kPARSER_REGIONHEADER,   ///< region, previous region (-1 if none)
+        kPARSER_DATASHORT,      ///< data field, previous data field (-1 if none), region (-1 if none)
+        kPARSER_DATALONG,       ///< data field, hit map, previous data field (-1 if none), region (-1 if none)
+        kPARSER_UNKNOWN,        ///< data byte, offset in the event
+        kDECODER_EVENT,         ///< event size in bytes, trigger time (low and high 32 bits)
+        kDECODER_WORD,          ///< offset in the event, data byte, data type, chip id
+        kDECODER_HIT,           ///< chip id, region, double column << 16 | address, pixel flag
+        kDECODER_ERROR,         ///< error code (TDecoderError), offset in the event, data byte, chip id
+        kDECODER_END,           ///< started | finished << 1 | corrupt << 2, number of hits
+        kNSITES
+    };
+
+    /// errors found by the decoder (first argument of kDECODER_ERROR)
+    enum TDecoderError : std::uint32_t {
+        kTRAILER_BEFORE_HEADER = 1,
+        kTRAILER_AFTER_END,
+        kREGION_OUTSIDE_CHIP,
+        kHIT_OUTSIDE_CHIP,
+        kHIT_WITHOUT_REGION,
+        kUNEXPECTED_CHIP_ID,
+        kUNKNOWN_WORD,
+        kEVENT_NOT_FINISHED,
+        kEVENT_NOT_STARTED
+    };
+
+    struct TFileHeader {
+        char          magic[8];
+        std::uint32_t version;
+        /// number of rings in the file
+        std::uint32_t nRings;
+    };
+
+    /// header of a ring, followed by its records from the oldest to the newest
+    struct TRingHeader {
+        /// index of the ring
+        std::uint32_t ring;
+        /// number of records stored in the file
+        std::uint32_t nRecords;
+        /// number of records written in the ring since the last reset
+        std::uint64_t nWritten;
+    };
+
+    struct TRecord {
+        /// index of the record in its ring since the last reset
+        std::uint64_t sequence;
+        /// trigger number of the event
+        std::uint32_t trgNum;
+        /// trace site (TSite)
+        std::uint16_t site;
+        /// board and receiver of the event
+        std::uint8_t  board;
+        std::uint8_t  receiver;
+        std::uint32_t args[4];
+    };
+
+    static_assert( sizeof(TFileHeader) == 16, "unexpected size of HotTrace::TFileHeader" );
+    static_assert( sizeof(TRingHeader) == 16, "unexpected size of HotTrace::TRingHeader" );
+    static_assert( sizeof(TRecord) == 32, "unexpected size of HotTrace::TRecord" );
+}
+
+class THotTrace {
+
+    /// ring of records of a thread
+    struct TRing {
+        std::vector<HotTrace::TRecord> records;
+        std::uint64_t nWritten;
+        bool inUse;
+    };
+
+    /// guards the list of rings (not the records)
+    static std::mutex fMutex;
+
+    /// all rings created so far
+    static std::vector<std::unique_ptr<TRing>> fRings;
+
+    /// number of records of the rings created from now on (power of two)
+    static std::size_t fRingSize;
+
+    /// ring of the current thread (null until its first record)
+    static thread_local TRing* fLocalRing;
+
+    /// give a ring to the current thread
+    static TRing* AcquireRing();
+
+public:
+
+    /// default number of records per ring (8 MB)
+    static const std::size_t DEFAULTRINGSIZE = 1 << 18;
+
+    /// add a record to the ring of the current thread
+    static void Add( const HotTrace::TSite site,
+                     const unsigned int board,
+                     const unsigned int receiver,
+                     const std::uint32_t trgNum,
+                     const std::uint32_t arg0 = 0,
+                     const std::uint32_t arg1 = 0,
+                     const std::uint32_t arg2 = 0,
+                     const std::uint32_t arg3 = 0 )
+    {
+        TRing* ring = fLocalRing ? fLocalRing : AcquireRing();
+        HotTrace::TRecord& record = ring->records[ring->nWritten & (ring->records.size() - 1)];
+        record.sequence = ring->nWritten++;
+        record.trgNum   = trgNum;
+        record.site     = site;
+        record.board    = (std::uint8_t)board;
+        record.receiver = (std::uint8_t)receiver;
+        record.args[0]  = arg0;
+        record.args[1]  = arg1;
+        record.args[2]  = arg2;
+        record.args[3]  = arg3;
+    }
+
+    /// set the number of records of the rings created from now on (rounded up to a power of two)
+    static void SetRingSize( const std::size_t nRecords );
+
+    /// forget all records (only between two runs, when no thread adds records)
+    static void Reset();
+
+    /// write all rings in a binary file (only when no thread adds records)
+    static void WriteToFile( const std::string fileName );
+
+    /// name of a trace site
+    static const char* GetSiteName( const std::uint16_t site );
+
+};
+
+#ifdef WITH_HOT_TRACE
+#define HOT_TRACE( ... ) THotTrace::Add( __VA_ARGS__ )
+#else
+// never evaluated, removed by the compiler, but the trace sites are still type-checked
+#define HOT_TRACE( ... ) do { if ( false ) THotTrace::Add( __VA_ARGS__ ); } while ( 0 )
+#endif
+
+#endif
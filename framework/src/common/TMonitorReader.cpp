@@ -0,0 +1,152 @@
+#include "TMonitorReader.h"
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+//___________________________________________________________________
+TMonitorReader::TMonitorReader() : TVerbosity(),
+fName( "" ),
+fMap( nullptr ),
+fMapSize( 0 )
+{
+    memset( &fHeader, 0, sizeof(fHeader) );
+}
+
+//___________________________________________________________________
+TMonitorReader::~TMonitorReader()
+{
+    Detach();
+}
+
+//___________________________________________________________________
+void TMonitorReader::Attach( const string name )
+{
+    Detach();
+    const int fd = shm_open( name.c_str(), O_RDONLY, 0 );
+    if ( fd < 0 ) {
+        throw runtime_error( "TMonitorReader::Attach() - no monitoring segment " + name );
+    }
+    struct stat st;
+    if ( (fstat( fd, &st ) != 0) || ((size_t)st.st_size < sizeof(MonitorSegment::TSegmentHeader)) ) {
+        close( fd );
+        throw runtime_error( "TMonitorReader::Attach() - " + name + " is not a monitoring segment." );
+    }
+    void* map = mmap( nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+    close( fd );
+    if ( map == MAP_FAILED ) {
+        throw runtime_error( "TMonitorReader::Attach() - can not map the monitoring segment " + name );
+    }
+    fMap = (const unsigned char*)map;
+    fMapSize = st.st_size;
+    fName = name;
+
+    // the header is written last by the scan: a valid magic means a ready segment
+    memcpy( &fHeader, fMap, sizeof(fHeader) );
+    atomic_thread_fence( memory_order_acquire );
+    if ( memcmp( fHeader.magic, MonitorSegment::SEGMENT_MAGIC, sizeof(fHeader.magic) ) ) {
+        Detach();
+        throw runtime_error( "TMonitorReader::Attach() - " + name + " is not ready or not a monitoring segment." );
+    }
+    if ( fHeader.version != MonitorSegment::VERSION ) {
+        Detach();
+        throw runtime_error( "TMonitorReader::Attach() - unknown version of the monitoring segment " + name );
+    }
+    if ( MonitorSegment::GetSegmentSize( fHeader.nChips, fHeader.nBins1, fHeader.nBins2 ) > fMapSize ) {
+        Detach();
+        throw runtime_error( "TMonitorReader::Attach() - truncated monitoring segment " + name );
+    }
+    if ( GetVerboseLevel() > kSILENT ) {
+        cout << "TMonitorReader::Attach() - " << name << " : " << std::dec << fHeader.nChips
+             << " chip(s), hit maps " << fHeader.nBins1 << " x " << fHeader.nBins2
+             << ", scan pid " << fHeader.writerPid << endl;
+    }
+}
+
+//___________________________________________________________________
+void TMonitorReader::Detach()
+{
+    if ( fMap ) {
+        munmap( (void*)fMap, fMapSize );
+    }
+    fMap = nullptr;
+    fMapSize = 0;
+    memset( &fHeader, 0, sizeof(fHeader) );
+}
+
+//___________________________________________________________________
+const MonitorSegment::TSlotHeader* TMonitorReader::GetSlot( const unsigned int ichip ) const
+{
+    if ( !fMap ) {
+        throw runtime_error( "TMonitorReader::GetSlot() - no segment ! Please use Attach() first." );
+    }
+    if ( ichip >= fHeader.nChips ) {
+        throw out_of_range( "TMonitorReader::GetSlot() - bad chip index" );
+    }
+    return (const MonitorSegment::TSlotHeader*)( fMap
+        + MonitorSegment::GetSlotOffset( ichip, fHeader.nBins1, fHeader.nBins2 ) );
+}
+
+//___________________________________________________________________
+void TMonitorReader::GetChipId( const unsigned int ichip,
+                                unsigned int& boardIndex,
+                                unsigned int& dataReceiver,
+                                unsigned int& deviceId,
+                                unsigned int& chipId ) const
+{
+    const MonitorSegment::TSlotHeader* slot = GetSlot( ichip );
+    boardIndex = slot->boardIndex;
+    dataReceiver = slot->dataReceiver;
+    deviceId = slot->deviceId;
+    chipId = slot->chipId;
+}
+
+//___________________________________________________________________
+bool TMonitorReader::ReadSnapshot( const unsigned int ichip,
+                                   TMonitorSnapshot& snapshot,
+                                   const bool withHitMap ) const
+{
+    const MonitorSegment::TSlotHeader* slot = GetSlot( ichip );
+    const size_t nBins = (size_t)fHeader.nBins1 * fHeader.nBins2;
+    snapshot.hits.resize( withHitMap ? nBins : 0 );
+
+    for ( unsigned int itrial = 0; itrial < MAXTRIALS; itrial++ ) {
+        const uint32_t active = slot->active.load( memory_order_acquire ) & 1;
+        const unsigned char* buffer = (const unsigned char*)slot
+            + MonitorSegment::GetBufferOffset( active, fHeader.nBins1, fHeader.nBins2 );
+        const MonitorSegment::TSnapshotHeader* header = (const MonitorSegment::TSnapshotHeader*)buffer;
+        const uint64_t sequence = header->sequence.load( memory_order_acquire );
+        if ( !sequence ) {
+            return false; // nothing published yet
+        }
+        if ( sequence & 1 ) {
+            continue; // the scan is writing this buffer
+        }
+        snapshot.sequence = sequence;
+        snapshot.publishTime = header->publishTime;
+        snapshot.nEntries = header->nEntries;
+        snapshot.nHitPixels = header->nHitPixels;
+        snapshot.nCorruptedHits = header->nCorruptedHits;
+        snapshot.nPrioEncoder = header->nPrioEncoder;
+        snapshot.n8b10b = header->n8b10b;
+        snapshot.nTimeout = header->nTimeout;
+        if ( withHitMap && nBins ) {
+            memcpy( snapshot.hits.data(), buffer + MonitorSegment::GetHitMapOffset(), nBins * sizeof(uint32_t) );
+        }
+        // the copy is valid only if the scan did not start to write this buffer again
+        atomic_thread_fence( memory_order_acquire );
+        if ( header->sequence.load( memory_order_relaxed ) == sequence ) {
+            return true;
+        }
+    }
+    if ( GetVerboseLevel() > kSILENT ) {
+        cout << "TMonitorReader::ReadSnapshot() - chip " << std::dec << ichip
+             << " : no consistent snapshot after " << MAXTRIALS << " trials" << endl;
+    }
+    return false;
+}
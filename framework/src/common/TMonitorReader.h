@@ -0,0 +1,81 @@
+#ifndef MONITOR_READER_H
+#define MONITOR_READER_H
+
+/**
+ * \class TMonitorReader
+ *
+ * \brief Read-only access to the live monitoring segment of a running scan (see
+ * TMonitorPublisher)
+ *
+ * \author Andry Rakotozafindrabe
+ *
+ * The segment is mapped read-only: the reader never writes to it and never blocks the
+ * scan. A snapshot is copied out of the active buffer of a chip, and the copy is done
+ * again if the scan published a new snapshot in this buffer during the copy.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "TMonitorSegment.h"
+#include "TVerbosity.h"
+
+class TMonitorReader : public TVerbosity {
+
+    /// name of the shared memory segment
+    std::string fName;
+
+    /// start of the mapped segment
+    const unsigned char* fMap;
+
+    /// size of the mapped segment
+    std::size_t fMapSize;
+
+    /// copy of the segment header
+    MonitorSegment::TSegmentHeader fHeader;
+
+public:
+
+    /// max number of copies of a snapshot before giving up (publication too fast)
+    static const unsigned int MAXTRIALS = 100;
+
+    /// constructor
+    TMonitorReader();
+
+    /// destructor, unmaps the segment
+    ~TMonitorReader();
+
+    /// map the segment with a given name, throw if it does not exist or is not valid
+    void Attach( const std::string name = MonitorSegment::DEFAULT_NAME );
+
+    /// unmap the segment
+    void Detach();
+
+    /// true if a segment is mapped
+    bool IsAttached() const { return ( fMap != nullptr ); }
+
+    /// number of chips in the segment
+    unsigned int GetNChips() const { return fHeader.nChips; }
+
+    /// number of bins of the hit maps in a given dimension (0 if no hit map)
+    unsigned int GetNBins( const int d ) const { return d ? fHeader.nBins2 : fHeader.nBins1; }
+
+    /// process id of the scan
+    std::uint64_t GetWriterPid() const { return fHeader.writerPid; }
+
+    /// index of a given chip
+    void GetChipId( const unsigned int ichip, unsigned int& boardIndex, unsigned int& dataReceiver,
+                    unsigned int& deviceId, unsigned int& chipId ) const;
+
+    /// copy the last snapshot of a given chip, return false if none was published yet
+    bool ReadSnapshot( const unsigned int ichip, TMonitorSnapshot& snapshot,
+                       const bool withHitMap = true ) const;
+
+private:
+
+    /// slot header of a given chip
+    const MonitorSegment::TSlotHeader* GetSlot( const unsigned int ichip ) const;
+
+};
+
+#endif
@@ -0,0 +1,143 @@
+#ifndef MONITOR_SEGMENT_H
+#define MONITOR_SEGMENT_H
+
+/**
+ * \file TMonitorSegment.h
+ *
+ * \brief Layout of the shared memory segment of the live monitoring (see TMonitorPublisher
+ * and TMonitorReader)
+ *
+ * \author Andry Rakotozafindrabe
+ *
+ * The scan publishes, for each chip, a snapshot of its hit map and of its error counters
+ * in a POSIX shared memory segment, which a separate monitor process maps read-only.
+ *
+ * Layout of the segment:
+ * - segment header (TSegmentHeader), written last: a valid magic means a ready segment
+ * - one slot per chip, each with:
+ *   - a slot header (TSlotHeader), with the index of the chip and the active buffer
+ *   - two snapshot buffers, each with a snapshot header (TSnapshotHeader) followed by the
+ *     hit map (nBins1 x nBins2 counters, key = i * nBins2 + j as in THisto)
+ *
+ * A chip has a single writer, which fills the inactive buffer and then makes it the
+ * active one with an atomic store: the writer never waits for the readers. The sequence
+ * number of a buffer is odd while the buffer is written: a reader copies the active
+ * buffer and starts again if the sequence number changed during the copy.
+ *
+ * All structures start on a multiple of ALIGNMENT bytes, so that the atomic counters
+ * of the slots of different chips never share a cache line.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace MonitorSegment {
+
+    /// identifies a monitoring segment
+    static const char SEGMENT_MAGIC[8] = { 'M', 'L', 'O', 'M', 'O', 'N', 'I', 'T' };
+
+    /// current version of the layout
+    static const std::uint32_t VERSION = 1;
+
+    /// alignment of the structures in the segment
+    static const std::size_t ALIGNMENT = 64;
+
+    /// default name of the segment
+    static const char DEFAULT_NAME[] = "/mlo-monitor";
+
+    struct TSegmentHeader {
+        char          magic[8];
+        std::uint32_t version;
+        std::uint32_t nChips;
+        /// number of bins of the hit maps in each dimension (0 if no hit map)
+        std::uint32_t nBins1;
+        std::uint32_t nBins2;
+        /// process id of the writer
+        std::uint64_t writerPid;
+    };
+
+    struct TSlotHeader {
+        /// index of the active buffer (0 or 1)
+        std::atomic<std::uint32_t> active;
+        std::uint32_t boardIndex;
+        std::uint32_t dataReceiver;
+        std::uint32_t deviceType;
+        std::uint32_t deviceId;
+        std::uint32_t chipId;
+    };
+
+    struct TSnapshotHeader {
+        /// incremented before and after each write of the buffer (0 = never written)
+        std::atomic<std::uint64_t> sequence;
+        /// time of the snapshot in ms since the epoch
+        std::uint64_t publishTime;
+        /// total number of hits of the chip
+        std::uint64_t nEntries;
+        /// number of pixels with at least one hit
+        std::uint32_t nHitPixels;
+        /// total number of corrupted hits from the decoder
+        std::uint32_t nCorruptedHits;
+        /// number of priority encoder errors
+        std::uint32_t nPrioEncoder;
+        /// number of 8b10b encoder errors
+        std::uint32_t n8b10b;
+        /// number of readout timeouts (all boards)
+        std::uint32_t nTimeout;
+        std::uint32_t reserved;
+    };
+
+    static_assert( sizeof(TSegmentHeader) == 32, "unexpected padding in TSegmentHeader" );
+    static_assert( sizeof(TSlotHeader) == 24, "unexpected padding in TSlotHeader" );
+    static_assert( sizeof(TSnapshotHeader) == 48, "unexpected padding in TSnapshotHeader" );
+    static_assert( std::atomic<std::uint32_t>::is_always_lock_free
+                   && std::atomic<std::uint64_t>::is_always_lock_free,
+                   "the atomic counters of the segment must be lock free to be shared between processes" );
+
+    /// round up to a multiple of ALIGNMENT
+    inline std::size_t Align( const std::size_t nBytes )
+    { return ( (nBytes + ALIGNMENT - 1) / ALIGNMENT ) * ALIGNMENT; }
+
+    /// size of a snapshot buffer
+    inline std::size_t GetBufferSize( const std::uint32_t nBins1, const std::uint32_t nBins2 )
+    { return Align( sizeof(TSnapshotHeader) ) + Align( (std::size_t)nBins1 * nBins2 * sizeof(std::uint32_t) ); }
+
+    /// size of the slot of a chip
+    inline std::size_t GetSlotSize( const std::uint32_t nBins1, const std::uint32_t nBins2 )
+    { return Align( sizeof(TSlotHeader) ) + 2 * GetBufferSize( nBins1, nBins2 ); }
+
+    /// position of the slot of a chip in the segment
+    inline std::size_t GetSlotOffset( const std::uint32_t ichip, const std::uint32_t nBins1, const std::uint32_t nBins2 )
+    { return Align( sizeof(TSegmentHeader) ) + ichip * GetSlotSize( nBins1, nBins2 ); }
+
+    /// position of a snapshot buffer in the slot of its chip
+    inline std::size_t GetBufferOffset( const std::uint32_t ibuffer, const std::uint32_t nBins1, const std::uint32_t nBins2 )
+    { return Align( sizeof(TSlotHeader) ) + ibuffer * GetBufferSize( nBins1, nBins2 ); }
+
+    /// position of the hit map in a snapshot buffer
+    inline std::size_t GetHitMapOffset()
+    { return Align( sizeof(TSnapshotHeader) ); }
+
+    /// size of the segment
+    inline std::size_t GetSegmentSize( const std::uint32_t nChips, const std::uint32_t nBins1, const std::uint32_t nBins2 )
+    { return GetSlotOffset( nChips, nBins1, nBins2 ); }
+}
+
+/// copy of the snapshot of a chip, as given by TMonitorReader
+struct TMonitorSnapshot {
+    /// sequence number of the snapshot buffer (changes at each new snapshot)
+    std::uint64_t sequence = 0;
+    /// time of the snapshot in ms since the epoch
+    std::uint64_t publishTime = 0;
+    std::uint64_t nEntries = 0;
+    std::uint32_t nHitPixels = 0;
+    std::uint32_t nCorruptedHits = 0;
+    std::uint32_t nPrioEncoder = 0;
+    std::uint32_t n8b10b = 0;
+    std::uint32_t nTimeout = 0;
+    /// hit map (nBins1 x nBins2 counters, key = i * nBins2 + j)
+    std::vector<std::uint32_t> hits;
+};
+
+#endif
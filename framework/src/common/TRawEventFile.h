@@ -0,0 +1,127 @@
+#ifndef RAW_EVENT_FILE_H
+#define RAW_EVENT_FILE_H
+
+/**
+ * \file TRawEventFile.h
+ *
+ * \brief Layout of the binary raw event files (see TRawEventWriter and TRawEventReader)
+ *
+ * \author Andry Rakotozafindrabe
+ *
+ * A raw event is the buffer returned by TReadoutBoard::ReadEventData() (board
+ * header, chip data and board trailer), stored with the index of the readout board
+ * and the trigger number and time given by the trigger recorder.
+ *
+ * Layout of the file (all integers in the byte order of the writing host):
+ * - file header (TFileHeader)
+ * - firmware version of each readout board, one TBoardEntry per board (since version 2)
+ * - blocks of events, each with:
+ *   - a block header (TBlockHeader)
+ *   - the index of the events of the block, one TEventEntry per event, never compressed
+ *   - the data of the events, one after the other, optionally compressed as a whole,
+ *     followed by zero bytes up to the next multiple of 8 bytes
+ * - block table, one TBlockEntry per block
+ * - file trailer (TFileTrailer), giving the position of the block table
+ *
+ * A file without a valid trailer (e.g. run interrupted) can still be read: the
+ * reader then walks through the blocks, and ignores an incomplete last block.
+ */
+
+#include <cstdint>
+
+namespace RawEventFile {
+
+    /// compression of the data of a block
+    enum TCompression : std::uint32_t {
+        kNONE = 0,
+        kLZ4  = 1,
+        kZSTD = 2
+    };
+
+    /// identifies a raw event file
+    static const char FILE_MAGIC[8] = { 'M', 'L', 'O', 'R', 'A', 'W', 'E', 'V' };
+
+    /// identifies a block header ("RBLK")
+    static const std::uint32_t BLOCK_MAGIC = 0x4b4c4252;
+
+    /// identifies the file trailer ("REND")
+    static const std::uint32_t TRAILER_MAGIC = 0x444e4552;
+
+    /// current version of the layout
+    static const std::uint32_t VERSION = 2;
+
+    struct TFileHeader {
+        char          magic[8];
+        std::uint32_t version;
+        /// number of TBoardEntry after the header (always 0 in version 1)
+        std::uint32_t nBoards;
+    };
+
+    struct TBoardEntry {
+        /// firmware version of the readout board (null terminated, empty if unknown)
+        char firmwareVersion[64];
+    };
+
+    struct TBlockHeader {
+        std::uint32_t magic;
+        std::uint32_t nEvents;
+        std::uint32_t compression;
+        std::uint32_t reserved;
+        /// size in bytes of the (possibly compressed) data, as stored in the file
+        std::uint64_t storedSize;
+        /// size in bytes of the data once decompressed
+        std::uint64_t rawSize;
+    };
+
+    struct TEventEntry {
+        /// position of the event in the (decompressed) data of the block
+        std::uint32_t offset;
+        /// size of the event in bytes
+        std::uint32_t size;
+        /// index of the readout board in the device
+        std::uint32_t boardIndex;
+        /// trigger number from the trigger recorder (0 if none)
+        std::uint32_t trgNum;
+        /// trigger time from the trigger recorder (0 if none)
+        std::uint64_t trgTime;
+    };
+
+    struct TBlockEntry {
+        /// position of the block header in the file
+        std::uint64_t fileOffset;
+        /// number of events in the file before this block
+        std::uint64_t firstEvent;
+    };
+
+    struct TFileTrailer {
+        /// position of the block table in the file
+        std::uint64_t tableOffset;
+        std::uint64_t nBlocks;
+        std::uint64_t nEvents;
+        std::uint32_t magic;
+        std::uint32_t reserved;
+    };
+
+    static_assert( sizeof(TFileHeader) == 16, "unexpected padding in TFileHeader" );
+    static_assert( sizeof(TBoardEntry) == 64, "unexpected padding in TBoardEntry" );
+    static_assert( sizeof(TBlockHeader) == 32, "unexpected padding in TBlockHeader" );
+    static_assert( sizeof(TEventEntry) == 24, "unexpected padding in TEventEntry" );
+    static_assert( sizeof(TBlockEntry) == 16, "unexpected padding in TBlockEntry" );
+    static_assert( sizeof(TFileTrailer) == 32, "unexpected padding in TFileTrailer" );
+}
+
+/// one raw event, as given by TRawEventReader
+struct TRawEvent {
+    /// event data (points to the mapped file or to the buffer of the decompressed block)
+    const unsigned char* data = nullptr;
+    /// size of the event in bytes
+    int size = 0;
+    /// index of the readout board in the device
+    unsigned int boardIndex = 0;
+    /// trigger number from the trigger recorder
+    std::uint32_t trgNum = 0;
+    /// trigger time from the trigger recorder
+    std::uint64_t trgTime = 0;
+};
+
+#endif
@@ -0,0 +1,272 @@
+#include "TRawEventReader.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef HAVE_LZ4
+#include <lz4.h>
+#endif
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+using namespace std;
+
+//___________________________________________________________________
+TRawEventReader::TRawEventReader() : TVerbosity(),
+fMap( nullptr ),
+fMapSize( 0 ),
+fFirstBlockOffset( 0 ),
+fNEvents( 0 )
+{
+
+}
+
+//___________________________________________________________________
+TRawEventReader::~TRawEventReader()
+{
+    Close();
+}
+
+//___________________________________________________________________
+void TRawEventReader::Open( const string fileName )
+{
+    Close();
+    const int fd = open( fileName.c_str(), O_RDONLY );
+    if ( fd < 0 ) {
+        throw runtime_error( "TRawEventReader::Open() - can not open input file " + fileName );
+    }
+    struct stat st;
+    if ( (fstat( fd, &st ) != 0) || (st.st_size < (off_t)sizeof(RawEventFile::TFileHeader)) ) {
+        close( fd );
+        throw runtime_error( "TRawEventReader::Open() - " + fileName + " is not a raw event file." );
+    }
+    void* map = mmap( nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    close( fd );
+    if ( map == MAP_FAILED ) {
+        throw runtime_error( "TRawEventReader::Open() - can not map input file " + fileName );
+    }
+    fMap = (const unsigned char*)map;
+    fMapSize = st.st_size;
+    fFileName = fileName;
+
+    const RawEventFile::TFileHeader* header = (const RawEventFile::TFileHeader*)fMap;
+    if ( memcmp( header->magic, RawEventFile::FILE_MAGIC, sizeof(header->magic) ) != 0 ) {
+        Close();
+        throw runtime_error( "TRawEventReader::Open() - " + fileName + " is not a raw event file." );
+    }
+    if ( (header->version < 1) || (header->version > RawEventFile::VERSION) ) {
+        Close();
+        throw runtime_error( "TRawEventReader::Open() - unknown version of the raw event file " + fileName );
+    }
+    // the firmware versions of the boards are only recorded since version 2
+    const uint32_t nBoards = ( header->version >= 2 ) ? header->nBoards : 0;
+    fFirstBlockOffset = sizeof(RawEventFile::TFileHeader) + (uint64_t)nBoards * sizeof(RawEventFile::TBoardEntry);
+    if ( fFirstBlockOffset > fMapSize ) {
+        Close();
+        throw runtime_error( "TRawEventReader::Open() - truncated header in " + fileName );
+    }
+    for ( uint32_t ib = 0; ib < nBoards; ib++ ) {
+        const RawEventFile::TBoardEntry* board = (const RawEventFile::TBoardEntry*)(fMap + sizeof(RawEventFile::TFileHeader)) + ib;
+        fFirmwareVersions.push_back( string( board->firmwareVersion,
+                                             strnlen( board->firmwareVersion, sizeof(board->firmwareVersion) ) ) );
+    }
+    if ( !ReadBlockTable() ) {
+        if ( GetVerboseLevel() > kSILENT ) {
+            cout << "TRawEventReader::Open() - no valid trailer in " << fileName
+                 << " , walking through the blocks." << endl;
+        }
+        ScanBlocks();
+    }
+
+    if ( GetVerboseLevel() > kSILENT ) {
+        cout << "TRawEventReader::Open() - " << std::dec << fNEvents << " events in "
+             << fBlocks.size() << " blocks found in " << fileName << endl;
+    }
+}
+
+//___________________________________________________________________
+void TRawEventReader::Close()
+{
+    if ( fMap ) {
+        munmap( (void*)fMap, fMapSize );
+    }
+    fMap = nullptr;
+    fMapSize = 0;
+    fFirmwareVersions.clear();
+    fFirstBlockOffset = 0;
+    fBlocks.clear();
+    fNEvents = 0;
+    fBuffer.block = -1;
+    fBuffer.data.clear();
+}
+
+//___________________________________________________________________
+string TRawEventReader::GetFirmwareVersion( const unsigned int boardIndex ) const
+{
+    return ( boardIndex < fFirmwareVersions.size() ) ? fFirmwareVersions[boardIndex] : string();
+}
+
+//___________________________________________________________________
+uint64_t TRawEventReader::GetBlockFirstEvent( const unsigned int iblock ) const
+{
+    return fBlocks.at( iblock ).firstEvent;
+}
+
+//___________________________________________________________________
+unsigned int TRawEventReader::GetBlockNEvents( const unsigned int iblock ) const
+{
+    return fBlocks.at( iblock ).nEvents;
+}
+
+//___________________________________________________________________
+void TRawEventReader::GetEvent( const uint64_t ievent, TRawEvent& event, TBlockBuffer& buffer ) const
+{
+    if ( ievent >= fNEvents ) {
+        throw out_of_range( "TRawEventReader::GetEvent() - bad event index" );
+    }
+    const unsigned int iblock = FindBlock( ievent );
+    const TBlock& block = fBlocks[iblock];
+    const RawEventFile::TEventEntry& entry = block.entries[ ievent - block.firstEvent ];
+    if ( (uint64_t)entry.offset + entry.size > block.rawSize ) {
+        throw runtime_error( "TRawEventReader::GetEvent() - corrupted index in " + fFileName );
+    }
+    if ( block.compression == RawEventFile::kNONE ) {
+        event.data = block.data + entry.offset;
+    } else {
+        if ( buffer.block != (long)iblock ) {
+            Decompress( iblock, buffer );
+        }
+        event.data = buffer.data.data() + entry.offset;
+    }
+    event.size = entry.size;
+    event.boardIndex = entry.boardIndex;
+    event.trgNum = entry.trgNum;
+    event.trgTime = entry.trgTime;
+}
+
+//___________________________________________________________________
+void TRawEventReader::GetEvent( const uint64_t ievent, TRawEvent& event )
+{
+    GetEvent( ievent, event, fBuffer );
+}
+
+//___________________________________________________________________
+bool TRawEventReader::ReadBlockTable()
+{
+    if ( fMapSize < fFirstBlockOffset + sizeof(RawEventFile::TFileTrailer) ) {
+        return false;
+    }
+    RawEventFile::TFileTrailer trailer;
+    memcpy( &trailer, fMap + fMapSize - sizeof(trailer), sizeof(trailer) );
+    if ( (trailer.magic != RawEventFile::TRAILER_MAGIC)
+        || (trailer.tableOffset + trailer.nBlocks * sizeof(RawEventFile::TBlockEntry)
+            != fMapSize - sizeof(trailer)) ) {
+        return false;
+    }
+    fBlocks.reserve( trailer.nBlocks );
+    for ( uint64_t ib = 0; ib < trailer.nBlocks; ib++ ) {
+        RawEventFile::TBlockEntry entry;
+        memcpy( &entry, fMap + trailer.tableOffset + ib * sizeof(entry), sizeof(entry) );
+        uint64_t nextOffset;
+        if ( (entry.firstEvent != fNEvents) || !AddBlock( entry.fileOffset, entry.firstEvent, nextOffset ) ) {
+            fBlocks.clear();
+            fNEvents = 0;
+            return false;
+        }
+    }
+    if ( fNEvents != trailer.nEvents ) {
+        fBlocks.clear();
+        fNEvents = 0;
+        return false;
+    }
+    return true;
+}
+
+//___________________________________________________________________
+void TRawEventReader::ScanBlocks()
+{
+    uint64_t offset = fFirstBlockOffset;
+    while ( AddBlock( offset, fNEvents, offset ) ) { }
+}
+
+//___________________________________________________________________
+bool TRawEventReader::AddBlock( const uint64_t offset, const uint64_t firstEvent,
+                                uint64_t& nextOffset )
+{
+    if ( (offset % 8) || (offset + sizeof(RawEventFile::TBlockHeader) > fMapSize) ) {
+        return false;
+    }
+    const RawEventFile::TBlockHeader* header = (const RawEventFile::TBlockHeader*)(fMap + offset);
+    if ( header->magic != RawEventFile::BLOCK_MAGIC ) {
+        return false;
+    }
+    const uint64_t indexOffset = offset + sizeof(RawEventFile::TBlockHeader);
+    const uint64_t dataOffset = indexOffset + header->nEvents * sizeof(RawEventFile::TEventEntry);
+    if ( dataOffset + header->storedSize > fMapSize ) {
+        return false; // incomplete block
+    }
+    if ( (header->compression == RawEventFile::kNONE)
+        && (header->rawSize != header->storedSize) ) {
+        return false; // uncompressed data are read in place
+    }
+    TBlock block;
+    block.entries = (const RawEventFile::TEventEntry*)(fMap + indexOffset);
+    block.data = fMap + dataOffset;
+    block.storedSize = header->storedSize;
+    block.rawSize = header->rawSize;
+    block.compression = header->compression;
+    block.nEvents = header->nEvents;
+    block.firstEvent = firstEvent;
+    fBlocks.push_back( block );
+    fNEvents += block.nEvents;
+    nextOffset = dataOffset + header->storedSize;
+    nextOffset += (8 - nextOffset % 8) % 8;
+    return true;
+}
+
+//___________________________________________________________________
+unsigned int TRawEventReader::FindBlock( const uint64_t ievent ) const
+{
+    // first block whose first event is after the requested one, minus one
+    vector<TBlock>::const_iterator it = upper_bound( fBlocks.begin(), fBlocks.end(), ievent,
+        []( const uint64_t value, const TBlock& block ) { return value < block.firstEvent; } );
+    return ( it - fBlocks.begin() ) - 1;
+}
+
+//___________________________________________________________________
+void TRawEventReader::Decompress( const unsigned int iblock, TBlockBuffer& buffer ) const
+{
+    const TBlock& block = fBlocks[iblock];
+    buffer.block = -1;
+    buffer.data.resize( block.rawSize );
+    switch ( block.compression ) {
+#ifdef HAVE_LZ4
+        case RawEventFile::kLZ4 : {
+            const int n = LZ4_decompress_safe( (const char*)block.data, (char*)buffer.data.data(),
+                                               block.storedSize, block.rawSize );
+            if ( (n < 0) || ((uint64_t)n != block.rawSize) ) {
+                throw runtime_error( "TRawEventReader::Decompress() - corrupted LZ4 block in " + fFileName );
+            }
+            break;
+        }
+#endif
+#ifdef HAVE_ZSTD
+        case RawEventFile::kZSTD : {
+            const size_t n = ZSTD_decompress( buffer.data.data(), block.rawSize,
+                                              block.data, block.storedSize );
+            if ( ZSTD_isError( n ) || (n != block.rawSize) ) {
+                throw runtime_error( "TRawEventReader::Decompress() - corrupted zstd block in " + fFileName );
+            }
+            break;
+        }
+#endif
+        default :
+            throw runtime_error( "TRawEventReader::Decompress() - compression not available in this build for " + fFileName );
+    }
+    buffer.block = iblock;
+}
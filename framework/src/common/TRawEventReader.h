@@ -0,0 +1,135 @@
+#ifndef RAW_EVENT_READER_H
+#define RAW_EVENT_READER_H
+
+/**
+ * \class TRawEventReader
+ *
+ * \brief Direct access to the events of a binary raw event file (see TRawEventWriter)
+ *
+ * \author Andry Rakotozafindrabe
+ *
+ * The file is mapped in memory. The events of a non compressed block are read in
+ * place, without any copy; a compressed block is decompressed in a buffer given by
+ * the caller (TBlockBuffer), and kept there as long as the following events belong
+ * to the same block.
+ *
+ * The reader is not modified once the file is open: several threads can read the
+ * events at the same time, each with its own TBlockBuffer, e.g. one range of
+ * blocks per thread (see GetBlockFirstEvent() and GetBlockNEvents()).
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "TRawEventFile.h"
+#include "TVerbosity.h"
+
+class TRawEventReader : public TVerbosity {
+
+public:
+
+    /// buffer for the decompressed data of one block
+    struct TBlockBuffer {
+        /// index of the block in the buffer (-1 if none)
+        long block = -1;
+        std::vector<unsigned char> data;
+    };
+
+private:
+
+    /// one block of events in the mapped file
+    struct TBlock {
+        /// index of the events of the block
+        const RawEventFile::TEventEntry* entries;
+        /// (possibly compressed) data of the block
+        const unsigned char* data;
+        std::uint64_t storedSize;
+        std::uint64_t rawSize;
+        std::uint32_t compression;
+        std::uint32_t nEvents;
+        /// number of events in the file before this block
+        std::uint64_t firstEvent;
+    };
+
+    /// name of the input file
+    std::string fFileName;
+
+    /// start of the mapped file
+    const unsigned char* fMap;
+
+    /// size of the mapped file
+    std::uint64_t fMapSize;
+
+    /// firmware version of each readout board (empty if not in the file)
+    std::vector<std::string> fFirmwareVersions;
+
+    /// position of the first block in the file
+    std::uint64_t fFirstBlockOffset;
+
+    /// blocks of the file
+    std::vector<TBlock> fBlocks;
+
+    /// number of events in the file
+    std::uint64_t fNEvents;
+
+    /// buffer used by GetEvent() without TBlockBuffer
+    TBlockBuffer fBuffer;
+
+public:
+
+    /// constructor
+    TRawEventReader();
+
+    /// destructor (unmaps the file)
+    virtual ~TRawEventReader();
+
+    /// map the input file and read its block table (or walk through its blocks)
+    void Open( const std::string fileName );
+
+    /// unmap the input file
+    void Close();
+
+    /// true if a file is open
+    bool IsOpen() const { return ( fMap != nullptr ); }
+
+    /// number of events in the file
+    std::uint64_t GetNEvents() const { return fNEvents; }
+
+    /// firmware version of a readout board, as recorded in the file (empty if unknown)
+    std::string GetFirmwareVersion( const unsigned int boardIndex ) const;
+
+    /// number of blocks in the file
+    unsigned int GetNBlocks() const { return fBlocks.size(); }
+
+    /// number of events in the file before a given block
+    std::uint64_t GetBlockFirstEvent( const unsigned int iblock ) const;
+
+    /// number of events in a given block
+    unsigned int GetBlockNEvents( const unsigned int iblock ) const;
+
+    /// get an event (thread safe, the buffer must not be shared between threads)
+    void GetEvent( const std::uint64_t ievent, TRawEvent& event, TBlockBuffer& buffer ) const;
+
+    /// get an event, using the internal buffer of the reader (not thread safe)
+    void GetEvent( const std::uint64_t ievent, TRawEvent& event );
+
+private:
+
+    /// read the block table pointed by the trailer, return false if there is no valid trailer
+    bool ReadBlockTable();
+
+    /// build the block table by walking through the blocks of the file
+    void ScanBlocks();
+
+    /// add the block whose header is at a given position, return false if it is not complete
+    bool AddBlock( const std::uint64_t offset, const std::uint64_t firstEvent,
+                   std::uint64_t& nextOffset );
+
+    /// index of the block containing a given event
+    unsigned int FindBlock( const std::uint64_t ievent ) const;
+
+    /// decompress a block in the buffer
+    void Decompress( const unsigned int iblock, TBlockBuffer& buffer ) const;
+};
+
+#endif
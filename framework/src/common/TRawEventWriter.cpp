@@ -0,0 +1,258 @@
+#include "TRawEventWriter.h"
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#ifdef HAVE_LZ4
+#include <lz4.h>
+#endif
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+using namespace std;
+
+//___________________________________________________________________
+TRawEventWriter::TRawEventWriter() : TVerbosity(),
+fFile( nullptr ),
+fCompression( RawEventFile::kNONE ),
+fBlockSize( 4*1024*1024 ),
+fFileOffset( 0 ),
+fNEvents( 0 )
+{
+
+}
+
+//___________________________________________________________________
+TRawEventWriter::~TRawEventWriter()
+{
+    try {
+        Close();
+    } catch ( exception& err ) {
+        cerr << err.what() << endl;
+    }
+}
+
+//___________________________________________________________________
+void TRawEventWriter::SetCompression( const RawEventFile::TCompression compression )
+{
+    if ( !IsCompressionAvailable( compression ) ) {
+        cerr << "TRawEventWriter::SetCompression() - compression " << (int)compression
+             << " not available in this build, blocks will not be compressed." << endl;
+        fCompression = RawEventFile::kNONE;
+        return;
+    }
+    fCompression = compression;
+}
+
+//___________________________________________________________________
+void TRawEventWriter::SetBlockSize( const unsigned int nBytes )
+{
+    if ( !nBytes ) {
+        cerr << "TRawEventWriter::SetBlockSize() - zero size is not valid !" << endl;
+        return;
+    }
+    fBlockSize = nBytes;
+}
+
+//___________________________________________________________________
+void TRawEventWriter::SetFirmwareVersion( const unsigned int boardIndex, const string version )
+{
+    if ( fFile ) {
+        cerr << "TRawEventWriter::SetFirmwareVersion() - file already open, ignored." << endl;
+        return;
+    }
+    if ( version.size() >= sizeof(RawEventFile::TBoardEntry::firmwareVersion) ) {
+        cerr << "TRawEventWriter::SetFirmwareVersion() - version too long, truncated." << endl;
+    }
+    if ( boardIndex >= fFirmwareVersions.size() ) {
+        fFirmwareVersions.resize( boardIndex + 1 );
+    }
+    fFirmwareVersions.at( boardIndex ) = version;
+}
+
+//___________________________________________________________________
+void TRawEventWriter::Open( const string fileName )
+{
+    Close();
+    fFile = fopen( fileName.c_str(), "wb" );
+    if ( !fFile ) {
+        throw runtime_error( "TRawEventWriter::Open() - can not open output file " + fileName );
+    }
+    fFileName = fileName;
+    fFileOffset = 0;
+    fNEvents = 0;
+    fBlocks.clear();
+    fEntries.clear();
+    fData.clear();
+    fData.reserve( fBlockSize );
+
+    RawEventFile::TFileHeader header;
+    memcpy( header.magic, RawEventFile::FILE_MAGIC, sizeof(header.magic) );
+    header.version = RawEventFile::VERSION;
+    header.nBoards = fFirmwareVersions.size();
+    Write( &header, sizeof(header) );
+    for ( unsigned int ib = 0; ib < fFirmwareVersions.size(); ib++ ) {
+        RawEventFile::TBoardEntry board;
+        memset( &board, 0, sizeof(board) );
+        strncpy( board.firmwareVersion, fFirmwareVersions.at( ib ).c_str(), sizeof(board.firmwareVersion) - 1 );
+        Write( &board, sizeof(board) );
+    }
+
+    if ( GetVerboseLevel() > kSILENT ) {
+        cout << "TRawEventWriter::Open() - writing raw events to " << fFileName << endl;
+    }
+}
+
+//___________________________________________________________________
+void TRawEventWriter::AddEvent( const unsigned char* data, const int nBytes,
+                                const unsigned int boardIndex,
+                                const uint32_t trgNum, const uint64_t trgTime )
+{
+    if ( !fFile ) {
+        throw runtime_error( "TRawEventWriter::AddEvent() - no output file ! Please use Open() first." );
+    }
+    if ( nBytes < 0 ) {
+        throw invalid_argument( "TRawEventWriter::AddEvent() - negative event size !" );
+    }
+    RawEventFile::TEventEntry entry;
+    entry.offset = fData.size();
+    entry.size = nBytes;
+    entry.boardIndex = boardIndex;
+    entry.trgNum = trgNum;
+    entry.trgTime = trgTime;
+    fEntries.push_back( entry );
+    fData.insert( fData.end(), data, data + nBytes );
+    fNEvents++;
+    if ( fData.size() >= fBlockSize ) {
+        Flush();
+    }
+}
+
+//___________________________________________________________________
+void TRawEventWriter::Flush()
+{
+    if ( !fFile || fEntries.empty() ) {
+        return;
+    }
+    RawEventFile::TBlockEntry block;
+    block.fileOffset = fFileOffset;
+    block.firstEvent = fNEvents - fEntries.size();
+    fBlocks.push_back( block );
+
+    const bool compressed = Compress();
+    RawEventFile::TBlockHeader header;
+    header.magic = RawEventFile::BLOCK_MAGIC;
+    header.nEvents = fEntries.size();
+    header.compression = compressed ? fCompression : RawEventFile::kNONE;
+    header.reserved = 0;
+    header.storedSize = compressed ? fCompressed.size() : fData.size();
+    header.rawSize = fData.size();
+    Write( &header, sizeof(header) );
+    Write( fEntries.data(), fEntries.size() * sizeof(RawEventFile::TEventEntry) );
+    if ( compressed ) {
+        Write( fCompressed.data(), fCompressed.size() );
+    } else {
+        Write( fData.data(), fData.size() );
+    }
+    // the next block starts on a 8 bytes boundary, for the reader to use the index in place
+    const uint64_t padding[1] = { 0 };
+    Write( padding, (8 - fFileOffset % 8) % 8 );
+    if ( GetVerboseLevel() > kCHATTY ) {
+        cout << "TRawEventWriter::Flush() - block " << std::dec << fBlocks.size()-1
+             << " , " << header.nEvents << " events, " << header.rawSize << " bytes ("
+             << header.storedSize << " stored)" << endl;
+    }
+    fEntries.clear();
+    fData.clear();
+}
+
+//___________________________________________________________________
+void TRawEventWriter::Close()
+{
+    if ( !fFile ) {
+        return;
+    }
+    Flush();
+    RawEventFile::TFileTrailer trailer;
+    trailer.tableOffset = fFileOffset;
+    trailer.nBlocks = fBlocks.size();
+    trailer.nEvents = fNEvents;
+    trailer.magic = RawEventFile::TRAILER_MAGIC;
+    trailer.reserved = 0;
+    Write( fBlocks.data(), fBlocks.size() * sizeof(RawEventFile::TBlockEntry) );
+    Write( &trailer, sizeof(trailer) );
+    fclose( fFile );
+    fFile = nullptr;
+    if ( GetVerboseLevel() > kSILENT ) {
+        cout << "TRawEventWriter::Close() - " << std::dec << fNEvents << " events in "
+             << fBlocks.size() << " blocks written to " << fFileName << endl;
+    }
+    fBlocks.clear();
+}
+
+//___________________________________________________________________
+bool TRawEventWriter::IsCompressionAvailable( const RawEventFile::TCompression compression )
+{
+    switch ( compression ) {
+        case RawEventFile::kNONE :
+            return true;
+#ifdef HAVE_LZ4
+        case RawEventFile::kLZ4 :
+            return true;
+#endif
+#ifdef HAVE_ZSTD
+        case RawEventFile::kZSTD :
+            return true;
+#endif
+        default :
+            return false;
+    }
+}
+
+//___________________________________________________________________
+void TRawEventWriter::Write( const void* data, const size_t nBytes )
+{
+    if ( !nBytes ) {
+        return;
+    }
+    if ( fwrite( data, 1, nBytes, fFile ) != nBytes ) {
+        throw runtime_error( "TRawEventWriter::Write() - failed to write to " + fFileName );
+    }
+    fFileOffset += nBytes;
+}
+
+//___________________________________________________________________
+bool TRawEventWriter::Compress()
+{
+    size_t nBytes = 0;
+    switch ( fCompression ) {
+#ifdef HAVE_LZ4
+        case RawEventFile::kLZ4 : {
+            fCompressed.resize( LZ4_compressBound( fData.size() ) );
+            const int n = LZ4_compress_default( (const char*)fData.data(), (char*)fCompressed.data(),
+                                                fData.size(), fCompressed.size() );
+            if ( n <= 0 ) return false;
+            nBytes = n;
+            break;
+        }
+#endif
+#ifdef HAVE_ZSTD
+        case RawEventFile::kZSTD : {
+            fCompressed.resize( ZSTD_compressBound( fData.size() ) );
+            const size_t n = ZSTD_compress( fCompressed.data(), fCompressed.size(),
+                                            fData.data(), fData.size(), 1 );
+            if ( ZSTD_isError( n ) ) return false;
+            nBytes = n;
+            break;
+        }
+#endif
+        default :
+            return false;
+    }
+    // keep the raw data if the compression does not save anything
+    if ( nBytes >= fData.size() ) {
+        return false;
+    }
+    fCompressed.resize( nBytes );
+    return true;
+}
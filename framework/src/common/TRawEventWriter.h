@@ -0,0 +1,109 @@
+#ifndef RAW_EVENT_WRITER_H
+#define RAW_EVENT_WRITER_H
+
+/**
+ * \class TRawEventWriter
+ *
+ * \brief Write the raw events read from the readout boards in a binary indexed file
+ *
+ * \author Andry Rakotozafindrabe
+ *
+ * Events are gathered in memory until the block size is reached, then the block is
+ * written with its index (and its data optionally compressed with LZ4 or zstd, if the
+ * library was found at build time). Close() writes the block table and the trailer
+ * used by TRawEventReader for a direct access to any event. See TRawEventFile.h for
+ * the layout of the file.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "TRawEventFile.h"
+#include "TVerbosity.h"
+
+class TRawEventWriter : public TVerbosity {
+
+    /// output file
+    FILE* fFile;
+
+    /// name of the output file
+    std::string fFileName;
+
+    /// compression of the data of each block
+    RawEventFile::TCompression fCompression;
+
+    /// size of the data above which a block is written (in bytes)
+    unsigned int fBlockSize;
+
+    /// index of the events of the current block
+    std::vector<RawEventFile::TEventEntry> fEntries;
+
+    /// data of the events of the current block
+    std::vector<unsigned char> fData;
+
+    /// buffer for the compressed data of a block
+    std::vector<unsigned char> fCompressed;
+
+    /// position and first event of each block written
+    std::vector<RawEventFile::TBlockEntry> fBlocks;
+
+    /// current position in the file
+    std::uint64_t fFileOffset;
+
+    /// number of events written (including those of the current block)
+    std::uint64_t fNEvents;
+
+    /// firmware version of each readout board, written in the file header
+    std::vector<std::string> fFirmwareVersions;
+
+public:
+
+    /// constructor
+    TRawEventWriter();
+
+    /// destructor (closes the file)
+    virtual ~TRawEventWriter();
+
+    /// set the compression of the blocks (kNONE if the library is not available)
+    void SetCompression( const RawEventFile::TCompression compression );
+
+    /// set the size of the data above which a block is written (default = 4 MB)
+    void SetBlockSize( const unsigned int nBytes );
+
+    /// set the firmware version of a readout board (to be done before Open())
+    void SetFirmwareVersion( const unsigned int boardIndex, const std::string version );
+
+    /// open (and overwrite) the output file
+    void Open( const std::string fileName );
+
+    /// true if the output file is open
+    bool IsOpen() const { return ( fFile != nullptr ); }
+
+    /// add an event read from a given readout board
+    void AddEvent( const unsigned char* data, const int nBytes,
+                   const unsigned int boardIndex,
+                   const std::uint32_t trgNum, const std::uint64_t trgTime );
+
+    /// write the current block to the file
+    void Flush();
+
+    /// write the last block, the block table and the trailer, then close the file
+    void Close();
+
+    /// number of events written
+    std::uint64_t GetNEvents() const { return fNEvents; }
+
+    /// true if the compression is available in this build
+    static bool IsCompressionAvailable( const RawEventFile::TCompression compression );
+
+private:
+
+    /// write bytes to the file
+    void Write( const void* data, const std::size_t nBytes );
+
+    /// compress the data of the current block in fCompressed, return false if not worth it
+    bool Compress();
+};
+
+#endif
@@ -0,0 +1,141 @@
+#include "TTimingReport.h"
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+
+using namespace std;
+
+//___________________________________________________________________
+TTimingReport::TTimingReport( const string name ) : TVerbosity(),
+fName( name )
+{
+    Reset();
+}
+
+//___________________________________________________________________
+TTimingReport::~TTimingReport()
+{
+
+}
+
+//___________________________________________________________________
+void TTimingReport::Reset()
+{
+    for ( unsigned int ip = 0; ip < kNPHASES; ip++ ) {
+        fPhases[ip].nSpans.store( 0 );
+        fPhases[ip].totalTime.store( 0 );
+        fPhases[ip].maxTime.store( 0 );
+        fPhases[ip].nBytes.store( 0 );
+        fPhases[ip].nEvents.store( 0 );
+        for ( unsigned int ibin = 0; ibin < NBINS; ibin++ ) {
+            fPhases[ip].histo[ibin].store( 0 );
+        }
+    }
+    fStartTime = chrono::steady_clock::now();
+}
+
+//___________________________________________________________________
+void TTimingReport::AddSpan( const TPhase phase,
+                             const uint64_t duration,
+                             const uint64_t nBytes,
+                             const uint64_t nEvents )
+{
+    TPhaseCounters& counters = fPhases[phase];
+    counters.nSpans.fetch_add( 1, memory_order_relaxed );
+    counters.totalTime.fetch_add( duration, memory_order_relaxed );
+    if ( nBytes ) counters.nBytes.fetch_add( nBytes, memory_order_relaxed );
+    if ( nEvents ) counters.nEvents.fetch_add( nEvents, memory_order_relaxed );
+    uint64_t maxTime = counters.maxTime.load( memory_order_relaxed );
+    while ( (duration > maxTime)
+           && !counters.maxTime.compare_exchange_weak( maxTime, duration, memory_order_relaxed ) ) { }
+
+    // bin k holds the durations in [2^k, 2^(k+1)) ns
+    unsigned int ibin = 0;
+    for ( uint64_t d = duration; (d > 1) && (ibin < NBINS - 1); d >>= 1 ) {
+        ibin++;
+    }
+    counters.histo[ibin].fetch_add( 1, memory_order_relaxed );
+}
+
+//___________________________________________________________________
+const char* TTimingReport::GetPhaseName( const TPhase phase )
+{
+    switch ( phase ) {
+        case kCONFIGURE: return "configure";
+        case kTRIGGER:   return "trigger";
+        case kREADOUT:   return "readout";
+        case kDECODE:    return "decode";
+        case kMERGE:     return "merge";
+        case kANALYSIS:  return "analysis";
+        default:         return "unknown";
+    }
+}
+
+//___________________________________________________________________
+uint64_t TTimingReport::GetWallTime() const
+{
+    return chrono::duration_cast<chrono::nanoseconds>( chrono::steady_clock::now() - fStartTime ).count();
+}
+
+//___________________________________________________________________
+void TTimingReport::Dump() const
+{
+    const double wallTime = 1.e-9 * GetWallTime();
+    cout << "TTimingReport::Dump() - " << fName << " , wall time " << wallTime << " s" << endl;
+    for ( unsigned int ip = 0; ip < kNPHASES; ip++ ) {
+        const TPhaseCounters& counters = fPhases[ip];
+        const uint64_t nSpans = counters.nSpans.load();
+        if ( !nSpans ) continue;
+        const double totalTime = 1.e-9 * counters.totalTime.load();
+        char line[200];
+        snprintf( line, sizeof(line), "\t %-10s %10.3f s (%5.1f %%) %9llu spans, mean %10.1f us, max %10.1f us",
+                  GetPhaseName( (TPhase)ip ), totalTime, wallTime > 0 ? 100. * totalTime / wallTime : 0.,
+                  (unsigned long long)nSpans, 1.e6 * totalTime / nSpans, 1.e-3 * counters.maxTime.load() );
+        cout << line;
+        if ( counters.nEvents.load() && (totalTime > 0) ) {
+            cout << " , " << counters.nEvents.load() / totalTime << " events/s";
+        }
+        if ( counters.nBytes.load() && (totalTime > 0) ) {
+            cout << " , " << 1.e-6 * counters.nBytes.load() / totalTime << " MB/s";
+        }
+        cout << endl;
+    }
+}
+
+//___________________________________________________________________
+void TTimingReport::WriteToFile( const string fileName ) const
+{
+    FILE* fp = fopen( fileName.c_str(), "w" );
+    if ( !fp ) {
+        throw runtime_error( "TTimingReport::WriteToFile() - can not open output file " + fileName );
+    }
+    fprintf( fp, "{\n" );
+    fprintf( fp, "  \"scan\": \"%s\",\n", fName.c_str() );
+    fprintf( fp, "  \"wallTime_ns\": %llu,\n", (unsigned long long)GetWallTime() );
+    fprintf( fp, "  \"phases\": [" );
+    for ( unsigned int ip = 0; ip < kNPHASES; ip++ ) {
+        const TPhaseCounters& counters = fPhases[ip];
+        fprintf( fp, "%s\n    {\n", ip ? "," : "" );
+        fprintf( fp, "      \"name\": \"%s\",\n", GetPhaseName( (TPhase)ip ) );
+        fprintf( fp, "      \"spans\": %llu,\n", (unsigned long long)counters.nSpans.load() );
+        fprintf( fp, "      \"totalTime_ns\": %llu,\n", (unsigned long long)counters.totalTime.load() );
+        fprintf( fp, "      \"maxTime_ns\": %llu,\n", (unsigned long long)counters.maxTime.load() );
+        fprintf( fp, "      \"bytes\": %llu,\n", (unsigned long long)counters.nBytes.load() );
+        fprintf( fp, "      \"events\": %llu,\n", (unsigned long long)counters.nEvents.load() );
+        // histogram of the durations: counts of bin k = [2^k, 2^(k+1)) ns
+        fprintf( fp, "      \"histoLog2_ns\": [" );
+        for ( unsigned int ibin = 0; ibin < NBINS; ibin++ ) {
+            fprintf( fp, "%s%llu", ibin ? ", " : "", (unsigned long long)counters.histo[ibin].load() );
+        }
+        fprintf( fp, "]\n    }" );
+    }
+    fprintf( fp, "\n  ]\n}\n" );
+    const bool success = !ferror( fp );
+    fclose( fp );
+    if ( !success ) {
+        throw runtime_error( "TTimingReport::WriteToFile() - failed to write to " + fileName );
+    }
+    if ( GetVerboseLevel() > kSILENT ) {
+        cout << "TTimingReport::WriteToFile() - timing report written to " << fileName << endl;
+    }
+}
@@ -0,0 +1,159 @@
+#ifndef TIMING_REPORT_H
+#define TIMING_REPORT_H
+
+/**
+ * \class TTimingReport
+ *
+ * \brief Time spent by a scan in each of its phases (configuration, trigger, readout,
+ * decoding, ...), with the number of bytes and events processed
+ *
+ * \author Andry Rakotozafindrabe
+ *
+ * Each phase collects the durations of its spans (see TTimingSpan), measured with the
+ * steady clock: number of spans, total and max duration, and a histogram of the
+ * durations in powers of two of nanoseconds. The counters are atomic, so that the
+ * threads reading and decoding the boards in parallel add their spans without any
+ * lock; the spans of parallel threads overlap, so the total time of a phase can
+ * exceed the wall time of the scan.
+ *
+ * The report is written as a JSON file next to the data files of the scan (see
+ * WriteToFile()). The timing is compiled in by default; it is removed at compile time
+ * if NO_SCAN_TIMING is defined (cmake -DSCAN_TIMING=OFF).
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include "TVerbosity.h"
+
+class TTimingReport : public TVerbosity {
+
+public:
+
+    /// phases of a scan
+    enum TPhase {
+        kCONFIGURE = 0, ///< configuration of the boards and chips (control bus)
+        kTRIGGER,       ///< triggers sent to the boards
+        kREADOUT,       ///< events read from the boards
+        kDECODE,        ///< events decoded and hits filled in the histograms
+        kMERGE,         ///< histograms of the decoding lanes merged
+        kANALYSIS,      ///< analysis of the hits (e.g. S-curve fits)
+        kNPHASES
+    };
+
+    /// number of bins of the histogram of durations (bin k = [2^k, 2^(k+1)) ns)
+    static const unsigned int NBINS = 40;
+
+private:
+
+    /// counters of a phase
+    struct TPhaseCounters {
+        std::atomic<std::uint64_t> nSpans;
+        std::atomic<std::uint64_t> totalTime;
+        std::atomic<std::uint64_t> maxTime;
+        std::atomic<std::uint64_t> nBytes;
+        std::atomic<std::uint64_t> nEvents;
+        std::atomic<std::uint64_t> histo[NBINS];
+    };
+
+    /// name of the scan
+    std::string fName;
+
+    /// counters of each phase
+    TPhaseCounters fPhases[kNPHASES];
+
+    /// start of the scan
+    std::chrono::steady_clock::time_point fStartTime;
+
+public:
+
+    /// constructor
+    TTimingReport( const std::string name = "" );
+
+    /// destructor
+    ~TTimingReport();
+
+    /// set the name of the scan
+    void SetName( const std::string name ) { fName = name; }
+
+    /// reset all counters and the start time of the scan
+    void Reset();
+
+    /// add a span of a given duration (in ns) to a phase, with the bytes and events processed
+    void AddSpan( const TPhase phase, const std::uint64_t duration,
+                  const std::uint64_t nBytes = 0, const std::uint64_t nEvents = 0 );
+
+    /// number of spans of a phase
+    std::uint64_t GetNSpans( const TPhase phase ) const { return fPhases[phase].nSpans.load(); }
+
+    /// total time (in ns) spent in a phase
+    std::uint64_t GetTotalTime( const TPhase phase ) const { return fPhases[phase].totalTime.load(); }
+
+    /// name of a phase
+    static const char* GetPhaseName( const TPhase phase );
+
+    /// time (in ns) since the start of the scan
+    std::uint64_t GetWallTime() const;
+
+    /// print the time spent in each phase
+    void Dump() const;
+
+    /// write the report in a JSON file
+    void WriteToFile( const std::string fileName ) const;
+
+};
+
+/**
+ * \class TTimingSpan
+ *
+ * \brief Measure the duration of a block of code and add it to a phase of a timing
+ * report at the end of the block (or at Stop()); does nothing if the report is null
+ */
+class TTimingSpan {
+
+#ifndef NO_SCAN_TIMING
+    TTimingReport* fReport;
+    TTimingReport::TPhase fPhase;
+    std::chrono::steady_clock::time_point fStartTime;
+    std::uint64_t fNBytes;
+    std::uint64_t fNEvents;
+
+public:
+
+    TTimingSpan( TTimingReport* report, const TTimingReport::TPhase phase ) :
+        fReport( report ), fPhase( phase ),
+        fStartTime( report ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point() ),
+        fNBytes( 0 ), fNEvents( 0 ) { }
+
+    ~TTimingSpan() { Stop(); }
+
+    /// add a number of bytes processed during the span
+    void AddBytes( const std::uint64_t n ) { fNBytes += n; }
+
+    /// add a number of events processed during the span
+    void AddEvents( const std::uint64_t n = 1 ) { fNEvents += n; }
+
+    /// end the span now (only the first call counts)
+    void Stop()
+    {
+        if ( !fReport ) return;
+        const std::uint64_t duration = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - fStartTime ).count();
+        fReport->AddSpan( fPhase, duration, fNBytes, fNEvents );
+        fReport = nullptr;
+    }
+#else
+public:
+
+    TTimingSpan( TTimingReport*, const TTimingReport::TPhase ) { }
+    void AddBytes( const std::uint64_t ) { }
+    void AddEvents( const std::uint64_t = 1 ) { }
+    void Stop() { }
+#endif
+
+    TTimingSpan( const TTimingSpan& ) = delete;
+    TTimingSpan& operator=( const TTimingSpan& ) = delete;
+};
+
+#endif
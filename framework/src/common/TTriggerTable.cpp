@@ -0,0 +1,132 @@
+#include "TTriggerTable.h"
+#include <stdexcept>
+
+using namespace std;
+
+const size_t TTriggerTable::NOROW = (size_t)-1;
+
+//___________________________________________________________________
+TTriggerTable::TTriggerTable() :
+    fIsSorted( true ),
+    fFirst( 0 ),
+    fNRemoved( 0 )
+{
+
+}
+
+//___________________________________________________________________
+TTriggerTable::~TTriggerTable()
+{
+    Clear();
+}
+
+//___________________________________________________________________
+void TTriggerTable::Reserve( const size_t nRecords )
+{
+    fTrgNum.reserve( nRecords );
+    fTrgTime.reserve( nRecords );
+    fBoard.reserve( nRecords );
+}
+
+//___________________________________________________________________
+void TTriggerTable::Add( const uint32_t trgNum, const uint64_t trgTime, const uint16_t board )
+{
+    if ( !fTrgNum.empty() && IsBefore( trgNum, fTrgNum.back() ) ) {
+        fIsSorted = false;
+    }
+    fTrgNum.push_back( trgNum );
+    fTrgTime.push_back( trgTime );
+    fBoard.push_back( board );
+}
+
+//___________________________________________________________________
+void TTriggerTable::Append( const TTriggerTable& table )
+{
+    if ( !table.fIsSorted
+        || (!fTrgNum.empty() && table.GetSize() && IsBefore( table.GetTriggerNum( 0 ), fTrgNum.back() )) ) {
+        fIsSorted = false;
+    }
+    fTrgNum.insert( fTrgNum.end(), table.fTrgNum.begin() + table.fFirst, table.fTrgNum.end() );
+    fTrgTime.insert( fTrgTime.end(), table.fTrgTime.begin() + table.fFirst, table.fTrgTime.end() );
+    fBoard.insert( fBoard.end(), table.fBoard.begin() + table.fFirst, table.fBoard.end() );
+}
+
+//___________________________________________________________________
+void TTriggerTable::Clear()
+{
+    fTrgNum.clear();
+    fTrgTime.clear();
+    fBoard.clear();
+    fIsSorted = true;
+    fFirst = 0;
+    fNRemoved = 0;
+}
+
+//___________________________________________________________________
+void TTriggerTable::RemoveFirst( const size_t nRecords )
+{
+    const size_t n = ( nRecords < GetSize() ) ? nRecords : GetSize();
+    fFirst += n;
+    fNRemoved += n;
+    // the remaining records are moved once the removed ones take most of the columns
+    if ( (fFirst == fTrgNum.size()) || ((fFirst >= MINCOMPACTSIZE) && (2 * fFirst >= fTrgNum.size())) ) {
+        fTrgNum.erase( fTrgNum.begin(), fTrgNum.begin() + fFirst );
+        fTrgTime.erase( fTrgTime.begin(), fTrgTime.begin() + fFirst );
+        fBoard.erase( fBoard.begin(), fBoard.begin() + fFirst );
+        fFirst = 0;
+    }
+}
+
+//___________________________________________________________________
+size_t TTriggerTable::Join( const vector<const TTriggerTable*>& tables,
+                            vector<size_t>& rows,
+                            const bool requireAll,
+                            const size_t maxFound )
+{
+    const size_t nTables = tables.size();
+    for ( size_t it = 0; it < nTables; it++ ) {
+        if ( !tables[it] ) {
+            throw invalid_argument( "TTriggerTable::Join() - can not use a null pointer !" );
+        }
+        if ( !tables[it]->IsSorted() ) {
+            throw runtime_error( "TTriggerTable::Join() - table not sorted by trigger number." );
+        }
+    }
+    vector<size_t> cursor( nTables, 0 );
+    size_t nFound = 0;
+    while ( !maxFound || (nFound < maxFound) ) {
+        // smallest trigger number not yet joined
+        bool isEnd = true;
+        bool isComplete = true;
+        uint32_t current = 0;
+        for ( size_t it = 0; it < nTables; it++ ) {
+            if ( cursor[it] >= tables[it]->GetSize() ) {
+                isComplete = false;
+                continue;
+            }
+            const uint32_t trgNum = tables[it]->GetTriggerNum( cursor[it] );
+            if ( isEnd || IsBefore( trgNum, current ) ) current = trgNum;
+            isEnd = false;
+        }
+        // no trigger can be found in all tables once one of them is exhausted
+        if ( isEnd || (requireAll && !isComplete) ) break;
+
+        for ( size_t it = 0; it < nTables; it++ ) {
+            isComplete = isComplete && ( tables[it]->GetTriggerNum( cursor[it] ) == current );
+        }
+        if ( isComplete || !requireAll ) {
+            for ( size_t it = 0; it < nTables; it++ ) {
+                const bool isFound = ( cursor[it] < tables[it]->GetSize() )
+                                  && ( tables[it]->GetTriggerNum( cursor[it] ) == current );
+                rows.push_back( isFound ? cursor[it] : NOROW );
+            }
+            nFound++;
+        }
+        for ( size_t it = 0; it < nTables; it++ ) {
+            if ( (cursor[it] < tables[it]->GetSize()) && (tables[it]->GetTriggerNum( cursor[it] ) == current) ) {
+                cursor[it]++;
+            }
+        }
+    }
+    return nFound;
+}
@@ -0,0 +1,114 @@
+#ifndef TRIGGER_TABLE_H
+#define TRIGGER_TABLE_H
+
+/**
+ * \class TTriggerTable
+ *
+ * \brief Columnar table of the trigger records of the readout boards
+ *
+ * \author Andry Rakotozafindrabe
+ *
+ * One row per trigger record (trigger number, 64-bit trigger time in units of clock,
+ * board), stored column by column so that a table of a long run stays compact and is
+ * scanned without touching the columns that are not needed. The table of a board is
+ * cleared at the start of each run and filled in bulk by its trigger recorder parser
+ * (see TrgRecorderParser), from the reading thread of the board: a table is not
+ * protected against concurrent accesses. The event builder takes a copy of the new
+ * records from the same thread (see TEventBuilder::AddTriggerRecords()).
+ *
+ * The records are removed from the beginning of the table (see RemoveFirst()) by moving
+ * the index of the first row: the columns are only compacted once most of their memory
+ * is taken by removed records, so that removing the records one by one stays cheap.
+ *
+ * The trigger numbers of a board increase with time, so the tables of several boards
+ * are matched by a merge-join on the trigger number (see Join()), in a single pass over
+ * all tables, instead of searching each trigger of a board in the other tables.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class TTriggerTable {
+
+    /// trigger number of each record
+    std::vector<std::uint32_t> fTrgNum;
+
+    /// trigger time (in units of clock) of each record
+    std::vector<std::uint64_t> fTrgTime;
+
+    /// board that recorded the trigger
+    std::vector<std::uint16_t> fBoard;
+
+    /// false once a record was added with a trigger number before the previous one
+    bool fIsSorted;
+
+    /// index in the columns of the first row of the table
+    std::size_t fFirst;
+
+    /// number of records removed at the beginning of the table since Clear()
+    std::size_t fNRemoved;
+
+    /// min number of removed records kept in the columns before they are compacted
+    static const std::size_t MINCOMPACTSIZE = 1024;
+
+public:
+
+    /// row index used by Join() for a trigger missing in a table
+    static const std::size_t NOROW;
+
+    /// constructor
+    TTriggerTable();
+
+    /// destructor
+    ~TTriggerTable();
+
+    /// reserve memory for a given number of records
+    void Reserve( const std::size_t nRecords );
+
+    /// add a trigger record
+    void Add( const std::uint32_t trgNum, const std::uint64_t trgTime, const std::uint16_t board );
+
+    /// add all records of another table
+    void Append( const TTriggerTable& table );
+
+    /// remove all records
+    void Clear();
+
+    /// remove a given number of records at the beginning of the table
+    void RemoveFirst( const std::size_t nRecords );
+
+    /// number of records
+    std::size_t GetSize() const { return fTrgNum.size() - fFirst; }
+
+    /// number of records removed at the beginning of the table since Clear(): the i-th
+    /// record added since Clear() is at row i - GetNRemoved()
+    std::size_t GetNRemoved() const { return fNRemoved; }
+
+    /// number of records added since Clear()
+    std::size_t GetNAdded() const { return fNRemoved + GetSize(); }
+
+    std::uint32_t GetTriggerNum( const std::size_t row ) const { return fTrgNum[fFirst + row]; }
+    std::uint64_t GetTriggerTime( const std::size_t row ) const { return fTrgTime[fFirst + row]; }
+    std::uint16_t GetBoard( const std::size_t row ) const { return fBoard[fFirst + row]; }
+
+    /// true if trigger a comes before trigger b, also across the wrap-around of the 32-bit counter
+    static bool IsBefore( const std::uint32_t a, const std::uint32_t b )
+    {
+        return ( (std::int32_t)(a - b) < 0 );
+    }
+
+    /// true if the trigger numbers never decrease (see IsBefore()), checked by Add() and Append()
+    bool IsSorted() const { return fIsSorted; }
+
+    /// merge-join of tables sorted by trigger number: for each trigger number, append to
+    /// rows the row of this trigger in each table (one row index per table, NOROW if the
+    /// trigger is missing in a table), only for the triggers found in all tables if
+    /// requireAll is true, up to maxFound triggers (all if 0); return the number of triggers found
+    static std::size_t Join( const std::vector<const TTriggerTable*>& tables,
+                             std::vector<std::size_t>& rows,
+                             const bool requireAll = true,
+                             const std::size_t maxFound = 0 );
+};
+
+#endif
@@ -9,6 +9,8 @@
 #include <sstream>
 #include <stdexcept>
 #include <array>
+#include <thread>
+#include <vector>
 
 using namespace std;
 
@@ -60,6 +62,10 @@ const char* TAlpide::fDACsRegName[] = {
     ( char* ) "ITHR   "
 };
 
+// settling time of the monitored signal, and duration of one ADC conversion
+const chrono::microseconds TAlpide::fADCSettlingTime( 5000 );
+const chrono::microseconds TAlpide::fADCConversionTime( 5000 );
+
 #pragma mark - Constructors/destructor
 
 //___________________________________________________________________
@@ -67,7 +73,12 @@ TAlpide::TAlpide() :
     fChipId( -1 ),
     fADCOffset( -1 ),
     fADCHalfLSB( false ),
-    fADCSign( false )
+    fADCSign( false ),
+    fUseRegisterCache( true ),
+    fADCInput( AlpideADCInput::Temperature ),
+    fADCConversionPending( false ),
+    fADCSettledTimePending( false ),
+    fADCReadyTimePending( false )
 { }
 
 //___________________________________________________________________
@@ -75,7 +86,12 @@ TAlpide::TAlpide( shared_ptr<TChipConfig> config ) :
     fChipId( -1 ),
     fADCOffset( -1 ),
     fADCHalfLSB( false ),
-    fADCSign( false )
+    fADCSign( false ),
+    fUseRegisterCache( true ),
+    fADCInput( AlpideADCInput::Temperature ),
+    fADCConversionPending( false ),
+    fADCSettledTimePending( false ),
+    fADCReadyTimePending( false )
 {
     if ( !config ) {
         throw runtime_error( "TAlpide::TAlpide() - chip config. is a nullptr !" );
@@ -90,7 +106,12 @@ TAlpide::TAlpide( shared_ptr<TChipConfig> config,
     fChipId( -1 ),
     fADCOffset( -1 ),
     fADCHalfLSB( false ),
-    fADCSign( false )
+    fADCSign( false ),
+    fUseRegisterCache( true ),
+    fADCInput( AlpideADCInput::Temperature ),
+    fADCConversionPending( false ),
+    fADCSettledTimePending( false ),
+    fADCReadyTimePending( false )
 {
     if ( !config ) {
         throw runtime_error( "TAlpide::TAlpide() - chip config. is a nullptr !" );
@@ -372,6 +393,9 @@ void TAlpide::ReadRegister( const AlpideRegister address,
         cerr << "TAlpide::ReadRegister() - chip id = " << DecomposeChipId() << endl;
         throw runtime_error( "TAlpide::ReadRegister() - failed." );
     }
+    if ( doExecute && fUseRegisterCache && IsCacheableRegister( (uint16_t)address ) ) {
+        fRegisterCache[(uint16_t)address] = value;
+    }
     return;
 }
 
@@ -412,6 +436,9 @@ void TAlpide::ReadRegister( const uint16_t address,
         cerr << "TAlpide::ReadRegister() - chip id = " << DecomposeChipId() << endl;
         throw runtime_error( "TAlpide::ReadRegister() - failed." );
     }
+    if ( doExecute && fUseRegisterCache && IsCacheableRegister( (uint16_t)address ) ) {
+        fRegisterCache[(uint16_t)address] = value;
+    }
     return;
 }
 
@@ -443,6 +470,21 @@ void TAlpide::WriteRegister( const AlpideRegister address,
         return;
     }
 
+    uint16_t cached;
+    if ( !verify && GetCachedRegister( (uint16_t)address, cached ) && (cached == value) ) {
+        // write elision: the chip already holds this value
+        if ( GetVerboseLevel() > kULTRACHATTY ) {
+            cout << "TAlpide::WriteRegister() - chip id = " << DecomposeChipId()
+                 << " , address 0x" << std::hex << (uint16_t)address
+                 << " unchanged, skipped." << std::dec << endl;
+        }
+        if ( doExecute ) {
+            // still flush the transactions that may have been queued before
+            spBoard->ExecuteChipTransactions( (uint8_t)fChipId );
+        }
+        return;
+    }
+
     int result = -1;
     try {
         result = spBoard->WriteChipRegister( (uint16_t)address, value, (uint8_t)fChipId, (doExecute || verify) ); // always execute if verify is true
@@ -450,19 +492,25 @@ void TAlpide::WriteRegister( const AlpideRegister address,
         cerr << msg.what() << endl;
     }
     if ( result < 0 ) {
+        fRegisterCache.erase( (uint16_t)address );
         cerr << "TAlpide::WriteRegister() - chip id = " << DecomposeChipId() << endl;
         throw runtime_error( "TAlpide::WriteRegister() - failed." );
     }
+    if ( fUseRegisterCache && IsCacheableRegister( (uint16_t)address ) ) {
+        fRegisterCache[(uint16_t)address] = value;
+    }
     if ( verify ) {
         uint16_t check;
         try {
             ReadRegister( address, check );
         } catch ( exception& msg ) {
+            fRegisterCache.erase( (uint16_t)address );
             cerr << msg.what() << endl;
             cerr << "TAlpide::WriteRegister() - chip id = " << DecomposeChipId() << endl;
             throw runtime_error( "TAlpide::WriteRegister() - readback check failed." );
         }
         if ( check != value ) {
+            fRegisterCache.erase( (uint16_t)address );
             cerr << "TAlpide::WriteRegister() - chip id = " << DecomposeChipId() << endl;
             cerr << "TAlpide::WriteRegister() - value = " << value << endl;
             cerr << "TAlpide::WriteRegister() - readback value = " << check << endl;
@@ -500,6 +548,21 @@ void TAlpide::WriteRegister( const uint16_t address,
         return;
     }
     
+    uint16_t cached;
+    if ( !verify && GetCachedRegister( (uint16_t)address, cached ) && (cached == value) ) {
+        // write elision: the chip already holds this value
+        if ( GetVerboseLevel() > kULTRACHATTY ) {
+            cout << "TAlpide::WriteRegister() - chip id = " << DecomposeChipId()
+                 << " , address 0x" << std::hex << (uint16_t)address
+                 << " unchanged, skipped." << std::dec << endl;
+        }
+        if ( doExecute ) {
+            // still flush the transactions that may have been queued before
+            spBoard->ExecuteChipTransactions( (uint8_t)fChipId );
+        }
+        return;
+    }
+
     int result = -1;
     try {
         result = spBoard->WriteChipRegister( address, value, (uint8_t)fChipId, (doExecute || verify) ); // always execute if verify is true
@@ -507,19 +570,25 @@ void TAlpide::WriteRegister( const uint16_t address,
         cerr << msg.what() << endl;
     }
     if ( result < 0 ) {
+        fRegisterCache.erase( (uint16_t)address );
         cerr << "TAlpide::WriteRegister() - chip id = " << DecomposeChipId() << endl;
         throw runtime_error( "TAlpide::WriteRegister() - failed." );
     }
+    if ( fUseRegisterCache && IsCacheableRegister( (uint16_t)address ) ) {
+        fRegisterCache[(uint16_t)address] = value;
+    }
     if ( verify ) {
         uint16_t check;
         try {
             ReadRegister( address, check );
         } catch ( exception& msg ) {
+            fRegisterCache.erase( (uint16_t)address );
             cerr << msg.what() << endl;
             cerr << "TAlpide::WriteRegister() - chip id = " << DecomposeChipId() << endl;
             throw runtime_error( "TAlpide::WriteRegister() - readback check failed." );
         }
         if ( check != value ) {
+            fRegisterCache.erase( (uint16_t)address );
             cerr << "TAlpide::WriteRegister() - chip id = " << DecomposeChipId() << endl;
             cerr << "TAlpide::WriteRegister() - value = " << value << endl;
             cerr << "TAlpide::WriteRegister() - readback value = " << check << endl;
@@ -539,16 +608,19 @@ void TAlpide::ModifyRegisterBits( const AlpideRegister address,
                                  const bool skipDisabledChip )
 {
     
-    if ( (lowBit > 15) || (lowBit + nBits > 15)) {
+    if ( (lowBit > 15) || (lowBit + nBits > 16)) {
         throw domain_error( "TAlpide::ModifyRegisterBits() - illegal limits." );
     }
-    uint16_t registerValue, mask = 0xffff;
-    try {
-        ReadRegister( address, registerValue, skipDisabledChip );
-    } catch ( exception& msg ) {
-        cerr << msg.what() << endl;
-        cerr << "TAlpide::ModifyRegisterBits() - chip id = " << DecomposeChipId() << endl;
-        throw runtime_error( "TAlpide::ModifyRegisterBits() - readback step failed." );
+    uint16_t registerValue = 0, mask = 0xffff;
+    // read-modify-write: the read step is served from the shadow copy when possible
+    if ( !GetCachedRegister( (uint16_t)address, registerValue ) ) {
+        try {
+            ReadRegister( address, registerValue, true, skipDisabledChip );
+        } catch ( exception& msg ) {
+            cerr << msg.what() << endl;
+            cerr << "TAlpide::ModifyRegisterBits() - chip id = " << DecomposeChipId() << endl;
+            throw runtime_error( "TAlpide::ModifyRegisterBits() - readback step failed." );
+        }
     }
     
     for (int i = lowBit; i < lowBit + nBits; i++) {
@@ -557,9 +629,9 @@ void TAlpide::ModifyRegisterBits( const AlpideRegister address,
     
     registerValue &= mask;                // set all bits that are to be overwritten to 0
     value         &= (1 << nBits) -1;     // make sure value fits into nBits
-    registerValue |= value << nBits;      // or value into the foreseen spot
+    registerValue |= value << lowBit;     // or value into the foreseen spot
     try {
-        WriteRegister( address, registerValue, verify, skipDisabledChip );
+        WriteRegister( address, registerValue, true, verify, skipDisabledChip );
     } catch ( exception& msg ) {
         cerr << msg.what() << endl;
         cerr << "TAlpide::ModifyRegisterBits() - chip id = " << DecomposeChipId() << endl;
@@ -568,78 +640,264 @@ void TAlpide::ModifyRegisterBits( const AlpideRegister address,
     return;
 }
 
-#pragma mark - operations with ADC or DAC
+#pragma mark - shadow register cache
 
 //___________________________________________________________________
-float TAlpide::ReadTemperature()
+void TAlpide::SetRegisterCacheEnabled( const bool en )
 {
-    shared_ptr<TReadoutBoard> spBoard = fReadoutBoard.lock();
-    if ( !spBoard ) {
-        throw runtime_error( "TAlpide::ReadTemperature() - unuseable readout board." );
+    fUseRegisterCache = en;
+    if ( !fUseRegisterCache ) {
+        InvalidateRegisterCache();
     }
+}
 
-    uint16_t theResult = 0;
-    if (fADCOffset == -1) { // needs calibration
-        CalibrateADC();
+//___________________________________________________________________
+void TAlpide::ResyncRegisterCache()
+{
+    shared_ptr<TChipConfig> spConfig = fConfig.lock();
+    if ( !spConfig ) {
+        throw runtime_error( "TAlpide::ResyncRegisterCache() - chip config. not found!" );
     }
+    InvalidateRegisterCache();
+    if ( !fUseRegisterCache || !(spConfig->IsEnabled()) ) {
+        return;
+    }
+    
+    // queue all the reads, execute them in one go with the last one
+    vector<uint16_t> addresses;
+    for ( uint16_t i = (uint16_t)AlpideRegister::MODE_CONTROL; i <= (uint16_t)AlpideRegister::BUSY_MINWIDTH; i++ ) {
+        if ( IsCacheableRegister( i ) ) addresses.push_back( i );
+    }
+    for ( uint16_t i = (uint16_t)AlpideRegister::ANALOGMON; i <= (uint16_t)AlpideRegister::ADC_DAC_INPUT; i++ ) {
+        if ( IsCacheableRegister( i ) ) addresses.push_back( i );
+    }
+    addresses.push_back( (uint16_t)AlpideRegister::PIXEL_CONFIG );
+    addresses.push_back( (uint16_t)AlpideRegister::TEST_CONTROL );
     
-    SetTheDacMonitor( AlpideRegister::ANALOGMON ); // uses the RE_ANALOGMON, in order to disable the monitoring !
-    usleep(5000);
-    SetTheADCCtrlRegister( AlpideADCMode::MANUAL, AlpideADCInput::Temperature, AlpideADCComparator::COMP_296uA, AlpideADCRampSpeed::RAMP_1us );
-    spBoard->SendOpCode( (uint16_t)AlpideOpCode::ADCMEASURE,  (uint8_t)fChipId );
-    usleep(5000); // Wait for the measurement > of 5 milli sec
-    ReadRegister( AlpideRegister::ADC_AVSS, theResult );
-    theResult -=  (uint16_t)fADCOffset;
-    float theValue =  ( ((float)theResult) * 0.1281) + 6.8; // first approximation
-    return theValue;
+    vector<uint16_t> values( addresses.size(), 0 );
+    try {
+        for ( unsigned int i = 0; i < addresses.size(); i++ ) {
+            const bool doExecute = ( i == addresses.size() - 1 );
+            ReadRegister( addresses.at(i), values.at(i), doExecute );
+        }
+    } catch ( exception& msg ) {
+        cerr << msg.what() << endl;
+        cerr << "TAlpide::ResyncRegisterCache() - chip id = " << DecomposeChipId() << endl;
+        InvalidateRegisterCache();
+        throw runtime_error( "TAlpide::ResyncRegisterCache() - failed." );
+    }
+    for ( unsigned int i = 0; i < addresses.size(); i++ ) {
+        fRegisterCache[addresses.at(i)] = values.at(i);
+    }
+    if ( GetVerboseLevel() > kVERBOSE ) {
+        cout << "TAlpide::ResyncRegisterCache() - chip id = " << DecomposeChipId()
+             << " , " << fRegisterCache.size() << " registers cached" << endl;
+    }
 }
 
 //___________________________________________________________________
-float TAlpide::ReadDACVoltage( AlpideRegister ADac )
+bool TAlpide::GetCachedRegister( const uint16_t address, uint16_t& value ) const
 {
-    shared_ptr<TReadoutBoard> spBoard = fReadoutBoard.lock();
-    if ( !spBoard ) {
-        throw runtime_error( "TAlpide::ReadDACVoltage() - unuseable readout board." );
+    if ( !fUseRegisterCache ) {
+        return false;
+    }
+    std::map<uint16_t, uint16_t>::const_iterator it = fRegisterCache.find( address );
+    if ( it == fRegisterCache.end() ) {
+        return false;
     }
+    value = it->second;
+    return true;
+}
 
-    uint16_t theResult = 0;
+//___________________________________________________________________
+bool TAlpide::IsCacheableRegister( const uint16_t address )
+{
+    // command, status, FIFO and debug registers have side effects or change by
+    // themselves; pixel and region registers are only addressed through broadcast
+    // or select patterns that alias several physical registers
+    switch ( (AlpideRegister)address ) {
+        case AlpideRegister::MODE_CONTROL:
+        case AlpideRegister::DISABLE_REGION_LOW:
+        case AlpideRegister::DISABLE_REGION_HIGH:
+        case AlpideRegister::FROMU_CONFIG1:
+        case AlpideRegister::FROMU_CONFIG2:
+        case AlpideRegister::FROMU_CONFIG3:
+        case AlpideRegister::FROMU_PULSING1:
+        case AlpideRegister::FROMU_PULSING2:
+        case AlpideRegister::DACS_CLKIO_BUF:
+        case AlpideRegister::DACS_CMUIO_BUF:
+        case AlpideRegister::CMU_DMU_CONFIG:
+        case AlpideRegister::DTU_CONFIG:
+        case AlpideRegister::DTU_DACS:
+        case AlpideRegister::DTU_TEST1:
+        case AlpideRegister::DTU_TEST2:
+        case AlpideRegister::DTU_TEST3:
+        case AlpideRegister::BUSY_MINWIDTH:
+        case AlpideRegister::ANALOGMON:
+        case AlpideRegister::VRESETP:
+        case AlpideRegister::VRESETD:
+        case AlpideRegister::VCASP:
+        case AlpideRegister::VCASN:
+        case AlpideRegister::VPULSEH:
+        case AlpideRegister::VPULSEL:
+        case AlpideRegister::VCASN2:
+        case AlpideRegister::VCLIP:
+        case AlpideRegister::VTEMP:
+        case AlpideRegister::IAUX2:
+        case AlpideRegister::IRESET:
+        case AlpideRegister::IDB:
+        case AlpideRegister::IBIAS:
+        case AlpideRegister::ITHR:
+        case AlpideRegister::BYPASS_BUFFER:
+        case AlpideRegister::ADC_CONTROL:
+        case AlpideRegister::ADC_DAC_INPUT:
+        case AlpideRegister::PIXEL_CONFIG:
+        case AlpideRegister::TEST_CONTROL:
+            return true;
+        default:
+            return false;
+    }
+}
+
+#pragma mark - operations with ADC or DAC
+
+//___________________________________________________________________
+float TAlpide::ReadTemperature()
+{
+    // uses the RE_ANALOGMON, in order to disable the monitoring !
+    SelectADCInput( AlpideADCInput::Temperature, AlpideRegister::ANALOGMON );
+    StartADCConversion();
+    return ReadADCConversion();
+}
+
+//___________________________________________________________________
+float TAlpide::ReadDACVoltage( AlpideRegister ADac )
+{
+    SelectADCInput( AlpideADCInput::DACMONV, ADac );
+    StartADCConversion();
+    return ReadADCConversion();
+}
+
+//___________________________________________________________________
+float TAlpide::ReadDACCurrent( AlpideRegister ADac )
+{
+    SelectADCInput( AlpideADCInput::DACMONI, ADac );
+    StartADCConversion();
+    return ReadADCConversion();
+}
+
+//___________________________________________________________________
+void TAlpide::SelectADCInput( AlpideADCInput SelectInput, AlpideRegister ADac, const bool doExecute )
+{
+    if ( fADCConversionPending ) {
+        throw runtime_error( "TAlpide::SelectADCInput() - previous ADC conversion not read yet." );
+    }
     if (fADCOffset == -1) { // needs calibration
         CalibrateADC();
     }
-    
-    SetTheDacMonitor( ADac );
-    usleep(5000);
-    SetTheADCCtrlRegister( AlpideADCMode::MANUAL, AlpideADCInput::DACMONV, AlpideADCComparator::COMP_296uA, AlpideADCRampSpeed::RAMP_1us );
-    spBoard->SendOpCode( (uint16_t)AlpideOpCode::ADCMEASURE, (uint8_t)fChipId );
-    usleep(5000); // Wait for the measurement > of 5 milli sec
-    ReadRegister( AlpideRegister::ADC_AVSS, theResult );
-    theResult -=  (uint16_t)fADCOffset;
-    float theValue =  ( ((float)theResult) * 0.001644); // V scale first approximation
-    return theValue;
+    SetTheDacMonitor( ADac, AlpideDACMonIref::IREF_100uA, doExecute );
+    // a queued write only reaches the chip when the transactions are executed,
+    // the settling time then starts at ExecutedADCTransactions()
+    fADCSettledTime = chrono::steady_clock::now() + fADCSettlingTime;
+    fADCSettledTimePending = !doExecute;
+    // the control register is written while the monitored signal settles
+    SetTheADCCtrlRegister( AlpideADCMode::MANUAL, SelectInput, AlpideADCComparator::COMP_296uA, AlpideADCRampSpeed::RAMP_1us, doExecute );
+    fADCInput = SelectInput;
 }
 
 //___________________________________________________________________
-float TAlpide::ReadDACCurrent( AlpideRegister ADac )
+void TAlpide::StartADCConversion( const bool doExecute )
 {
     shared_ptr<TReadoutBoard> spBoard = fReadoutBoard.lock();
     if ( !spBoard ) {
-        throw runtime_error( "TAlpide::ReadDACCurrent() - unuseable readout board." );
+        throw runtime_error( "TAlpide::StartADCConversion() - unuseable readout board." );
+    }
+    if ( fADCConversionPending ) {
+        throw runtime_error( "TAlpide::StartADCConversion() - previous ADC conversion not read yet." );
+    }
+    if ( fADCSettledTimePending ) {
+        // the settling time can not be known before the selection reached the chip
+        throw runtime_error( "TAlpide::StartADCConversion() - ADC input selection queued but not executed yet." );
+    }
+    this_thread::sleep_until( fADCSettledTime );
+    if ( doExecute ) {
+        spBoard->SendOpCode( (uint16_t)AlpideOpCode::ADCMEASURE, (uint8_t)fChipId );
+    } else {
+        // same as the chip-addressed opcode, but queued with the other transactions
+        WriteRegister( AlpideRegister::COMMAND, (uint16_t)AlpideOpCode::ADCMEASURE, false );
     }
+    fADCReadyTime = chrono::steady_clock::now() + fADCConversionTime;
+    fADCReadyTimePending = !doExecute;
+    fADCConversionPending = true;
+}
+
+//___________________________________________________________________
+void TAlpide::ExecutedADCTransactions()
+{
+    // the queued DAC / monitor writes and ADCMEASURE opcode reached the chip just now
+    const chrono::steady_clock::time_point now = chrono::steady_clock::now();
+    if ( fADCSettledTimePending ) {
+        fADCSettledTime = now + fADCSettlingTime;
+        fADCSettledTimePending = false;
+    }
+    if ( fADCReadyTimePending ) {
+        fADCReadyTime = now + fADCConversionTime;
+        fADCReadyTimePending = false;
+    }
+}
 
+//___________________________________________________________________
+float TAlpide::ReadADCConversion()
+{
     uint16_t theResult = 0;
-    if (fADCOffset == -1) { // needs calibration
-        CalibrateADC();
+    ReadADCConversion( theResult, true );
+    return ConvertADCValue( theResult );
+}
+
+//___________________________________________________________________
+void TAlpide::ReadADCConversion( uint16_t& rawValue, const bool doExecute )
+{
+    if ( !fADCConversionPending ) {
+        throw runtime_error( "TAlpide::ReadADCConversion() - no ADC conversion started." );
     }
-    
-    SetTheDacMonitor( ADac );
-    usleep(5000);
-    SetTheADCCtrlRegister( AlpideADCMode::MANUAL, AlpideADCInput::DACMONI, AlpideADCComparator::COMP_296uA, AlpideADCRampSpeed::RAMP_1us );
-    spBoard->SendOpCode( (uint16_t)AlpideOpCode::ADCMEASURE,  (uint8_t)fChipId );
-    usleep(5000); // Wait for the measurement > of 5 milli sec
-    ReadRegister( AlpideRegister::ADC_AVSS, theResult );
-    theResult -= (uint16_t)fADCOffset;
-    float theValue =  ( ((float)theResult) * 0.164); // uA scale   first approximation
-    return theValue;
+    if ( fADCReadyTimePending ) {
+        throw runtime_error( "TAlpide::ReadADCConversion() - ADC conversion queued but not executed yet." );
+    }
+    fADCConversionPending = false;
+    this_thread::sleep_until( fADCReadyTime );
+    ReadRegister( AlpideRegister::ADC_AVSS, rawValue, doExecute );
+}
+
+//___________________________________________________________________
+float TAlpide::ConvertADCValue( uint16_t rawValue ) const
+{
+    rawValue -= (uint16_t)fADCOffset;
+    switch ( fADCInput ) {
+        case AlpideADCInput::Temperature:
+            return ( ((float)rawValue) * 0.1281) + 6.8; // first approximation
+        case AlpideADCInput::DACMONV:
+            return ( ((float)rawValue) * 0.001644); // V scale first approximation
+        case AlpideADCInput::DACMONI:
+            return ( ((float)rawValue) * 0.164); // uA scale   first approximation
+        default:
+            return (float)rawValue;
+    }
+}
+
+//___________________________________________________________________
+bool TAlpide::IsVoltageDAC( const AlpideRegister ADac )
+{
+    return ( (ADac >= AlpideRegister::VRESETP) && (ADac <= AlpideRegister::VTEMP) );
+}
+
+//___________________________________________________________________
+string TAlpide::GetDACName( const AlpideRegister ADac )
+{
+    if ( (ADac < AlpideRegister::VRESETP) || (ADac > AlpideRegister::ITHR) ) {
+        return string();
+    }
+    string name( fDACsRegName[ (int)ADac - (int)AlpideRegister::VRESETP ] );
+    return name.substr( 0, name.find( ' ' ) );
 }
 
 #pragma mark - chip configuration operations
@@ -1110,6 +1368,28 @@ int TAlpide::ConfigureMaskStage( int nPix, const int iStage )
     }
 }
 
+//___________________________________________________________________
+bool TAlpide::IsPulsedInMaskStage( int nPix, const int iStage,
+                                   const unsigned int row, const unsigned int column )
+{
+    // same pattern as ConfigureMaskStage()
+    if ( iStage < 0 ) {
+        if ( nPix > 512 ) nPix = 512;
+        if ( nPix < 0 ) nPix = 1;
+        return ( row < (unsigned int)nPix );
+    }
+    if ((nPix <= 0) || (nPix & (nPix - 1)) || (nPix > 32)) {
+        nPix = 1;
+    }
+    if ( nPix == 32 ) {
+        return ( row == (unsigned int)iStage );
+    }
+    const unsigned int colStep = 32 / nPix;
+    const unsigned int colOffset = iStage / 512;
+    return ( (row == (unsigned int)(iStage % 512))
+            && (column >= colOffset) && ((column - colOffset) % colStep == 0) );
+}
+
 
 //___________________________________________________________________
 void TAlpide::WriteControlReg( const AlpideChipMode chipMode )
@@ -1470,16 +1750,17 @@ void TAlpide::CalibrateADC()
 uint16_t TAlpide::SetTheADCCtrlRegister( AlpideADCMode Mode,
 										AlpideADCInput SelectInput,
 										AlpideADCComparator ComparatorCurrent,
-										AlpideADCRampSpeed RampSpeed )
+										AlpideADCRampSpeed RampSpeed,
+										const bool doExecute )
 {
 	uint16_t Data;
 	Data = (int)Mode | ((int)SelectInput<<2) | ((int)ComparatorCurrent<<6) | (fADCSign<<8) | ((int)RampSpeed<<9) | (fADCHalfLSB<<11);
-	WriteRegister( AlpideRegister::ADC_CONTROL, Data );
+	WriteRegister( AlpideRegister::ADC_CONTROL, Data, doExecute );
 	return Data;
 }
 
 //___________________________________________________________________
-void TAlpide::SetTheDacMonitor( AlpideRegister ADac, AlpideDACMonIref IRef )
+void TAlpide::SetTheDacMonitor( AlpideRegister ADac, AlpideDACMonIref IRef, const bool doExecute )
 {
 	int VDAC, IDAC;
 	uint16_t Value;
@@ -1550,7 +1831,7 @@ void TAlpide::SetTheDacMonitor( AlpideRegister ADac, AlpideDACMonIref IRef )
 	Value |= (IDAC & 0x7) << 4;
 	Value |= ((int)IRef & 0x3) << 9;
 
-	WriteRegister( AlpideRegister::ANALOGMON, Value );
+	WriteRegister( AlpideRegister::ANALOGMON, Value, doExecute );
 	return;
 }
 
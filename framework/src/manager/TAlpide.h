@@ -2,7 +2,9 @@
 #define ALPIDE_H
 
 #include <unistd.h>
+#include <chrono>
 #include <cstdint>
+#include <map>
 #include <memory>
 #include <string>
 #include "TVerbosity.h"
@@ -23,7 +25,34 @@ class TAlpide : public TVerbosity {
 
     std::weak_ptr<TChipConfig> fConfig;
     std::weak_ptr<TReadoutBoard> fReadoutBoard;
-    
+
+    /// shadow copy of the writable registers (key = address, value = last written or read value)
+    std::map<std::uint16_t, std::uint16_t> fRegisterCache;
+
+    /// if true (default), writes of an unchanged value are skipped
+    bool fUseRegisterCache;
+
+    /// input selected for the next (or pending) ADC conversion
+    AlpideADCInput fADCInput;
+
+    /// time after which the monitored analog signal is considered stable
+    std::chrono::steady_clock::time_point fADCSettledTime;
+
+    /// time after which the pending ADC conversion is complete
+    std::chrono::steady_clock::time_point fADCReadyTime;
+
+    /// true between StartADCConversion() and ReadADCConversion()
+    bool fADCConversionPending;
+
+    /// true if the ADC input selection is queued: fADCSettledTime is set at its execution
+    bool fADCSettledTimePending;
+
+    /// true if the ADC conversion start is queued: fADCReadyTime is set at its execution
+    bool fADCReadyTimePending;
+
+    static const std::chrono::microseconds fADCSettlingTime;
+    static const std::chrono::microseconds fADCConversionTime;
+
     static const char* fRegName[];
     static const char* fDACsRegName[];
 
@@ -84,6 +113,25 @@ class TAlpide : public TVerbosity {
                             const bool verify = false,
                             const bool skipDisabledChip = true );
     
+    #pragma mark - shadow register cache
+
+    /// Enable (default) or disable the shadow register cache (disabling also clears it)
+    void SetRegisterCacheEnabled( const bool en );
+    
+    bool IsRegisterCacheEnabled() const { return fUseRegisterCache; }
+    
+    /// Forget all cached register values, e.g. after a global reset of the chip
+    void InvalidateRegisterCache() { fRegisterCache.clear(); }
+    
+    /// Re-read all cacheable registers from the chip to refill the shadow copy
+    void ResyncRegisterCache();
+    
+    /// Get the cached value of a register, returns false if the register is not cached
+    bool GetCachedRegister( const std::uint16_t address, std::uint16_t& value ) const;
+    
+    /// True for the registers that only store a value written by the user (no side effect)
+    static bool IsCacheableRegister( const std::uint16_t address );
+
 
     #pragma mark - chip configuration operations
 
@@ -119,6 +167,10 @@ class TAlpide : public TVerbosity {
 
     /// Return value: active row (needed for threshold scan histogramming).
     int  ConfigureMaskStage( int nPix, const int iStage );
+
+    /// true if the pixel (row, column) is pulsed by ConfigureMaskStage( nPix, iStage )
+    static bool IsPulsedInMaskStage( int nPix, const int iStage,
+                                     const unsigned int row, const unsigned int column );
     
     /// Write the bits in the Mode Control Register
     void WriteControlReg( const AlpideChipMode chipMode );
@@ -168,6 +220,51 @@ class TAlpide : public TVerbosity {
      */
     float ReadDACCurrent( AlpideRegister ADac );
     
+    /// Selects the input of the internal ADC (first step of a measurement).
+    /**
+     \param SelectInput the ADC input, e.g. Temperature, DACMONV or DACMONI
+     \param ADac the DAC register to be monitored (ANALOGMON = no DAC monitored)
+     - Note:
+     
+     the three steps SelectADCInput(), StartADCConversion() and ReadADCConversion()
+     do not block the caller more than needed: each one only waits for the end of
+     the settling (resp. conversion) time still remaining since the previous step.
+     Calling each step for all chips before going to the next one thus measures
+     all chips in the time of a single measurement. With doExecute = false, the
+     register transactions are only queued, see TReadoutBoard::ExecuteChipTransactions(),
+     and ExecutedADCTransactions() must be called once they are executed.
+     */
+    void SelectADCInput( AlpideADCInput SelectInput,
+                         AlpideRegister ADac = AlpideRegister::ANALOGMON,
+                         const bool doExecute = true );
+    
+    /// Starts the ADC conversion once the selected input has settled.
+    void StartADCConversion( const bool doExecute = true );
+
+    /// Starts the settling (resp. conversion) time of a queued ADC input selection (resp. conversion start), to be called right after its execution.
+    void ExecutedADCTransactions();
+    
+    /// Waits for the end of the conversion and returns the measurement.
+    /**
+     Returns the value in Celsius degree (Temperature), Volts (DACMONV),
+     Micro Ampere (DACMONI), or in ADC counts for any other input.
+     */
+    float ReadADCConversion();
+    
+    /// Waits for the end of the conversion and reads (or queues the read of) the raw ADC value.
+    void ReadADCConversion( std::uint16_t& rawValue, const bool doExecute );
+    
+    /// Converts a raw ADC value read by ReadADCConversion() into physical units.
+    float ConvertADCValue( std::uint16_t rawValue ) const;
+    
+    bool IsADCConversionPending() const { return fADCConversionPending; }
+    
+    /// Returns true for a voltage DAC (VRESETP ... VTEMP), false for a current DAC (IAUX2 ... ITHR).
+    static bool IsVoltageDAC( const AlpideRegister ADac );
+    
+    /// Returns the name of a DAC register (e.g. "VCASN"), or an empty string if not a DAC.
+    static std::string GetDACName( const AlpideRegister ADac );
+    
 private:
     
     #pragma mark - needed to operate with ADC or DAC
@@ -190,7 +287,8 @@ private:
     uint16_t SetTheADCCtrlRegister( AlpideADCMode Mode,
                                     AlpideADCInput SelectInput,
                                     AlpideADCComparator ComparatorCurrent,
-                                    AlpideADCRampSpeed RampSpeed );
+                                    AlpideADCRampSpeed RampSpeed,
+                                    const bool doExecute = true );
 
     /// Sets the DAC Monitor multiplexer.
     /**
@@ -198,7 +296,8 @@ private:
      \param IRef the IRef value [Iref =  0:0.25ua 1:0.75uA 2:1.00uA 3:1.25uA]
      */
     void SetTheDacMonitor( AlpideRegister ADac,
-                           AlpideDACMonIref IRef = AlpideDACMonIref::IREF_100uA );
+                           AlpideDACMonIref IRef = AlpideDACMonIref::IREF_100uA,
+                           const bool doExecute = true );
     
     #pragma mark - needed for chip config. operations
     
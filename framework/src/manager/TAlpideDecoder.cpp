@@ -2,8 +2,10 @@
 #include "TDevice.h"
 #include "TPixHit.h"
 #include "THisto.h"
+#include "TSCurveHisto.h"
 #include "TErrorCounter.h"
 #include "TStorePixHit.h"
+#include "THotTrace.h"
 #include <stdint.h>
 #include <iostream>
 #include <string>
@@ -12,6 +14,10 @@
 
 using namespace std;
 
+// trace record of the event being decoded
+#define DECODER_TRACE( site, ... ) \
+    HOT_TRACE( site, fCurrentChipIndex.boardIndex, fCurrentChipIndex.dataReceiver, fTrgNum, __VA_ARGS__ )
+
 //___________________________________________________________________
 TAlpideDecoder::TAlpideDecoder() : TVerbosity(),
     fDevice( nullptr ),
@@ -25,6 +31,7 @@ TAlpideDecoder::TAlpideDecoder() : TVerbosity(),
     fRescueBadChipId( false ),
     fDataType( TDataType::kUNKNOWN ),
     fScanHisto( nullptr ),
+    fSCurveHisto( nullptr ),
     fErrorCounter( nullptr ),
     fStorePixHit( nullptr )
 {
@@ -47,6 +54,7 @@ TAlpideDecoder::TAlpideDecoder( shared_ptr<TDevice> aDevice,
     fRescueBadChipId( false ),
     fDataType( TDataType::kUNKNOWN ),
     fScanHisto( nullptr ),
+    fSCurveHisto( nullptr ),
     fErrorCounter( nullptr ),
     fStorePixHit( aPixStorage )
 {
@@ -88,6 +96,15 @@ void TAlpideDecoder::SetScanHisto( shared_ptr<TScanHisto> aScanHisto )
     fScanHisto = aScanHisto;
 }
 
+//___________________________________________________________________
+void TAlpideDecoder::SetSCurveHisto( shared_ptr<TSCurveHisto> aSCurveHisto )
+{
+    if ( !aSCurveHisto ) {
+        throw runtime_error( "TAlpideDecoder::SetSCurveHisto() - can not use a null pointer !" );
+    }
+    fSCurveHisto = aSCurveHisto;
+}
+
 //___________________________________________________________________
 void TAlpideDecoder::SetErrorCounter( shared_ptr<TErrorCounter> anErrorCounter )
 {
@@ -100,6 +117,9 @@ void TAlpideDecoder::SetErrorCounter( shared_ptr<TErrorCounter> anErrorCounter )
 //___________________________________________________________________
 unsigned int TAlpideDecoder::GetNHits() const
 {
+    if ( fSCurveHisto ) {
+        return fSCurveHisto->GetNEntries();
+    }
     if ( !fScanHisto ) {
         throw runtime_error( "TAlpideDecoder::GetNHits() - scan histo is a null pointer !" );
     }
@@ -136,6 +156,8 @@ bool TAlpideDecoder::DecodeEvent( unsigned char* data,
         cerr << "TAlpideDecoder::DecodeEvent() - " << err.what() << endl;
         exit( EXIT_FAILURE );
     }
+    DECODER_TRACE( HotTrace::kDECODER_EVENT, nBytes,
+                   (uint32_t)( trgTime & 0xffffffff ), (uint32_t)( trgTime >> 32 ) );
     fDataType = TDataType::kUNKNOWN;
     bool started = false; // event has started, i.e. chip header has been found
     bool finished = false; // event trailer found
@@ -149,6 +171,7 @@ bool TAlpideDecoder::DecodeEvent( unsigned char* data,
         
         last = data[byte];
         FindDataType( data[byte] );
+        DECODER_TRACE( HotTrace::kDECODER_WORD, byte, data[byte], (uint32_t)fDataType, fChipId );
         
         switch ( fDataType ) {
             case TDataType::kIDLE:
@@ -174,10 +197,12 @@ bool TAlpideDecoder::DecodeEvent( unsigned char* data,
                 break;
             case TDataType::kCHIPTRAILER:
                 if ( !started ) {
+                    DECODER_TRACE( HotTrace::kDECODER_ERROR, HotTrace::kTRAILER_BEFORE_HEADER, byte, data[byte], fChipId );
                     cerr << "TAlpideDecoder::DecodeEvent() - Error: chip trailer found before chip header" << endl;
                     return false;
                 }
                 if ( finished ) {
+                    DECODER_TRACE( HotTrace::kDECODER_ERROR, HotTrace::kTRAILER_AFTER_END, byte, data[byte], fChipId );
                     cerr << "TAlpideDecoder::DecodeEvent() - Error: chip trailer found after event was finished" << endl;
                     return false;
                 }
@@ -188,6 +213,7 @@ bool TAlpideDecoder::DecodeEvent( unsigned char* data,
                 break;
             case TDataType::kREGIONHEADER:
                 if (!started) {
+                    DECODER_TRACE( HotTrace::kDECODER_ERROR, HotTrace::kREGION_OUTSIDE_CHIP, byte, data[byte], fChipId );
                     cerr << "TAlpideDecoder::DecodeEvent() - Error: region header found before chip header or after chip trailer" << endl;
                     return false;
                 }
@@ -196,13 +222,16 @@ bool TAlpideDecoder::DecodeEvent( unsigned char* data,
                 break;
             case TDataType::kDATASHORT:
                 if ( !started ) {
+                    DECODER_TRACE( HotTrace::kDECODER_ERROR, HotTrace::kHIT_OUTSIDE_CHIP, byte, data[byte], fChipId );
                     cerr << "TAlpideDecoder::DecodeEvent() - Error: hit data found before chip header or after chip trailer" << endl;
                     return false;
                 }
                 if ( fRegion == 32 ) {
+                    DECODER_TRACE( HotTrace::kDECODER_ERROR, HotTrace::kHIT_WITHOUT_REGION, byte, data[byte], fChipId );
                     cout << "TAlpideDecoder::DecodeEvent() - Warning: data word without region (Chip " << fChipId << ")" << endl;
                 }
                 if ( !IsValidChipId() ) {
+                    DECODER_TRACE( HotTrace::kDECODER_ERROR, HotTrace::kUNEXPECTED_CHIP_ID, byte, data[byte], fChipId );
                     cerr << "TAlpideDecoder::DecodeEvent() - Warning: unexpected chip id (Chip " << fChipId << ") , TDataType::kDATASHORT" << endl;
                     if ( GetVerboseLevel() > kCHATTY ) {
                         for ( int i = 0; i < nBytes; i++ ) {
@@ -216,13 +245,16 @@ bool TAlpideDecoder::DecodeEvent( unsigned char* data,
                 break;
             case TDataType::kDATALONG:
                 if ( !started ) {
+                    DECODER_TRACE( HotTrace::kDECODER_ERROR, HotTrace::kHIT_OUTSIDE_CHIP, byte, data[byte], fChipId );
                     cerr << "TAlpideDecoder::DecodeEvent() - Error: hit data found before chip header or after chip trailer" << endl;
                     return false;
                 }
                 if ( fRegion == 32 ) {
+                    DECODER_TRACE( HotTrace::kDECODER_ERROR, HotTrace::kHIT_WITHOUT_REGION, byte, data[byte], fChipId );
                     cerr << "TAlpideDecoder::DecodeEvent() - Warning: data word without region, skipping (Chip " << fChipId << ")" << endl;
                 }
                 if ( !IsValidChipId() ) {
+                    DECODER_TRACE( HotTrace::kDECODER_ERROR, HotTrace::kUNEXPECTED_CHIP_ID, byte, data[byte], fChipId );
                     cerr << "TAlpideDecoder::DecodeEvent() - Warning: unexpected chip id (Chip " << fChipId << ") , TDataType::kDATALONG" << endl;
                     if ( GetVerboseLevel() > kCHATTY ) {
                         for ( int i = 0; i < nBytes; i++ ) {
@@ -235,10 +267,12 @@ bool TAlpideDecoder::DecodeEvent( unsigned char* data,
                 byte += GetWordLength();
                 break;
             case TDataType::kUNKNOWN:
+                DECODER_TRACE( HotTrace::kDECODER_ERROR, HotTrace::kUNKNOWN_WORD, byte, data[byte], fChipId );
                 cerr << "TAlpideDecoder::DecodeEvent() - Error: data of unknown type 0x" << std::hex << data[byte] << std::dec << endl;
                 return false;
         }
     }
+    DECODER_TRACE( HotTrace::kDECODER_END, (started ? 1 : 0) | (finished ? 2 : 0) | (corrupt ? 4 : 0), fHits.size() );
     try {
         FillHistoWithEvent();
     } catch ( std::exception &err ) {
@@ -250,10 +284,12 @@ bool TAlpideDecoder::DecodeEvent( unsigned char* data,
         return (!corrupt);
     } else {
         if ( started && !finished ) {
+            DECODER_TRACE( HotTrace::kDECODER_ERROR, HotTrace::kEVENT_NOT_FINISHED, nBytes, last, fChipId );
             cout << "TAlpideDecoder::DecodeEvent() - Warning (chip "<< fChipId << "): event not finished at end of data, last byte was 0x" << std::hex << (int) last << std::dec << ", event length = " << nBytes << endl;
             return false;
         }
         if ( !started ) {
+            DECODER_TRACE( HotTrace::kDECODER_ERROR, HotTrace::kEVENT_NOT_STARTED, nBytes, last, fChipId );
             cout << "TAlpideDecoder::DecodeEvent() - Warning: event not started at end of data" << endl;
             return false;
         }
@@ -275,45 +311,6 @@ void TAlpideDecoder::FindDataType( unsigned char dataWord )
     else if ( (dataWord & 0xc0) == 0x40 ) fDataType = TDataType::kDATASHORT;
     else if ( (dataWord & 0xc0) == 0x0 )  fDataType = TDataType::kDATALONG;
     else fDataType = TDataType::kUNKNOWN;
-
-    if ( GetVerboseLevel() > kCHATTY ) {
-        
-        cout << "TAlpideDecoder::FindDataType() - dataWord = " << endl;
-        printf ("%02x ", (int)dataWord);
-        cout << endl << "TAlpideDecoder::FindDataType() - fDataType = " ;
-        switch ( (int)fDataType ) {
-            case (int)TDataType::kIDLE:
-                cout << "TDataType::kIDLE" << endl;
-                break;
-            case (int)TDataType::kCHIPHEADER:
-                cout << "TDataType::kCHIPHEADER" << endl;
-                break;
-            case (int)TDataType::kCHIPTRAILER:
-                cout << "TDataType::kCHIPTRAILER" << endl;
-                break;
-            case (int)TDataType::kEMPTYFRAME:
-                cout << "TDataType::kEMPTYFRAME" << endl;
-                break;
-            case (int)TDataType::kREGIONHEADER:
-                cout << "TDataType::kREGIONHEADER" << endl;
-                break;
-            case (int)TDataType::kDATASHORT:
-                cout << "TDataType::kDATASHORT" << endl;
-                break;
-            case (int)TDataType::kDATALONG:
-                cout << "TDataType::kDATALONG" << endl;
-                break;
-            case (int)TDataType::kBUSYON:
-                cout << "TDataType::kBUSYON" << endl;
-                break;
-            case (int)TDataType::kBUSYOFF:
-                cout << "TDataType::kBUSYOFF" << endl;
-                break;
-            default:
-                cout << "TDataType::kUNKNOWN" << endl;
-                break;
-        }
-    }
 }
 
 //___________________________________________________________________
@@ -382,10 +379,6 @@ bool TAlpideDecoder::DecodeDataWord( unsigned char* data,
     
     int16_t data_field = (((int16_t) data[0]) << 8) + data[1];
 
-    if ( GetVerboseLevel() > kCHATTY ) {
-        cout << "TAlpideDecoder::DecodeDataWord() - data word = 0x" << std::hex << (int) data_field << std::dec << endl;
-    }
-  
     bool corrupt = false;
 
     hit->SetBoardIndex( fCurrentChipIndex.boardIndex );
@@ -452,16 +445,12 @@ bool TAlpideDecoder::DecodeDataWord( unsigned char* data,
         if ( singleHit->GetPixFlag() == TPixFlag::kUNKNOWN ) { // nothing bad detected, it means that the flag still has its initialization value => the pixel hit is ok
             singleHit->SetPixFlag( TPixFlag::kOK );
         }
-        if ( GetVerboseLevel() > kCHATTY ) {
-            cout << "TAlpideDecoder::DecodeDataWord() - new hit found" << endl;
-            singleHit->DumpPixHit();
-        }
+        DECODER_TRACE( HotTrace::kDECODER_HIT, fChipId, fRegion,
+                       (singleHit->GetDoubleColumn() << 16) | singleHit->GetAddress(),
+                       (uint32_t)singleHit->GetPixFlag() );
         // data word is corrupted if there is any bad hit found
         corrupt = corrupt | singleHit->IsPixHitCorrupted();
         fHits.push_back( move(singleHit) ); // vector only owns hit with the address set
-        if ( GetVerboseLevel() > kCHATTY ) {
-            cout << "\t TAlpideDecoder::DecodeDataWord() - hit added in vector." << endl;
-        }
     }
     hit.reset();
     fNewEvent = false;
@@ -497,10 +486,10 @@ void TAlpideDecoder::FillHistoWithEvent()
             unsigned int dcol = (fHits.at(i))->GetDoubleColumn();
             unsigned int addr = (fHits.at(i))->GetAddress();
 
-            fScanHisto->Incr(idx, dcol, addr);
-            if ( GetVerboseLevel() > kULTRACHATTY ) {
-                cout << "TAlpideDecoder::FillHistoEvent() - add hit" << endl;
-                (fHits.at(i))->DumpPixHit();
+            if ( fSCurveHisto ) {
+                fSCurveHisto->Incr(idx, dcol, addr);
+            } else {
+                fScanHisto->Incr(idx, dcol, addr);
             }
             if ( fStorePixHit->IsInitOk() ) {
                 //shared_ptr<TPixHit> singleHit( new TPixHit( fHits.at(i) ) ); // deep copy
@@ -23,6 +23,7 @@ enum class TDataType {
 class TPixHit;
 class TDevice;
 class TScanHisto;
+class TSCurveHisto;
 class TErrorCounter;
 class TStorePixHit;
 
@@ -68,6 +69,9 @@ private:
 
     /// map to histograms (one per chip) of hit pixels, accumulating over events
     std::shared_ptr<TScanHisto> fScanHisto;
+
+    /// sparse S-curve storage, filled instead of fScanHisto if set (threshold scan)
+    std::shared_ptr<TSCurveHisto> fSCurveHisto;
     
     /// error counter, accumulating over events
     std::shared_ptr<TErrorCounter> fErrorCounter;
@@ -95,11 +99,17 @@ public:
     /// set the pointer to the map containing histograms of hit pixels vs chip index
     void SetScanHisto( std::shared_ptr<TScanHisto> aScanHisto );
 
+    /// set the pointer to the sparse S-curve storage, filled instead of the map of histograms
+    void SetSCurveHisto( std::shared_ptr<TSCurveHisto> aSCurveHisto );
+
     /// set the pointer to the error container
     void SetErrorCounter( std::shared_ptr<TErrorCounter> anErrorCounter );
     
     /// toggle on/off the possibility to rescue a bad chip id
     inline void SetRescueBadChipId( const bool permit ) { fRescueBadChipId = permit; }
+
+    /// true if a bad chip id can be rescued with the MOSAIC receiver id
+    inline bool GetRescueBadChipId() const { return fRescueBadChipId; }
     
     /// get the map of histograms (one per chip) of hit pixels
     inline std::shared_ptr<TScanHisto> GetScanHisto() { return fScanHisto; }
@@ -6,6 +6,7 @@
 #include <cstring>
 #include <stdexcept>
 
+#include "THisto.h"
 #include "THitMapDiscordant.h"
 
 using namespace std;
@@ -23,7 +24,7 @@ fNInefficientPixels( 0 ),
 fNHotPixels( 0 ),
 fN8b10b( 0 ),
 fFilledErrorCounters( false ),
-fHitMap( nullptr )
+fNInjections( 50 )
 {
     fIdx.boardIndex = 0;
     fIdx.dataReceiver = 0;
@@ -47,29 +48,28 @@ fNInefficientPixels( 0 ),
 fNHotPixels( 0 ),
 fN8b10b( 0 ),
 fFilledErrorCounters( false ),
-fHitMap( nullptr )
+fNInjections( nInjections )
 {
     fIdx.boardIndex = aChipIndex.boardIndex;
     fIdx.dataReceiver = aChipIndex.dataReceiver;
     fIdx.deviceType = dt;
     fIdx.deviceId = aChipIndex.deviceId;
     fIdx.chipId = aChipIndex.chipId;
-    fHitMap = make_shared<THitMapDiscordant>( dt, fIdx, nInjections );
-    fHitMap->BuildCanvas();
 }
 
 //___________________________________________________________________
 TChipErrorCounter::~TChipErrorCounter()
 {
     fCorruptedHits.clear();
+    fDeadPixelMap.clear();
+    fInefficientPixelMap.clear();
+    fHotPixelMap.clear();
+    fNTimesFired.clear();
 }
 
 //___________________________________________________________________
 void TChipErrorCounter::SetVerboseLevel( const int level )
 {
-    if ( fHitMap ) {
-        fHitMap->SetVerboseLevel( level );
-    }
     TVerbosity::SetVerboseLevel( level );
 }
 
@@ -86,9 +86,35 @@ void TChipErrorCounter::AddCorruptedHit( shared_ptr<TPixHit> badHit )
         cerr << "TChipErrorCounter::AddCorruptedHit() - counters filled, no more modification allowed !" << endl;
         return;
     }
-    if ( badHit ) {
-        fCorruptedHits.push_back( move(badHit) );
+    if ( !badHit ) {
+        return;
     }
+    switch ( (int)badHit->GetPixFlag() ) {
+        case (int)TPixFlag::kDEAD :
+            AddDeadPixel( badHit->GetDoubleColumn(), badHit->GetAddress() );
+            return;
+        case (int)TPixFlag::kINEFFICIENT :
+            AddInefficientPixel( badHit->GetDoubleColumn(), badHit->GetAddress(), 0 );
+            return;
+        case (int)TPixFlag::kHOT :
+            AddHotPixel( badHit->GetDoubleColumn(), badHit->GetAddress(), 0 );
+            return;
+        case (int)TPixFlag::kBAD_REGIONID :
+            fNBadRegionIdFlag++;
+            break;
+        case (int)TPixFlag::kBAD_DCOLID :
+            fNBadColIdFlag++;
+            break;
+        case (int)TPixFlag::kBAD_ADDRESS :
+            fNBadAddressIdFlag++;
+            break;
+        case (int)TPixFlag::kSTUCK :
+            fNStuckPixelFlag++;
+            break;
+        default:
+            break;
+    }
+    fCorruptedHits.push_back( move(badHit) );
 }
 
 //___________________________________________________________________
@@ -98,15 +124,10 @@ void TChipErrorCounter::AddDeadPixel( const unsigned int icol, const unsigned in
         cerr << "TChipErrorCounter::AddDeadPixel() - counters filled, no more modification allowed !" << endl;
         return;
     }
-    auto hit = make_shared<TPixHit>();
-    hit->SetPixChipIndex( fIdx );
-    hit->SetDoubleColumn( icol );
-    hit->SetAddress( iaddr );
-    float region = std::floor( ((float)icol)/((float)common::NDCOL_PER_REGION) );
-    hit->SetRegion( (unsigned int)region );
-    hit->SetPixFlag( TPixFlag::kDEAD );
-    fHitMap->AddDeadPixel( hit );
-    fCorruptedHits.push_back( move(hit) );
+    if ( !SetPixelBit( fDeadPixelMap, icol, iaddr ) ) {
+        return;
+    }
+    fNDeadPixels++;
 }
 
 //___________________________________________________________________
@@ -118,15 +139,11 @@ void TChipErrorCounter::AddInefficientPixel( const unsigned int icol,
         cerr << "TChipErrorCounter::AddInefficientPixel() - counters filled, no more modification allowed !" << endl;
         return;
     }
-    auto hit = make_shared<TPixHit>();
-    hit->SetPixChipIndex( fIdx );
-    hit->SetDoubleColumn( icol );
-    hit->SetAddress( iaddr );
-    float region = std::floor( ((float)icol)/((float)common::NDCOL_PER_REGION) );
-    hit->SetRegion( (unsigned int)region );
-    hit->SetPixFlag( TPixFlag::kINEFFICIENT );
-    fHitMap->AddInefficientPixel( hit, nhits );
-    fCorruptedHits.push_back( move(hit) );
+    if ( !SetPixelBit( fInefficientPixelMap, icol, iaddr ) ) {
+        return;
+    }
+    fNInefficientPixels++;
+    fNTimesFired[ icol * (common::MAX_ADDR+1) + iaddr ] = (unsigned int)nhits;
 }
 
 //___________________________________________________________________
@@ -137,15 +154,33 @@ void TChipErrorCounter::AddHotPixel( const unsigned int icol, const unsigned int
         cerr << "TChipErrorCounter::AddHotPixel() - counters filled, no more modification allowed !" << endl;
         return;
     }
-    auto hit = make_shared<TPixHit>();
-    hit->SetPixChipIndex( fIdx );
-    hit->SetDoubleColumn( icol );
-    hit->SetAddress( iaddr );
-    float region = std::floor( ((float)icol)/((float)common::NDCOL_PER_REGION) );
-    hit->SetRegion( (unsigned int)region );
-    hit->SetPixFlag( TPixFlag::kHOT );
-    fHitMap->AddHotPixel( hit, nhits );
-    fCorruptedHits.push_back( move(hit) );
+    if ( !SetPixelBit( fHotPixelMap, icol, iaddr ) ) {
+        return;
+    }
+    fNHotPixels++;
+    fNTimesFired[ icol * (common::MAX_ADDR+1) + iaddr ] = (unsigned int)nhits;
+}
+
+//___________________________________________________________________
+void TChipErrorCounter::AddDiscordantPixels( const TDiscordantBins& bins )
+{
+    if ( fFilledErrorCounters ) {
+        cerr << "TChipErrorCounter::AddDiscordantPixels() - counters filled, no more modification allowed !" << endl;
+        return;
+    }
+    // bin key = dcol * (common::MAX_ADDR+1) + address
+    for ( unsigned int i = 0; i < bins.emptyBins.size(); i++ ) {
+        const uint32_t key = bins.emptyBins[i];
+        AddDeadPixel( key / (common::MAX_ADDR+1), key % (common::MAX_ADDR+1) );
+    }
+    for ( unsigned int i = 0; i < bins.lowBins.size(); i++ ) {
+        const uint32_t key = bins.lowBins[i];
+        AddInefficientPixel( key / (common::MAX_ADDR+1), key % (common::MAX_ADDR+1), bins.lowContents[i] );
+    }
+    for ( unsigned int i = 0; i < bins.highBins.size(); i++ ) {
+        const uint32_t key = bins.highBins[i];
+        AddHotPixel( key / (common::MAX_ADDR+1), key % (common::MAX_ADDR+1), bins.highContents[i] );
+    }
 }
 
 //___________________________________________________________________
@@ -186,7 +221,7 @@ void TChipErrorCounter::Dump()
     cout << endl;
     cout << "Number of priority encoder errors: " << fNPrioEncoder << endl;
     cout << "Number of 8b10b encoder errors: " << fN8b10b << endl;
-    if ( fCorruptedHits.size()  && fFilledErrorCounters ) {
+    if ( GetNCorruptedHits() && fFilledErrorCounters ) {
         cout << "Number of hits with bad region id flag: " << fNBadRegionIdFlag << endl;
         cout << "Number of hits with bad col id flag: " << fNBadColIdFlag << endl;
         cout << "Number of hits with bad address flag: " << fNBadAddressIdFlag << endl;
@@ -217,7 +252,7 @@ void TChipErrorCounter::WriteCorruptedHitsToFile( const char *fName, bool Recrea
 //___________________________________________________________________
 void TChipErrorCounter::DrawAndSaveToFile( const char *fName )
 {
-    if ( !fCorruptedHits.size() ) {
+    if ( !GetNCorruptedHits() ) {
         cout << "TChipErrorCounter::DrawAndSaveToFile() - "; 
         common::DumpId( fIdx );
         cout << " , no bad hits => no file will be written !" << endl; 
@@ -238,98 +273,173 @@ void TChipErrorCounter::DrawAndSaveToFile( const char *fName )
         common::DumpId( fIdx );
         cout << " , to file " << fNameChip << endl;
     }
-    fHitMap->Draw();
-    fHitMap->SaveToFile( fNameChip );
+    // the hit map is only built now: no graphics object exists if nothing is drawn
+    THitMapDiscordant hitMap( fIdx.deviceType, fIdx, fNInjections );
+    hitMap.SetVerboseLevel( GetVerboseLevel() );
+    hitMap.BuildCanvas();
+    vector<shared_ptr<TPixHit>> hits;
+    GetCorruptedHits( TPixFlag::kDEAD, hits );
+    for ( unsigned int i = 0; i < hits.size(); i++ ) {
+        hitMap.AddDeadPixel( (hits.at(i))->GetColumn(), (hits.at(i))->GetRow() );
+    }
+    GetCorruptedHits( TPixFlag::kINEFFICIENT, hits );
+    for ( unsigned int i = 0; i < hits.size(); i++ ) {
+        hitMap.AddInefficientPixel( (hits.at(i))->GetColumn(), (hits.at(i))->GetRow(),
+                                    GetNTimesFired( hits.at(i) ) );
+    }
+    GetCorruptedHits( TPixFlag::kHOT, hits );
+    for ( unsigned int i = 0; i < hits.size(); i++ ) {
+        hitMap.AddHotPixel( (hits.at(i))->GetColumn(), (hits.at(i))->GetRow(),
+                            GetNTimesFired( hits.at(i) ) );
+    }
+    hitMap.Draw();
+    hitMap.SaveToFile( fNameChip );
 }
 
 
 //___________________________________________________________________
-void TChipErrorCounter::FindCorruptedHits( const TPixFlag flag )
+unsigned int TChipErrorCounter::GetNCorruptedHits( const TPixFlag flag ) const
 {
-    if( fCorruptedHits.size() ) {
- 
-        if ( GetVerboseLevel() > kCHATTY ) {
-            cout << endl;
-            cout << "------------------------------- TChipErrorCounter::ClassifyCorruptedHits() "
-            << endl;
+    switch ( (int)flag ) {
+        case (int)TPixFlag::kBAD_REGIONID : return fNBadRegionIdFlag;
+        case (int)TPixFlag::kBAD_DCOLID :   return fNBadColIdFlag;
+        case (int)TPixFlag::kBAD_ADDRESS :  return fNBadAddressIdFlag;
+        case (int)TPixFlag::kSTUCK :        return fNStuckPixelFlag;
+        case (int)TPixFlag::kDEAD :         return fNDeadPixels;
+        case (int)TPixFlag::kINEFFICIENT :  return fNInefficientPixels;
+        case (int)TPixFlag::kHOT :          return fNHotPixels;
+        default: return 0;
+    }
+}
+
+//___________________________________________________________________
+unsigned int TChipErrorCounter::GetNCorruptedHits() const
+{
+    return fCorruptedHits.size() + fNDeadPixels + fNInefficientPixels + fNHotPixels;
+}
+
+//___________________________________________________________________
+void TChipErrorCounter::GetCorruptedHits( const TPixFlag flag,
+                                          vector<shared_ptr<TPixHit>>& hits ) const
+{
+    hits.clear();
+    const vector<uint64_t>* pixelMap = GetPixelMap( flag );
+    if ( !pixelMap ) {
+        for ( unsigned int i = 0; i < fCorruptedHits.size(); i++ ) {
+            if ( (fCorruptedHits.at(i))->GetPixFlag() == flag ) {
+                hits.push_back( fCorruptedHits.at(i) );
+            }
         }
-        bool first = true;
-        switch ( (int)flag ) {
-            case (int)TPixFlag::kUNKNOWN : // dump all hits, no matter what their flag is
-                first = true;
-                if ( GetVerboseLevel() > kCHATTY ) {
-                    for ( unsigned int i = 0; i < fCorruptedHits.size(); i++ ) {
-                        (fCorruptedHits.at(i))->DumpPixHit(first);
-                        first = false;
-                    }
-                }
-                break;
-            case (int)TPixFlag::kOK : // nothing to do, since all hits in the deque are bad
-                break;
-            case (int)TPixFlag::kBAD_CHIPID : // nothing to do, since a bad chip id can not be attached (and hence found) to (in) a given TChipErrorCounter
-                break;
-            default: // select bad hits with the requested flag
-                first = true;
-                unsigned int counter = 0;
-                for ( unsigned int i = 0; i < fCorruptedHits.size(); i++ ) {
-                    if ( (fCorruptedHits.at(i))->GetPixFlag() == flag ) {
-                        if ( GetVerboseLevel() > kCHATTY ) {
-                            (fCorruptedHits.at(i))->DumpPixHit(first);
-                            first = false;
-                        }
-                        counter++;
-                    }
-                }
-                if ( GetVerboseLevel() > kCHATTY ) {
-                    cout << "\t Total: " << std::dec << counter << " hits with flag ";
-                }
-                if ( flag == TPixFlag::kBAD_ADDRESS ) {
-                    if ( GetVerboseLevel() > kCHATTY ) {
-                        cout << "TPixFlag::kBAD_ADDRESS" << endl;
-                    }
-                    fNBadAddressIdFlag = counter;
-                }
-                if ( flag == TPixFlag::kBAD_DCOLID ) {
-                    if ( GetVerboseLevel() > kCHATTY ) {
-                        cout << "TPixFlag::kBAD_DCOLID" << endl;
-                    }
-                    fNBadColIdFlag = counter;
-                }
-                if ( flag == TPixFlag::kBAD_REGIONID ) {
-                    if ( GetVerboseLevel() > kCHATTY ) {
-                        cout << "TPixFlag::kBAD_REGIONID" << endl;
-                    }
-                    fNBadRegionIdFlag = counter;
-                }
-                if ( flag == TPixFlag::kSTUCK ) {
-                    if ( GetVerboseLevel() > kCHATTY ) {
-                        cout << "TPixFlag::kSTUCK" << endl;
-                    }
-                    fNStuckPixelFlag = counter;
-                }
-                if ( flag == TPixFlag::kDEAD ) {
-                    if ( GetVerboseLevel() > kCHATTY ) {
-                        cout << "TPixFlag::kDEAD" << endl;
-                    }
-                    fNDeadPixels = counter;
-                }
-                if ( flag == TPixFlag::kINEFFICIENT ) {
-                    if ( GetVerboseLevel() > kCHATTY ) {
-                        cout << "TPixFlag::kINEFFICIENT" << endl;
-                    }
-                    fNInefficientPixels = counter;
-                }
-                if ( flag == TPixFlag::kHOT ) {
-                    if ( GetVerboseLevel() > kCHATTY ) {
-                        cout << "TPixFlag::kHOT" << endl;
-                    }
-                    fNHotPixels = counter;
-                }
-                break;
+        return;
+    }
+    hits.reserve( GetNCorruptedHits( flag ) );
+    for ( unsigned int iword = 0; iword < pixelMap->size(); iword++ ) {
+        uint64_t word = pixelMap->at(iword);
+        while ( word ) {
+            const unsigned int key = iword * 64 + __builtin_ctzll( word );
+            hits.push_back( NewPixel( key / (common::MAX_ADDR+1), key % (common::MAX_ADDR+1), flag ) );
+            word &= word - 1; // clear the lowest set bit
         }
     }
 }
 
+//___________________________________________________________________
+shared_ptr<TPixHit> TChipErrorCounter::NewPixel( const unsigned int icol,
+                                                 const unsigned int iaddr,
+                                                 const TPixFlag flag ) const
+{
+    auto hit = make_shared<TPixHit>();
+    hit->SetPixChipIndex( fIdx );
+    hit->SetDoubleColumn( icol );
+    hit->SetAddress( iaddr );
+    float region = std::floor( ((float)icol)/((float)common::NDCOL_PER_REGION) );
+    hit->SetRegion( (unsigned int)region );
+    hit->SetPixFlag( flag );
+    return hit;
+}
+
+//___________________________________________________________________
+unsigned int TChipErrorCounter::GetNTimesFired( const shared_ptr<TPixHit> hit ) const
+{
+    const uint32_t key = hit->GetDoubleColumn() * (common::MAX_ADDR+1) + hit->GetAddress();
+    unordered_map<uint32_t, unsigned int>::const_iterator it = fNTimesFired.find( key );
+    if ( it == fNTimesFired.end() ) {
+        return 0;
+    }
+    return it->second;
+}
+
+//___________________________________________________________________
+bool TChipErrorCounter::SetPixelBit( vector<uint64_t>& pixelMap,
+                                     const unsigned int icol, const unsigned int iaddr )
+{
+    if ( (icol > common::MAX_DCOL) || (iaddr > common::MAX_ADDR) ) {
+        cerr << "TChipErrorCounter::SetPixelBit() - bad pixel coordinates !" << endl;
+        return false;
+    }
+    if ( pixelMap.empty() ) {
+        pixelMap.assign( NPIXELS / 64, 0 );
+    }
+    const unsigned int key = icol * (common::MAX_ADDR+1) + iaddr;
+    const uint64_t mask = ((uint64_t)1) << (key % 64);
+    if ( pixelMap[key / 64] & mask ) {
+        return false;
+    }
+    pixelMap[key / 64] |= mask;
+    return true;
+}
+
+//___________________________________________________________________
+const vector<uint64_t>* TChipErrorCounter::GetPixelMap( const TPixFlag flag ) const
+{
+    switch ( (int)flag ) {
+        case (int)TPixFlag::kDEAD :        return &fDeadPixelMap;
+        case (int)TPixFlag::kINEFFICIENT : return &fInefficientPixelMap;
+        case (int)TPixFlag::kHOT :         return &fHotPixelMap;
+        default: return nullptr;
+    }
+}
+
+//___________________________________________________________________
+void TChipErrorCounter::FindCorruptedHits( const TPixFlag flag )
+{
+    // the number of bad hits for each flag is already up to date, only dump them
+    if ( !GetNCorruptedHits() || (GetVerboseLevel() <= kCHATTY) ) {
+        return;
+    }
+    cout << endl;
+    cout << "------------------------------- TChipErrorCounter::ClassifyCorruptedHits() "
+    << endl;
+    switch ( (int)flag ) {
+        case (int)TPixFlag::kOK : // nothing to do, since all hits in the lists are bad
+            return;
+        case (int)TPixFlag::kBAD_CHIPID : // nothing to do, since a bad chip id can not be attached (and hence found) to (in) a given TChipErrorCounter
+            return;
+        case (int)TPixFlag::kUNKNOWN : // nothing to do, all flags are dumped one by one
+            return;
+        default:
+            break;
+    }
+    vector<shared_ptr<TPixHit>> hits;
+    GetCorruptedHits( flag, hits );
+    bool first = true;
+    for ( unsigned int i = 0; i < hits.size(); i++ ) {
+        (hits.at(i))->DumpPixHit( first );
+        first = false;
+    }
+    cout << "\t Total: " << std::dec << GetNCorruptedHits( flag ) << " hits with flag ";
+    switch ( (int)flag ) {
+        case (int)TPixFlag::kBAD_ADDRESS :  cout << "TPixFlag::kBAD_ADDRESS" << endl; break;
+        case (int)TPixFlag::kBAD_DCOLID :   cout << "TPixFlag::kBAD_DCOLID" << endl; break;
+        case (int)TPixFlag::kBAD_REGIONID : cout << "TPixFlag::kBAD_REGIONID" << endl; break;
+        case (int)TPixFlag::kSTUCK :        cout << "TPixFlag::kSTUCK" << endl; break;
+        case (int)TPixFlag::kDEAD :         cout << "TPixFlag::kDEAD" << endl; break;
+        case (int)TPixFlag::kINEFFICIENT :  cout << "TPixFlag::kINEFFICIENT" << endl; break;
+        case (int)TPixFlag::kHOT :          cout << "TPixFlag::kHOT" << endl; break;
+        default: cout << endl; break;
+    }
+}
+
 //___________________________________________________________________
 void TChipErrorCounter::WriteCorruptedHitsToFile( const TPixFlag flag,
                                                   const char *fName,
@@ -346,7 +456,7 @@ void TChipErrorCounter::WriteCorruptedHitsToFile( const TPixFlag flag,
     
     // file will only be written if there is any bad hit corresponding to the flag
     
-    if ( !fCorruptedHits.size() ) {
+    if ( !GetNCorruptedHits() ) {
         if ( GetVerboseLevel() > kVERBOSE ) {
             cout << "TChipErrorCounter::WriteCorruptedHitsToFile() - "; 
             common::DumpId( fIdx );
@@ -447,12 +557,12 @@ void TChipErrorCounter::WriteCorruptedHitsToFile( const TPixFlag flag,
         throw runtime_error( "TChipErrorCounter::WriteCorruptedHitsToFile() - output file not found." );
     }
     const int nhit = 1;
-    for ( unsigned int i = 0; i < fCorruptedHits.size(); i++ ) {
-        if ( (fCorruptedHits.at(i))->GetPixFlag() == flag ) {
-            fprintf(fp, "%d %d %d\n",
-                    (fCorruptedHits.at(i))->GetRow(),
-                    (fCorruptedHits.at(i))->GetColumn(), nhit);
-        }
+    vector<shared_ptr<TPixHit>> hits;
+    GetCorruptedHits( flag, hits );
+    for ( unsigned int i = 0; i < hits.size(); i++ ) {
+        fprintf(fp, "%d %d %d\n",
+                (hits.at(i))->GetRow(),
+                (hits.at(i))->GetColumn(), nhit);
     }
     if (fp) fclose (fp);
 }
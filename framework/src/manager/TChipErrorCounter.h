@@ -24,18 +24,27 @@
  * - number of inefficient pixels 
  * - number of hot pixels
  * This class can also print the bad pixel hits to screen or to output files, 
- * with a possible selection on the type of flaw. Thanks to its data member of
- * type THitMapDiscordant, this class also plot a hit map of the corrupted pixels
+ * with a possible selection on the type of flaw. Thanks to the class
+ * THitMapDiscordant, this class also plot a hit map of the corrupted pixels
  * and their firing frequency given the number of injected triggers per pixel.
+ * The hit map is only created when drawing, see DrawAndSaveToFile().
+ *
+ * The dead, inefficient and hot pixels are stored as one bit per pixel of the
+ * matrix (one bit map per type), and the number of bad hits of each type is
+ * updated as soon as a bad hit is added. TPixHit objects for these pixels are
+ * only created on demand, see GetCorruptedHits().
  */
 
 
 #include "Common.h"
 #include "TPixHit.h"
+#include <cstdint>
 #include <memory>
 #include <deque>
+#include <unordered_map>
+#include <vector>
 
-class THitMapDiscordant;
+struct TDiscordantBins;
 
 class TChipErrorCounter : public TVerbosity {
     
@@ -72,11 +81,26 @@ class TChipErrorCounter : public TVerbosity {
     /// index of the chip for which we collect errors
     common::TChipIndex fIdx;
 
-    /// list of corrupted pixel hits
+    /// list of corrupted pixel hits from the decoder (bad region, dcol, address or stuck pixel)
     std::deque<std::shared_ptr<TPixHit>> fCorruptedHits;
+
+    /// number of pixels in the matrix, i.e. number of bits in a bit map
+    static const unsigned int NPIXELS = (common::MAX_DCOL+1)*(common::MAX_ADDR+1);
+
+    /// bit map of the dead pixels (bit = dcol * (common::MAX_ADDR+1) + address), allocated at first use
+    std::vector<std::uint64_t> fDeadPixelMap;
+
+    /// bit map of the inefficient pixels, allocated at first use
+    std::vector<std::uint64_t> fInefficientPixelMap;
+
+    /// bit map of the hot pixels, allocated at first use
+    std::vector<std::uint64_t> fHotPixelMap;
+    
+    /// number of times an inefficient or hot pixel fired (key = dcol * (common::MAX_ADDR+1) + address)
+    std::unordered_map<std::uint32_t, unsigned int> fNTimesFired;
     
-    /// class used to locate bad pixel on a hit map
-    std::shared_ptr<THitMapDiscordant> fHitMap;
+    /// number of injections per pixel, used to draw the firing frequency of bad pixels
+    unsigned int fNInjections;
 
 public:
     
@@ -111,6 +135,9 @@ public:
     void AddHotPixel( const unsigned int icol, const unsigned int iaddr,
                       const double nhits );
 
+    /// add all dead, inefficient and hot pixels found in the hit map of the chip
+    void AddDiscordantPixels( const TDiscordantBins& bins );
+
     /// count bad hits for each type of flag
     void ClassifyCorruptedHits();
     
@@ -127,6 +154,19 @@ public:
 
     /// return the number of 8b10b encoder errors
     inline unsigned int GetN8b10b() const { return fN8b10b; }
+
+    /// return the number of priority encoder errors
+    inline unsigned int GetNPrioEncoder() const { return fNPrioEncoder; }
+
+    /// return the number of bad hits with a given flag
+    unsigned int GetNCorruptedHits( const TPixFlag flag ) const;
+
+    /// return the total number of bad hits
+    unsigned int GetNCorruptedHits() const;
+
+    /// create the list of bad hits with a given flag
+    void GetCorruptedHits( const TPixFlag flag,
+                           std::vector<std::shared_ptr<TPixHit>>& hits ) const;
     
 #pragma mark - increment
     
@@ -140,7 +180,21 @@ public:
     
 private:
     
-    /// find the bad hits based on a given flag
+    /// create a pixel of this chip with a given flag
+    std::shared_ptr<TPixHit> NewPixel( const unsigned int icol, const unsigned int iaddr,
+                                       const TPixFlag flag ) const;
+
+    /// number of times a bad pixel fired (0 for a dead pixel)
+    unsigned int GetNTimesFired( const std::shared_ptr<TPixHit> hit ) const;
+
+    /// set the bit of a pixel in a bit map, return false if it was already set
+    bool SetPixelBit( std::vector<std::uint64_t>& pixelMap,
+                      const unsigned int icol, const unsigned int iaddr );
+
+    /// bit map for a given flag (nullptr if the flag is not stored in a bit map)
+    const std::vector<std::uint64_t>* GetPixelMap( const TPixFlag flag ) const;
+
+    /// dump the bad hits with a given flag and their number
     void FindCorruptedHits( const TPixFlag flag );
     
     /// write list of corrupted hits in an output file for a given flag
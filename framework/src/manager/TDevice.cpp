@@ -149,6 +149,10 @@ void TDevice::SendBroadcastReset()
     for ( int i = 0; i < (int)fBoards.size(); i++ ) {
         GetBoard(i)->SendBroadcastReset();
     }
+    // registers are back to their reset values -> shadow copies are stale
+    for ( int i = 0; i < (int)fChips.size(); i++ ) {
+        if ( fChips.at(i) ) fChips.at(i)->InvalidateRegisterCache();
+    }
 }
 
 #pragma mark - add an item to one of the vectors
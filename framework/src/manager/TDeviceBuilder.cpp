@@ -10,6 +10,9 @@
 #include "TBoardConfigMOSAIC.h"
 #include "TAlpide.h"
 #include "TReadoutBoard.h"
+#include "TReadoutBoardMOSAIC.h"
+#include "TReadoutBoardReplay.h"
+#include "TRawEventReader.h"
 
 using namespace std;
 
@@ -17,7 +20,9 @@ using namespace std;
 
 //___________________________________________________________________
 TDeviceBuilder::TDeviceBuilder() : TVerbosity(),
-    fCurrentDevice( nullptr )
+    fCurrentDevice( nullptr ),
+    fReplayReader( nullptr ),
+    fReplaySpeed( TReplaySpeed::kMAXIMUM )
 {
 }
 
@@ -118,8 +123,33 @@ void TDeviceBuilder::SetDeviceNickName( const string name )
         fCurrentDevice->SetNickName( name );
 }
 
+//___________________________________________________________________
+void TDeviceBuilder::SetReplayFile( const string fileName, const TReplaySpeed speed )
+{
+    if ( GetVerboseLevel() > kSILENT ) {
+        cout << "TDeviceBuilder::SetReplayFile() - the MOSAIC boards are replaced by the replay of "
+             << fileName << endl;
+    }
+    fReplayReader = make_shared<TRawEventReader>();
+    fReplayReader->SetVerboseLevel( GetVerboseLevel() );
+    fReplayReader->Open( fileName );
+    fReplaySpeed = speed;
+}
+
 #pragma mark - protected methods
 
+//___________________________________________________________________
+shared_ptr<TReadoutBoard> TDeviceBuilder::NewMosaicBoard( shared_ptr<TBoardConfigMOSAIC> boardConfig )
+{
+    if ( !fReplayReader ) {
+        return make_shared<TReadoutBoardMOSAIC>( boardConfig );
+    }
+    auto newBoard = make_shared<TReadoutBoardReplay>( boardConfig, fReplayReader,
+                                                      fCurrentDevice->GetNBoards(false) );
+    newBoard->SetSpeed( fReplaySpeed );
+    return newBoard;
+}
+
 //___________________________________________________________________
 void TDeviceBuilder::CountEnabledChipsPerBoard()
 {
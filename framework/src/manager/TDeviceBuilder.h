@@ -23,14 +23,25 @@
 #include "TVerbosity.h"
 
 enum class TDeviceType;
+enum class TReplaySpeed;
 class TDevice;
+class TBoardConfigMOSAIC;
+class TRawEventReader;
+class TReadoutBoard;
 
 class TDeviceBuilder : public TVerbosity {
 
 protected:
     std::shared_ptr<TDevice> fCurrentDevice;
+
+    /// raw event file replayed instead of reading the MOSAIC boards (see TReadoutBoardReplay)
+    std::shared_ptr<TRawEventReader> fReplayReader;
+
+    /// speed of the replay of the raw event file
+    TReplaySpeed fReplaySpeed;
     
 protected:
+    std::shared_ptr<TReadoutBoard> NewMosaicBoard( std::shared_ptr<TBoardConfigMOSAIC> boardConfig );
     void CheckControlInterface();
     void CountEnabledChipsPerBoard();
     void FillWorkingChipIndexList();
@@ -49,6 +60,7 @@ public:
     void SetDeviceParamValue( const char *Name, const char *Value, int Chip );
     virtual void SetVerboseLevel( const int level );
     void SetDeviceNickName( const std::string name );
+    void SetReplayFile( const std::string fileName, const TReplaySpeed speed );
     virtual void InitSetup() = 0;
     
     #pragma mark - Getters
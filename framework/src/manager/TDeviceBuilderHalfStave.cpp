@@ -107,7 +107,7 @@ void TDeviceBuilderHalfStave::InitSetup()
         shared_ptr<TBoardConfigMOSAIC> boardConfig = ((dynamic_pointer_cast<TBoardConfigMOSAIC>)(fCurrentDevice->GetBoardConfig(i)));
         boardConfig->SetInvertedData(false);  //already inverted in the adapter plug ?
         boardConfig->SetSpeedMode(MosaicReceiverSpeed::RCV_RATE_400);
-        auto newBoard = make_shared<TReadoutBoardMOSAIC>( boardConfig );
+        auto newBoard = NewMosaicBoard( boardConfig );
         fCurrentDevice->AddBoard( newBoard );
     }
     
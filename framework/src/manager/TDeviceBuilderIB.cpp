@@ -122,7 +122,7 @@ void TDeviceBuilderIB::InitSetup()
     cout << "TDeviceBuilderIB::InitSetup() - Speed mode = " << (int)speed << endl;
     boardConfig->SetSpeedMode( speed );
     
-    auto newBoard = make_shared<TReadoutBoardMOSAIC>( boardConfig );
+    auto newBoard = NewMosaicBoard( boardConfig );
     fCurrentDevice->AddBoard( newBoard );
     
     for (unsigned int i = 0; i < fCurrentDevice->GetNChips(); i++) {
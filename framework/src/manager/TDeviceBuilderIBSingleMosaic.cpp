@@ -135,7 +135,7 @@ void TDeviceBuilderIBSingleMosaic::InitSetup()
     }
     boardConfig->SetSpeedMode( speed );
     
-    auto myBoard = make_shared<TReadoutBoardMOSAIC>( boardConfig );
+    auto myBoard = NewMosaicBoard( boardConfig );
     fCurrentDevice->AddBoard( myBoard );
     
     auto alpide = make_shared<TAlpide>( chipConfig );
@@ -146,7 +146,7 @@ void TDeviceBuilderMFTLadder::InitSetup()
     }
     boardConfig->SetSpeedMode( speed );
     
-    auto newBoard = make_shared<TReadoutBoardMOSAIC>( boardConfig );
+    auto newBoard = NewMosaicBoard( boardConfig );
     fCurrentDevice->AddBoard( newBoard );
     
     for (unsigned int i = 0; i < fCurrentDevice->GetNChips(); i++) {
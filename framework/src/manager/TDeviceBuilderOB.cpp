@@ -107,7 +107,7 @@ void TDeviceBuilderOB::InitSetup()
     shared_ptr<TBoardConfigMOSAIC> boardConfig = ((dynamic_pointer_cast<TBoardConfigMOSAIC>)(fCurrentDevice->GetBoardConfig(0)));
     boardConfig->SetInvertedData(boardConfig->IsInverted()); // ???: circular definition? (AR)
     boardConfig->SetSpeedMode( MosaicReceiverSpeed::RCV_RATE_400 );
-    auto newBoard = make_shared<TReadoutBoardMOSAIC>( boardConfig );
+    auto newBoard = NewMosaicBoard( boardConfig );
     fCurrentDevice->AddBoard( newBoard );
     
     for (unsigned int i = 0; i < fCurrentDevice->GetNChips(); i++) {
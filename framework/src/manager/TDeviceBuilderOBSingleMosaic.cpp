@@ -103,7 +103,7 @@ void TDeviceBuilderOBSingleMosaic::InitSetup()
     boardConfig->SetInvertedData( false );
     boardConfig->SetSpeedMode( MosaicReceiverSpeed::RCV_RATE_400 );
     
-    auto myBoard = make_shared<TReadoutBoardMOSAIC>( boardConfig );
+    auto myBoard = NewMosaicBoard( boardConfig );
     fCurrentDevice->AddBoard( myBoard );
     
     auto alpide = make_shared<TAlpide>( chipConfig );
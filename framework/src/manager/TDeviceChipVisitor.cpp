@@ -264,6 +264,29 @@ void TDeviceChipVisitor::DoConfigureVPulseLow( const unsigned int deltaV )
 
 #pragma mark - readout board and chip configuration
 
+//___________________________________________________________________
+void TDeviceChipVisitor::DoReadTemperature( std::vector<float>& temperatures )
+{
+    if ( !fIsInitDone ) {
+        throw runtime_error( "TDeviceChipVisitor::DoReadTemperature() - not initialized ! Please use Init() first." );
+    }
+    // each step is done for all chips before the next one, so that the chips
+    // settle and convert at the same time instead of one after the other
+    temperatures.assign( fDevice->GetNChips(), 0. );
+    for (unsigned int i = 0; i < fDevice->GetNChips(); i ++) {
+        if ( !(fDevice->GetChipConfig(i)->IsEnabled()) ) continue;
+        fDevice->GetChip(i)->SelectADCInput( AlpideADCInput::Temperature, AlpideRegister::ANALOGMON );
+    }
+    for (unsigned int i = 0; i < fDevice->GetNChips(); i ++) {
+        if ( !(fDevice->GetChipConfig(i)->IsEnabled()) ) continue;
+        fDevice->GetChip(i)->StartADCConversion();
+    }
+    for (unsigned int i = 0; i < fDevice->GetNChips(); i ++) {
+        if ( !(fDevice->GetChipConfig(i)->IsEnabled()) ) continue;
+        temperatures.at(i) = fDevice->GetChip(i)->ReadADCConversion();
+    }
+}
+
 //___________________________________________________________________
 void TDeviceChipVisitor::DoBroadcastReset()
 {
@@ -297,4 +320,8 @@ void TDeviceChipVisitor::DoBroadcastReset()
         
         myBoard->SendOpCode( (uint16_t)AlpideOpCode::PRST );
     }
+    // registers are back to their reset values -> shadow copies are stale
+    for ( unsigned int i = 0; i < fDevice->GetNChips(); i++ ) {
+        fDevice->GetChip( i )->InvalidateRegisterCache();
+    }
 }
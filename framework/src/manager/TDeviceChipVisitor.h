@@ -15,6 +15,7 @@
  */
 
 #include <memory>
+#include <vector>
 #include "TVerbosity.h"
 
 class TDevice;
@@ -63,6 +64,8 @@ public:
     void DoDumpConfig();
     void DoActivateReadoutMode();
     void DoConfigureVPulseLow( const unsigned int deltaV );
+    /// Read the temperature of all enabled chips, with ADC conversions done in parallel
+    void DoReadTemperature( std::vector<float>& temperatures );
     
 protected:
     
@@ -0,0 +1,267 @@
+#include "AlpideDictionary.h"
+#include "TAlpide.h"
+#include "TChipConfig.h"
+#include "TDevice.h"
+#include "TDeviceDacScan.h"
+#include "TReadoutBoard.h"
+#include "TReadoutBoardDAQ.h"
+#include "Common.h"
+#include <stdexcept>
+#include <iostream>
+#include <string>
+#include <cstdio>
+#include <cstring>
+
+using namespace std;
+
+//___________________________________________________________________
+TDeviceDacScan::TDeviceDacScan() : TDeviceChipVisitor(),
+fSampleDist( 1 ),
+fNPoints( NDACVALUES )
+{
+    SetDacList( vector<AlpideRegister>() );
+}
+
+//___________________________________________________________________
+TDeviceDacScan::TDeviceDacScan( shared_ptr<TDevice> aDevice ) :
+TDeviceChipVisitor( aDevice ),
+fSampleDist( 1 ),
+fNPoints( NDACVALUES )
+{
+    SetDacList( vector<AlpideRegister>() );
+}
+
+//___________________________________________________________________
+TDeviceDacScan::~TDeviceDacScan()
+{ }
+
+//___________________________________________________________________
+void TDeviceDacScan::SetDacList( const vector<AlpideRegister>& dacList )
+{
+    fDacList.clear();
+    if ( dacList.empty() ) {
+        // all voltage and current DACs
+        for ( int dac = (int)AlpideRegister::VRESETP; dac <= (int)AlpideRegister::ITHR; dac++ ) {
+            fDacList.push_back( (AlpideRegister)dac );
+        }
+        return;
+    }
+    for ( unsigned int i = 0; i < dacList.size(); i++ ) {
+        if ( TAlpide::GetDACName( dacList.at(i) ).empty() ) {
+            throw domain_error( "TDeviceDacScan::SetDacList() - not a DAC register !" );
+        }
+        fDacList.push_back( dacList.at(i) );
+    }
+}
+
+//___________________________________________________________________
+void TDeviceDacScan::SetSampleDistance( const unsigned int sampleDist )
+{
+    if ( (sampleDist == 0) || (sampleDist >= NDACVALUES) ) {
+        throw domain_error( "TDeviceDacScan::SetSampleDistance() - sample distance out of range !" );
+    }
+    fSampleDist = sampleDist;
+    fNPoints = (NDACVALUES - 1)/fSampleDist + 1;
+}
+
+//___________________________________________________________________
+void TDeviceDacScan::Go()
+{
+    if ( !fIsInitDone ) {
+        throw runtime_error( "TDeviceDacScan::Go() - not initialized ! Please use Init() first." );
+    }
+
+    fScannedChips.clear();
+    for ( unsigned int iChip = 0; iChip < fDevice->GetNChips(); iChip++ ) {
+        if ( !((fDevice->GetChipConfig(iChip))->IsEnabled()) ) {
+            if ( GetVerboseLevel() > kTERSE ) {
+                cout << "TDeviceDacScan::Go() - chip id = " << fDevice->GetChipId( iChip )
+                     << " : disabled chip, skipped." <<  endl;
+            }
+            continue;
+        }
+        fScannedChips.push_back( iChip );
+    }
+    if ( fScannedChips.empty() ) {
+        throw runtime_error( "TDeviceDacScan::Go() - no enabled chip found !" );
+    }
+    fResults.assign( fDacList.size() * fDevice->GetNChips() * fNPoints, 0. );
+    fRawValues.assign( fScannedChips.size(), 0 );
+    fOldValues.assign( fScannedChips.size(), 0 );
+
+    for ( unsigned int idac = 0; idac < fDacList.size(); idac++ ) {
+        if ( GetVerboseLevel() > kSILENT ) {
+            cout << "TDeviceDacScan::Go() - scanning DAC " << TAlpide::GetDACName( fDacList.at(idac) )
+                 << " on " << fScannedChips.size() << " chip(s)" << endl;
+        }
+        ScanDac( idac );
+    }
+}
+
+//___________________________________________________________________
+void TDeviceDacScan::ScanDac( const unsigned int idac )
+{
+    const AlpideRegister dac = fDacList.at(idac);
+
+    try {
+        // save the DAC values before the scan
+        for ( unsigned int i = 0; i < fScannedChips.size(); i++ ) {
+            fDevice->GetChip( fScannedChips.at(i) )->ReadRegister( dac, fOldValues.at(i), false );
+        }
+        ExecuteTransactions();
+
+        // the three phases (set DAC + select ADC input, start conversions, read ADCs)
+        // are each executed at once for all chips; the reads of one point and the
+        // set-up of the next point share the same transaction
+        QueueSetPoint( dac, 0 );
+        ExecuteTransactions();
+        for ( unsigned int ipoint = 0; ipoint < fNPoints; ipoint++ ) {
+            for ( unsigned int i = 0; i < fScannedChips.size(); i++ ) {
+                fDevice->GetChip( fScannedChips.at(i) )->StartADCConversion( false );
+            }
+            ExecuteTransactions();
+            for ( unsigned int i = 0; i < fScannedChips.size(); i++ ) {
+                fDevice->GetChip( fScannedChips.at(i) )->ReadADCConversion( fRawValues.at(i), false );
+            }
+            if ( ipoint + 1 < fNPoints ) {
+                QueueSetPoint( dac, ipoint + 1 );
+            }
+            ExecuteTransactions();
+            for ( unsigned int i = 0; i < fScannedChips.size(); i++ ) {
+                const unsigned int ichip = fScannedChips.at(i);
+                fResults.at( GetResultIndex( idac, ichip, ipoint ) )
+                    = fDevice->GetChip( ichip )->ConvertADCValue( fRawValues.at(i) );
+            }
+        }
+
+        // restore the DAC values
+        for ( unsigned int i = 0; i < fScannedChips.size(); i++ ) {
+            fDevice->GetChip( fScannedChips.at(i) )->WriteRegister( dac, fOldValues.at(i), false );
+        }
+        ExecuteTransactions();
+    } catch ( exception& err ) {
+        cerr << err.what() << endl;
+        throw runtime_error( "TDeviceDacScan::ScanDac() - failed for DAC " + TAlpide::GetDACName( dac ) );
+    }
+}
+
+//___________________________________________________________________
+void TDeviceDacScan::QueueSetPoint( const AlpideRegister dac, const unsigned int ipoint )
+{
+    const AlpideADCInput input = TAlpide::IsVoltageDAC( dac ) ? AlpideADCInput::DACMONV : AlpideADCInput::DACMONI;
+    for ( unsigned int i = 0; i < fScannedChips.size(); i++ ) {
+        shared_ptr<TAlpide> chip = fDevice->GetChip( fScannedChips.at(i) );
+        chip->WriteRegister( dac, GetDacValue( ipoint ), false );
+        // only the first point really writes the monitor and ADC control registers,
+        // the next ones are skipped by the shadow register cache of the chip
+        chip->SelectADCInput( input, dac, false );
+    }
+}
+
+//___________________________________________________________________
+void TDeviceDacScan::ExecuteTransactions()
+{
+    // all control interfaces of a MOSAIC board share the same IPbus: the first
+    // execution sends everything, the next ones only check their read results
+    for ( unsigned int i = 0; i < fScannedChips.size(); i++ ) {
+        const unsigned int ichip = fScannedChips.at(i);
+        fDevice->GetBoardByChip( ichip )->ExecuteChipTransactions( (uint8_t)fDevice->GetChipId( ichip ) );
+    }
+    // the settling and conversion times start once the transactions reached the chips
+    for ( unsigned int i = 0; i < fScannedChips.size(); i++ ) {
+        fDevice->GetChip( fScannedChips.at(i) )->ExecutedADCTransactions();
+    }
+}
+
+//___________________________________________________________________
+unsigned int TDeviceDacScan::GetResultIndex( const unsigned int idac,
+                                            const unsigned int ichip,
+                                            const unsigned int ipoint ) const
+{
+    return (idac*fDevice->GetNChips() + ichip)*fNPoints + ipoint;
+}
+
+//___________________________________________________________________
+float TDeviceDacScan::GetResult( const unsigned int idac,
+                                const unsigned int ichip,
+                                const unsigned int ipoint ) const
+{
+    if ( (idac >= fDacList.size()) || (ichip >= fDevice->GetNChips()) || (ipoint >= fNPoints) ) {
+        throw out_of_range( "TDeviceDacScan::GetResult() - index out of range !" );
+    }
+    if ( fResults.empty() ) {
+        throw runtime_error( "TDeviceDacScan::GetResult() - no result ! Please use Go() first." );
+    }
+    return fResults.at( GetResultIndex( idac, ichip, ipoint ) );
+}
+
+//___________________________________________________________________
+void TDeviceDacScan::WriteDataToFile( const char *fName )
+{
+    if ( fResults.empty() ) {
+        throw runtime_error( "TDeviceDacScan::WriteDataToFile() - no result ! Please use Go() first." );
+    }
+    char fNameTemp[100];
+    sprintf( fNameTemp,"%s", fName );
+    strtok( fNameTemp, "." );
+    string suffix( fNameTemp );
+
+    for ( unsigned int i = 0; i < fScannedChips.size(); i++ ) {
+        const unsigned int ichip = fScannedChips.at(i);
+        common::TChipIndex aChipIndex;
+        aChipIndex.boardIndex = fDevice->GetUniqueBoardId();
+        aChipIndex.dataReceiver = fDevice->GetChipReceiverById( fDevice->GetChipId( ichip ) );
+        aChipIndex.deviceType = fDevice->GetDeviceType();
+        aChipIndex.deviceId = fDevice->GetDeviceId();
+        aChipIndex.chipId = fDevice->GetChipId( ichip );
+
+        string filename = common::GetFileName( aChipIndex, suffix );
+        if ( GetVerboseLevel() > kSILENT ) {
+            cout << "TDeviceDacScan::WriteDataToFile() - Writing data to file "<< filename << endl;
+        }
+        FILE *fp = fopen( filename.c_str(), "w" );
+        if ( !fp ) {
+            throw runtime_error( "TDeviceDacScan::WriteDataToFile() - output file not found." );
+        }
+        for ( unsigned int idac = 0; idac < fDacList.size(); idac++ ) {
+            const string dacName = TAlpide::GetDACName( fDacList.at(idac) );
+            for ( unsigned int ipoint = 0; ipoint < fNPoints; ipoint++ ) {
+                fprintf( fp, "%s %d %.3f\n", dacName.c_str(), GetDacValue( ipoint ),
+                        fResults.at( GetResultIndex( idac, ichip, ipoint ) ) );
+            }
+        }
+        fclose( fp );
+    }
+}
+
+//___________________________________________________________________
+void TDeviceDacScan::ConfigureBoards()
+{
+    // nothing to do to be able to run a DAC scan
+}
+
+//___________________________________________________________________
+void TDeviceDacScan::ConfigureChips()
+{
+    DoActivateConfigMode();
+    DoBaseConfig();
+}
+
+//___________________________________________________________________
+void TDeviceDacScan::StartReadout()
+{
+    // nothing to do to be able to run a DAC scan
+}
+
+//___________________________________________________________________
+void TDeviceDacScan::StopReadout()
+{
+    for ( unsigned int iboard = 0; iboard < fDevice->GetNBoards(false); iboard++ ) {
+
+        shared_ptr<TReadoutBoardDAQ> myDAQBoard = dynamic_pointer_cast<TReadoutBoardDAQ>(fDevice->GetBoard( iboard ));
+
+        if ( myDAQBoard ) {
+            myDAQBoard->PowerOff();
+        }
+    }
+}
@@ -0,0 +1,127 @@
+#ifndef DEVICE_DAC_SCAN_H
+#define DEVICE_DAC_SCAN_H
+
+/**
+ * \class TDeviceDacScan
+ *
+ * \brief This class runs the DAC scan for all enabled chips in the device.
+ *
+ * \author Andry Rakotozafindrabe
+ *
+ * Each DAC of the list is swept from 0 to 255 and its output voltage (or current)
+ * is measured by the internal ADC of the chip. All enabled chips are scanned in
+ * lockstep: at each step of the sweep, the DAC writes, the ADC input selection,
+ * the ADC conversion requests and the ADC reads of all chips are queued and
+ * executed at once (one control transaction per step and per phase for the
+ * MOSAIC board), and the settling and conversion times of all chips overlap.
+ *
+ * The measured values are stored in one contiguous array indexed by
+ * [dac][chip][point], see GetResult().
+ *
+ * \note
+ * The code was inspired from the original main_dacscan.cpp written by ITS team.
+ */
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "TDeviceChipVisitor.h"
+
+enum class AlpideRegister : std::uint16_t;
+
+class TDeviceDacScan : public TDeviceChipVisitor {
+
+    /// list of the DACs to be scanned
+    std::vector<AlpideRegister> fDacList;
+
+    /// distance between two consecutive DAC values of the sweep
+    unsigned int fSampleDist;
+
+    /// number of DAC values of the sweep
+    unsigned int fNPoints;
+
+    /// measured values (V or uA), [dac][chip][point] in one contiguous array
+    std::vector<float> fResults;
+
+    /// device indices of the chips being scanned (enabled chips)
+    std::vector<unsigned int> fScannedChips;
+
+    /// raw ADC values read at the current point (one per scanned chip)
+    std::vector<std::uint16_t> fRawValues;
+
+    /// DAC values found before the scan (one per scanned chip), restored at the end
+    std::vector<std::uint16_t> fOldValues;
+
+public:
+
+    /// constructor
+    TDeviceDacScan();
+
+    /// constructor with a TDevice specified
+    TDeviceDacScan( std::shared_ptr<TDevice> aDevice );
+
+    /// destructor
+    virtual ~TDeviceDacScan();
+
+    /// set the list of DACs to be scanned (default = all voltage and current DACs)
+    void SetDacList( const std::vector<AlpideRegister>& dacList );
+
+    /// set the distance between two consecutive DAC values of the sweep (default = 1)
+    void SetSampleDistance( const unsigned int sampleDist );
+
+    /// run the DAC scan on all enabled chips of the device
+    void Go();
+
+    /// write one text file per chip with the lines "DAC value measurement"
+    void WriteDataToFile( const char *fName );
+
+    /// number of DAC values of the sweep
+    unsigned int GetNPoints() const { return fNPoints; }
+
+    /// DAC value at the i-th point of the sweep
+    unsigned int GetDacValue( const unsigned int ipoint ) const { return ipoint*fSampleDist; }
+
+    /// measurement for the i-th DAC of the list, the i-th chip of the device and the i-th point
+    float GetResult( const unsigned int idac,
+                     const unsigned int ichip,
+                     const unsigned int ipoint ) const;
+
+    /// all measurements, [dac][chip][point] in one contiguous array (0 for disabled chips)
+    const std::vector<float>& GetResults() const { return fResults; }
+
+private:
+
+    /// sweep one DAC on all scanned chips
+    void ScanDac( const unsigned int idac );
+
+    /// queue the DAC write and the ADC input selection of all scanned chips
+    void QueueSetPoint( const AlpideRegister dac, const unsigned int ipoint );
+
+    /// execute the transactions queued for all scanned chips
+    void ExecuteTransactions();
+
+    /// index of a measurement in fResults
+    unsigned int GetResultIndex( const unsigned int idac,
+                                 const unsigned int ichip,
+                                 const unsigned int ipoint ) const;
+
+    /// number of possible values of a DAC
+    static const unsigned int NDACVALUES = 256;
+
+protected:
+
+    /// configure readout boards
+    void ConfigureBoards();
+
+    /// configure chips
+    void ConfigureChips();
+
+    /// start the readout
+    void StartReadout();
+
+    /// stop the readout
+    void StopReadout();
+};
+
+
+#endif
@@ -41,6 +41,8 @@ void TDeviceDigitalScan::Terminate()
     cout << endl;
     fErrorCounter->ClassifyCorruptedHits();
     fErrorCounter->Dump();
+    WriteTimingReport();
+    WriteHotTrace();
 }
 
 //___________________________________________________________________
@@ -153,10 +155,13 @@ void TDeviceDigitalScan::Go()
             cout << "TDeviceDigitalScan::Go() - Mask stage "
                  << std::dec << istage << endl;
         }
-        if ( fNMaskStages < 0 ) {
-            DoConfigureMaskStage( fNPixPerRegion, fNMaskStages );
-        } else {
-            DoConfigureMaskStage( fNPixPerRegion, istage );
+        {
+            TTimingSpan span( fTimingReport.get(), TTimingReport::kCONFIGURE );
+            if ( fNMaskStages < 0 ) {
+                DoConfigureMaskStage( fNPixPerRegion, fNMaskStages );
+            } else {
+                DoConfigureMaskStage( fNPixPerRegion, istage );
+            }
         }
         
         
@@ -165,31 +170,25 @@ void TDeviceDigitalScan::Go()
         // cout << "CMU DMU Config: 0x" << std::hex << Value << std::dec << endl;
         // (fDevice->GetChip(0))->ReadRegister( AlpideRegister::CMU_DMU_STATUS, Value );
         // cout << "Trigger counter before: " << Value << endl;
-        for ( unsigned int ib = 0; ib < fDevice->GetNBoards(false); ib++ ) {
-            // Send triggers for all boards
-            (fDevice->GetBoard( ib ))->Trigger(fNTriggers);
-        }
+        // Send triggers for all boards
+        TriggerAllBoards( fNTriggers );
         // (fDevice->GetChip(0))->ReadRegister( AlpideRegister::CMU_DMU_STATUS, Value );
         // cout << "Trigger counter after: " << Value << endl;
         // (fDevice->GetBoard( 0 ))->SendOpCode( (uint16_t)AlpideOpCode::DEBUG );
         // (fDevice->GetChip(0))->PrintDebugStream();
         
         if ( istage ) {
-            nHitsLastStage = fChipDecoder->GetNHits();
+            nHitsLastStage = GetNHits();
         }
-        usleep(2000);
 
-        // Read data for all boards
-        for ( unsigned int ib = 0; ib < fDevice->GetNBoards(false); ib++ ) {
-            ReadEventData( ib );
-        }
+        // Read data for all boards, until all expected events arrived (or timeout)
+        ReadAllBoardsEventData();
         
-        nHitsTot = fChipDecoder->GetNHits() - nHitsLastStage;
+        nHitsTot = GetNHits() - nHitsLastStage;
         if ( GetVerboseLevel() > kSILENT ) {
             cout << "TDeviceDigitalScan::Go() - stage "
                  << std::dec << istage << " , found n hits = " << nHitsTot << endl;
         }
-        usleep(200);
     }
 }
 
@@ -230,25 +229,12 @@ void TDeviceDigitalScan::CollectDiscordantPixels()
     }
     for ( unsigned int ichip = 0; ichip < fScanHisto->GetChipListSize(); ichip++ ) {
         
-        for (unsigned int icol = 0; icol <= common::MAX_DCOL; icol ++) {
-            for (unsigned int iaddr = 0; iaddr <= common::MAX_ADDR; iaddr ++) {
-                
-                common::TChipIndex idx = fScanHisto->GetChipIndex(ichip);
-                double nhits = (*fScanHisto)(idx,icol,iaddr);
-                if ( nhits == 0 ) {
-                    fErrorCounter->AddDeadPixel( idx, icol, iaddr );
-                } else {
-                    if ( nhits < fNTriggers ) {
-                        fErrorCounter->AddInefficientPixel( idx, icol, iaddr, nhits );
-                    } else {
-                        if ( nhits > fNTriggers ) {
-                            fErrorCounter->AddHotPixel( idx, icol, iaddr, nhits );
-                        }
-                    }
-                }
-                
-            } // end of loop on iaddr
-        } // end of loop on icol
+        // dead (no hit), inefficient (< n triggers) and hot (> n triggers) pixels
+        // are found in one pass over the hit map, then given at once to the error counter
+        common::TChipIndex idx = fScanHisto->GetChipIndex(ichip);
+        TDiscordantBins bins;
+        fScanHisto->FindDiscordantBins( idx, (double)fNTriggers, bins );
+        fErrorCounter->AddDiscordantPixels( idx, bins );
         
     } // end of loop on ichip
 }
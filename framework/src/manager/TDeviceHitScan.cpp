@@ -8,14 +8,23 @@
 #include "TReadoutBoard.h"
 #include "TReadoutBoardDAQ.h"
 #include "TReadoutBoardMOSAIC.h"
+#include "TReadoutBoardReplay.h"
 #include "TScanConfig.h"
 #include "THisto.h"
 #include "mdictionary.h"
 #include "TStorePixHit.h"
+#include "TRawEventWriter.h"
+#include "TMonitorPublisher.h"
+#include "THotTrace.h"
 #include <stdexcept>
 #include <iostream>
 #include <bitset>
+#include <chrono>
+#include <functional>
+#include <limits>
 #include <string.h>
+#include <thread>
+#include <unistd.h>
 
 using namespace std;
 
@@ -29,7 +38,14 @@ fChipDecoder( nullptr ),
 fBoardDecoder( nullptr ),
 fNTriggers( 0 ),
 fStorePixHit( nullptr ),
-fProduceTTree( false )
+fProduceTTree( false ),
+fRecordRawEvents( false ),
+fRawEventWriter( nullptr ),
+fBuildEvents( false ),
+fEventBuilder( nullptr ),
+fMonitorSegmentName( "" ),
+fMonitorPublisher( nullptr ),
+fTimingReport( nullptr )
 {
     fErrorCounter = make_shared<TErrorCounter>();
     fBoardDecoder = make_unique<TBoardDecoder>();
@@ -48,7 +64,14 @@ fErrorCounter( nullptr ),
 fChipDecoder( nullptr ),
 fNTriggers( 0 ),
 fStorePixHit( nullptr ),
-fProduceTTree( produceTTree )
+fProduceTTree( produceTTree ),
+fRecordRawEvents( false ),
+fRawEventWriter( nullptr ),
+fBuildEvents( false ),
+fEventBuilder( nullptr ),
+fMonitorSegmentName( "" ),
+fMonitorPublisher( nullptr ),
+fTimingReport( nullptr )
 {
     try {
         SetScanConfig( aScanConfig );
@@ -61,6 +84,7 @@ fProduceTTree( produceTTree )
     fStorePixHit = make_shared<TStorePixHit>();
     fChipDecoder  = make_unique<TAlpideDecoder>( aDevice, fErrorCounter, fStorePixHit );
     fBoardDecoder = make_unique<TBoardDecoder>();
+    fTimingReport = make_shared<TTimingReport>();
 
 }
 
@@ -70,6 +94,8 @@ TDeviceHitScan::~TDeviceHitScan()
     if ( fErrorCounter ) fErrorCounter.reset();
     if ( fScanConfig ) fScanConfig.reset();
     if ( fScanHisto ) fScanHisto.reset();
+    if ( fEventBuilder ) fEventBuilder.reset();
+    if ( fRawEventWriter ) fRawEventWriter.reset();
 }
 
 //___________________________________________________________________
@@ -89,6 +115,10 @@ void TDeviceHitScan::SetVerboseLevel( const int level )
     fBoardDecoder->SetVerboseLevel( level );
     fErrorCounter->SetVerboseLevel( level );
     fStorePixHit->SetVerboseLevel( level );
+    for ( unsigned int ib = 0; ib < fBoardLanes.size(); ib++ ) {
+        fBoardLanes.at(ib).boardDecoder->SetVerboseLevel( level );
+        fBoardLanes.at(ib).chipDecoder->SetVerboseLevel( level );
+    }
     TDeviceChipVisitor::SetVerboseLevel( level );
 }
 
@@ -96,6 +126,18 @@ void TDeviceHitScan::SetVerboseLevel( const int level )
 void TDeviceHitScan::SetRescueBadChipId( const bool permit )
 {
     fChipDecoder->SetRescueBadChipId( permit );
+    for ( unsigned int ib = 0; ib < fBoardLanes.size(); ib++ ) {
+        fBoardLanes.at(ib).chipDecoder->SetRescueBadChipId( permit );
+    }
+}
+
+//___________________________________________________________________
+void TDeviceHitScan::AddBuiltEventHandler( TEventBuilder::TEventHandler handler )
+{
+    if ( fEventBuilder ) {
+        throw runtime_error( "TDeviceHitScan::AddBuiltEventHandler() - the event builder is already created !" );
+    }
+    fBuiltEventHandlers.push_back( move(handler) );
 }
 
 //___________________________________________________________________
@@ -124,7 +166,13 @@ void TDeviceHitScan::Init()
     }
     InitScanParameters();
     AddHisto();
+    if ( fTimingReport ) {
+        fTimingReport->SetName( fName );
+        fTimingReport->Reset();
+    }
+    THotTrace::Reset();
     try {
+        TTimingSpan span( fTimingReport.get(), TTimingReport::kCONFIGURE );
         TDeviceChipVisitor::Init();
     } catch ( std::exception &err ) {
         cerr << err.what() << endl;
@@ -143,16 +191,157 @@ void TDeviceHitScan::Init()
     } else {
         fProduceTTree = false;
     }
+    if ( fRecordRawEvents ) {
+        char fNameTemp[100];
+        sprintf( fNameTemp, "%s", fName.c_str() );
+        strtok( fNameTemp, "." );
+        fRawEventWriter = make_unique<TRawEventWriter>();
+        fRawEventWriter->SetVerboseLevel( GetVerboseLevel() );
+        // recorded for the replayed events to be decoded as the live ones
+        for ( unsigned int iboard = 0; iboard < fDevice->GetNBoards(false); iboard++ ) {
+            shared_ptr<TReadoutBoardMOSAIC> myMOSAIC = dynamic_pointer_cast<TReadoutBoardMOSAIC>(fDevice->GetBoard( iboard ));
+            shared_ptr<TReadoutBoardReplay> myReplay = dynamic_pointer_cast<TReadoutBoardReplay>(fDevice->GetBoard( iboard ));
+            if ( myMOSAIC ) {
+                fRawEventWriter->SetFirmwareVersion( iboard, myMOSAIC->GetFwIdString() );
+            }
+            if ( myReplay ) {
+                fRawEventWriter->SetFirmwareVersion( iboard, myReplay->GetFwIdString() );
+            }
+        }
+        fRawEventWriter->Open( "../../data/" + string( fNameTemp ) + ".raw" );
+    }
+    if ( fBuildEvents ) {
+        InitEventBuilder();
+    }
+    if ( !fMonitorSegmentName.empty() ) {
+        fMonitorPublisher = make_unique<TMonitorPublisher>();
+        fMonitorPublisher->SetVerboseLevel( GetVerboseLevel() );
+        try {
+            fMonitorPublisher->Open( fMonitorSegmentName, *fScanHisto );
+        } catch ( exception& err ) {
+            // the scan goes on without the live monitoring
+            cerr << err.what() << endl;
+            fMonitorPublisher.reset();
+        }
+    }
     shared_ptr<TReadoutBoardMOSAIC> myMOSAICboard = dynamic_pointer_cast<TReadoutBoardMOSAIC>(fDevice->GetBoard(0));
-    if ( GetVerboseLevel() > kTERSE ) {
+    if ( myMOSAICboard && (GetVerboseLevel() > kTERSE) ) {
         myMOSAICboard->DumpConfig();
     }
 }
 
+//___________________________________________________________________
+void TDeviceHitScan::InitEventBuilder()
+{
+    const unsigned int nBoards = fDevice->GetNBoards(false);
+    shared_ptr<TBoardConfigMOSAIC> myMOSAICboardConfig = dynamic_pointer_cast<TBoardConfigMOSAIC>(fDevice->GetBoardConfig(0));
+    
+    // the fragments of the boards are matched by the trigger number of the trigger recorder
+    if ( (nBoards < 2) || !myMOSAICboardConfig || !myMOSAICboardConfig->IsTrgRecorderEnable() ) {
+        if ( GetVerboseLevel() > kSILENT ) {
+            cout << "TDeviceHitScan::InitEventBuilder() - needs several boards with their trigger recorder, no event building" << endl;
+        }
+        fBuildEvents = false;
+        return;
+    }
+    vector<unsigned int> nFragments;
+    for ( unsigned int ib = 0; ib < nBoards; ib++ ) {
+        nFragments.push_back( fDevice->GetNWorkingChipsPerBoard( ib ) );
+    }
+    fEventBuilder = make_unique<TEventBuilder>( nFragments );
+    fEventBuilder->SetVerboseLevel( GetVerboseLevel() );
+    
+    // the raw event file is then written in the order of the built events
+    if ( fRawEventWriter ) {
+        TRawEventWriter* writer = fRawEventWriter.get();
+        fEventBuilder->AddEventHandler( [writer]( const TEventBuilder::TBuiltEvent& event ) {
+            unsigned int offset = 0;
+            for ( unsigned int i = 0; i < event.size.size(); i++ ) {
+                writer->AddEvent( event.data.data() + offset, event.size.at(i), event.board.at(i),
+                                  event.trgNum, event.trgTime.at(i) );
+                offset += event.size.at(i);
+            }
+        } );
+    }
+    for ( unsigned int ih = 0; ih < fBuiltEventHandlers.size(); ih++ ) {
+        fEventBuilder->AddEventHandler( fBuiltEventHandlers.at(ih) );
+    }
+    if ( GetVerboseLevel() > kTERSE ) {
+        cout << "TDeviceHitScan::InitEventBuilder() - events of " << std::dec << nBoards
+             << " boards built by trigger number" << endl;
+    }
+}
+
+//___________________________________________________________________
+void TDeviceHitScan::PublishMonitorSnapshot( const unsigned int iboard, const bool force )
+{
+    if ( !fMonitorPublisher ) return;
+    
+    // the hits of a board decoded by its own lane are in its shard until the lanes are merged
+    const TScanHisto* histoShard = fBoardLanes.empty() ? nullptr : fBoardLanes.at(iboard).histoShard.get();
+    fMonitorPublisher->PublishBoard( iboard, *fScanHisto, histoShard, *fErrorCounter, force );
+}
+
+//___________________________________________________________________
+void TDeviceHitScan::TriggerAllBoards( const int nTriggers )
+{
+    TTimingSpan span( fTimingReport.get(), TTimingReport::kTRIGGER );
+    for ( unsigned int ib = 0; ib < fDevice->GetNBoards(false); ib++ ) {
+        (fDevice->GetBoard( ib ))->Trigger( nTriggers );
+    }
+}
+
+//___________________________________________________________________
+void TDeviceHitScan::WriteTimingReport()
+{
+    // without scan timing, the spans are removed at compile time: nothing to report
+#ifndef NO_SCAN_TIMING
+    if ( !fTimingReport ) return;
+    if ( GetVerboseLevel() > kSILENT ) {
+        fTimingReport->Dump();
+    }
+    char fNameTemp[100];
+    sprintf( fNameTemp, "%s", fName.c_str() );
+    strtok( fNameTemp, "." );
+    fTimingReport->SetVerboseLevel( GetVerboseLevel() );
+    try {
+        fTimingReport->WriteToFile( "../../data/" + string( fNameTemp ) + ".timing.json" );
+    } catch ( exception& err ) {
+        cerr << err.what() << endl;
+    }
+#endif
+}
+
+//___________________________________________________________________
+void TDeviceHitScan::WriteHotTrace()
+{
+    // without hot trace, the trace sites are removed at compile time: nothing to write
+#ifdef WITH_HOT_TRACE
+    char fNameTemp[100];
+    sprintf( fNameTemp, "%s", fName.c_str() );
+    strtok( fNameTemp, "." );
+    const string fileName = "../../data/" + string( fNameTemp ) + ".trace.bin";
+    try {
+        THotTrace::WriteToFile( fileName );
+    } catch ( exception& err ) {
+        cerr << err.what() << endl;
+        return;
+    }
+    if ( GetVerboseLevel() > kSILENT ) {
+        cout << "TDeviceHitScan::WriteHotTrace() - trace of the decoding written to " << fileName << endl;
+    }
+#endif
+}
+
 //___________________________________________________________________
 unsigned int TDeviceHitScan::GetNHits() const 
 { 
-    return fChipDecoder->GetNHits(); 
+    // hits not merged yet are still in the histograms of the board lanes
+    unsigned int nHits = fChipDecoder->GetNHits();
+    for ( unsigned int ib = 0; ib < fBoardLanes.size(); ib++ ) {
+        nHits += fBoardLanes.at(ib).chipDecoder->GetNHits();
+    }
+    return nHits; 
 }
 
 
@@ -173,11 +362,12 @@ void TDeviceHitScan::ConfigureChips()
 //___________________________________________________________________
 unsigned int TDeviceHitScan::ReadEventData( const unsigned int iboard, int nTriggers )
 {
-    unsigned char buffer[1024*4000];
-    int n_bytes_data, n_bytes_header, n_bytes_trailer;
+    unsigned char buffer[READBUFFERSIZE];
+    int n_bytes_data;
         
     unsigned int itrg = 0;
     unsigned int nTrials = 0;
+    unsigned int nBad  = 0;
     uint32_t trgNum = 0;
 	uint64_t trgTime = 0;
     unsigned int uniqueBoardId = fDevice->GetUniqueBoardId(); 
@@ -186,8 +376,12 @@ unsigned int TDeviceHitScan::ReadEventData( const unsigned int iboard, int nTrig
     
     while( itrg < nTriggers * fDevice->GetNWorkingChipsPerBoard( iboard ) ) {
         
-        unsigned int nBad  = 0;
+        TTimingSpan readSpan( fTimingReport.get(), TTimingReport::kREADOUT );
         int readDataFlag = (fDevice->GetBoard( iboard ))->ReadEventData(n_bytes_data, buffer);
+        if ( readDataFlag != MosaicDict::kEMPTY_EVENT ) {
+            readSpan.AddBytes( n_bytes_data );
+        }
+        readSpan.Stop();
         
         if ( readDataFlag == MosaicDict::kEMPTY_EVENT ) {
             
@@ -209,15 +403,9 @@ unsigned int TDeviceHitScan::ReadEventData( const unsigned int iboard, int nTrig
             
         } else {
 
-            shared_ptr<TBoardConfig> boardConfig = fDevice->GetBoardConfig( iboard );
-            fBoardDecoder->SetBoardType( boardConfig->GetBoardType() );
-
-            if ( boardConfig->GetBoardType() == TBoardType::kBOARD_MOSAIC ) {
-
+            if ( readDataFlag == MosaicDict::kTRGRECORDER_EVENT ) {
                 shared_ptr<TReadoutBoardMOSAIC> myMOSAIC = dynamic_pointer_cast<TReadoutBoardMOSAIC>(fDevice->GetBoard( iboard ));
-                fBoardDecoder->SetFirmwareVersion( myMOSAIC->GetFwIdString() );
-
-                if ( readDataFlag == MosaicDict::kTRGRECORDER_EVENT ) {
+                if ( myMOSAIC ) {
                     trgNum = myMOSAIC->GetTriggerNum();
                     trgTime = myMOSAIC->GetTriggerTime();
                     if ( GetVerboseLevel() > kULTRACHATTY ) {
@@ -227,67 +415,418 @@ unsigned int TDeviceHitScan::ReadEventData( const unsigned int iboard, int nTrig
                     }
                     continue;
                 }
+                shared_ptr<TReadoutBoardReplay> myReplay = dynamic_pointer_cast<TReadoutBoardReplay>(fDevice->GetBoard( iboard ));
+                if ( myReplay ) {
+                    trgNum = myReplay->GetTriggerNum();
+                    trgTime = myReplay->GetTriggerTime();
+                    continue;
+                }
             }
-                        
-            // decode readout board event
-            fBoardDecoder->DecodeEvent( buffer, n_bytes_data, n_bytes_header, n_bytes_trailer );
-            if ( fBoardDecoder->GetMosaicDecoder10b8bError() ) {
-                fErrorCounter->IncrementN8b10b( fBoardDecoder->GetMosaicChannel() );
-            }
-            if ( fBoardDecoder->GetMosaicTimeout() ) {
-                fErrorCounter->IncrementNTimeout();
-            }
-            if ( fBoardDecoder->GetMosaicEventOverSizeError() ) {
-                fErrorCounter->IncrementNEventOverSizeError();
-            }
-
             if ( GetVerboseLevel() > kVERBOSE ) {
                 cout << "TDeviceHitScan::ReadEventData() - board "
                 << std::dec << uniqueBoardId
                 << " , received event " << itrg << " with length "
                 << n_bytes_data << endl;
-                for ( int iByte = 0; iByte < n_bytes_data; ++iByte ) {
-                    printf ("%02x ", (int) buffer[iByte]);
-                }
-                cout << endl;
             }
-            
-            // decode Chip event
-            int n_bytes_chipevent = n_bytes_data-n_bytes_header;// - n_bytes_trailer;
-            if ( fBoardDecoder->GetMosaicEoeCount() < 2) {
-                n_bytes_chipevent -= n_bytes_trailer;
+            // the boards are read one after the other here: their events are not built
+            if ( fRawEventWriter ) {
+                fRawEventWriter->AddEvent( buffer, n_bytes_data, iboard, trgNum, trgTime );
             }
-            bool isOk = fChipDecoder->DecodeEvent(buffer + n_bytes_header, n_bytes_chipevent,
-                                                  iboard,
-                                                  fBoardDecoder->GetMosaicChannel(),
-                                                  trgNum, trgTime );
-            
-            if ( !isOk ) {
-                if ( GetVerboseLevel() > kSILENT ) {
-                    cout << "TDeviceHitScan::ReadEventData() - board "
-                    << std::dec << uniqueBoardId
-                    << " , found bad event " << endl;
-                }
-                fErrorCounter->IncrementNCorruptEvent();
-                nBad++;
-                if ( nBad > TDeviceHitScan::MAXNBAD ) continue;
-                FILE* fDebug = fopen ("../../data/DebugData.dat", "a");
-                if ( fDebug ) {
-                    for ( int iByte=0; iByte<n_bytes_data; ++iByte ) {
-                        fprintf (fDebug, "%02x ", (int) buffer[iByte]);
-                    }
-                    fprintf(fDebug, "\nFull Event:\n");
-                    for (unsigned int ibyte = 0; ibyte < fDebugBuffer.size(); ibyte ++) {
-                        fprintf (fDebug, "%02x ", (int) fDebugBuffer.at(ibyte));
+            TTimingSpan decodeSpan( fTimingReport.get(), TTimingReport::kDECODE );
+            decodeSpan.AddBytes( n_bytes_data );
+            decodeSpan.AddEvents();
+            DecodeBoardEvent( iboard, buffer, n_bytes_data, trgNum, trgTime, nBad );
+            itrg++;
+        }
+    }
+    PublishMonitorSnapshot( iboard );
+    return itrg;
+}
+
+//___________________________________________________________________
+void TDeviceHitScan::ReadAllBoardsEventData( int nTriggers )
+{
+    if ( nTriggers <= 0 ) nTriggers = fNTriggers;
+    
+    const unsigned int nBoards = fDevice->GetNBoards(false);
+    vector<TBoardEvents> events( nBoards );
+    
+    // the boards are drained at the same time (one thread per board), so that the
+    // wait for the data of one board does not delay the others; each thread also
+    // decodes the events of its board if the boards have their own decoding lane
+    const bool useLanes = PrepareBoardLanes();
+    PrepareReadBuffers();
+    if ( nBoards == 1 ) {
+        FetchBoardEvents( 0, nTriggers * fDevice->GetNWorkingChipsPerBoard( 0 ), events.at(0) );
+    } else {
+        vector<thread> readingThreads;
+        for ( unsigned int ib = 0; ib < nBoards; ib++ ) {
+            readingThreads.push_back( thread( [this, ib, nTriggers, useLanes, &events]() {
+                FetchBoardEvents( ib, nTriggers * fDevice->GetNWorkingChipsPerBoard( ib ), events.at(ib) );
+                if ( useLanes ) DecodeBoardEvents( ib, events.at(ib) );
+            } ) );
+        }
+        for ( auto &t : readingThreads ) {
+            t.join();
+        }
+    }
+    
+    if ( useLanes ) {
+        MergeBoardLanes();
+    } else {
+        // otherwise the decoders are shared by all boards: events are decoded by this thread only
+        for ( unsigned int ib = 0; ib < nBoards; ib++ ) {
+            DecodeBoardEvents( ib, events.at(ib) );
+        }
+    }
+    for ( unsigned int ib = 0; ib < nBoards; ib++ ) {
+        PublishMonitorSnapshot( ib );
+    }
+}
+
+//___________________________________________________________________
+void TDeviceHitScan::DecodeBoardEvents( const unsigned int iboard, TBoardEvents& events )
+{
+    TTimingSpan span( fTimingReport.get(), TTimingReport::kDECODE );
+    span.AddBytes( events.data.size() );
+    span.AddEvents( events.size.size() );
+    if ( events.timeout ) {
+        if ( GetVerboseLevel() > kSILENT ) {
+            cout << "TDeviceHitScan::DecodeBoardEvents() - board "
+            << std::dec << iboard << " , timeout after " << events.size.size()
+            << " events, giving up on this point." << endl;
+        }
+        fErrorCounter->IncrementNTimeout();
+    }
+    unsigned int nBad = 0;
+    unsigned int offset = 0;
+    for ( unsigned int iev = 0; iev < events.size.size(); iev++ ) {
+        if ( fRawEventWriter && !fEventBuilder ) {
+            fRawEventWriter->AddEvent( events.data.data() + offset, events.size.at(iev), iboard,
+                                       events.trgNum.at(iev), events.trgTime.at(iev) );
+        }
+        DecodeBoardEvent( iboard, events.data.data() + offset, events.size.at(iev),
+                          events.trgNum.at(iev), events.trgTime.at(iev), nBad );
+        offset += events.size.at(iev);
+    }
+}
+
+//___________________________________________________________________
+bool TDeviceHitScan::PrepareBoardLanes()
+{
+    if ( !fBoardLanes.empty() ) return true;
+    const unsigned int nBoards = fDevice->GetNBoards(false);
+    
+    // the TTree and the raw event file (unless written by the event builder) are filled
+    // in the order of the events: no lane
+    if ( (nBoards < 2) || !fScanHisto || IsTTreeActivated() ) return false;
+    if ( fRawEventWriter && !fEventBuilder ) return false;
+    
+    fBoardLanes.resize( nBoards );
+    for ( unsigned int ib = 0; ib < nBoards; ib++ ) {
+        TBoardLane& lane = fBoardLanes.at(ib);
+        lane.boardDecoder = make_unique<TBoardDecoder>();
+        lane.boardDecoder->SetVerboseLevel( GetVerboseLevel() );
+        lane.chipDecoder = make_unique<TAlpideDecoder>( fDevice, fErrorCounter, fStorePixHit );
+        lane.chipDecoder->SetVerboseLevel( GetVerboseLevel() );
+        lane.chipDecoder->SetRescueBadChipId( fChipDecoder->GetRescueBadChipId() );
+        lane.histoShard = make_shared<TScanHisto>();
+        for ( unsigned int ichip = 0; ichip < fScanHisto->GetChipListSize(); ichip++ ) {
+            const common::TChipIndex idx = fScanHisto->GetChipIndex( ichip );
+            if ( idx.boardIndex != ib ) continue;
+            // a shard only holds the hits of a stage: it starts sparse
+            THisto shard( fScanHisto->GetHisto( idx ) );
+            shard.SetSparse( MAXSHARDDENSITY );
+            lane.histoShard->AddHisto( idx, shard );
+        }
+        lane.histoShard->FindChipList();
+        lane.chipDecoder->SetScanHisto( lane.histoShard );
+    }
+    if ( GetVerboseLevel() > kTERSE ) {
+        cout << "TDeviceHitScan::PrepareBoardLanes() - " << std::dec << nBoards
+             << " boards decoded in parallel" << endl;
+    }
+    return true;
+}
+
+//___________________________________________________________________
+void TDeviceHitScan::PrepareReadBuffers()
+{
+    const unsigned int nBoards = fDevice->GetNBoards(false);
+    if ( fReadBuffers.size() == nBoards ) return;
+    fReadBuffers.resize( nBoards );
+    for ( unsigned int ib = 0; ib < nBoards; ib++ ) {
+        fReadBuffers.at(ib).resize( READBUFFERSIZE );
+    }
+}
+
+//___________________________________________________________________
+void TDeviceHitScan::MergeBoardLanes()
+{
+    TTimingSpan span( fTimingReport.get(), TTimingReport::kMERGE );
+    for ( unsigned int ib = 0; ib < fBoardLanes.size(); ib++ ) {
+        fScanHisto->MergeShard( *(fBoardLanes.at(ib).histoShard) );
+    }
+}
+
+//___________________________________________________________________
+void TDeviceHitScan::FetchBoardEvents( const unsigned int iboard,
+                                       const unsigned int nEvents,
+                                       TBoardEvents& events,
+                                       const unsigned int maxReadTime,
+                                       const bool runStopped )
+{
+    // only the thread fetching this board uses its buffer
+    vector<unsigned char>& buffer = fReadBuffers.at( iboard );
+    int n_bytes_data = 0;
+    uint32_t trgNum = 0;
+    uint64_t trgTime = 0;
+    unsigned int nTrials = 0;
+    
+    shared_ptr<TReadoutBoard> myBoard = fDevice->GetBoard( iboard );
+    shared_ptr<TReadoutBoardMOSAIC> myMOSAIC = dynamic_pointer_cast<TReadoutBoardMOSAIC>( myBoard );
+    shared_ptr<TReadoutBoardReplay> myReplay = dynamic_pointer_cast<TReadoutBoardReplay>( myBoard );
+    
+    // the k-th event of a MOSAIC receiver belongs to the k-th trigger record of the board,
+    // whether this record was read before or after the event
+    shared_ptr<TBoardConfigMOSAIC> myMOSAICboardConfig = dynamic_pointer_cast<TBoardConfigMOSAIC>( fDevice->GetBoardConfig( iboard ) );
+    shared_ptr<TTriggerTable> triggerTable = ( myMOSAIC && myMOSAICboardConfig && myMOSAICboardConfig->IsTrgRecorderEnable() ) ?
+        myMOSAIC->GetTriggerTable() : nullptr;
+    // events fetched here whose trigger record is not read yet: (index in events, ordinal of the record)
+    vector<pair<unsigned int, uint64_t>> unresolved;
+    // events whose ordinal was found out of sync by the board
+    const unsigned long nOrdinalMismatches = myMOSAIC ? myMOSAIC->GetNOrdinalMismatches() : 0;
+    
+    TTimingSpan span( fTimingReport.get(), TTimingReport::kREADOUT );
+    const chrono::steady_clock::time_point deadline = maxReadTime ?
+        chrono::steady_clock::now() + chrono::milliseconds( maxReadTime ) : chrono::steady_clock::time_point::max();
+    chrono::steady_clock::time_point lastEventTime = chrono::steady_clock::now();
+    
+    while ( events.size.size() < nEvents ) {
+        
+        // the MOSAIC board waits for the data on its TCP connection, up to its polling timeout
+        int readDataFlag = myBoard->ReadEventData( n_bytes_data, buffer.data() );
+        const chrono::steady_clock::time_point now = chrono::steady_clock::now();
+        
+        if ( readDataFlag == MosaicDict::kEMPTY_EVENT ) {
+            // nothing more will come once the run is stopped
+            if ( runStopped ) break;
+            nTrials ++;
+            if ( ((nTrials >= TDeviceHitScan::MAXTRIALS)
+                  && (now - lastEventTime >= chrono::milliseconds( MINIDLETIME )))
+                || (now >= deadline) ) {
+                events.timeout = true;
+                break;
+            }
+            usleep(100);
+            continue;
+        }
+        nTrials = 0;
+        lastEventTime = now;
+        if ( myMOSAIC && (readDataFlag == MosaicDict::kTRGRECORDER_EVENT) ) {
+            trgNum = myMOSAIC->GetTriggerNum();
+            trgTime = myMOSAIC->GetTriggerTime();
+            if ( triggerTable ) {
+                for ( unsigned int i = 0; i < unresolved.size(); ) {
+                    const uint64_t ordinal = unresolved.at(i).second;
+                    if ( ordinal < triggerTable->GetNAdded() ) {
+                        const size_t row = ordinal - triggerTable->GetNRemoved();
+                        events.trgNum.at( unresolved.at(i).first ) = triggerTable->GetTriggerNum( row );
+                        events.trgTime.at( unresolved.at(i).first ) = triggerTable->GetTriggerTime( row );
+                        unresolved.erase( unresolved.begin() + i );
+                    } else {
+                        i++;
                     }
-                    fprintf(fDebug, "\n\n");
-                    fclose( fDebug );
                 }
             }
-            itrg++;
+            // the builder gets the records of a trigger before its fragments
+            if ( fEventBuilder ) {
+                fEventBuilder->AddTriggerRecords( iboard, *(myMOSAIC->GetTriggerTable()) );
+                if ( triggerTable ) AddResolvedFragments( iboard, *triggerTable );
+            }
+            continue;
+        }
+        if ( myReplay && (readDataFlag == MosaicDict::kTRGRECORDER_EVENT) ) {
+            trgNum = myReplay->GetTriggerNum();
+            trgTime = myReplay->GetTriggerTime();
+            if ( fEventBuilder ) {
+                fEventBuilder->AddTriggerRecords( iboard, *(myReplay->GetTriggerTable()) );
+            }
+            continue;
+        }
+        uint32_t eventTrgNum = trgNum;
+        uint64_t eventTrgTime = trgTime;
+        bool isResolved = true;
+        if ( triggerTable ) {
+            // the board only removes the records of the triggers already read by all its receivers
+            const uint64_t ordinal = myMOSAIC->GetEventOrdinal();
+            if ( ordinal < triggerTable->GetNAdded() ) {
+                const size_t row = ordinal - triggerTable->GetNRemoved();
+                eventTrgNum = triggerTable->GetTriggerNum( row );
+                eventTrgTime = triggerTable->GetTriggerTime( row );
+            } else {
+                // the last trigger read is kept until the record of this event is read
+                isResolved = false;
+                unresolved.push_back( make_pair( (unsigned int)events.size.size(), ordinal ) );
+                if ( fEventBuilder ) {
+                    TPendingFragment fragment;
+                    fragment.ordinal = ordinal;
+                    fragment.data.assign( buffer.begin(), buffer.begin() + n_bytes_data );
+                    fPendingFragments.at( iboard ).push_back( std::move( fragment ) );
+                }
+            }
+        }
+        events.data.insert( events.data.end(), buffer.begin(), buffer.begin() + n_bytes_data );
+        events.size.push_back( n_bytes_data );
+        events.trgNum.push_back( eventTrgNum );
+        events.trgTime.push_back( eventTrgTime );
+        span.AddBytes( n_bytes_data );
+        span.AddEvents();
+        if ( fEventBuilder && isResolved ) {
+            fEventBuilder->AddFragment( iboard, eventTrgNum, eventTrgTime, buffer.data(), n_bytes_data );
+        }
+        if ( now >= deadline ) {
+            events.timeout = ( events.size.size() < nEvents );
+            break;
         }
     }
-    return itrg;
+    if ( myMOSAIC && (myMOSAIC->GetNOrdinalMismatches() > nOrdinalMismatches) ) {
+        fErrorCounter->IncrementNOrdinalMismatch( myMOSAIC->GetNOrdinalMismatches() - nOrdinalMismatches );
+    }
+    if ( !unresolved.empty() && (GetVerboseLevel() > kTERSE) ) {
+        cout << "TDeviceHitScan::FetchBoardEvents() - board " << std::dec << iboard << " , "
+             << unresolved.size() << " event(s) fetched before their trigger record" << endl;
+    }
+}
+
+//___________________________________________________________________
+void TDeviceHitScan::AddResolvedFragments( const unsigned int iboard, const TTriggerTable& table )
+{
+    deque<TPendingFragment>& pending = fPendingFragments.at( iboard );
+    for ( auto it = pending.begin(); it != pending.end(); ) {
+        if ( it->ordinal >= table.GetNAdded() ) {
+            ++it;
+            continue;
+        }
+        const size_t row = it->ordinal - table.GetNRemoved();
+        fEventBuilder->AddFragment( iboard, table.GetTriggerNum( row ), table.GetTriggerTime( row ),
+                                    it->data.data(), it->data.size() );
+        it = pending.erase( it );
+    }
+}
+
+//___________________________________________________________________
+void TDeviceHitScan::ReadDrainedEvents()
+{
+    const unsigned int nBoards = fDevice->GetNBoards(false);
+    PrepareReadBuffers();
+    for ( unsigned int ib = 0; ib < nBoards; ib++ ) {
+        shared_ptr<TReadoutBoardMOSAIC> myMOSAIC = dynamic_pointer_cast<TReadoutBoardMOSAIC>(fDevice->GetBoard( ib ));
+        if ( !myMOSAIC ) continue;
+        // the board gives back the events drained at StopRun(), then only empty events
+        TBoardEvents events;
+        FetchBoardEvents( ib, numeric_limits<unsigned int>::max(), events, 0, true );
+        if ( !fPendingFragments.empty() && !fPendingFragments.at( ib ).empty() ) {
+            if ( GetVerboseLevel() > kSILENT ) {
+                cout << "TDeviceHitScan::ReadDrainedEvents() - board " << std::dec << ib << " , "
+                     << fPendingFragments.at( ib ).size() << " event(s) without trigger record not built" << endl;
+            }
+            fPendingFragments.at( ib ).clear();
+        }
+        if ( events.size.empty() ) continue;
+        if ( GetVerboseLevel() > kTERSE ) {
+            cout << "TDeviceHitScan::ReadDrainedEvents() - board " << std::dec << ib
+                 << " , " << events.size.size() << " event(s) read after the end of run" << endl;
+        }
+        DecodeBoardEvents( ib, events );
+    }
+    if ( !fBoardLanes.empty() ) {
+        MergeBoardLanes();
+    }
+}
+
+//___________________________________________________________________
+bool TDeviceHitScan::DecodeBoardEvent( const unsigned int iboard,
+                                       unsigned char* buffer,
+                                       const int nBytes,
+                                       const uint32_t trgNum,
+                                       const uint64_t trgTime,
+                                       unsigned int& nBad )
+{
+    int n_bytes_header, n_bytes_trailer;
+    unsigned int uniqueBoardId = fDevice->GetUniqueBoardId(); 
+    TBoardDecoder& boardDecoder = fBoardLanes.empty() ? *fBoardDecoder : *(fBoardLanes.at(iboard).boardDecoder);
+    TAlpideDecoder& chipDecoder = fBoardLanes.empty() ? *fChipDecoder : *(fBoardLanes.at(iboard).chipDecoder);
+
+    shared_ptr<TBoardConfig> boardConfig = fDevice->GetBoardConfig( iboard );
+    boardDecoder.SetBoardType( boardConfig->GetBoardType() );
+
+    if ( boardConfig->GetBoardType() == TBoardType::kBOARD_MOSAIC ) {
+        shared_ptr<TReadoutBoardMOSAIC> myMOSAIC = dynamic_pointer_cast<TReadoutBoardMOSAIC>(fDevice->GetBoard( iboard ));
+        if ( myMOSAIC ) {
+            boardDecoder.SetFirmwareVersion( myMOSAIC->GetFwIdString() );
+        }
+        shared_ptr<TReadoutBoardReplay> myReplay = dynamic_pointer_cast<TReadoutBoardReplay>(fDevice->GetBoard( iboard ));
+        if ( myReplay ) {
+            boardDecoder.SetFirmwareVersion( myReplay->GetFwIdString() );
+        }
+    }
+                
+    // decode readout board event
+    boardDecoder.DecodeEvent( buffer, nBytes, n_bytes_header, n_bytes_trailer );
+    if ( boardDecoder.GetMosaicDecoder10b8bError() ) {
+        fErrorCounter->IncrementN8b10b( boardDecoder.GetMosaicChannel() );
+    }
+    if ( boardDecoder.GetMosaicTimeout() ) {
+        fErrorCounter->IncrementNTimeout();
+    }
+    if ( boardDecoder.GetMosaicEventOverSizeError() ) {
+        fErrorCounter->IncrementNEventOverSizeError();
+    }
+
+    if ( GetVerboseLevel() > kVERBOSE ) {
+        cout << "TDeviceHitScan::DecodeBoardEvent() - board "
+        << std::dec << uniqueBoardId
+        << " , event with length " << nBytes << endl;
+        for ( int iByte = 0; iByte < nBytes; ++iByte ) {
+            printf ("%02x ", (int) buffer[iByte]);
+        }
+        cout << endl;
+    }
+    
+    // decode Chip event
+    int n_bytes_chipevent = nBytes-n_bytes_header;// - n_bytes_trailer;
+    if ( boardDecoder.GetMosaicEoeCount() < 2) {
+        n_bytes_chipevent -= n_bytes_trailer;
+    }
+    bool isOk = chipDecoder.DecodeEvent(buffer + n_bytes_header, n_bytes_chipevent,
+                                          iboard,
+                                          boardDecoder.GetMosaicChannel(),
+                                          trgNum, trgTime );
+    
+    if ( !isOk ) {
+        if ( GetVerboseLevel() > kSILENT ) {
+            cout << "TDeviceHitScan::DecodeBoardEvent() - board "
+            << std::dec << uniqueBoardId
+            << " , found bad event " << endl;
+        }
+        fErrorCounter->IncrementNCorruptEvent();
+        nBad++;
+        if ( nBad > TDeviceHitScan::MAXNBAD ) return isOk;
+        FILE* fDebug = fopen ("../../data/DebugData.dat", "a");
+        if ( fDebug ) {
+            for ( int iByte=0; iByte<nBytes; ++iByte ) {
+                fprintf (fDebug, "%02x ", (int) buffer[iByte]);
+            }
+            fprintf(fDebug, "\nFull Event:\n");
+            for (unsigned int ibyte = 0; ibyte < fDebugBuffer.size(); ibyte ++) {
+                fprintf (fDebug, "%02x ", (int) fDebugBuffer.at(ibyte));
+            }
+            fprintf(fDebug, "\n\n");
+            fclose( fDebug );
+        }
+    }
+    return isOk;
 }
 
 //___________________________________________________________________
@@ -302,7 +841,19 @@ void TDeviceHitScan::StartReadout()
         
         shared_ptr<TReadoutBoardMOSAIC> myMOSAIC = dynamic_pointer_cast<TReadoutBoardMOSAIC>(myBoard);
         
-        myMOSAIC->StartRun();
+        shared_ptr<TReadoutBoardReplay> myReplay = dynamic_pointer_cast<TReadoutBoardReplay>(myBoard);
+        
+        if ( myMOSAIC ) {
+            myMOSAIC->StartRun();
+        }
+        if ( myReplay ) {
+            myReplay->StartRun();
+        }
+    }
+    // the trigger records are numbered from the start of the run
+    fPendingFragments.assign( fDevice->GetNBoards(false), deque<TPendingFragment>() );
+    if ( fEventBuilder && !fEventBuilder->IsRunning() ) {
+        fEventBuilder->Start();
     }
 }
 
@@ -315,12 +866,34 @@ void TDeviceHitScan::StopReadout()
         
         shared_ptr<TReadoutBoardDAQ> myDAQBoard = dynamic_pointer_cast<TReadoutBoardDAQ>(fDevice->GetBoard( iboard ));
         
+        shared_ptr<TReadoutBoardReplay> myReplay = dynamic_pointer_cast<TReadoutBoardReplay>(fDevice->GetBoard( iboard ));
+        
         if ( myMOSAIC ) {
             myMOSAIC->StopRun();
         }
+        if ( myReplay ) {
+            myReplay->StopRun();
+        }
         if ( myDAQBoard ) {
             myDAQBoard->PowerOff();
         }
     }
+    // the events drained at the end of the run go through the same path as the others
+    ReadDrainedEvents();
+    // last snapshot of the live monitoring, with all hits of the scan
+    for ( unsigned int iboard = 0; iboard < fDevice->GetNBoards(false); iboard++ ) {
+        PublishMonitorSnapshot( iboard, true );
+    }
+    // the remaining fragments are built before the raw event file is closed
+    if ( fEventBuilder ) {
+        try {
+            fEventBuilder->Stop();
+        } catch ( exception& err ) {
+            cerr << err.what() << endl;
+        }
+    }
+    if ( fRawEventWriter ) {
+        fRawEventWriter->Close();
+    }
 }
 
@@ -10,12 +10,16 @@
  *
  */
 
+#include <cstdint>
+#include <deque>
 #include <memory>
 #include <string.h>
 #include <vector>
 #include "TDeviceChipVisitor.h"
 #include "Common.h"
 #include "TMultiDeviceOperator.h"
+#include "TEventBuilder.h"
+#include "TTimingReport.h"
 
 class TScanConfig;
 class TScanHisto;
@@ -24,6 +28,8 @@ class TAlpideDecoder;
 class TBoardDecoder;
 class TDevice;
 class TStorePixHit;
+class TRawEventWriter;
+class TMonitorPublisher;
 
 class TDeviceHitScan : public TDeviceChipVisitor {
     
@@ -34,6 +40,47 @@ protected:
 
     /// max number of bad chip events per chip for each injection
     static const unsigned int MAXNBAD = 10;
+
+    /// min time (in ms) without any new event before giving up on a board
+    static const unsigned int MINIDLETIME = 2;
+
+    /// max time (in ms) allowed to read the events of all boards for each injection
+    static const unsigned int MAXREADTIME = 5000;
+
+    /// size in bytes of the buffer receiving one event from a readout board
+    static const unsigned int READBUFFERSIZE = 1024*4000;
+
+    /// fraction of hit pixels above which a sparse histogram shard of a chip becomes dense
+    static constexpr double MAXSHARDDENSITY = 0.25;
+
+    /// raw events fetched from one readout board
+    struct TBoardEvents {
+        /// data of all events, one after the other
+        std::vector<unsigned char> data;
+        /// size in bytes of each event
+        std::vector<int> size;
+        /// trigger number of each event (from the trigger recorder, if any)
+        std::vector<std::uint32_t> trgNum;
+        /// trigger time of each event (from the trigger recorder, if any)
+        std::vector<std::uint64_t> trgTime;
+        /// true if the board did not give all the expected events in time
+        bool timeout = false;
+    };
+
+    /// chip event read before the record of its trigger, given to the event builder once resolved
+    struct TPendingFragment {
+        /// row of the trigger record in the trigger table of the board
+        std::uint64_t ordinal;
+        std::vector<unsigned char> data;
+    };
+
+    /// decoders and private histograms of one readout board, used to decode the boards in parallel
+    struct TBoardLane {
+        std::unique_ptr<TBoardDecoder> boardDecoder;
+        std::unique_ptr<TAlpideDecoder> chipDecoder;
+        /// histograms of the chips of the board, merged into fScanHisto by MergeBoardLanes()
+        std::shared_ptr<TScanHisto> histoShard;
+    };
                 
     /// scan configuration
     std::shared_ptr<TScanConfig> fScanConfig;
@@ -62,6 +109,39 @@ protected:
     /// part (prefix) of the name of the output files
     std::string fName;
 
+    /// bool used to decide if ones wants to record the raw events in a binary file
+    bool fRecordRawEvents;
+
+    /// binary file with all raw events read from the readout boards
+    std::unique_ptr<TRawEventWriter> fRawEventWriter;
+
+    /// one decoding lane per readout board (empty if the boards are decoded by this thread only)
+    std::vector<TBoardLane> fBoardLanes;
+
+    /// one read buffer per readout board, reused by each FetchBoardEvents() of the board
+    std::vector<std::vector<unsigned char>> fReadBuffers;
+
+    /// bool used to decide if ones wants to assemble the events of all boards by trigger number
+    bool fBuildEvents;
+
+    /// builder of the multi-board events, fed by the threads reading the boards in parallel
+    std::unique_ptr<TEventBuilder> fEventBuilder;
+
+    /// chip events of each board waiting for their trigger record (used by the thread of the board only)
+    std::vector<std::deque<TPendingFragment>> fPendingFragments;
+
+    /// functions given to the event builder for each built event (e.g. monitoring)
+    std::vector<TEventBuilder::TEventHandler> fBuiltEventHandlers;
+
+    /// name of the shared memory segment of the live monitoring (none if empty)
+    std::string fMonitorSegmentName;
+
+    /// live snapshots of the hit maps and error counters for a separate monitor process
+    std::unique_ptr<TMonitorPublisher> fMonitorPublisher;
+
+    /// time spent in each phase of the scan
+    std::shared_ptr<TTimingReport> fTimingReport;
+
 public:
     
     /// constructor
@@ -77,6 +157,18 @@ public:
 
     /// enable the use of a TTree to gather the pixel hits
     void SetActivateTTree( const bool en ) { fProduceTTree = en; }
+
+    /// enable the recording of the raw events in a binary file (see TRawEventWriter)
+    void SetRecordRawEvents( const bool en ) { fRecordRawEvents = en; }
+
+    /// enable the assembly of the events of all boards by trigger number (see TEventBuilder)
+    void SetBuildEvents( const bool en ) { fBuildEvents = en; }
+
+    /// add a function called for each multi-board event (before Init() only)
+    void AddBuiltEventHandler( TEventBuilder::TEventHandler handler );
+
+    /// enable the live monitoring in a shared memory segment with a given name (see TMonitorPublisher)
+    void SetMonitorSegment( const std::string name ) { fMonitorSegmentName = name; }
     
     /// set the scan configuration
     void SetScanConfig( std::shared_ptr<TScanConfig> aScanConfig );
@@ -105,8 +197,11 @@ public:
     /// draw and save hit map or distributions
     virtual void DrawAndSaveToFile() = 0;
 
-    /// return the current number of hits seen by the alpide decoder
+    /// return the current number of hits seen by the alpide decoders of all boards
     unsigned int GetNHits() const;
+
+    /// time spent in each phase of the scan
+    std::shared_ptr<TTimingReport> GetTimingReport() const { return fTimingReport; }
     
 protected:
     
@@ -124,6 +219,53 @@ protected:
     
     /// read data from a given readout board, for a given number of triggers (all if 0 is asked)
     unsigned int ReadEventData( const unsigned int iboard, int nTriggers = 0 );
+
+    /// read data from all readout boards at once, for a given number of triggers (all if 0 is asked)
+    void ReadAllBoardsEventData( int nTriggers = 0 );
+
+    /// fetch the raw events of a given readout board until the expected number is reached (or timeout),
+    /// within maxReadTime ms (no limit if 0); once the run is stopped, until the board has no event left
+    void FetchBoardEvents( const unsigned int iboard, const unsigned int nEvents,
+                           TBoardEvents& events, const unsigned int maxReadTime = MAXREADTIME,
+                           const bool runStopped = false );
+
+    /// read and decode the events drained from the MOSAIC boards at the end of the run
+    void ReadDrainedEvents();
+
+    /// give to the event builder the pending fragments of a board whose trigger record is now in the table
+    void AddResolvedFragments( const unsigned int iboard, const TTriggerTable& table );
+
+    /// decode one event of a given readout board, return false if the chip event is corrupted
+    bool DecodeBoardEvent( const unsigned int iboard, unsigned char* buffer, const int nBytes,
+                           const std::uint32_t trgNum, const std::uint64_t trgTime,
+                           unsigned int& nBad );
+
+    /// decode the events fetched from a given readout board, with its own lane if any
+    void DecodeBoardEvents( const unsigned int iboard, TBoardEvents& events );
+
+    /// create the decoding lanes if the boards can be decoded in parallel, return true if so
+    bool PrepareBoardLanes();
+
+    /// allocate the read buffer of each board once (before the boards are read in parallel)
+    void PrepareReadBuffers();
+
+    /// merge the histogram shards of the decoding lanes into fScanHisto (at stage or scan end)
+    void MergeBoardLanes();
+
+    /// create the event builder of the boards, with the raw event file as storage if any
+    void InitEventBuilder();
+
+    /// publish the live snapshot of the chips of a board if it is time to (from the thread decoding the board)
+    void PublishMonitorSnapshot( const unsigned int iboard, const bool force = false );
+
+    /// send a given number of triggers to all boards
+    void TriggerAllBoards( const int nTriggers );
+
+    /// write the timing report of the scan next to its data files (at the end of Terminate())
+    void WriteTimingReport();
+
+    /// write the trace of the parser and decoder hot loops next to the data files (needs -DHOT_TRACE=ON)
+    void WriteHotTrace();
     
     /// start the readout
     void StartReadout();
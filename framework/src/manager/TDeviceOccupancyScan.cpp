@@ -11,10 +11,14 @@
 #include "TReadoutBoardDAQ.h"
 #include "TReadoutBoardMOSAIC.h"
 #include "TScanConfig.h"
-#include <stdexcept>
-#include <iostream>
 #include <bitset>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
 #include <string.h>
+#include <thread>
 
 using namespace std;
 
@@ -72,31 +76,123 @@ void TDeviceOccupancyScan::Go()
 
     const int nTrains = fNTriggers / fNTriggersPerTrain;
     const int nRest   = fNTriggers % fNTriggersPerTrain;
-    int nTrigsThisTrain = 0;
 
     cout << "TDeviceOccupancyScan::Go() - fNTriggers: " << fNTriggers << endl;
     cout << "TDeviceOccupancyScan::Go() - fNTriggersPerTrain: " << fNTriggersPerTrain << endl;
     cout << "TDeviceOccupancyScan::Go() - nTrains: " << nTrains << endl;
     cout << "TDeviceOccupancyScan::Go() - nRest: " << nRest << endl;
 
+    vector<int> trains( nTrains, fNTriggersPerTrain );
+    if ( nRest ) trains.push_back( nRest );
+    const unsigned int nBoards = fDevice->GetNBoards(false);
+
+    // in master/slave mode, the master triggers all boards: the trains are sent together
+    bool isMasterSlave = false;
+    for ( unsigned int ib = 0; ib < nBoards; ib++ ) {
+        shared_ptr<TBoardConfigMOSAIC> myMOSAICconfig = dynamic_pointer_cast<TBoardConfigMOSAIC>(fDevice->GetBoardConfig( ib ));
+        if ( myMOSAICconfig && myMOSAICconfig->IsMasterSlaveModeOn() ) isMasterSlave = true;
+    }
+
+    // Pipeline of the trains: one thread per board fetches the events of each train sent
+    // to its board, while this thread sends the next trains and decodes the trains already
+    // fetched (unless each board has its own decoding lane: then the reading thread of a
+    // board decodes its trains). The pulser of a board runs one train at a time (a new
+    // train replaces the pulse count of the running one), so a board gets its next train
+    // only once the previous one is fetched, and as long as it has less than
+    // MAXTRAINSINFLIGHT trains not yet decoded: the trains overlap across the boards.
+    struct TFetchedTrain {
+        unsigned int iboard;
+        TBoardEvents events;
+    };
+    const bool useLanes = PrepareBoardLanes();
+    PrepareReadBuffers();
+    mutex mtx;
+    condition_variable trainSent, trainFetched;
+    deque<TFetchedTrain> fetched;
+    vector<unsigned int> nSent( nBoards, 0 ), nFetched( nBoards, 0 ), nDecoded( nBoards, 0 );
+
+    vector<thread> readingThreads;
+    for ( unsigned int ib = 0; ib < nBoards; ib++ ) {
+        readingThreads.push_back( thread( [&, ib]() {
+            for ( unsigned int itrain = 0; itrain < trains.size(); itrain++ ) {
+                {
+                    unique_lock<mutex> lock( mtx );
+                    trainSent.wait( lock, [&]() { return nSent.at(ib) > itrain; } );
+                }
+                TFetchedTrain train;
+                train.iboard = ib;
+                FetchBoardEvents( ib, trains.at(itrain) * fDevice->GetNWorkingChipsPerBoard( ib ),
+                                  train.events, 0 );
+                if ( useLanes ) {
+                    DecodeBoardEvents( ib, train.events );
+                    PublishMonitorSnapshot( ib );
+                }
+                lock_guard<mutex> lock( mtx );
+                fetched.push_back( std::move( train ) );
+                nFetched.at(ib)++;
+                trainFetched.notify_one();
+            }
+        } ) );
+    }
+
+    const unsigned int nTotal = trains.size() * nBoards;
+    for ( unsigned int iDecoded = 0; iDecoded < nTotal; iDecoded++ ) {
 
-    for ( int itrain = 0; itrain <= nTrains; itrain ++ ) { 
+        // send the next train to the boards whose pulser is idle and with some credit left
+        vector<unsigned int> boardsToTrigger;
+        {
+            lock_guard<mutex> lock( mtx );
+            auto canSend = [&]( const unsigned int ib ) {
+                return ( nSent.at(ib) < trains.size() )
+                    && ( nSent.at(ib) == nFetched.at(ib) )
+                    && ( nSent.at(ib) - nDecoded.at(ib) < MAXTRAINSINFLIGHT );
+            };
+            bool allCanSend = true;
+            for ( unsigned int ib = 0; ib < nBoards; ib++ ) {
+                if ( canSend( ib ) ) {
+                    boardsToTrigger.push_back( ib );
+                } else {
+                    allCanSend = false;
+                }
+            }
+            // in master/slave mode, the boards are triggered together
+            if ( isMasterSlave && !allCanSend ) boardsToTrigger.clear();
+        }
+        // the trigger phase is only timed when a train is actually sent, and the trains
+        // are sent without holding the lock: each one is a round trip to its board
+        if ( !boardsToTrigger.empty() ) {
+            TTimingSpan span( fTimingReport.get(), TTimingReport::kTRIGGER );
+            for ( unsigned int i = 0; i < boardsToTrigger.size(); i++ ) {
+                const unsigned int ib = boardsToTrigger.at(i);
+                (fDevice->GetBoard( ib ))->Trigger( trains.at( nSent.at(ib) ) );
+            }
+            lock_guard<mutex> lock( mtx );
+            for ( unsigned int i = 0; i < boardsToTrigger.size(); i++ ) {
+                nSent.at( boardsToTrigger.at(i) )++;
+            }
+            trainSent.notify_all();
+        }
 
-        cout << "TDeviceOccupancyScan::Go() - trains: " << itrain << endl;   
-        if ( itrain == nTrains ) {
-            nTrigsThisTrain = nRest;
-        } else {
-            nTrigsThisTrain = fNTriggersPerTrain;
+        // decode the oldest train fetched
+        TFetchedTrain train;
+        {
+            unique_lock<mutex> lock( mtx );
+            trainFetched.wait( lock, [&]() { return !fetched.empty(); } );
+            train = std::move( fetched.front() );
+            fetched.pop_front();
         }
-        // Send triggers for all boards
-        for ( unsigned int ib = 0; ib < fDevice->GetNBoards(false); ib++ ) {
-            (fDevice->GetBoard( ib ))->Trigger(nTrigsThisTrain);
-        } 
-        // Read data for all boards
-        for ( unsigned int ib = 0; ib < fDevice->GetNBoards(false); ib++ ) {
-            ReadEventData( ib,  nTrigsThisTrain );
+        if ( !useLanes ) {
+            DecodeBoardEvents( train.iboard, train.events );
+            PublishMonitorSnapshot( train.iboard );
         }
+        lock_guard<mutex> lock( mtx );
+        nDecoded.at( train.iboard )++;
     } // end of loop on trigger trains
+
+    for ( auto &t : readingThreads ) {
+        t.join();
+    }
+    if ( useLanes ) MergeBoardLanes();
 }
 
 //___________________________________________________________________
@@ -105,6 +201,8 @@ void TDeviceOccupancyScan::Terminate()
     TDeviceChipVisitor::Terminate();
     cout << endl;
     fErrorCounter->Dump();
+    WriteTimingReport();
+    WriteHotTrace();
 }
 
 //___________________________________________________________________
@@ -158,6 +256,8 @@ void TDeviceOccupancyScan::AddHisto()
     THisto histo ("NoiseScanHisto", "NoiseScanHisto",
                   common::MAX_DCOL+1, 0, common::MAX_DCOL,
                   common::MAX_ADDR+1, 0, common::MAX_ADDR);
+    // most pixels never fire in a noise occupancy scan: only the hit pixels are stored
+    histo.SetSparse( MAXSPARSEDENSITY );
     
     for ( unsigned int ichip = 0; ichip < fDevice->GetNChips(); ichip++ ) {
         if ( fDevice->GetChipConfig(ichip)->IsEnabled() ) {
@@ -27,6 +27,12 @@ class THitMapView;
 class TDeviceOccupancyScan : public TDeviceHitScan {
     
 protected:
+    
+    /// max number of trains sent to a board and not yet decoded (buffer credit of a board)
+    static const unsigned int MAXTRAINSINFLIGHT = 2;
+    
+    /// fraction of hit pixels above which the sparse hit map of a chip becomes dense
+    static constexpr double MAXSPARSEDENSITY = 0.05;
         
     /// number of triggers per train
     int fNTriggersPerTrain;
@@ -1,5 +1,6 @@
 #include "TAlpideDecoder.h"
 #include "AlpideDictionary.h"
+#include "TAlpide.h"
 #include "TBoardDecoder.h"
 #include "TChipConfig.h"
 #include "Common.h"
@@ -11,10 +12,18 @@
 #include "TReadoutBoard.h"
 #include "TScanConfig.h"
 #include "TSCurveAnalysis.h"
+#include "TSCurveHisto.h"
+#include "TSCurveDataFile.h"
+#include "TTaskPool.h"
+#include <algorithm>
 #include <stdexcept>
 #include <iostream>
 #include <bitset>
 #include <string.h>
+#include <thread>
+
+// ROOT includes
+#include "TROOT.h"
 
 using namespace std;
 
@@ -24,7 +33,9 @@ TDeviceMaskScan(),
 fChargeStart( 0 ),
 fChargeStep( 0 ),
 fChargeStop( 0 ),
-fNChargeSteps( 0 )
+fNChargeSteps( 0 ),
+fSCurveHisto( nullptr ),
+fFitPool( nullptr )
 {
     
 }
@@ -36,13 +47,15 @@ TDeviceMaskScan( aDevice, aScanConfig ),
 fChargeStart( 0 ),
 fChargeStep( 0 ),
 fChargeStop( 0 ),
-fNChargeSteps( 0 )
+fNChargeSteps( 0 ),
+fSCurveHisto( nullptr ),
+fFitPool( nullptr )
 { }
 
 //___________________________________________________________________
 TDeviceThresholdScan::~TDeviceThresholdScan()
 {
-    fHistoQue.clear();
+    fFitPool.reset();
     fAnalyserCollection.clear();
 }
 
@@ -55,17 +68,26 @@ void TDeviceThresholdScan::Init()
         cerr << err.what() << endl;
         exit( EXIT_FAILURE );
     }
-    fScanHisto = fHistoQue.front();
-    if ( !fScanHisto ) {
-        throw runtime_error( "TDeviceThresholdScan::Init() - can not use a null pointer for the map of scan histo !" );
+    if ( !fSCurveHisto ) {
+        throw runtime_error( "TDeviceThresholdScan::Init() - can not use a null pointer for the S-curve storage !" );
     }
-    fChipDecoder->SetScanHisto( fScanHisto );
-    fErrorCounter->Init( fScanHisto, fNTriggers );
+    fChipDecoder->SetSCurveHisto( fSCurveHisto );
     
+    // S-curves are fitted in background threads during the acquisition
+    ROOT::EnableThreadSafety();
     for ( unsigned int ichip = 0; ichip < fDevice->GetNWorkingChips(); ichip++ ) {
         common::TChipIndex aChipIndex = fDevice->GetWorkingChipIndex( ichip );
         AddChipSCurveAnalyzer( aChipIndex );
     }
+    unsigned int nThreads = thread::hardware_concurrency();
+    if ( (nThreads < 1) || (nThreads > fSCurveHisto->GetChipListSize()) ) {
+        nThreads = fSCurveHisto->GetChipListSize() ? fSCurveHisto->GetChipListSize() : 1;
+    }
+    fFitPool.reset( new TTaskPool( nThreads ) );
+    if ( GetVerboseLevel() > kTERSE ) {
+        cout << "TDeviceThresholdScan::Init() - " << std::dec << fFitPool->GetNThreads()
+             << " thread(s) for the S-curve fits" << endl;
+    }
 }
 
 //___________________________________________________________________
@@ -74,6 +96,9 @@ void TDeviceThresholdScan::SetVerboseLevel( const int level )
     for ( std::map<int, shared_ptr<TSCurveAnalysis>>::iterator it = fAnalyserCollection.begin(); it != fAnalyserCollection.end(); ++it ) {
         ((*it).second)->SetVerboseLevel( level );
     }
+    if ( fSCurveHisto ) {
+        fSCurveHisto->SetVerboseLevel( level );
+    }
     TDeviceMaskScan::SetVerboseLevel( level );
 }
 
@@ -91,37 +116,44 @@ void TDeviceThresholdScan::Go()
     
     unsigned int nHitsPerStage = 0, nHitsLastStage = 0;
 
+    // expected number of pulsed pixels per chip in each mask stage
+    const unsigned int nPixPerStage = (common::MAX_REGION+1) * (unsigned int)fNPixPerRegion;
+
     for ( int istage = 0; istage < fNMaskStages; istage ++ ) { //---------------- loop on pixels
         
         if ( GetVerboseLevel() > kSILENT ) {
             cout << "TDeviceThresholdScan::Go() - Mask stage "
             << std::dec << istage << endl;
         }
-        DoConfigureMaskStage( fNPixPerRegion, istage );
+        {
+            TTimingSpan span( fTimingReport.get(), TTimingReport::kCONFIGURE );
+            DoConfigureMaskStage( fNPixPerRegion, istage );
+        }
         unsigned int deltaV = fChargeStart;
 
         if ( istage ) {
-            nHitsLastStage = fChipDecoder->GetNHits();
+            nHitsLastStage = GetNHits();
         }
+        fSCurveHisto->StartStage( nPixPerStage );
 
         for ( unsigned int iampl = 0; iampl < fNChargeSteps; iampl++ ) { //-- loop on VPulse low
             
             if ( deltaV >= fChargeStop ) { break; }
             // use current charge
-            DoConfigureVPulseLow( deltaV );
-            // Send triggers for all boards
-            for ( unsigned int ib = 0; ib < fDevice->GetNBoards(false); ib++ ) {
-                (fDevice->GetBoard( ib ))->Trigger(fNTriggers);
+            {
+                TTimingSpan span( fTimingReport.get(), TTimingReport::kCONFIGURE );
+                DoConfigureVPulseLow( deltaV );
             }
+            // Send triggers for all boards
+            TriggerAllBoards( fNTriggers );
             try {
-                fScanHisto = fHistoQue.at( iampl );
+                fSCurveHisto->SetChargeStep( iampl );
             } catch ( std::exception &err ) {
                 cerr << "TDeviceThresholdScan::Go() - Error, stage "
                      << std::dec << istage << " , iampl " << iampl
                      << " , " << err.what() << endl;
                 exit( EXIT_FAILURE );
             }
-            fChipDecoder->SetScanHisto( fScanHisto );
             // Read data for all boards
             for ( unsigned int ib = 0; ib < fDevice->GetNBoards(false); ib++ ) {
                 ReadEventData( ib );
@@ -131,7 +163,14 @@ void TDeviceThresholdScan::Go()
             usleep(1000);
         } //---------------------------------------------------------- end of loop on VPulse low
         
-        nHitsPerStage = fChipDecoder->GetNHits() - nHitsLastStage;
+        // fit the S-curves of this stage while the next stages are acquired,
+        // then merge its hits into the S-curves of all pulsed pixels
+        {
+            TTimingSpan span( fTimingReport.get(), TTimingReport::kANALYSIS );
+            SubmitStageFits( istage );
+            fSCurveHisto->EndStage();
+        }
+        nHitsPerStage = GetNHits() - nHitsLastStage;
         if ( GetVerboseLevel() > kSILENT ) {
             cout << "TDeviceThresholdScan::Go() - stage "
             << std::dec << istage << " , found n hits = " << nHitsPerStage << endl;
@@ -155,20 +194,7 @@ unsigned int TDeviceThresholdScan::GetHits( const common::TChipIndex aChipIndex,
     if ( iampl >= fNChargeSteps ) {
         throw domain_error( "TDeviceThresholdScan::GetHits() - bad amplification step" );
     }
-    double hits = 0;
-    try {
-        fScanHisto = fHistoQue.at( iampl );
-    } catch ( std::exception &err ) {
-        cerr << "TDeviceThresholdScan::GetHits() - Error, icol "
-        << std::dec << icol << " , iaddr " << iaddr
-        << " , iampl " << iampl << err.what() << endl;
-        exit( EXIT_FAILURE );
-    }
-    hits = (*fScanHisto)(aChipIndex,icol,iaddr);
-    if ( hits < 0 ) {
-        hits = 0;
-    }
-    return (unsigned int)hits;
+    return fSCurveHisto->GetHits( aChipIndex, icol, iaddr, iampl );
 }
 
 //___________________________________________________________________
@@ -193,9 +219,17 @@ unsigned int TDeviceThresholdScan::GetInjectedCharge( const unsigned int iampl )
 void TDeviceThresholdScan::Terminate()
 {
     TDeviceChipVisitor::Terminate();
-    AnalyzeData();
+    {
+        TTimingSpan span( fTimingReport.get(), TTimingReport::kANALYSIS );
+        AnalyzeData();
+    }
+    for ( std::map<int, shared_ptr<TSCurveAnalysis>>::iterator it = fAnalyserCollection.begin(); it != fAnalyserCollection.end(); ++it ) {
+        ((*it).second)->Dump();
+    }
     cout << endl;
     fErrorCounter->Dump();
+    WriteTimingReport();
+    WriteHotTrace();
 }
 
 //___________________________________________________________________
@@ -207,8 +241,9 @@ void TDeviceThresholdScan::DrawAndSaveToFile()
     if ( !fIsTerminated ) {
         throw runtime_error( "TDeviceThresholdScan::DrawAndSaveToFile() - not terminated ! Please use Terminate() first." );
     }
+    // the S-curves are read back from the raw data files, see WriteDataToFile()
     for ( std::map<int, shared_ptr<TSCurveAnalysis>>::iterator it = fAnalyserCollection.begin(); it != fAnalyserCollection.end(); ++it ) {
-        ((*it).second)->DrawDistributions();
+        ((*it).second)->DrawDistributions( fName.c_str() );
         ((*it).second)->SaveToFile( fName.c_str() );
     }
 }
@@ -222,8 +257,8 @@ void TDeviceThresholdScan::WriteDataToFile( bool Recreate )
     if ( !fIsTerminated ) {
         throw runtime_error( "TDeviceThresholdScan::WriteDataToFile() - not terminated ! Please use Terminate() first." );
     }
-    if ( !fHistoQue.size() ) {
-        throw runtime_error( "TDeviceThresholdScan::WriteDataToFile() - histo deque is empty !" );
+    if ( !fNChargeSteps ) {
+        throw runtime_error( "TDeviceThresholdScan::WriteDataToFile() - no step of injected charge !" );
     }
     
     char  fNameChip[100];
@@ -263,61 +298,85 @@ void TDeviceThresholdScan::WriteDataToFile( bool Recreate )
         }
         TPixHit pixhit;
         pixhit.SetPixChipIndex( aChipIndex ); 
-        for ( unsigned int icol = 0; icol <= common::MAX_DCOL; icol ++ ) {
-            for ( unsigned int iaddr = 0; iaddr <= common::MAX_ADDR; iaddr ++ ) {
-                pixhit.SetDoubleColumn( icol );
-                pixhit.SetAddress( iaddr );
-                unsigned int column = pixhit.GetColumn();
-                unsigned int row = pixhit.GetRow();
-                double hits_at_max_charge = GetHits( aChipIndex, icol, iaddr, fNChargeSteps - 1 );
-                for ( unsigned int iampl = 0; iampl < fNChargeSteps; iampl ++ ) {
-                    double hits = GetHits( aChipIndex, icol, iaddr, iampl );
-                    // also write zero hit for pixels who are responding at max injected charge
-                    if ( (hits_at_max_charge > 0) || (hits > 0) ) {
-                        fprintf(fp, "%d %d %d %d\n",
-                                row, column, GetInjectedCharge(iampl), (int)hits);
-                    }
+        // only pixels with at least one hit are stored, in (dcol, address) order
+        vector<uint32_t> pixels;
+        fSCurveHisto->GetPixelList( aChipIndex, pixels );
+        for ( unsigned int ipix = 0; ipix < pixels.size(); ipix++ ) {
+            const unsigned int icol = TSCurveHisto::GetDoubleColumn( pixels.at(ipix) );
+            const unsigned int iaddr = TSCurveHisto::GetAddress( pixels.at(ipix) );
+            pixhit.SetDoubleColumn( icol );
+            pixhit.SetAddress( iaddr );
+            unsigned int column = pixhit.GetColumn();
+            unsigned int row = pixhit.GetRow();
+            double hits_at_max_charge = GetHits( aChipIndex, icol, iaddr, fNChargeSteps - 1 );
+            for ( unsigned int iampl = 0; iampl < fNChargeSteps; iampl ++ ) {
+                double hits = GetHits( aChipIndex, icol, iaddr, iampl );
+                // also write zero hit for pixels who are responding at max injected charge
+                if ( (hits_at_max_charge > 0) || (hits > 0) ) {
+                    fprintf(fp, "%d %d %d %d\n",
+                            row, column, GetInjectedCharge(iampl), (int)hits);
                 }
             }
         }
         if (fp) fclose (fp);
+
+        // same S-curves in binary form, for the offline fitter (see TSCurveFitter)
+        TSCurveDataFile::TData data;
+        data.nInjections = fNTriggers;
+        for ( unsigned int iampl = 0; iampl < fNChargeSteps; iampl ++ ) {
+            data.charges.push_back( GetInjectedCharge( iampl ) );
+        }
+        data.pixels = pixels;
+        data.counts.reserve( pixels.size() * fNChargeSteps );
+        for ( unsigned int ipix = 0; ipix < pixels.size(); ipix++ ) {
+            for ( unsigned int iampl = 0; iampl < fNChargeSteps; iampl ++ ) {
+                data.counts.push_back( GetHits( aChipIndex, TSCurveHisto::GetDoubleColumn( pixels.at(ipix) ),
+                                                TSCurveHisto::GetAddress( pixels.at(ipix) ), iampl ) );
+            }
+        }
+        TSCurveDataFile::Write( common::GetFileName( aChipIndex, suffix, "", ".scurve" ), data );
+        
+        // threshold, noise and chi2/ndf of each fitted pixel
+        int int_index = common::GetMapIntIndex( aChipIndex );
+        if ( fAnalyserCollection.count( int_index ) ) {
+            fAnalyserCollection.at( int_index )->WriteResultsToFile( fName.c_str() );
+        }
     }
 }
 
 //___________________________________________________________________
 void TDeviceThresholdScan::AddHisto()
 {
-    unsigned int currentCharge = fChargeStart;
+    // the map of histograms only provides the list of enabled chips (e.g. to
+    // the error counter): the hits are stored in the sparse S-curve storage
+    fScanHisto = make_shared<TScanHisto>();
+    fSCurveHisto = make_shared<TSCurveHisto>();
+    fSCurveHisto->SetVerboseLevel( GetVerboseLevel() );
+    common::TChipIndex id;
+    THisto histo;
     
-    while ( currentCharge < fChargeStop ) {
-        
-        auto aScanHisto = make_shared<TScanHisto>();
-        common::TChipIndex id;
-        // histo for a given value of the injected charge
-        THisto histo ("ThrScanHisto", "ThrScanHisto",
-                      common::MAX_DCOL+1, 0, common::MAX_DCOL,
-                      common::MAX_ADDR+1, 0, common::MAX_ADDR);
-        
-        for ( unsigned int ichip = 0; ichip < fDevice->GetNChips(); ichip++ ) {
-            if ( fDevice->GetChipConfig(ichip)->IsEnabled() ) {
-                id.boardIndex   = fDevice->GetBoardIndexByChip(ichip);
-                id.dataReceiver = fDevice->GetChipConfig(ichip)->GetParamValue("RECEIVER");
-                id.deviceType   = fDevice->GetDeviceType();
-                id.deviceId     = fDevice->GetDeviceId();
-                id.chipId       = fDevice->GetChipId(ichip);
-                aScanHisto->AddHisto( id, histo );
-            }
-        }
-        aScanHisto->FindChipList();
-        if ( GetVerboseLevel() > kCHATTY ) {
-            cout << endl << "TDeviceThresholdScan::AddHisto() - generated map with " << std::dec << aScanHisto->GetSize() << " elements" << endl;
+    for ( unsigned int ichip = 0; ichip < fDevice->GetNChips(); ichip++ ) {
+        if ( fDevice->GetChipConfig(ichip)->IsEnabled() ) {
+            id.boardIndex   = fDevice->GetBoardIndexByChip(ichip);
+            id.dataReceiver = fDevice->GetChipConfig(ichip)->GetParamValue("RECEIVER");
+            id.deviceType   = fDevice->GetDeviceType();
+            id.deviceId     = fDevice->GetDeviceId();
+            id.chipId       = fDevice->GetChipId(ichip);
+            fScanHisto->AddHisto( id, histo );
+            fSCurveHisto->AddChip( id );
         }
-        fHistoQue.push_back( move(aScanHisto) );
+    }
+    fScanHisto->FindChipList();
+
+    unsigned int currentCharge = fChargeStart;
+    fNChargeSteps = 0;
+    while ( currentCharge < fChargeStop ) {
+        fNChargeSteps++;
         currentCharge += fChargeStep;
     }
-    fNChargeSteps = fHistoQue.size();
+    fSCurveHisto->SetNChargeSteps( fNChargeSteps );
     if ( GetVerboseLevel() > kSILENT ) {
-        cout << endl << "TDeviceThresholdScan::AddHisto() - generated deque with " << std::dec << fNChargeSteps << " elements" << endl;
+        cout << endl << "TDeviceThresholdScan::AddHisto() - S-curves with " << std::dec << fNChargeSteps << " steps for " << fSCurveHisto->GetChipListSize() << " chip(s)" << endl;
     }
 }
 
@@ -355,19 +414,10 @@ void TDeviceThresholdScan::InitScanParameters()
 //___________________________________________________________________
 bool TDeviceThresholdScan::HasData( const common::TChipIndex idx )
 {
-    unsigned int iampl = fNChargeSteps - 1;
-    try {
-        fScanHisto = fHistoQue.at( iampl );
-    } catch ( std::exception &err ) {
-        cerr << "TDeviceThresholdScan::HasData() - Error, iampl "
-        << std::dec << iampl << err.what() << endl;
-        exit( EXIT_FAILURE );
-    }
-    if ( !fScanHisto->IsValidChipIndex( idx ) ) {
+    if ( !fSCurveHisto->IsValidChipIndex( idx ) ) {
         return false;
     }
-    return fScanHisto->HasData( idx );
-    return false;
+    return fSCurveHisto->HasData( idx );
 }
 
 //___________________________________________________________________
@@ -384,49 +434,63 @@ void TDeviceThresholdScan::AddChipSCurveAnalyzer( const common::TChipIndex idx )
 void TDeviceThresholdScan::AnalyzeData()
 {
     if ( GetVerboseLevel() > kTERSE ) 
-        cout << "TDeviceThresholdScan::AnalyzeData() - start ... " << endl;
-    for ( unsigned int ichip = 0; ichip < fDevice->GetNWorkingChips(); ichip++ ) {
-        
-    if ( GetVerboseLevel() > kTERSE ) {
-        cout << "TDeviceThresholdScan::AnalyzeData() - working on chip " ;
-        common::DumpId(fDevice->GetWorkingChipIndex( ichip ));
-        cout << endl;
+        cout << "TDeviceThresholdScan::AnalyzeData() - waiting for the S-curve fits ... " << endl;
+    if ( !fFitPool ) {
+        throw runtime_error( "TDeviceThresholdScan::AnalyzeData() - no fit pool ! Please use Init() first." );
     }
-        common::TChipIndex chipIndex = fDevice->GetWorkingChipIndex( ichip );
+    fFitPool->Wait();
+    if ( GetVerboseLevel() > kTERSE ) 
+        cout << "TDeviceThresholdScan::AnalyzeData() - done" << endl;
+}
+
+//___________________________________________________________________
+void TDeviceThresholdScan::SubmitStageFits( const int istage )
+{
+    TPixHit pixhit;
+    for ( unsigned int ichip = 0; ichip < fSCurveHisto->GetChipListSize(); ichip++ ) {
         
-        for ( unsigned int icol = 0; icol <= common::MAX_DCOL; icol ++ ) {
-            for ( unsigned int iaddr = 0; iaddr <= common::MAX_ADDR; iaddr ++ ) {
-         
-                AnalyzePixelSCurve( chipIndex, icol, iaddr );
-                
+        common::TChipIndex chipIndex = fSCurveHisto->GetChipIndex( ichip );
+        if ( !fAnalyserCollection.count( common::GetMapIntIndex( chipIndex ) ) ) {
+            continue; // not a working chip
+        }
+        // the task owns a copy of the hits of the stage
+        vector<uint32_t> pixels, counts;
+        fSCurveHisto->GetStageData( chipIndex, pixels, counts );
+        // only the pixels pulsed by this stage are fitted, e.g. a noisy pixel firing in
+        // every stage is fitted once, in its own stage
+        unsigned int nPulsed = 0;
+        for ( unsigned int ipix = 0; ipix < pixels.size(); ipix++ ) {
+            pixhit.SetDoubleColumn( TSCurveHisto::GetDoubleColumn( pixels.at(ipix) ) );
+            pixhit.SetAddress( TSCurveHisto::GetAddress( pixels.at(ipix) ) );
+            if ( !TAlpide::IsPulsedInMaskStage( fNPixPerRegion, istage, pixhit.GetRow(), pixhit.GetColumn() ) ) {
+                continue;
             }
+            pixels.at( nPulsed ) = pixels.at( ipix );
+            copy( counts.begin() + ipix * fNChargeSteps, counts.begin() + (ipix + 1) * fNChargeSteps,
+                  counts.begin() + nPulsed * fNChargeSteps );
+            nPulsed++;
         }
-        
+        pixels.resize( nPulsed );
+        counts.resize( nPulsed * fNChargeSteps );
+        if ( pixels.empty() ) {
+            continue;
+        }
+        // one lane per chip: the analyzer of a chip is only used by one thread
+        fFitPool->Submit( ichip, [this, chipIndex, pixels, counts]() {
+            AnalyzePixelSCurves( chipIndex, pixels, counts );
+        } );
     }
 }
 
-
-
 //___________________________________________________________________
-void TDeviceThresholdScan::AnalyzePixelSCurve( const common::TChipIndex aChipIndex,
-                                              const unsigned int icol,
-                                              const unsigned int iaddr )
+void TDeviceThresholdScan::AnalyzePixelSCurves( const common::TChipIndex aChipIndex,
+                                               const vector<uint32_t>& pixels,
+                                               const vector<uint32_t>& counts )
 {
-    if ( !GetHits( aChipIndex, icol, iaddr, fNChargeSteps-1 ) ) {
-        // skip pixels that have no data (presumably not pulsed)
-        return;
-    }
-
-    int int_index = common::GetMapIntIndex( aChipIndex );
-    (fAnalyserCollection.at(int_index))->SetPixelCoordinates( icol, iaddr );
-
-    
+    shared_ptr<TSCurveAnalysis> analyzer = fAnalyserCollection.at( common::GetMapIntIndex( aChipIndex ) );
+    vector<uint32_t> charges( fNChargeSteps );
     for ( unsigned int iampl = 0; iampl < fNChargeSteps; iampl++ ) {
-        unsigned int icharge = GetInjectedCharge( iampl );
-        unsigned int nhits = GetHits( aChipIndex, icol, iaddr, iampl );
-        (fAnalyserCollection.at(int_index))->FillPixelData( iampl, icharge, nhits );
+        charges.at( iampl ) = GetInjectedCharge( iampl );
     }
-    
-    (fAnalyserCollection.at(int_index))->ProcessPixelData();
+    analyzer->ProcessSCurves( pixels, counts, charges, 0, pixels.size() );
 }
-
@@ -13,13 +13,17 @@
  */
 
 #include "TDeviceMaskScan.h"
-#include <deque>
+#include <cstdint>
 #include <map>
+#include <memory>
+#include <vector>
 
 class TScanConfig;
 class TScanHisto;
+class TSCurveHisto;
 class TDevice;
 class TSCurveAnalysis;
+class TTaskPool;
 
 class TDeviceThresholdScan : public TDeviceMaskScan {
     
@@ -35,11 +39,14 @@ class TDeviceThresholdScan : public TDeviceMaskScan {
     /// number of steps on the injected charge during the scan
     unsigned int fNChargeSteps;
         
-    /// list of histogram maps (one per step of the injected charge)
-    std::deque<std::shared_ptr<TScanHisto>> fHistoQue;
+    /// number of hits vs injected charge for the pulsed pixels of all enabled chips
+    std::shared_ptr<TSCurveHisto> fSCurveHisto;
     
     /// S-curve analyzer (one per chip index)
     std::map<int, std::shared_ptr<TSCurveAnalysis>> fAnalyserCollection;
+
+    /// background workers fitting the S-curves of each finished mask stage (one lane per chip)
+    std::unique_ptr<TTaskPool> fFitPool;
     
 public:
     
@@ -74,15 +81,15 @@ public:
     /// perform the digital scan of the device
     void Go();
     
-    /// write raw hit data to a text file
+    /// write raw hit data and S-curve fit results to text files, and the S-curves to a binary file
     void WriteDataToFile( bool Recreate = true );
     
-    /// draw and save threshold, noise and chi2/ndf distributions
+    /// draw and save threshold, noise and chi2/ndf distributions (optional, needs the files of WriteDataToFile())
     void DrawAndSaveToFile();
 
 protected:
     
-    /// allocate memory for histogram of hit pixels for each enabled chip
+    /// allocate the S-curve storage for each enabled chip
     void AddHisto();
     
     /// dump scan parameters
@@ -97,13 +104,16 @@ protected:
     /// add an S-curve analyzer for a given chip
     void AddChipSCurveAnalyzer( const common::TChipIndex idx );
     
-    /// analyze the data obtained from the threshold scan of the device
+    /// wait for the end of the S-curve fits of all mask stages
     void AnalyzeData();
 
-    /// Fill the S-curve for a given pixel then extract threshold and noise
-    void AnalyzePixelSCurve( const common::TChipIndex aChipIndex,
-                            const unsigned int icol,
-                            const unsigned int iaddr );
+    /// queue the S-curve fits of the pixels pulsed by the current mask stage (all chips)
+    void SubmitStageFits( const int istage );
+
+    /// fill the S-curves of a list of pixels of a chip then extract threshold and noise
+    void AnalyzePixelSCurves( const common::TChipIndex aChipIndex,
+                             const std::vector<std::uint32_t>& pixels,
+                             const std::vector<std::uint32_t>& counts );
     
 };
 
@@ -10,6 +10,7 @@ TErrorCounter::TErrorCounter() :
 fNTimeout( 0 ),
 fNCorruptEvent( 0 ),
 fNEventOverSizeError( 0 ),
+fNOrdinalMismatch( 0 ),
 fDeviceType( TDeviceType::kUNKNOWN )
 {
     
@@ -19,6 +20,7 @@ TErrorCounter::TErrorCounter( const TDeviceType dt ) :
 fNTimeout( 0 ),
 fNCorruptEvent( 0 ),
 fNEventOverSizeError( 0 ),
+fNOrdinalMismatch( 0 ),
 fDeviceType( dt )
 {
     
@@ -48,6 +50,7 @@ void TErrorCounter::AddCorruptedHit( shared_ptr<TPixHit> badHit )
 {
     if ( badHit ) {
         
+        lock_guard<mutex> lock( fMutex );
         if ( badHit->GetPixFlag() != TPixFlag::kBAD_CHIPID ) {
             common::TChipIndex idx;
             idx.boardIndex    = badHit->GetBoardIndex();
@@ -110,6 +113,20 @@ void TErrorCounter::AddHotPixel( const common::TChipIndex idx,
     }
 }
 
+//___________________________________________________________________
+void TErrorCounter::AddDiscordantPixels( const common::TChipIndex idx,
+                                         const TDiscordantBins& bins )
+{
+    if ( !fCounterCollection.size() ) {
+        throw runtime_error( "TErrorCounter::AddDiscordantPixels() - no chip in the list ! Please use Init() first." );
+    }
+    try {
+        (fCounterCollection.at( common::GetMapIntIndex(idx) )).AddDiscordantPixels( bins );
+    } catch ( exception& msg ) {
+        cerr << "TErrorCounter::AddDiscordantPixels() - " << msg.what() << endl;
+    }
+}
+
 //___________________________________________________________________
 void TErrorCounter::SetVerboseLevel( const int level )
 {
@@ -132,6 +149,7 @@ void TErrorCounter::IncrementNPrioEncoder( std::shared_ptr<TPixHit> badHit,
     idx.deviceType    = badHit->GetDeviceType();
     idx.deviceId      = badHit->GetDeviceId();
     idx.chipId        = badHit->GetChipId();
+    lock_guard<mutex> lock( fMutex );
     try {
         (fCounterCollection.at( common::GetMapIntIndex(idx) )).IncrementNPrioEncoder( value );
     } catch ( exception& msg ) {
@@ -139,10 +157,30 @@ void TErrorCounter::IncrementNPrioEncoder( std::shared_ptr<TPixHit> badHit,
     }
 }
 
+//___________________________________________________________________
+void TErrorCounter::GetChipErrors( const common::TChipIndex idx,
+                                   unsigned int& nCorruptedHits,
+                                   unsigned int& nPrioEncoder,
+                                   unsigned int& n8b10b )
+{
+    lock_guard<mutex> lock( fMutex );
+    map<int, TChipErrorCounter>::const_iterator it = fCounterCollection.find( common::GetMapIntIndex(idx) );
+    if ( it == fCounterCollection.end() ) {
+        nCorruptedHits = 0;
+        nPrioEncoder = 0;
+        n8b10b = 0;
+        return;
+    }
+    nCorruptedHits = (it->second).GetNCorruptedHits();
+    nPrioEncoder = (it->second).GetNPrioEncoder();
+    n8b10b = (it->second).GetN8b10b();
+}
+
 //___________________________________________________________________
 void TErrorCounter::IncrementN8b10b( const unsigned int boardReceiver,
                                      const unsigned int value )
 {
+    lock_guard<mutex> lock( fMutex );
     for ( std::map<int, TChipErrorCounter>::iterator it = fCounterCollection.begin(); it != fCounterCollection.end(); ++it ) {
         ((*it).second).IncrementN8b10b( boardReceiver, value );
     }
@@ -160,6 +198,7 @@ void TErrorCounter::Dump()
     cout << "Number of event over size errors: " << std::dec << fNEventOverSizeError << endl;
     cout << "Number of corrupted events: " <<  fNCorruptEvent << endl;
     cout << "Number of timeout: " << fNTimeout << endl;
+    cout << "Number of trigger ordinal mismatches: " << fNOrdinalMismatch << endl;
     cout << "Number of hits with bad chip id: " << fBadChipIdHits.size() << endl;
     cout << "-------------------------------" << endl << endl;
 }
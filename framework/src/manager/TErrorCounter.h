@@ -16,6 +16,8 @@
  * - number of priority encoder errors (stuck pixel hits), i.e. a subset of corrupted
  *   events
  * - number of times any readout board had a timeout error
+ * - number of chip events whose trigger ordinal disagreed with their bunch counter (see
+ *   TReadoutBoardMOSAIC::GetNOrdinalMismatches())
  * - number of bad hits for each type of bad hits for each chip.
  * See the class TChipErrorCounter for more details about the errors that are 
  * considered from a given chip.
@@ -24,12 +26,14 @@
 #include <map>
 #include <memory>
 #include <deque>
+#include <mutex>
 #include "Common.h"
 #include "TChipErrorCounter.h"
 #include "TPixHit.h"
 #include "TVerbosity.h"
 
 class TScanHisto;
+struct TDiscordantBins;
 
 class TErrorCounter : public TVerbosity {
     
@@ -42,6 +46,9 @@ class TErrorCounter : public TVerbosity {
     /// number of event over size errors
     unsigned int fNEventOverSizeError;
 
+    /// number of chip events whose trigger ordinal disagreed with their bunch counter
+    unsigned int fNOrdinalMismatch;
+
     /// error counter (one per chip index)
     std::map<int, TChipErrorCounter> fCounterCollection;
 
@@ -51,6 +58,9 @@ class TErrorCounter : public TVerbosity {
     /// device type
     TDeviceType fDeviceType;
 
+    /// protects the counters when several boards are decoded at the same time
+    std::mutex fMutex;
+
 public:
     
     /// default constructor
@@ -79,6 +89,9 @@ public:
                       const unsigned int icol, const unsigned int iaddr,
                       const double nhits);
 
+    /// add all dead, inefficient and hot pixels found in the hit map of a chip
+    void AddDiscordantPixels( const common::TChipIndex idx, const TDiscordantBins& bins );
+
     /// create the collection of chip error counters from the map of histograms
     void Init( std::shared_ptr<TScanHisto> aScanHisto,
                const unsigned int nInjections );
@@ -106,6 +119,9 @@ public:
     /// set the number of event over size errors
     inline void SetNEventOverSizeError( const unsigned int value ) { fNEventOverSizeError = value; }
 
+    /// set the number of trigger ordinal mismatches
+    inline void SetNOrdinalMismatch( const unsigned int value ) { fNOrdinalMismatch = value; }
+
    /// propagate the verbosity level to data members
     virtual void SetVerboseLevel( const int level );
     
@@ -113,15 +129,19 @@ public:
 
     /// increment the number of timeout errors by the given value
     inline void IncrementNTimeout( const unsigned int value = 1 )
-    { fNTimeout += value; }
+    { std::lock_guard<std::mutex> lock( fMutex ); fNTimeout += value; }
 
     /// increment the number of corrupted events by the given value
     inline void IncrementNCorruptEvent( const unsigned int value = 1 )
-    { fNCorruptEvent += value; }
+    { std::lock_guard<std::mutex> lock( fMutex ); fNCorruptEvent += value; }
 
     /// increment the number of event over size errors
     inline void IncrementNEventOverSizeError(const unsigned int value = 1 )
-    { fNEventOverSizeError += value; }
+    { std::lock_guard<std::mutex> lock( fMutex ); fNEventOverSizeError += value; }
+
+    /// increment the number of trigger ordinal mismatches
+    inline void IncrementNOrdinalMismatch( const unsigned int value = 1 )
+    { std::lock_guard<std::mutex> lock( fMutex ); fNOrdinalMismatch += value; }
 
     /// increment the number of 8b10b encoder errors by the given value
     void IncrementN8b10b( const unsigned int boardReceiver,
@@ -141,6 +161,13 @@ public:
     /// return the number of event over size errors
     inline unsigned int GetNEventOverSizeError() const { return fNEventOverSizeError; }
 
+    /// return the number of trigger ordinal mismatches
+    inline unsigned int GetNOrdinalMismatch() const { return fNOrdinalMismatch; }
+
+    /// current error counts of a given chip (e.g. for the live monitoring, while decoding)
+    void GetChipErrors( const common::TChipIndex idx, unsigned int& nCorruptedHits,
+                        unsigned int& nPrioEncoder, unsigned int& n8b10b );
+
 
 private:
     
@@ -0,0 +1,334 @@
+#include "TEventBuilder.h"
+#include <iostream>
+#include <stdexcept>
+
+using namespace std;
+
+//___________________________________________________________________
+TEventBuilder::TEventBuilder( const vector<unsigned int>& nFragmentsPerBoard,
+                              const unsigned int maxQueued,
+                              const unsigned int timeout ) : TVerbosity(),
+fQueues( nFragmentsPerBoard.size() ),
+fMaxQueued( maxQueued ),
+fTimeout( timeout ),
+fIsRunning( false ),
+fStop( false ),
+fNComplete( 0 ),
+fNIncomplete( 0 ),
+fHasBuilt( false ),
+fLastBuilt( 0 ),
+fError( "" )
+{
+    if ( fQueues.empty() ) {
+        throw invalid_argument( "TEventBuilder::TEventBuilder() - no readout board !" );
+    }
+    if ( !fMaxQueued ) {
+        throw invalid_argument( "TEventBuilder::TEventBuilder() - the queues can not have a zero size !" );
+    }
+    for ( unsigned int ib = 0; ib < fQueues.size(); ib++ ) {
+        fQueues.at(ib).nExpected = nFragmentsPerBoard.at(ib);
+    }
+}
+
+//___________________________________________________________________
+TEventBuilder::~TEventBuilder()
+{
+    try {
+        Stop();
+    } catch ( exception& err ) {
+        cerr << err.what() << endl;
+    }
+}
+
+//___________________________________________________________________
+void TEventBuilder::AddEventHandler( TEventHandler handler )
+{
+    if ( fIsRunning ) {
+        throw runtime_error( "TEventBuilder::AddEventHandler() - the builder is already running !" );
+    }
+    fHandlers.push_back( move(handler) );
+}
+
+//___________________________________________________________________
+void TEventBuilder::Start()
+{
+    if ( fIsRunning ) {
+        throw runtime_error( "TEventBuilder::Start() - the builder is already running !" );
+    }
+    {
+        lock_guard<mutex> lock( fMutex );
+        for ( unsigned int ib = 0; ib < fQueues.size(); ib++ ) {
+            fQueues.at(ib).fragments.clear();
+            fQueues.at(ib).nQueued = 0;
+            fQueues.at(ib).triggers.Clear();
+            fQueues.at(ib).nRecordsTaken = 0;
+            fQueues.at(ib).nMissing = 0;
+            fQueues.at(ib).nLate = 0;
+        }
+        fNComplete = 0;
+        fNIncomplete = 0;
+        fHasBuilt = false;
+        fLastBuilt = 0;
+        fError.clear();
+        fStop = false;
+        fIsRunning = true;
+    }
+    fThread = thread( &TEventBuilder::Run, this );
+}
+
+//___________________________________________________________________
+void TEventBuilder::AddTriggerRecords( const unsigned int iboard, const TTriggerTable& table )
+{
+    if ( iboard >= fQueues.size() ) {
+        throw out_of_range( "TEventBuilder::AddTriggerRecords() - unknown board " + to_string( iboard ) );
+    }
+    {
+        lock_guard<mutex> lock( fMutex );
+        TBoardQueue& queue = fQueues.at(iboard);
+        // the table of the board was cleared by a new run
+        if ( table.GetNAdded() < queue.nRecordsTaken ) {
+            queue.nRecordsTaken = 0;
+        }
+        if ( table.GetNAdded() == queue.nRecordsTaken ) return;
+        const size_t firstRow = ( queue.nRecordsTaken > table.GetNRemoved() ) ?
+            queue.nRecordsTaken - table.GetNRemoved() : 0;
+        for ( size_t row = firstRow; row < table.GetSize(); row++ ) {
+            // a record of a board lagging behind a trigger already built (incomplete)
+            if ( IsBuilt( table.GetTriggerNum( row ) ) ) {
+                queue.nLate++;
+                continue;
+            }
+            queue.triggers.Add( table.GetTriggerNum( row ), table.GetTriggerTime( row ), table.GetBoard( row ) );
+        }
+        queue.nRecordsTaken = table.GetNAdded();
+    }
+    fFragmentCondition.notify_one();
+}
+
+//___________________________________________________________________
+void TEventBuilder::AddFragment( const unsigned int iboard,
+                                 const uint32_t trgNum,
+                                 const uint64_t trgTime,
+                                 const unsigned char* data,
+                                 const int nBytes )
+{
+    if ( iboard >= fQueues.size() ) {
+        throw out_of_range( "TEventBuilder::AddFragment() - unknown board " + to_string( iboard ) );
+    }
+    TFragment fragment;
+    fragment.trgNum = trgNum;
+    fragment.trgTime = trgTime;
+    fragment.data.assign( data, data + nBytes );
+    {
+        unique_lock<mutex> lock( fMutex );
+        if ( !fIsRunning ) {
+            throw runtime_error( "TEventBuilder::AddFragment() - the builder is not running !" );
+        }
+        TBoardQueue& queue = fQueues.at(iboard);
+        if ( IsBuilt( trgNum ) ) {
+            queue.nLate++;
+            return;
+        }
+        fSpaceCondition.wait( lock, [this, &queue]{ return fStop || (queue.nQueued < fMaxQueued); } );
+        fragment.arrival = chrono::steady_clock::now();
+        queue.fragments[trgNum].push_back( move(fragment) );
+        queue.nQueued++;
+    }
+    fFragmentCondition.notify_one();
+}
+
+//___________________________________________________________________
+void TEventBuilder::Stop()
+{
+    if ( !fThread.joinable() ) return;
+    {
+        lock_guard<mutex> lock( fMutex );
+        fStop = true;
+    }
+    fFragmentCondition.notify_one();
+    fSpaceCondition.notify_all();
+    fThread.join();
+    string error;
+    {
+        lock_guard<mutex> lock( fMutex );
+        fIsRunning = false;
+        error.swap( fError );
+    }
+    if ( GetVerboseLevel() > kTERSE ) {
+        Dump();
+    }
+    if ( !error.empty() ) {
+        cerr << error << endl;
+        throw runtime_error( "TEventBuilder::Stop() - at least one event handler failed !" );
+    }
+}
+
+//___________________________________________________________________
+unsigned long TEventBuilder::GetNMissingFragments( const unsigned int iboard ) const
+{
+    return fQueues.at(iboard).nMissing;
+}
+
+//___________________________________________________________________
+unsigned long TEventBuilder::GetNLateFragments( const unsigned int iboard ) const
+{
+    return fQueues.at(iboard).nLate;
+}
+
+//___________________________________________________________________
+void TEventBuilder::Dump() const
+{
+    cout << "TEventBuilder::Dump() - " << std::dec << fNComplete << " complete event(s), "
+         << fNIncomplete << " incomplete event(s)" << endl;
+    for ( unsigned int ib = 0; ib < fQueues.size(); ib++ ) {
+        if ( !fQueues.at(ib).nMissing && !fQueues.at(ib).nLate ) continue;
+        cout << "\t board " << ib << " : " << fQueues.at(ib).nMissing << " missing fragment(s), "
+             << fQueues.at(ib).nLate << " late fragment(s) or record(s)" << endl;
+    }
+}
+
+//___________________________________________________________________
+bool TEventBuilder::IsBuilt( const uint32_t trgNum ) const
+{
+    return fHasBuilt && !TTriggerTable::IsBefore( fLastBuilt, trgNum );
+}
+
+//___________________________________________________________________
+void TEventBuilder::Run()
+{
+    // the same event is reused for all triggers to keep the memory already allocated
+    TBuiltEvent event;
+    const unsigned int nBoards = fQueues.size();
+    vector<const TTriggerTable*> tables;
+    for ( unsigned int ib = 0; ib < nBoards; ib++ ) {
+        tables.push_back( &(fQueues.at(ib).triggers) );
+    }
+    vector<size_t> rows;
+    // number of fragments of the current trigger in the queue of each board
+    vector<unsigned int> found( nBoards );
+    bool isWaiting = false;
+    uint32_t waitedTrgNum = 0;
+    chrono::steady_clock::time_point waitStart;
+    unique_lock<mutex> lock( fMutex );
+    while ( true ) {
+
+        // next trigger: merge-join of the trigger records of the boards
+        rows.clear();
+        if ( !TTriggerTable::Join( tables, rows, false, 1 ) ) {
+            // the record of a trigger is given before its fragments: the ones left are late
+            for ( unsigned int ib = 0; ib < nBoards; ib++ ) {
+                TBoardQueue& queue = fQueues.at(ib);
+                queue.nLate += queue.nQueued;
+                queue.fragments.clear();
+                queue.nQueued = 0;
+            }
+            fSpaceCondition.notify_all();
+            if ( fStop ) return;
+            fFragmentCondition.wait( lock );
+            continue;
+        }
+        uint32_t current = 0;
+        for ( unsigned int ib = 0; ib < nBoards; ib++ ) {
+            if ( rows.at(ib) == TTriggerTable::NOROW ) continue;
+            current = tables.at(ib)->GetTriggerNum( rows.at(ib) );
+            break;
+        }
+        if ( !isWaiting || (current != waitedTrgNum) ) {
+            isWaiting = true;
+            waitedTrgNum = current;
+            waitStart = chrono::steady_clock::now();
+        }
+
+        // a board is done with this trigger once it gave all its fragments or recorded a later trigger
+        bool isDone = true;
+        bool isComplete = true;
+        chrono::steady_clock::time_point firstArrival = waitStart;
+        for ( unsigned int ib = 0; ib < nBoards; ib++ ) {
+            TBoardQueue& queue = fQueues.at(ib);
+            // the triggers before the current one were built (the current one is after the last built)
+            while ( !queue.fragments.empty()
+                   && TTriggerTable::IsBefore( queue.fragments.begin()->first, current ) ) {
+                queue.nLate += queue.fragments.begin()->second.size();
+                queue.nQueued -= queue.fragments.begin()->second.size();
+                queue.fragments.erase( queue.fragments.begin() );
+            }
+            found.at(ib) = 0;
+            if ( !queue.fragments.empty() && (queue.fragments.begin()->first == current) ) {
+                const vector<TFragment>& fragments = queue.fragments.begin()->second;
+                found.at(ib) = fragments.size();
+                if ( fragments.front().arrival < firstArrival ) {
+                    firstArrival = fragments.front().arrival;
+                }
+            }
+            const unsigned int n = found.at(ib);
+            const bool hasMovedOn = ( rows.at(ib) == TTriggerTable::NOROW ) && queue.triggers.GetSize();
+            isComplete = isComplete && ( n >= queue.nExpected );
+            isDone = isDone && ( (n >= queue.nExpected) || hasMovedOn );
+        }
+        if ( !isDone && !fStop ) {
+            const chrono::steady_clock::time_point deadline = firstArrival + fTimeout;
+            if ( chrono::steady_clock::now() < deadline ) {
+                fFragmentCondition.wait_until( lock, deadline );
+                continue;
+            }
+        }
+
+        // build the event with the fragments found, in the order of the boards
+        event.trgNum = current;
+        event.data.clear();
+        event.size.clear();
+        event.board.clear();
+        event.trgTime.clear();
+        event.isComplete = isComplete;
+        for ( unsigned int ib = 0; ib < nBoards; ib++ ) {
+            TBoardQueue& queue = fQueues.at(ib);
+            const unsigned int n = found.at(ib);
+            if ( n ) {
+                const vector<TFragment>& fragments = queue.fragments.begin()->second;
+                for ( unsigned int i = 0; i < n; i++ ) {
+                    const TFragment& fragment = fragments.at(i);
+                    event.data.insert( event.data.end(), fragment.data.begin(), fragment.data.end() );
+                    event.size.push_back( fragment.data.size() );
+                    event.board.push_back( ib );
+                    event.trgTime.push_back( fragment.trgTime );
+                }
+                queue.fragments.erase( queue.fragments.begin() );
+                queue.nQueued -= n;
+            }
+            if ( n < queue.nExpected ) {
+                queue.nMissing += queue.nExpected - n;
+            }
+            if ( rows.at(ib) != TTriggerTable::NOROW ) {
+                queue.triggers.RemoveFirst( rows.at(ib) + 1 );
+            }
+        }
+        isWaiting = false;
+        fHasBuilt = true;
+        fLastBuilt = current;
+        if ( isComplete ) {
+            fNComplete++;
+        } else {
+            fNIncomplete++;
+            if ( GetVerboseLevel() > kVERBOSE ) {
+                cout << "TEventBuilder::Run() - incomplete event for trigger "
+                     << std::dec << current << endl;
+            }
+        }
+        fSpaceCondition.notify_all();
+
+        // the handlers run while the reading threads keep filling the queues
+        lock.unlock();
+        string error;
+        try {
+            for ( unsigned int ih = 0; ih < fHandlers.size(); ih++ ) {
+                fHandlers.at(ih)( event );
+            }
+        } catch ( exception& err ) {
+            error = err.what();
+        }
+        lock.lock();
+        if ( !error.empty() && fError.empty() ) {
+            fError = error;
+        }
+    }
+}
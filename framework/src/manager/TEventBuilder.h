@@ -0,0 +1,214 @@
+#ifndef TEVENT_BUILDER_H
+#define TEVENT_BUILDER_H
+
+/**
+ * \class TEventBuilder
+ *
+ * \brief Assemble the events of several readout boards into full-detector events
+ *
+ * \author Andry Rakotozafindrabe
+ *
+ * The reading thread of each board gives the trigger records of the board (see
+ * TrgRecorderParser and TTriggerTable), then its raw events (fragments) with their
+ * trigger number. Each board has its own bounded queue, keyed by trigger number so that
+ * the fragments of a trigger are taken at its front: the reading thread of a board
+ * waits when its queue is full, so that a board that runs ahead can not fill the memory
+ * while another one is late.
+ *
+ * A thread of the builder takes the triggers in order, with a merge-join of the trigger
+ * records of the boards (see TTriggerTable::Join()); the records of a trigger are
+ * removed once its event is built. A board is done with a trigger once it gave its
+ * expected number of fragments (e.g. one per working chip) or once it recorded a later
+ * trigger but not this one. If a board is neither, the event waits for it up to a
+ * timeout, counted from the arrival of the first fragment of the trigger (or from the
+ * start of the wait if none arrived yet), and is then built without the missing
+ * fragments (incomplete event). A fragment or a trigger record arriving after its event
+ * was built (i.e. not after the last trigger built) is dropped (late fragment), so that
+ * no trigger is built twice.
+ *
+ * Each built event is given to the event handlers (e.g. storage and monitoring), from
+ * the thread of the builder, in the order of the trigger numbers. The handlers are run
+ * without any lock held: they must be fast enough to keep up with the trigger rate.
+ */
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "TTriggerTable.h"
+#include "TVerbosity.h"
+
+class TEventBuilder : public TVerbosity {
+
+public:
+
+    /// event built from the fragments of all boards for a given trigger
+    struct TBuiltEvent {
+        /// trigger number
+        std::uint32_t trgNum = 0;
+        /// data of all fragments, one after the other, in the order of the boards
+        std::vector<unsigned char> data;
+        /// size in bytes of each fragment
+        std::vector<int> size;
+        /// board of each fragment
+        std::vector<unsigned int> board;
+        /// trigger time (in units of clock of the board) of each fragment
+        std::vector<std::uint64_t> trgTime;
+        /// true if all boards gave their expected number of fragments
+        bool isComplete = false;
+    };
+
+    /// function called for each built event
+    typedef std::function<void( const TBuiltEvent& )> TEventHandler;
+
+    /// default max number of fragments waiting in the queue of a board
+    static const unsigned int DEFAULTMAXQUEUED = 4096;
+
+    /// default max time (in ms) to wait for the missing fragments of a trigger
+    static const unsigned int DEFAULTTIMEOUT = 500;
+
+private:
+
+    /// raw event of a board waiting to be built
+    struct TFragment {
+        std::uint32_t trgNum;
+        std::uint64_t trgTime;
+        std::vector<unsigned char> data;
+        std::chrono::steady_clock::time_point arrival;
+    };
+
+    /// order of the trigger numbers, also across the wrap-around of the 32-bit counter
+    struct TTriggerOrder {
+        bool operator()( const std::uint32_t a, const std::uint32_t b ) const
+        {
+            return TTriggerTable::IsBefore( a, b );
+        }
+    };
+
+    /// queue of fragments of a board
+    struct TBoardQueue {
+        /// fragments of each trigger (in their order of arrival), the oldest trigger first
+        std::map<std::uint32_t, std::vector<TFragment>, TTriggerOrder> fragments;
+        /// number of fragments in the queue
+        unsigned int nQueued = 0;
+        /// trigger records of the board whose event is not built yet
+        TTriggerTable triggers;
+        /// number of records taken from the trigger table of the board since Start()
+        std::size_t nRecordsTaken = 0;
+        /// number of fragments expected for each trigger
+        unsigned int nExpected = 1;
+        /// number of fragments missing in the built events
+        unsigned long nMissing = 0;
+        /// number of fragments and trigger records dropped because their event was already built
+        unsigned long nLate = 0;
+    };
+
+    /// one queue per board
+    std::vector<TBoardQueue> fQueues;
+
+    /// max number of fragments in the queue of a board
+    unsigned int fMaxQueued;
+
+    /// max time to wait for the missing fragments of a trigger
+    std::chrono::milliseconds fTimeout;
+
+    /// functions called for each built event
+    std::vector<TEventHandler> fHandlers;
+
+    /// thread of the builder
+    std::thread fThread;
+
+    /// protect the queues, the counters, the stop request and the error message
+    std::mutex fMutex;
+
+    /// signal a new fragment (or the stop request) to the builder
+    std::condition_variable fFragmentCondition;
+
+    /// signal free space in the queues to the reading threads
+    std::condition_variable fSpaceCondition;
+
+    /// true between Start() and Stop()
+    bool fIsRunning;
+
+    /// stop request for the builder
+    bool fStop;
+
+    /// number of complete events
+    unsigned long fNComplete;
+
+    /// number of incomplete events
+    unsigned long fNIncomplete;
+
+    /// true once an event was built since Start()
+    bool fHasBuilt;
+
+    /// trigger number of the last event built
+    std::uint32_t fLastBuilt;
+
+    /// message of the first exception thrown by an event handler
+    std::string fError;
+
+public:
+
+    /// constructor with the number of fragments expected from each board for each trigger
+    TEventBuilder( const std::vector<unsigned int>& nFragmentsPerBoard,
+                   const unsigned int maxQueued = DEFAULTMAXQUEUED,
+                   const unsigned int timeout = DEFAULTTIMEOUT );
+
+    /// destructor, stops the builder if needed
+    ~TEventBuilder();
+
+    /// add a function called for each built event (before Start() only)
+    void AddEventHandler( TEventHandler handler );
+
+    /// start the thread of the builder, reset the counters
+    void Start();
+
+    /// take the records of the trigger table of a given board not taken yet since Start()
+    /// (from the thread that fills the table, before the fragments of these triggers)
+    void AddTriggerRecords( const unsigned int iboard, const TTriggerTable& table );
+
+    /// add a raw event of a given board, wait while the queue of the board is full
+    void AddFragment( const unsigned int iboard, const std::uint32_t trgNum,
+                      const std::uint64_t trgTime, const unsigned char* data, const int nBytes );
+
+    /// build all remaining fragments and stop the thread of the builder
+    void Stop();
+
+    /// true between Start() and Stop()
+    bool IsRunning() const { return fIsRunning; }
+
+    /// number of boards
+    unsigned int GetNBoards() const { return fQueues.size(); }
+
+    /// number of complete events built since Start()
+    unsigned long GetNCompleteEvents() const { return fNComplete; }
+
+    /// number of incomplete events built since Start()
+    unsigned long GetNIncompleteEvents() const { return fNIncomplete; }
+
+    /// number of fragments of a given board missing in the events built since Start()
+    unsigned long GetNMissingFragments( const unsigned int iboard ) const;
+
+    /// number of fragments and trigger records of a given board dropped since Start() because their event was already built
+    unsigned long GetNLateFragments( const unsigned int iboard ) const;
+
+    /// print the counters
+    void Dump() const;
+
+private:
+
+    /// loop of the thread of the builder
+    void Run();
+
+    /// true if the event of a given trigger was already built (called with the lock held)
+    bool IsBuilt( const std::uint32_t trgNum ) const;
+
+};
+
+#endif
@@ -1,6 +1,46 @@
 #include "THisto.h"
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 
+namespace {
+    
+    //___________________________________________________________________
+    template <typename T>
+    void FindDiscordantBinsInRows( void** histo, const unsigned int nbin1, const unsigned int nbin2,
+                                   const double ref, TDiscordantBins& bins )
+    {
+        const T refValue = (T)ref;
+        const bool isRefExact = ( (double)refValue == ref );
+        for ( unsigned int j = 0; j < nbin2; j++ ) {
+            const T* row = ((T**)histo)[j];
+            if ( isRefExact ) {
+                // branch-free compare of the whole row, vectorised by the compiler:
+                // most rows have all their bins equal to the reference value
+                unsigned int nDiff = 0;
+                for ( unsigned int i = 0; i < nbin1; i++ ) {
+                    nDiff += ( row[i] != refValue );
+                }
+                if ( !nDiff ) continue;
+            }
+            for ( unsigned int i = 0; i < nbin1; i++ ) {
+                const double content = (double)row[i];
+                if ( content == ref ) continue;
+                const std::uint32_t key = i * nbin2 + j;
+                if ( content == 0 ) {
+                    bins.emptyBins.push_back( key );
+                } else if ( content < ref ) {
+                    bins.lowBins.push_back( key );
+                    bins.lowContents.push_back( content );
+                } else {
+                    bins.highBins.push_back( key );
+                    bins.highContents.push_back( content );
+                }
+            }
+        }
+    }
+}
+
 //___________________________________________________________________
 THisto::THisto()
 {
@@ -16,6 +56,8 @@ THisto::THisto()
     fHisto = 0;
     fTrash = 0;
     fSize = 8;
+    fIsSparse = false;
+    fMaxDensity = 1;
 }
 
 //___________________________________________________________________
@@ -35,6 +77,8 @@ THisto::THisto( std::string name, std::string title,
     for (unsigned int i=0; i<fDim[0]; i++) ((double **)fHisto)[0][i] = 0;
     fTrash = 0;
     fSize = 8;
+    fIsSparse = false;
+    fMaxDensity = 1;
 }
 
 //___________________________________________________________________
@@ -58,6 +102,8 @@ THisto::THisto( std::string name, std::string title,
     }
     fTrash = 0;
     fSize = 8;
+    fIsSparse = false;
+    fMaxDensity = 1;
 }
 
 //___________________________________________________________________
@@ -99,56 +145,24 @@ THisto::THisto( std::string name, std::string title,
         }
     }
     fTrash = 0;
+    fIsSparse = false;
+    fMaxDensity = 1;
 }
 
 //___________________________________________________________________
 THisto::THisto( const THisto &h )
 {
-    fNdim = h.fNdim;
-    fName = h.fName;
-    fTitle = h.fTitle;
-    fDim[0] = h.fDim[0];
-    fDim[1] = h.fDim[1];
-    fLim[0][0] = h.fLim[0][0];
-    fLim[0][1] = h.fLim[0][1];
-    fLim[1][0] = h.fLim[1][0];
-    fLim[1][1] = h.fLim[1][1];
-    fSize = h.fSize;
-    fHisto = new void*[fDim[1]];
-    if (fSize == 1) {
-        for (unsigned int j=0; j<fDim[1]; j++) {
-            fHisto[j] = (void *)new unsigned char[fDim[0]];
-            for (unsigned int i=0; i<fDim[0]; i++) ((unsigned char **)fHisto)[j][i] = ((unsigned char **)h.fHisto)[j][i];
-        }
-    } else if (fSize == 2) {
-        for (unsigned int j=0; j<fDim[1]; j++) {
-            fHisto[j] = (void *)new unsigned short int[fDim[0]];
-            for (unsigned int i=0; i<fDim[0]; i++) ((unsigned short int **)fHisto)[j][i] = ((unsigned short int **)h.fHisto)[j][i];
-        }
-    } else if (fSize == 4) {
-        for (unsigned int j=0; j<fDim[1]; j++) {
-            fHisto[j] = (void *)new float[fDim[0]];
-            for (unsigned int i=0; i<fDim[0]; i++) ((float **)fHisto)[j][i] = ((float **)h.fHisto)[j][i];
-        }
-    } else {
-        for (unsigned int j=0; j<fDim[1]; j++) {
-            fHisto[j] = (void *)new double[fDim[0]];
-            for (unsigned int i=0; i<fDim[0]; i++) ((double **)fHisto)[j][i] = ((double **)h.fHisto)[j][i];
-        }
-    }
-    fTrash = 0;
+    fHisto = 0;
+    fDim[0] = 0;
+    fDim[1] = 0;
+    fSize = 8;
+    *this = h;
 }
 
 //___________________________________________________________________
 THisto::~THisto()
 {
-    for (unsigned int j=0; j<fDim[1]; j++) {
-        if (fSize == 1) delete[] ((unsigned char **)fHisto)[j];
-        if (fSize == 2) delete[] ((unsigned short int **)fHisto)[j];
-        if (fSize == 4) delete[] ((float **)fHisto)[j];
-        if (fSize == 8) delete[] (double *)(fHisto[j]);
-    }
-    delete[] fHisto;
+    ReleaseDense();
 }
 
 //___________________________________________________________________
@@ -157,13 +171,7 @@ THisto &THisto::operator=( const THisto &h )
     if (&h == this) {
         return *this;
     } else {
-        for (unsigned int j=0; j<fDim[1]; j++) {
-            if (fSize == 1) delete[] ((unsigned char **)fHisto)[j];
-            if (fSize == 2) delete[] ((unsigned short int **)fHisto)[j];
-            if (fSize == 4) delete[] ((float **)fHisto)[j];
-            if (fSize == 8) delete[] ((double **)fHisto)[j];
-        }
-        delete[] fHisto;
+        ReleaseDense();
         fNdim = h.fNdim;
         fName = h.fName;
         fTitle = h.fTitle;
@@ -174,27 +182,13 @@ THisto &THisto::operator=( const THisto &h )
         fLim[1][0] = h.fLim[1][0];
         fLim[1][1] = h.fLim[1][1];
         fSize = h.fSize;
-        fHisto = new void*[fDim[1]];
-        if (fSize == 1) {
-            for (unsigned int j=0; j<fDim[1]; j++) {
-                fHisto[j] = (void *)new unsigned char[fDim[0]];
-                for (unsigned int i=0; i<fDim[0]; i++) ((unsigned char **)fHisto)[j][i] = ((unsigned char **)h.fHisto)[j][i];
-            }
-        } else if (fSize == 2) {
-            for (unsigned int j=0; j<fDim[1]; j++) {
-                fHisto[j] = (void *)new unsigned short int[fDim[0]];
-                for (unsigned int i=0; i<fDim[0]; i++) ((unsigned short int **)fHisto)[j][i] = ((unsigned short int **)h.fHisto)[j][i];
-            }
-        } else if (fSize == 4) {
-            for (unsigned int j=0; j<fDim[1]; j++) {
-                fHisto[j] = (void *)new float[fDim[0]];
-                for (unsigned int i=0; i<fDim[0]; i++) ((float **)fHisto)[j][i] = ((float **)h.fHisto)[j][i];
-            }
-        } else {
-            for (unsigned int j=0; j<fDim[1]; j++) {
-                fHisto[j] = (void *)new double[fDim[0]];
-                for (unsigned int i=0; i<fDim[0]; i++) ((double **)fHisto)[j][i] = ((double **)h.fHisto)[j][i];
-            }
+        fIsSparse = h.fIsSparse;
+        fMaxDensity = h.fMaxDensity;
+        fSparse = h.fSparse;
+        if (!fIsSparse && h.fHisto) {
+            AllocateDense();
+            // the word size is the size of the bin type (unsigned char, unsigned short int, float or double)
+            for (unsigned int j=0; j<fDim[1]; j++) memcpy(fHisto[j], h.fHisto[j], fDim[0]*fSize);
         }
         fTrash = 0;
         return *this;
@@ -204,6 +198,10 @@ THisto &THisto::operator=( const THisto &h )
 //___________________________________________________________________
 double THisto::operator()(unsigned int i) const
 {
+    if (i<fDim[0] && fIsSparse) {
+        std::unordered_map<std::uint32_t, double>::const_iterator it = fSparse.find(i);
+        return (it == fSparse.end()) ? 0 : it->second;
+    }
     if (i<fDim[0]) {
         if (fSize == 1) return (double)(((unsigned char **)fHisto)[0][i]);
         if (fSize == 2) return (double)(((unsigned short int **)fHisto)[0][i]);
@@ -216,6 +214,10 @@ double THisto::operator()(unsigned int i) const
 //___________________________________________________________________
 double THisto::operator()(unsigned int i, unsigned int j) const
 {
+    if (i<fDim[0] && j<fDim[1] && fIsSparse) {
+        std::unordered_map<std::uint32_t, double>::const_iterator it = fSparse.find(i*fDim[1] + j);
+        return (it == fSparse.end()) ? 0 : it->second;
+    }
     if (i<fDim[0] && j<fDim[1]) {
         if (fSize == 1) return (double)(((unsigned char **)fHisto)[j][i]);
         if (fSize == 2) return (double)(((unsigned short int **)fHisto)[j][i]);
@@ -228,6 +230,10 @@ double THisto::operator()(unsigned int i, unsigned int j) const
 //___________________________________________________________________
 void THisto::Set(unsigned int i, double val)
 {
+    if (i<fDim[0] && fIsSparse) {
+        Set(i, 0, val);
+        return;
+    }
     if (i<fDim[0]) {
         if (fSize == 1) ((unsigned char **)fHisto)[0][i] = (unsigned char)val;
         if (fSize == 2) ((unsigned short int **)fHisto)[0][i] = (unsigned short int)val;
@@ -239,6 +245,15 @@ void THisto::Set(unsigned int i, double val)
 //___________________________________________________________________
 void THisto::Set(unsigned int i, unsigned int j, double val)
 {
+    if (i<fDim[0] && j<fDim[1] && fIsSparse) {
+        if (val == 0) {
+            fSparse.erase(i*fDim[1] + j);
+            return;
+        }
+        fSparse[i*fDim[1] + j] = val;
+        if (fSparse.size() > fMaxDensity * fDim[0] * fDim[1]) MakeDense();
+        return;
+    }
     if (i<fDim[0] && j<fDim[1]) {
         if (fSize == 1) ((unsigned char **)fHisto)[j][i] = (unsigned char)val;
         if (fSize == 2) ((unsigned short int **)fHisto)[j][i] = (unsigned short int)val;
@@ -250,6 +265,10 @@ void THisto::Set(unsigned int i, unsigned int j, double val)
 //___________________________________________________________________
 void THisto::Incr(unsigned int i)
 {
+    if (i<fDim[0] && fIsSparse) {
+        Incr(i, 0);
+        return;
+    }
     if (i<fDim[0]) {
         if (fSize == 1) ((unsigned char **)fHisto)[0][i]++;
         if (fSize == 2) ((unsigned short int **)fHisto)[0][i]++;
@@ -261,6 +280,11 @@ void THisto::Incr(unsigned int i)
 //___________________________________________________________________
 void THisto::Incr(unsigned int i, unsigned int j)
 {
+    if (i<fDim[0] && j<fDim[1] && fIsSparse) {
+        fSparse[i*fDim[1] + j]++;
+        if (fSparse.size() > fMaxDensity * fDim[0] * fDim[1]) MakeDense();
+        return;
+    }
     if (i<fDim[0] && j<fDim[1]) {
         if (fSize == 1) ((unsigned char **)fHisto)[j][i]++;
         if (fSize == 2) ((unsigned short int **)fHisto)[j][i]++;
@@ -272,6 +296,11 @@ void THisto::Incr(unsigned int i, unsigned int j)
 //___________________________________________________________________
 void THisto::Clear()
 {
+    fSparse.clear();
+    if (!fHisto) {
+        fTrash = 0;
+        return;
+    }
     for (unsigned int j=0; j<fDim[1]; j++) {
         for (unsigned int i=0; i<fDim[0]; i++) {
             if (fSize == 1) ((unsigned char **)fHisto)[j][i] = 0;
@@ -287,6 +316,12 @@ void THisto::Clear()
 unsigned int THisto::GetNEntries() const
 {
     double nEntries = 0;
+    if (fIsSparse) {
+        for (std::unordered_map<std::uint32_t, double>::const_iterator it = fSparse.begin(); it != fSparse.end(); ++it) {
+            nEntries += it->second;
+        }
+        return (nEntries < 0) ? 0 : (unsigned int)nEntries;
+    }
     for (unsigned int j=0; j<fDim[1]; j++) {
         for (unsigned int i=0; i<fDim[0]; i++) {
             if (fSize == 1) nEntries += ((unsigned char **)fHisto)[j][i];
@@ -305,6 +340,12 @@ unsigned int THisto::GetNEntries() const
 bool THisto::HasData() const
 {
     double data = 0;
+    if (fIsSparse) {
+        for (std::unordered_map<std::uint32_t, double>::const_iterator it = fSparse.begin(); it != fSparse.end(); ++it) {
+            if ( it->second > 0 ) return true;
+        }
+        return false;
+    }
     for (unsigned int j=0; j<fDim[1]; j++) {
         for (unsigned int i=0; i<fDim[0]; i++) {
             if (fSize == 1) data = ((unsigned char **)fHisto)[j][i];
@@ -319,6 +360,124 @@ bool THisto::HasData() const
     return false;
 }
 
+//___________________________________________________________________
+void THisto::FindDiscordantBins( const double ref, TDiscordantBins& bins ) const
+{
+    if ( fIsSparse ) {
+        for ( unsigned int j = 0; j < fDim[1]; j++ ) {
+            for ( unsigned int i = 0; i < fDim[0]; i++ ) {
+                const double content = (*this)(i, j);
+                if ( content == ref ) continue;
+                const std::uint32_t key = i * fDim[1] + j;
+                if ( content == 0 ) {
+                    bins.emptyBins.push_back( key );
+                } else if ( content < ref ) {
+                    bins.lowBins.push_back( key );
+                    bins.lowContents.push_back( content );
+                } else {
+                    bins.highBins.push_back( key );
+                    bins.highContents.push_back( content );
+                }
+            }
+        }
+        return;
+    }
+    if ( fSize == 1 ) FindDiscordantBinsInRows<unsigned char>( fHisto, fDim[0], fDim[1], ref, bins );
+    if ( fSize == 2 ) FindDiscordantBinsInRows<unsigned short int>( fHisto, fDim[0], fDim[1], ref, bins );
+    if ( fSize == 4 ) FindDiscordantBinsInRows<float>( fHisto, fDim[0], fDim[1], ref, bins );
+    if ( fSize == 8 ) FindDiscordantBinsInRows<double>( fHisto, fDim[0], fDim[1], ref, bins );
+}
+
+//___________________________________________________________________
+void THisto::GetFilledBins( std::vector<std::uint32_t>& keys, std::vector<double>& contents ) const
+{
+    keys.clear();
+    contents.clear();
+    if (fIsSparse) {
+        keys.reserve(fSparse.size());
+        for (std::unordered_map<std::uint32_t, double>::const_iterator it = fSparse.begin(); it != fSparse.end(); ++it) {
+            if (it->second != 0) keys.push_back(it->first);
+        }
+        std::sort(keys.begin(), keys.end());
+        contents.reserve(keys.size());
+        for (unsigned int k=0; k<keys.size(); k++) contents.push_back(fSparse.at(keys[k]));
+        return;
+    }
+    for (unsigned int i=0; i<fDim[0]; i++) {
+        for (unsigned int j=0; j<fDim[1]; j++) {
+            const double content = (*this)(i, j);
+            if (content != 0) {
+                keys.push_back(i*fDim[1] + j);
+                contents.push_back(content);
+            }
+        }
+    }
+}
+
+//___________________________________________________________________
+void THisto::Add( const THisto& h )
+{
+    if (h.fDim[0] != fDim[0] || h.fDim[1] != fDim[1]) {
+        std::cerr << "THisto::Add() - " << h.fName << " and " << fName << " have different binnings" << std::endl;
+        return;
+    }
+    std::vector<std::uint32_t> keys;
+    std::vector<double> contents;
+    h.GetFilledBins(keys, contents);
+    for (unsigned int k=0; k<keys.size(); k++) {
+        const unsigned int i = keys[k] / fDim[1], j = keys[k] % fDim[1];
+        Set(i, j, (*this)(i, j) + contents[k]);
+    }
+}
+
+//___________________________________________________________________
+void THisto::SetSparse( const double maxDensity )
+{
+    ReleaseDense();
+    fSparse.clear();
+    fIsSparse = true;
+    fMaxDensity = maxDensity;
+    fTrash = 0;
+}
+
+//___________________________________________________________________
+void THisto::AllocateDense()
+{
+    fHisto = new void*[fDim[1]];
+    for (unsigned int j=0; j<fDim[1]; j++) {
+        if (fSize == 1) fHisto[j] = (void *)new unsigned char[fDim[0]]();
+        if (fSize == 2) fHisto[j] = (void *)new unsigned short int[fDim[0]]();
+        if (fSize == 4) fHisto[j] = (void *)new float[fDim[0]]();
+        if (fSize == 8) fHisto[j] = (void *)new double[fDim[0]]();
+    }
+}
+
+//___________________________________________________________________
+void THisto::ReleaseDense()
+{
+    if (!fHisto) return;
+    for (unsigned int j=0; j<fDim[1]; j++) {
+        if (fSize == 1) delete[] ((unsigned char **)fHisto)[j];
+        if (fSize == 2) delete[] ((unsigned short int **)fHisto)[j];
+        if (fSize == 4) delete[] ((float **)fHisto)[j];
+        if (fSize == 8) delete[] ((double **)fHisto)[j];
+    }
+    delete[] fHisto;
+    fHisto = 0;
+}
+
+//___________________________________________________________________
+void THisto::MakeDense()
+{
+    if (!fIsSparse) return;
+    fIsSparse = false;
+    AllocateDense();
+    for (std::unordered_map<std::uint32_t, double>::const_iterator it = fSparse.begin(); it != fSparse.end(); ++it) {
+        Set(it->first / fDim[1], it->first % fDim[1], it->second);
+    }
+    fSparse.clear();
+}
+
 
 //================================================================================
 //
@@ -406,6 +565,29 @@ bool TScanHisto::HasData( common::TChipIndex index ) const
     return (fHistos.at(int_index)).HasData();
 }
 
+//___________________________________________________________________
+void TScanHisto::FindDiscordantBins( common::TChipIndex index, const double ref,
+                                     TDiscordantBins& bins ) const
+{
+    int int_index =  common::GetMapIntIndex( index );
+    (fHistos.at(int_index)).FindDiscordantBins( ref, bins );
+}
+
+//___________________________________________________________________
+void TScanHisto::GetFilledBins( common::TChipIndex index, std::vector<std::uint32_t>& keys,
+                                std::vector<double>& contents ) const
+{
+    int int_index =  common::GetMapIntIndex( index );
+    (fHistos.at(int_index)).GetFilledBins( keys, contents );
+}
+
+//___________________________________________________________________
+const THisto& TScanHisto::GetHisto( common::TChipIndex index ) const
+{
+    int int_index =  common::GetMapIntIndex( index );
+    return fHistos.at(int_index);
+}
+
 #pragma mark - other
 
 //___________________________________________________________________
@@ -457,6 +639,16 @@ void TScanHisto::FindChipList()
     }
 }
 
+//___________________________________________________________________
+void TScanHisto::MergeShard( TScanHisto& shard )
+{
+    for (std::map<int, THisto>::iterator it = shard.fHistos.begin(); it != shard.fHistos.end(); ++it) {
+        if ( !(it->second).HasData() ) continue;
+        (fHistos.at(it->first)).Add( it->second );
+        (it->second).Clear();
+    }
+}
+
 //___________________________________________________________________
 bool TScanHisto::IsValidChipIndex( const common::TChipIndex idx )
 {
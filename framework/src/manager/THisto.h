@@ -1,13 +1,29 @@
 #ifndef THISTO_H
 #define THISTO_H
 
+#include <cstdint>
 #include <string>
 #include <map>
+#include <unordered_map>
 #include <vector>
 
 #include "Common.h"
 #include "TVerbosity.h"
 
+/// bins of a histogram whose content differs from a reference value (key = i * nbin2 + j)
+struct TDiscordantBins {
+    /// keys of the bins with no entry
+    std::vector<std::uint32_t> emptyBins;
+    /// keys of the bins below the reference value
+    std::vector<std::uint32_t> lowBins;
+    /// content of the bins below the reference value
+    std::vector<double> lowContents;
+    /// keys of the bins above the reference value
+    std::vector<std::uint32_t> highBins;
+    /// content of the bins above the reference value
+    std::vector<double> highContents;
+};
+
 class THisto {
     
 private:
@@ -19,6 +35,9 @@ private:
     void**        fHisto;     ///< Histogram
     unsigned int  fSize;      ///< Word size
     double        fTrash;     ///< Trash bin
+    bool          fIsSparse;  ///< True if only the filled bins are stored
+    double        fMaxDensity;///< Fraction of filled bins above which a sparse histogram becomes dense
+    std::unordered_map<std::uint32_t, double> fSparse; ///< Filled bins of a sparse histogram (key = i * nbin2 + j)
     
 public:
     /// Default constructor ("0-Dim histogram")
@@ -65,6 +84,23 @@ public:
         if (d >=0 && d <= 1) return fLim[d][1]; else return 0; }
     unsigned int GetNEntries() const;
     bool HasData() const;
+    /// find the bins whose content differs from a reference value, in one pass
+    void FindDiscordantBins( const double ref, TDiscordantBins& bins ) const;
+    /// sorted keys (i * nbin2 + j) and contents of the bins with a non-zero content
+    void GetFilledBins( std::vector<std::uint32_t>& keys, std::vector<double>& contents ) const;
+    /// add the contents of the bins of another histogram with the same binning
+    void Add( const THisto& h );
+    /// store only the filled bins (all contents are lost) until their fraction exceeds maxDensity
+    void SetSparse( const double maxDensity );
+    bool IsSparse() const { return fIsSparse; }
+
+private:
+    /// allocate the bins of the dense storage, set to zero
+    void AllocateDense();
+    /// release the bins of the dense storage
+    void ReleaseDense();
+    /// move the filled bins of a sparse histogram to the dense storage
+    void MakeDense();
 };
 
 class TScanHisto : public TVerbosity {
@@ -105,6 +141,10 @@ public:
     common::TChipIndex GetChipIndex( const unsigned int i ) const;
     unsigned int GetChipNEntries(common::TChipIndex index) const;
     bool HasData(common::TChipIndex index) const;
+    void FindDiscordantBins( common::TChipIndex index, const double ref, TDiscordantBins& bins ) const;
+    void GetFilledBins( common::TChipIndex index, std::vector<std::uint32_t>& keys,
+                        std::vector<double>& contents ) const;
+    const THisto& GetHisto( common::TChipIndex index ) const;
 
 #pragma mark - other
     
@@ -112,6 +152,8 @@ public:
     void Incr( common::TChipIndex index, unsigned int i, unsigned int j );
     void Incr        (common::TChipIndex index, unsigned int i);
     void FindChipList();
+    /// add the bins of the histograms of a shard (subset of the chips) and clear them in the shard
+    void MergeShard( TScanHisto& shard );
     bool IsValidChipIndex( const common::TChipIndex idx );
     void Clear();
 };
@@ -38,14 +38,6 @@ fSaveToFileReady( false )
     fIdx.deviceType = TDeviceType::kUNKNOWN;
     fIdx.deviceId = 0;
     fIdx.chipId = 0;
-    fMapCanvas = new TCanvas( "cv" );
-    fH2Dummy = new TH2F ( "h2dummy", "",
-             fXNbinDummy, fXMinDummy, fXMaxDummy,
-             fYNbinDummy, fYMinDummy, fYMaxDummy ),
-    fH2Dummy->SetBit( kCanDelete );
-
-    SetBaseStyle();
-    fMapCanvas->UseCurrentStyle();
 }
 
 //___________________________________________________________________
@@ -71,25 +63,7 @@ fSaveToFileReady( false )
     fIdx.deviceId = aChipIndex.deviceId;
     fIdx.chipId = aChipIndex.chipId;
     
-    fMapCanvas = new TCanvas( "cv" );
-    fH2Dummy = new TH2F ( "h2dummy", "",
-                         fXNbinDummy, fXMinDummy, fXMaxDummy,
-                         fYNbinDummy, fYMinDummy, fYMaxDummy ),
-    fH2Dummy->SetBit( kCanDelete );
-    
-    
-    SetBaseStyle();
-    fMapCanvas->UseCurrentStyle();
-    
     SetHicChipName();
-    
-    string dummyname = GetName( "h2dummy" );
-    fH2Dummy->SetName( dummyname.c_str() );
-    string title = GetHistoTitle( fHicChipName );
-    fH2Dummy->SetTitle( title.c_str() );
-    
-    string cvname = GetName( "fMapCanvas" );
-    fMapCanvas->SetName( cvname.c_str() );
 }
 
 //___________________________________________________________________
@@ -97,8 +71,10 @@ THitMap::~THitMap()
 {
     // don't delete any other pointer to ROOT object
     // ROOT will take care by itself and delete anything in the Canvas
-    fMapCanvas->Clear();
-    delete fMapCanvas;
+    if ( fMapCanvas ) {
+        fMapCanvas->Clear();
+        delete fMapCanvas;
+    }
 }
 
 //___________________________________________________________________
@@ -111,6 +87,24 @@ void THitMap::SetNInjections( const unsigned int value )
     fNInjections = value;
 }
 
+//___________________________________________________________________
+void THitMap::CreateMapCanvas()
+{
+    if ( fMapCanvas ) {
+        return;
+    }
+    SetBaseStyle();
+    
+    fMapCanvas = new TCanvas( GetName( "fMapCanvas" ).c_str() );
+    fMapCanvas->UseCurrentStyle();
+    
+    string title = GetHistoTitle( fHicChipName );
+    fH2Dummy = new TH2F ( GetName( "h2dummy" ).c_str(), title.c_str(),
+                         fXNbinDummy, fXMinDummy, fXMaxDummy,
+                         fYNbinDummy, fYMinDummy, fYMaxDummy );
+    fH2Dummy->SetBit( kCanDelete );
+}
+
 //___________________________________________________________________
 void THitMap::SetHicChipName()
 {
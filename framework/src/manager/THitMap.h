@@ -34,13 +34,13 @@ protected:
     /// number of injections for each pixel
     unsigned int fNInjections;
     
-    /// the canvas that will contain all pads
+    /// the canvas that will contain all pads (only created by BuildCanvas())
     TCanvas* fMapCanvas;
     
     /// index of the chip for which we collect errors
     common::TChipIndex fIdx;
     
-    /// dummy 2D histo used to draw axis of the hit map
+    /// dummy 2D histo used to draw axis of the hit map (only created by BuildCanvas())
     TH2F* fH2Dummy;
     
     /// min for the x-axis of the hit map
@@ -97,6 +97,9 @@ public:
 
 protected:
     
+    /// create the canvas and the dummy 2D histo, no graphics object exists before
+    void CreateMapCanvas();
+    
     /// set the hic and chip name for which the hit map will be
     void SetHicChipName();
     
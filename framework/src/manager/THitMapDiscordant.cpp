@@ -11,7 +11,7 @@
 #include "TROOT.h" // useful for global ROOT pointers (such as gPad)
 #include "TGaxis.h"
 #include "TH2F.h"
-#include "TMarker.h"
+#include "TPolyMarker.h"
 #include "Rtypes.h"
 #include "TPDF.h"
 #include "TLine.h"
@@ -57,21 +57,7 @@ fHistoInefficient( nullptr ),
 fHistoHot( nullptr ),
 fHistoLegend( nullptr )
 {
-    fFireCanvas = new TCanvas( "cvF" );
-    fHistoScale = new TH1F( "hscale", "Discordant pixels; Firing frequency per pixel; Yield", (int)(1.5*fNInjections), -3.5, (1.5*fNInjections)+3.5 );
-    fHistoDead = new TH1F( "hdead", "", (int)(1.5*fNInjections), -3.5, (1.5*fNInjections)+3.5 );
-    fHistoInefficient = new TH1F( "hineff", "", (int)(1.5*fNInjections), -3.5, (1.5*fNInjections)+3.5 );
-    fHistoHot =  new TH1F( "hhot", "", (int)(1.5*fNInjections), -3.5, (1.5*fNInjections)+3.5 );
-    
-    fHistoScale->SetStats( kFALSE );
-    fHistoDead->SetStats( kFALSE );
-    fHistoInefficient->SetStats( kFALSE );
-    fHistoHot->SetStats( kFALSE );
-    
-    fHistoScale->SetBit( kCanDelete );
-    fHistoDead->SetBit( kCanDelete );
-    fHistoInefficient->SetBit( kCanDelete );
-    fHistoHot->SetBit( kCanDelete );
+
 }
 
 //___________________________________________________________________
@@ -92,45 +78,6 @@ fHistoInefficient( nullptr ),
 fHistoHot( nullptr ),
 fHistoLegend( nullptr )
 {
-    fFireCanvas = new TCanvas( "cvF" );
-    string titleS = fHicChipName + "; Firing frequency per pixel; Yield";
-    fHistoScale = new TH1F( "hscale", titleS.c_str(), (int)(1.5*fNInjections), -3.5, (1.5*fNInjections)+3.5 );
-    fHistoDead = new TH1F( "hdead", "", (int)(1.5*fNInjections), -3.5, (1.5*fNInjections)+3.5 );
-    fHistoInefficient = new TH1F( "hineff", "", (int)(1.5*fNInjections), -3.5, (1.5*fNInjections)+3.5 );
-    fHistoHot =  new TH1F( "hhot", "", (int)(1.5*fNInjections), -3.5, (1.5*fNInjections)+3.5 );
-    
-    string nameS = GetName( "hscale" );
-    fHistoScale->SetName( nameS.c_str() );
-
-    string nameD = GetName( "hdead" );
-    fHistoDead->SetName( nameD.c_str() );
-
-    string nameI = GetName( "hineff" );
-    fHistoInefficient->SetName( nameI.c_str() );
-
-    string nameH = GetName( "hhot" );
-    fHistoHot->SetName( nameH.c_str() );
-    
-    string nameCv = GetName( "fFireCanvas" );
-    fFireCanvas->SetName( nameCv.c_str() );
-
-    fHistoScale->SetStats( kFALSE );
-    fHistoDead->SetStats( kFALSE );
-    fHistoInefficient->SetStats( kFALSE );
-    fHistoHot->SetStats( kFALSE );
-    
-    fHistoScale->SetBit( kCanDelete );
-    fHistoDead->SetBit( kCanDelete );
-    fHistoInefficient->SetBit( kCanDelete );
-    fHistoHot->SetBit( kCanDelete );
-    
-    fHistoDead->SetFillColor( fDeadColor );
-    fHistoInefficient->SetFillColor( fIneffColor );
-    fHistoHot->SetFillColor( fHotColor );
-
-    fHistoDead->SetLineColor( fDeadColor );
-    fHistoInefficient->SetLineColor( fIneffColor );
-    fHistoHot->SetLineColor( fHotColor );
 
 }
 
@@ -139,8 +86,10 @@ THitMapDiscordant::~THitMapDiscordant()
 {
     // don't delete any other pointer to ROOT object
     // ROOT will take care by itself and delete anything in the Canvas
-    fFireCanvas->Clear();
-    delete fFireCanvas;
+    if ( fFireCanvas ) {
+        fFireCanvas->Clear();
+        delete fFireCanvas;
+    }
 }
 
 //___________________________________________________________________
@@ -157,6 +106,7 @@ void THitMapDiscordant::BuildCanvas()
     
     // canvas
     
+    CreateMapCanvas();
     fMapCanvas->SetWindowSize( fWidth, fHeight );
     fMapCanvas->SetFillColor( kWhite );
     fMapCanvas->SetFillStyle( kFSolid );
@@ -254,6 +204,34 @@ void THitMapDiscordant::BuildCanvas()
     
     //--- firing frequency distribution of bad pixels
 
+    fFireCanvas = new TCanvas( GetName( "fFireCanvas" ).c_str() );
+    string titleS = fHicChipName.empty() ? "Discordant pixels" : fHicChipName;
+    titleS += "; Firing frequency per pixel; Yield";
+    const int nbins = (int)(1.5*fNInjections);
+    const double xmin = -3.5, xmax = (1.5*fNInjections)+3.5;
+    fHistoScale = new TH1F( GetName( "hscale" ).c_str(), titleS.c_str(), nbins, xmin, xmax );
+    fHistoDead = new TH1F( GetName( "hdead" ).c_str(), "", nbins, xmin, xmax );
+    fHistoInefficient = new TH1F( GetName( "hineff" ).c_str(), "", nbins, xmin, xmax );
+    fHistoHot =  new TH1F( GetName( "hhot" ).c_str(), "", nbins, xmin, xmax );
+    
+    fHistoScale->SetStats( kFALSE );
+    fHistoDead->SetStats( kFALSE );
+    fHistoInefficient->SetStats( kFALSE );
+    fHistoHot->SetStats( kFALSE );
+    
+    fHistoScale->SetBit( kCanDelete );
+    fHistoDead->SetBit( kCanDelete );
+    fHistoInefficient->SetBit( kCanDelete );
+    fHistoHot->SetBit( kCanDelete );
+    
+    fHistoDead->SetFillColor( fDeadColor );
+    fHistoInefficient->SetFillColor( fIneffColor );
+    fHistoHot->SetFillColor( fHotColor );
+
+    fHistoDead->SetLineColor( fDeadColor );
+    fHistoInefficient->SetLineColor( fIneffColor );
+    fHistoHot->SetLineColor( fHotColor );
+
     fFireCanvas->cd();
 
     fHistoLegend = new TLegend( 0.21, 0.65, 0.52, 0.90 );
@@ -271,7 +249,7 @@ void THitMapDiscordant::BuildCanvas()
 }
 
 //___________________________________________________________________
-void THitMapDiscordant::AddDeadPixel( shared_ptr<TPixHit> pix )
+void THitMapDiscordant::AddDeadPixel( const unsigned int column, const unsigned int row )
 {
     if ( !IsCanvasReady() ) {
         throw runtime_error( "THitMapDiscordant::AddDeadPixel() - canvas not ready!" );
@@ -279,27 +257,15 @@ void THitMapDiscordant::AddDeadPixel( shared_ptr<TPixHit> pix )
 
     fNDeadPixels++;
     
-    fMapPadMain->cd();
-    
-    TMarker* marker = new TMarker();
-    marker->SetMarkerStyle( fDeadStyle );
-    marker->SetMarkerSize( fDeadSize );
-    marker->SetMarkerColor( fDeadColor );
-    float ym = pix->GetRow();
-    if ( IsMapYInverted() ) {
-        ym = fYMaxDummy - pix->GetRow();
-    }
-    float xm = pix->GetColumn();
-    marker->DrawMarker( xm, ym );
+    AddMarker( column, row, fDeadX, fDeadY );
 
     fHistoScale->Fill(0);
     fHistoDead->Fill(0);
-
-    delete marker;
 }
 
 //___________________________________________________________________
-void THitMapDiscordant::AddInefficientPixel( shared_ptr<TPixHit> pix,
+void THitMapDiscordant::AddInefficientPixel( const unsigned int column,
+                                             const unsigned int row,
                                              const unsigned int nTimesFired )
 {
     if ( !IsCanvasReady() ) {
@@ -308,27 +274,15 @@ void THitMapDiscordant::AddInefficientPixel( shared_ptr<TPixHit> pix,
 
     fNInefficientPixels++;
     
-    fMapPadMain->cd();
-    
-    TMarker* marker = new TMarker();
-    marker->SetMarkerStyle( fIneffStyle );
-    marker->SetMarkerSize( fIneffSize );
-    marker->SetMarkerColor( fIneffColor );
-    float ym = pix->GetRow();
-    if ( IsMapYInverted() ) {
-        ym = fYMaxDummy - pix->GetRow();
-    }
-    float xm = pix->GetColumn();
-    marker->DrawMarker( xm, ym );
-    
+    AddMarker( column, row, fIneffX, fIneffY );
+
     fHistoScale->Fill( nTimesFired );
     fHistoInefficient->Fill( nTimesFired );
-
-    delete marker;
 }
 
 //___________________________________________________________________
-void THitMapDiscordant::AddHotPixel( shared_ptr<TPixHit> pix,
+void THitMapDiscordant::AddHotPixel( const unsigned int column,
+                                     const unsigned int row,
                                      const unsigned int nTimesFired )
 {
     if ( !IsCanvasReady() ) {
@@ -337,23 +291,38 @@ void THitMapDiscordant::AddHotPixel( shared_ptr<TPixHit> pix,
     
     fNHotPixels++;
     
-    fMapPadMain->cd();
-    
-    TMarker* marker = new TMarker();
-    marker->SetMarkerStyle( fHotStyle );
-    marker->SetMarkerSize( fHotSize );
-    marker->SetMarkerColor( fHotColor );
-    float ym = pix->GetRow();
-    if ( IsMapYInverted() ) {
-        ym = fYMaxDummy - pix->GetRow();
-    }
-    float xm = pix->GetColumn();
-    marker->DrawMarker( xm, ym );
-    
+    AddMarker( column, row, fHotX, fHotY );
+
     fHistoScale->Fill( nTimesFired );
     fHistoHot->Fill( nTimesFired );
+}
 
-    delete marker;
+//___________________________________________________________________
+void THitMapDiscordant::AddMarker( const unsigned int column, const unsigned int row,
+                                   vector<double>& x, vector<double>& y )
+{
+    double ym = row;
+    if ( IsMapYInverted() ) {
+        ym = fYMaxDummy - row;
+    }
+    x.push_back( column );
+    y.push_back( ym );
+}
+
+//___________________________________________________________________
+void THitMapDiscordant::DrawMarkers( const vector<double>& x, const vector<double>& y,
+                                     const int style, const int color, const float size )
+{
+    if ( x.empty() ) {
+        return;
+    }
+    // one graphics object per type of bad pixel, whatever the number of pixels
+    TPolyMarker* markers = new TPolyMarker( (Int_t)x.size(), x.data(), y.data() );
+    markers->SetMarkerStyle( style );
+    markers->SetMarkerSize( size );
+    markers->SetMarkerColor( color );
+    markers->SetBit( kCanDelete );
+    markers->Draw();
 }
 
 //___________________________________________________________________
@@ -400,6 +369,12 @@ void THitMapDiscordant::FinishHitMap()
     }
     if ( fNDeadPixels | fNInefficientPixels | fNHotPixels ) {
         
+        fMapPadMain->cd();
+        DrawMarkers( fDeadX, fDeadY, fDeadStyle, fDeadColor, fDeadSize );
+        DrawMarkers( fIneffX, fIneffY, fIneffStyle, fIneffColor, fIneffSize );
+        DrawMarkers( fHotX, fHotY, fHotStyle, fHotColor, fHotSize );
+        gPad->Update();
+
         fMapPadLegend->cd();
         if ( fNDeadPixels ) {
             string label = "Dead pixels (";
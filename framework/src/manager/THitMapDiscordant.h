@@ -23,6 +23,7 @@
 
 #include <string>
 #include <memory>
+#include <vector>
 
 class TPixHit;
 
@@ -33,6 +34,7 @@ class TLegend;
 class TH1F;
 class TPad;
 class TPaveText;
+class TPolyMarker;
 
 class THitMapDiscordant : public THitMap {
     
@@ -108,6 +110,15 @@ class THitMapDiscordant : public THitMap {
     /// size to be used for hot pixel markers (0.6)
     static const float fHotSize;
 
+    /// marker coordinates (x, y) of the dead pixels, drawn at once by FinishHitMap()
+    std::vector<double> fDeadX, fDeadY;
+
+    /// marker coordinates (x, y) of the inefficient pixels, drawn at once by FinishHitMap()
+    std::vector<double> fIneffX, fIneffY;
+
+    /// marker coordinates (x, y) of the hot pixels, drawn at once by FinishHitMap()
+    std::vector<double> fHotX, fHotY;
+
 
 public:
     
@@ -122,17 +133,19 @@ public:
     /// destructor
     virtual ~THitMapDiscordant();
     
-    /// produce a canvas appropriate to draw the hit map
+    /// produce the canvases and histos appropriate to draw the hit map (nothing is drawn before)
     void BuildCanvas();
     
     /// add a dead pixel to the hit map
-    void AddDeadPixel( std::shared_ptr<TPixHit> pix );
+    void AddDeadPixel( const unsigned int column, const unsigned int row );
 
     /// add an inefficient pixel to the list
-    void AddInefficientPixel( std::shared_ptr<TPixHit> pix, const unsigned int nTimesFired );
+    void AddInefficientPixel( const unsigned int column, const unsigned int row,
+                              const unsigned int nTimesFired );
     
     /// add a hot pixel to the list
-    void AddHotPixel( std::shared_ptr<TPixHit> pix, const unsigned int nTimesFired );
+    void AddHotPixel( const unsigned int column, const unsigned int row,
+                      const unsigned int nTimesFired );
 
     /// draw all objects that must be drawn by the class
     void Draw();
@@ -142,8 +155,16 @@ public:
     
 private:
     
-    /// last step for the hit map, i.e. add legends for each type of bad pixel
+    /// last step for the hit map, i.e. draw the markers and add legends for each type of bad pixel
     void FinishHitMap();
+
+    /// store the marker coordinates of a bad pixel
+    void AddMarker( const unsigned int column, const unsigned int row,
+                    std::vector<double>& x, std::vector<double>& y );
+
+    /// draw all markers of one type of bad pixel as a single poly-marker
+    void DrawMarkers( const std::vector<double>& x, const std::vector<double>& y,
+                      const int style, const int color, const float size );
     
     /// draw the 1D histo with the distribution of the firing frequency for bad pixels
     void DrawFiringFrequencyHisto();
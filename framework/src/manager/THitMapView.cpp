@@ -69,6 +69,7 @@ void THitMapView::BuildCanvas()
         }
         return;
     }
+    CreateMapCanvas();
 
     fMapCanvas->SetFillColor( kWhite );
     fMapCanvas->SetFillStyle( kFSolid );
@@ -154,25 +155,53 @@ void THitMapView::WriteHitsToFile( const char *baseFName, const bool Recreate )
         cout << "THitMapView::WriteDataToFile() - Writing data to file "<< filenameChip << endl;
     }
 
+    vector<uint32_t> keys;
+    vector<double> contents;
+    fScanHisto->GetFilledBins( fChipIndex, keys, contents );
     TPixHit pixhit;
     pixhit.SetPixChipIndex( fChipIndex );
-    for ( unsigned int icol = 0; icol <= common::MAX_DCOL; icol ++ ) {
-        for ( unsigned int iaddr = 0; iaddr <= common::MAX_ADDR; iaddr ++ ) {
-            pixhit.SetDoubleColumn( icol );
-            pixhit.SetAddress( iaddr );
-            unsigned int column = pixhit.GetColumn();
-            unsigned int row = pixhit.GetRow();
-            double hits = (*fScanHisto)(fChipIndex,icol,iaddr);
-            if (hits > 0) {
-                fHisto2D->Fill( column, row, hits );
-                fprintf(fp, "%d %d %d\n", row, column, (int)hits);
-            }
+    for ( unsigned int ipix = 0; ipix < keys.size(); ipix++ ) {
+        pixhit.SetDoubleColumn( keys.at(ipix) / (common::MAX_ADDR+1) );
+        pixhit.SetAddress( keys.at(ipix) % (common::MAX_ADDR+1) );
+        unsigned int column = pixhit.GetColumn();
+        unsigned int row = pixhit.GetRow();
+        double hits = contents.at(ipix);
+        if (hits > 0) {
+            fHisto2D->Fill( column, row, hits );
+            fprintf(fp, "%d %d %d\n", row, column, (int)hits);
         }
     } 
     if (fp) fclose (fp);
     fHasData = true;
 }
 
+//___________________________________________________________________
+void THitMapView::ReadHitsFromFile( const char *baseFName )
+{
+    char filenameTemp[100];
+    sprintf( filenameTemp,"%s", baseFName);
+    strtok( filenameTemp, "." );
+    string suffix( filenameTemp );
+    string filename = common::GetFileName( fChipIndex, suffix );
+
+    FILE *fp = fopen( filename.c_str(), "r" );
+    if ( !fp ) {
+        throw runtime_error( "THitMapView::ReadHitsFromFile() - input file " + filename + " not found." );
+    }
+    if ( GetVerboseLevel() > kSILENT ) {
+        cout << "THitMapView::ReadHitsFromFile() - Reading data from file "<< filename << endl;
+    }
+    unsigned int row, column;
+    int hits;
+    while ( fscanf( fp, "%u %u %d", &row, &column, &hits ) == 3 ) {
+        if ( hits > 0 ) {
+            fHisto2D->Fill( column, row, hits );
+            fHasData = true;
+        }
+    }
+    fclose( fp );
+}
+
 //___________________________________________________________________
 void THitMapView::SaveToFile( const char *baseFName )
 {
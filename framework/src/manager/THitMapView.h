@@ -66,6 +66,9 @@ public:
     /// write the list of hit pixels to a file and fill TH2F* hit map for the chip
     void WriteHitsToFile( const char *baseFName, const bool Recreate );
 
+    /// fill TH2F* hit map for the chip from the file written by WriteHitsToFile()
+    void ReadHitsFromFile( const char *baseFName );
+
     /// save the drawing(s) to PDF file(s) and save the TH2F to a root file
     void SaveToFile( const char *baseFName );
 
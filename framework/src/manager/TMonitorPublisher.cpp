@@ -0,0 +1,190 @@
+#include "TMonitorPublisher.h"
+#include "TErrorCounter.h"
+#include "THisto.h"
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace std;
+
+//___________________________________________________________________
+TMonitorPublisher::TMonitorPublisher() : TVerbosity(),
+fName( "" ),
+fMap( nullptr ),
+fMapSize( 0 ),
+fPeriod( DEFAULTPERIOD )
+{
+    fNBins[0] = 0;
+    fNBins[1] = 0;
+}
+
+//___________________________________________________________________
+TMonitorPublisher::~TMonitorPublisher()
+{
+    Close();
+}
+
+//___________________________________________________________________
+void TMonitorPublisher::Open( const string name, TScanHisto& scanHisto )
+{
+    Close();
+    if ( !scanHisto.GetChipListSize() ) {
+        throw runtime_error( "TMonitorPublisher::Open() - no chip in the map of histograms !" );
+    }
+    fChipList.clear();
+    unsigned int nBoards = 0;
+    for ( unsigned int ichip = 0; ichip < scanHisto.GetChipListSize(); ichip++ ) {
+        fChipList.push_back( scanHisto.GetChipIndex( ichip ) );
+        nBoards = max( nBoards, fChipList.back().boardIndex + 1 );
+    }
+    fLastPublishTime.assign( nBoards, chrono::steady_clock::time_point() );
+
+    // all chips of a scan have the same kind of hit map (none for e.g. the threshold scan)
+    const THisto& histo = scanHisto.GetHisto( fChipList.front() );
+    const bool hasHitMap = ( histo.GetNDim() == 2 );
+    fNBins[0] = hasHitMap ? histo.GetNBin( 0 ) : 0;
+    fNBins[1] = hasHitMap ? histo.GetNBin( 1 ) : 0;
+
+    // a segment left by a previous scan is replaced
+    shm_unlink( name.c_str() );
+    const int fd = shm_open( name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644 );
+    if ( fd < 0 ) {
+        throw runtime_error( "TMonitorPublisher::Open() - can not create the monitoring segment " + name );
+    }
+    const size_t size = MonitorSegment::GetSegmentSize( fChipList.size(), fNBins[0], fNBins[1] );
+    if ( ftruncate( fd, size ) != 0 ) {
+        close( fd );
+        shm_unlink( name.c_str() );
+        throw runtime_error( "TMonitorPublisher::Open() - can not allocate the monitoring segment " + name );
+    }
+    void* map = mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+    close( fd );
+    if ( map == MAP_FAILED ) {
+        shm_unlink( name.c_str() );
+        throw runtime_error( "TMonitorPublisher::Open() - can not map the monitoring segment " + name );
+    }
+    fMap = (unsigned char*)map;
+    fMapSize = size;
+    fName = name;
+
+    // the new segment is filled with zeros: no snapshot yet, buffer 0 active
+    for ( unsigned int ichip = 0; ichip < fChipList.size(); ichip++ ) {
+        MonitorSegment::TSlotHeader* slot = GetSlot( ichip );
+        slot->boardIndex = fChipList.at(ichip).boardIndex;
+        slot->dataReceiver = fChipList.at(ichip).dataReceiver;
+        slot->deviceType = (uint32_t)fChipList.at(ichip).deviceType;
+        slot->deviceId = fChipList.at(ichip).deviceId;
+        slot->chipId = fChipList.at(ichip).chipId;
+    }
+    MonitorSegment::TSegmentHeader header;
+    memset( &header, 0, sizeof(header) );
+    header.version = MonitorSegment::VERSION;
+    header.nChips = fChipList.size();
+    header.nBins1 = fNBins[0];
+    header.nBins2 = fNBins[1];
+    header.writerPid = getpid();
+    memcpy( fMap, &header, sizeof(header) );
+
+    // the magic is written last: the monitor only uses a segment once it is ready
+    atomic_thread_fence( memory_order_release );
+    memcpy( fMap, MonitorSegment::SEGMENT_MAGIC, sizeof(header.magic) );
+
+    if ( GetVerboseLevel() > kSILENT ) {
+        cout << "TMonitorPublisher::Open() - " << name << " : " << std::dec << fChipList.size()
+             << " chip(s), " << size / (1024*1024) << " MB" << endl;
+    }
+}
+
+//___________________________________________________________________
+void TMonitorPublisher::Close()
+{
+    if ( !fMap ) return;
+    munmap( fMap, fMapSize );
+    shm_unlink( fName.c_str() );
+    fMap = nullptr;
+    fMapSize = 0;
+}
+
+//___________________________________________________________________
+MonitorSegment::TSlotHeader* TMonitorPublisher::GetSlot( const unsigned int ichip ) const
+{
+    return (MonitorSegment::TSlotHeader*)( fMap + MonitorSegment::GetSlotOffset( ichip, fNBins[0], fNBins[1] ) );
+}
+
+//___________________________________________________________________
+bool TMonitorPublisher::PublishBoard( const unsigned int iboard,
+                                      const TScanHisto& scanHisto,
+                                      const TScanHisto* histoShard,
+                                      TErrorCounter& errorCounter,
+                                      const bool force )
+{
+    if ( !fMap || (iboard >= fLastPublishTime.size()) ) return false;
+    const chrono::steady_clock::time_point now = chrono::steady_clock::now();
+    if ( !force && (now - fLastPublishTime.at(iboard) < fPeriod) ) return false;
+    fLastPublishTime.at(iboard) = now;
+
+    const uint64_t publishTime = chrono::duration_cast<chrono::milliseconds>(
+        chrono::system_clock::now().time_since_epoch() ).count();
+    const size_t nBins = (size_t)fNBins[0] * fNBins[1];
+    for ( unsigned int ichip = 0; ichip < fChipList.size(); ichip++ ) {
+        const common::TChipIndex idx = fChipList.at(ichip);
+        if ( idx.boardIndex != iboard ) continue;
+
+        // fill the inactive buffer, then make it the active one
+        MonitorSegment::TSlotHeader* slot = GetSlot( ichip );
+        const uint32_t inactive = 1 - ( slot->active.load( memory_order_relaxed ) & 1 );
+        unsigned char* buffer = (unsigned char*)slot + MonitorSegment::GetBufferOffset( inactive, fNBins[0], fNBins[1] );
+        MonitorSegment::TSnapshotHeader* header = (MonitorSegment::TSnapshotHeader*)buffer;
+        uint32_t* hits = (uint32_t*)( buffer + MonitorSegment::GetHitMapOffset() );
+
+        const uint64_t sequence = header->sequence.load( memory_order_relaxed );
+        header->sequence.store( sequence + 1, memory_order_relaxed );
+        atomic_thread_fence( memory_order_release );
+
+        header->publishTime = publishTime;
+        header->nEntries = 0;
+        header->nHitPixels = 0;
+        if ( nBins ) {
+            memset( hits, 0, nBins * sizeof(uint32_t) );
+            AddHits( scanHisto, idx, hits, *header );
+            if ( histoShard ) AddHits( *histoShard, idx, hits, *header );
+        }
+        unsigned int nCorruptedHits = 0, nPrioEncoder = 0, n8b10b = 0;
+        errorCounter.GetChipErrors( idx, nCorruptedHits, nPrioEncoder, n8b10b );
+        header->nCorruptedHits = nCorruptedHits;
+        header->nPrioEncoder = nPrioEncoder;
+        header->n8b10b = n8b10b;
+        header->nTimeout = errorCounter.GetNTimeout();
+
+        header->sequence.store( sequence + 2, memory_order_release );
+        slot->active.store( inactive, memory_order_release );
+    }
+    if ( GetVerboseLevel() > kULTRACHATTY ) {
+        cout << "TMonitorPublisher::PublishBoard() - board " << std::dec << iboard << " published" << endl;
+    }
+    return true;
+}
+
+//___________________________________________________________________
+void TMonitorPublisher::AddHits( const TScanHisto& scanHisto,
+                                 const common::TChipIndex idx,
+                                 uint32_t* hits,
+                                 MonitorSegment::TSnapshotHeader& header ) const
+{
+    const THisto& histo = scanHisto.GetHisto( idx );
+    if ( ((uint32_t)histo.GetNBin( 0 ) != fNBins[0]) || ((uint32_t)histo.GetNBin( 1 ) != fNBins[1]) ) {
+        return;
+    }
+    vector<uint32_t> keys;
+    vector<double> contents;
+    histo.GetFilledBins( keys, contents );
+    for ( unsigned int k = 0; k < keys.size(); k++ ) {
+        if ( !hits[keys[k]] ) header.nHitPixels++;
+        hits[keys[k]] += (uint32_t)contents[k];
+        header.nEntries += (uint64_t)contents[k];
+    }
+}
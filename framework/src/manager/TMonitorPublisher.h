@@ -0,0 +1,97 @@
+#ifndef MONITOR_PUBLISHER_H
+#define MONITOR_PUBLISHER_H
+
+/**
+ * \class TMonitorPublisher
+ *
+ * \brief Publish live snapshots of the hit maps and error counters of the chips in a
+ * shared memory segment, for a separate monitor process (see TMonitorReader and the
+ * executable test_monitor)
+ *
+ * \author Andry Rakotozafindrabe
+ *
+ * The snapshots of the chips of a board are published by the thread that decodes the
+ * board, at most once per period: the hit maps are copied into the inactive buffer of
+ * each chip, which is then made active with an atomic store (see TMonitorSegment.h).
+ * The publication never waits for the monitor process, and a board is published by a
+ * single thread at a time, so that different boards can be published at the same time.
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Common.h"
+#include "TMonitorSegment.h"
+#include "TVerbosity.h"
+
+class TScanHisto;
+class TErrorCounter;
+
+class TMonitorPublisher : public TVerbosity {
+
+    /// name of the shared memory segment
+    std::string fName;
+
+    /// start of the mapped segment
+    unsigned char* fMap;
+
+    /// size of the mapped segment
+    std::size_t fMapSize;
+
+    /// number of bins of the hit maps in each dimension (0 if no hit map)
+    std::uint32_t fNBins[2];
+
+    /// chips of the segment, in the order of their slots
+    std::vector<common::TChipIndex> fChipList;
+
+    /// min time between two snapshots of a board
+    std::chrono::milliseconds fPeriod;
+
+    /// time of the last snapshot of each board
+    std::vector<std::chrono::steady_clock::time_point> fLastPublishTime;
+
+public:
+
+    /// default min time (in ms) between two snapshots of a board
+    static const unsigned int DEFAULTPERIOD = 1000;
+
+    /// constructor
+    TMonitorPublisher();
+
+    /// destructor, removes the segment
+    ~TMonitorPublisher();
+
+    /// create the segment with one slot per chip of the map of histograms
+    void Open( const std::string name, TScanHisto& scanHisto );
+
+    /// unmap and remove the segment
+    void Close();
+
+    /// true if the segment is open
+    bool IsOpen() const { return ( fMap != nullptr ); }
+
+    /// set the min time between two snapshots of a board
+    void SetPeriod( const unsigned int ms ) { fPeriod = std::chrono::milliseconds( ms ); }
+
+    /// publish the chips of a given board if the period elapsed (or if forced); the hit map
+    /// of a chip is the sum of its histogram in the map and in the shard (if any) of the board
+    bool PublishBoard( const unsigned int iboard,
+                       const TScanHisto& scanHisto,
+                       const TScanHisto* histoShard,
+                       TErrorCounter& errorCounter,
+                       const bool force = false );
+
+private:
+
+    /// slot header of a given chip
+    MonitorSegment::TSlotHeader* GetSlot( const unsigned int ichip ) const;
+
+    /// add the filled bins of the histogram of a chip to a hit map
+    void AddHits( const TScanHisto& scanHisto, const common::TChipIndex idx,
+                  std::uint32_t* hits, MonitorSegment::TSnapshotHeader& header ) const;
+
+};
+
+#endif
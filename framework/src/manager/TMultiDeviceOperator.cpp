@@ -23,7 +23,8 @@ TVerbosity(),
 fScanType( MultiDeviceScanType::kNOISE_OCC_SCAN ),
 fNDevices( 0 ),
 fIsAdmissionClosed( false ),
-fIsInitDone( false )
+fIsInitDone( false ),
+fPlotting( true )
 { }
 
 //___________________________________________________________________
@@ -354,7 +355,9 @@ void TMultiDeviceOperator::TerminateDigitalScan()
         const bool Recreate = true;
         myDeviceTestor->WriteDataToFile( Recreate );
         myDeviceTestor->WriteCorruptedHitsToFile( Recreate );
-        myDeviceTestor->DrawAndSaveToFile();
+        if ( fPlotting ) {
+            myDeviceTestor->DrawAndSaveToFile();
+        }
     }
 }
 
@@ -374,6 +377,8 @@ void TMultiDeviceOperator::TerminateNoiseOccScan()
         myDeviceTestor->Terminate();
         const bool Recreate = true;
         myDeviceTestor->WriteDataToFile( Recreate );
-        myDeviceTestor->DrawAndSaveToFile();
+        if ( fPlotting ) {
+            myDeviceTestor->DrawAndSaveToFile();
+        }
     }
 }
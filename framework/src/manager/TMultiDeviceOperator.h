@@ -59,6 +59,9 @@ private:
     /// boolean will be set to true if all device operators are properly initialized
     bool fIsInitDone;
 
+    /// if false, only the data files are written at the end of the scan (default = true)
+    bool fPlotting;
+
     /// part (prefix) of the name of the output files
     std::string fName;
 
@@ -76,6 +79,9 @@ public:
     /// method that sets part of the name of the output files
     void SetPrefixFilename( std::string prefixFileName ) { fName = prefixFileName; }
 
+    /// draw the plots at the end of the scan, or only write the data files (see test_plotresults)
+    void SetPlotting( const bool value ) { fPlotting = value; }
+
     /// add a setup
     void AddSetup( const std::string aConfigFileName ); 
 
@@ -61,6 +61,8 @@ public:
     virtual int  SendOpCode        (std::uint16_t  OpCode) = 0;
     // sends op code to control interface belonging to chip chipId
     virtual int  SendOpCode        (std::uint16_t  OpCode, std::uint8_t chipId) = 0;
+    // executes the chip register transactions queued on the control interface of chip chipId
+    virtual int  ExecuteChipTransactions(std::uint8_t chipId) = 0;
     
     virtual int  SetTriggerConfig  (bool enablePulse, bool enableTrigger, int triggerDelay, int pulseDelay) = 0;
     virtual void SetTriggerSource  (TTriggerSource triggerSource) = 0;
@@ -177,6 +177,12 @@ class TReadoutBoardDAQ : public TUSBBoard, public TReadoutBoard {
   // DAQ board has only one control interface -> both methods are identical
   int  SendOpCode        (std::uint16_t  OpCode) ;
     int  SendOpCode        (std::uint16_t  OpCode, std::uint8_t chipId) { std::cout << "chip ID = " << chipId << std::endl; return SendOpCode (OpCode);};
+  // chip register transactions are never queued on DAQ board -> nothing to execute
+  int  ExecuteChipTransactions(std::uint8_t chipId)
+  {
+    (void)chipId;
+    return 0;
+  }
 
   int  SetTriggerConfig  (bool enablePulse, bool enableTrigger, int triggerDelay, int pulseDelay);
   void SetTriggerSource  (TTriggerSource triggerSource);
@@ -105,7 +105,12 @@ TReadoutBoardMOSAIC::TReadoutBoardMOSAIC() :
     fPulser( nullptr ),
     fTrgRecorder( nullptr ),
     fTrgDataParser( nullptr ),
+    fTriggerTable( nullptr ),
     fCoordinator( nullptr ),
+    fEventOrdinal( 0 ),
+    fNRecordsGiven( 0 ),
+    fFirstCheckedOrdinal( 0 ),
+    fNOrdinalMismatches( 0 ),
     fTheVersionId(""),
     fTheVersionMaj( 0 ),
     fTheVersionMin( 0 ),
@@ -119,7 +124,12 @@ TReadoutBoardMOSAIC::TReadoutBoardMOSAIC( shared_ptr<TBoardConfigMOSAIC> boardCo
     fPulser( nullptr ),
     fTrgRecorder( nullptr ),
     fTrgDataParser( nullptr ),
+    fTriggerTable( nullptr ),
     fCoordinator( nullptr ),
+    fEventOrdinal( 0 ),
+    fNRecordsGiven( 0 ),
+    fFirstCheckedOrdinal( 0 ),
+    fNOrdinalMismatches( 0 ),
     fTheVersionId(""),
     fTheVersionMaj( 0 ),
     fTheVersionMin( 0 ),
@@ -215,6 +225,22 @@ int TReadoutBoardMOSAIC::SendOpCode (uint16_t  OpCode)
     return(0);
 }
 
+//___________________________________________________________________
+int TReadoutBoardMOSAIC::ExecuteChipTransactions (uint8_t chipId)
+{
+    if ( !ClockOutputsEnabled() ) {
+        throw runtime_error( "TReadoutBoardMOSAIC::ExecuteChipTransactions() - clock outputs disabled" );
+    }
+    uint_fast16_t Cii = GetControlInterface(chipId);
+    try {
+        fControlInterface[Cii]->execute();
+    } catch ( exception &err ) {
+        cerr << err.what() << endl;
+        throw err;
+    }
+    return(0);
+}
+
 //___________________________________________________________________
 int TReadoutBoardMOSAIC::SetTriggerConfig (bool enablePulse, bool enableTrigger, int triggerDelay, int pulseDelay)
 {
@@ -293,13 +319,13 @@ int  TReadoutBoardMOSAIC::ReadEventData (int &nBytes, unsigned char *buffer)
     MDataReceiver *dr;
     long readDataSize;
     
-    // check for data in the receivers buffer
-    for (int i = 0; i < (int)MosaicBoardConfig::MAX_TRANRECV; i++){
-        if (fAlpideDataParser[i]->hasData())
-            return (fAlpideDataParser[i]->ReadEventData(nBytes, buffer));
-    }
-    if ( fTrgDataParser->hasData() ) 
-        return (fTrgDataParser->ReadEventData(nBytes, buffer));
+    // events already in the receivers buffer are read first
+    if ( !fReadySources.empty() )
+        return ReadReadySource(nBytes, buffer);
+    
+    // the run is stopped and all the drained data were read
+    if ( tcp_sockfd == -1 )
+        return MosaicDict::kEMPTY_EVENT;
     
     // try to read from TCP connection
     shared_ptr<TBoardConfigMOSAIC> spBoardConfig = fBoardConfig.lock();
@@ -316,11 +342,10 @@ int  TReadoutBoardMOSAIC::ReadEventData (int &nBytes, unsigned char *buffer)
         }
         
         // get event data from the selected data receiver
-        if (dr->hasData()) {
-            TAlpideDataParser* pa = dynamic_cast<TAlpideDataParser*>(dr);
-            if ( pa ) return (pa->ReadEventData(nBytes, buffer));
-            TrgRecorderParser* pt = dynamic_cast<TrgRecorderParser*>(dr);
-            if ( pt ) return (pt->ReadEventData(nBytes, buffer));
+        if (dr && dr->hasData()) {
+            SetReady( dr->getBlockSource() );
+            if ( !fReadySources.empty() )
+                return ReadReadySource(nBytes, buffer);
         }
     }
     return MosaicDict::kEMPTY_EVENT;
@@ -333,6 +358,22 @@ void TReadoutBoardMOSAIC::StartRun()
         throw runtime_error( "TReadoutBoardMOSAIC::StartRun() - clock outputs disabled" );
     }
     enableDefinedReceivers();
+    if ( fBoardConfig.lock()->IsTrgRecorderEnable() ) {
+        fRunSources.push_back( 11 ); // trigger recorder, ID 11
+    }
+    flushDataReceivers(); // forget what was left unread from the previous run
+    fTriggerTable->Clear(); // one table of trigger records per run
+    for ( auto& source : fDataSources ) {
+        source.ready = false;
+    }
+    fSourceNEvents.assign( fDataSources.size(), 0 );
+    fSourceBunchCounter.assign( fDataSources.size(), -1 );
+    fEventOrdinal = 0;
+    fNRecordsGiven = 0;
+    fOrdinalBunchCounters.clear();
+    fFirstCheckedOrdinal = 0;
+    fNOrdinalMismatches = 0;
+    fReadySources.clear();
     connectTCP(); // open TCP connection
     mRunControl->startRun(); // start run
     usleep(5000);
@@ -353,7 +394,20 @@ void TReadoutBoardMOSAIC::StopRun()
         fPulser->run(0);
     }
     mRunControl->stopRun();
-    closeTCP();  // FIXME: this could cause the lost of the tail of the buffer ...
+    
+    // read the tail of the data until the end of run markers, the drained events
+    // stay in the receivers buffers and can still be read with ReadEventData()
+    try {
+        long nDrained = drainTCP( spBoardConfig->GetPollingDataTimeout(), fRunSources );
+        if ( GetVerboseLevel() > kTERSE ) {
+            cout << "TReadoutBoardMOSAIC::StopRun() - board " << std::dec << getBoardId()
+                 << " : " << nDrained << " closed event(s) drained after the end of run" << endl;
+        }
+    } catch ( exception& e ) {
+        cerr << "TReadoutBoardMOSAIC::StopRun() - " << e.what() << endl;
+    }
+    FindReadySources();
+    closeTCP();
 }
 
 //___________________________________________________________________
@@ -576,13 +630,15 @@ void TReadoutBoardMOSAIC::init()
         fAlpideDataParser[i]->SetVerboseLevel( this->GetVerboseLevel() );
         fAlpideDataParser[i]->SetPointerTriggerNum( GetPointerTriggerNum() ); 
 		fAlpideDataParser[i]->SetPointerTriggerTime( GetPointerTriggerTime() ); 
-        addDataReceiver(i+1, fAlpideDataParser[i]); // ID 1-10
+        AddDataSource(i+1, fAlpideDataParser[i]); // ID 1-10
     }
 
     // Trigger data recorder
     fTrgDataParser = new TrgRecorderParser();
     fTrgDataParser->SetVerboseLevel( this->GetVerboseLevel() );
-    addDataReceiver(11, fTrgDataParser); // ID 11;
+    fTriggerTable = make_shared<TTriggerTable>();
+    fTrgDataParser->SetTriggerTable( fTriggerTable, getBoardId() );
+    AddDataSource(11, fTrgDataParser); // ID 11;
     
     if ( spBoardConfig->IsMasterSlaveModeOn() ) {
         try {
@@ -714,15 +770,21 @@ void TReadoutBoardMOSAIC::enableDefinedReceivers()
     for (int i = 0; i < (int)MosaicBoardConfig::MAX_TRANRECV; i++) { 
         Used[i] = false;
     }
+    fRunSources.clear();
+    fSourceNChips.assign( (int)MosaicBoardConfig::MAX_TRANRECV + 1, 0 );
     
     for( int i=0; i < (int)fChipPositions.size(); i++ ) { //for each defined chip
         shared_ptr<TChipConfig> spChipConfig = (fChipPositions.at(i)).lock();
         int dataLink = spChipConfig->GetReceiver();
         if(dataLink >= 0) { // Enable the data receiver
+            if ( spChipConfig->IsEnabled() ) {
+                fSourceNChips[dataLink + 1]++;
+            }
             if ( spChipConfig->IsEnabled() && !Used[dataLink] ) {
                 cout << "TReadoutBoardMOSAIC::enableDefinedReceivers() - ENabling receiver " << dataLink << endl;
                 fAlpideRcv[dataLink]->addEnable(true);
                 Used[dataLink] = true;
+                fRunSources.push_back( dataLink + 1 ); // ID 1-10
                 //fAlpideRcv[dataLink]->execute();
             }
             else if (!Used[dataLink]){
@@ -734,6 +796,159 @@ void TReadoutBoardMOSAIC::enableDefinedReceivers()
     return;
 }
 
+//___________________________________________________________________
+void TReadoutBoardMOSAIC::AddDataSource( const int source, TAlpideDataParser* parser )
+{
+    addDataReceiver( source, parser );
+    if ( source >= (int)fDataSources.size() ) {
+        fDataSources.resize( source + 1 );
+    }
+    fDataSources[source].type = kALPIDE_PARSER;
+    fDataSources[source].alpideParser = parser;
+}
+
+//___________________________________________________________________
+void TReadoutBoardMOSAIC::AddDataSource( const int source, TrgRecorderParser* parser )
+{
+    addDataReceiver( source, parser );
+    if ( source >= (int)fDataSources.size() ) {
+        fDataSources.resize( source + 1 );
+    }
+    fDataSources[source].type = kTRG_PARSER;
+    fDataSources[source].trgParser = parser;
+}
+
+//___________________________________________________________________
+void TReadoutBoardMOSAIC::SetReady( const int source )
+{
+    if ( (source < 0) || (source >= (int)fDataSources.size()) ) return;
+    TDataSource& entry = fDataSources[source];
+    if ( entry.ready || (entry.type == kNO_PARSER) ) return;
+    entry.ready = true;
+    fReadySources.push_back( source );
+}
+
+//___________________________________________________________________
+void TReadoutBoardMOSAIC::FindReadySources()
+{
+    // receivers filled without going through ReadEventData() (e.g. drained at StopRun)
+    for ( int source = 0; source < (int)fDataSources.size(); source++ ) {
+        const TDataSource& entry = fDataSources[source];
+        if ( (entry.type == kALPIDE_PARSER) && entry.alpideParser->hasData() ) SetReady( source );
+        if ( (entry.type == kTRG_PARSER) && entry.trgParser->hasData() ) SetReady( source );
+    }
+}
+
+//___________________________________________________________________
+int TReadoutBoardMOSAIC::ReadReadySource( int &nBytes, unsigned char *buffer )
+{
+    // read one event of the oldest ready source, it stays in the list while it has events
+    const int source = fReadySources.front();
+    TDataSource& entry = fDataSources[source];
+    int status = MosaicDict::kEMPTY_EVENT;
+    bool hasData = false;
+    switch ( entry.type ) {
+        case kALPIDE_PARSER: {
+            TrimTriggerTable();
+            status = entry.alpideParser->ReadEventData(nBytes, buffer);
+            hasData = entry.alpideParser->hasData();
+            if ( (status > 0) && (source < (int)fSourceNEvents.size()) && (source < (int)fSourceNChips.size())
+                && (source < (int)fSourceBunchCounter.size()) ) {
+                CheckEventOrdinal( source, buffer, nBytes );
+            }
+            break;
+        }
+        case kTRG_PARSER:
+            status = entry.trgParser->ReadEventData(nBytes, buffer);
+            hasData = entry.trgParser->hasData();
+            // the records added so far are handled by the caller before its next call
+            if ( status == MosaicDict::kTRGRECORDER_EVENT ) {
+                fNRecordsGiven = fTriggerTable->GetNAdded();
+            }
+            break;
+        default:
+            break;
+    }
+    if ( !hasData ) {
+        entry.ready = false;
+        fReadySources.pop_front();
+    }
+    return status;
+}
+
+//___________________________________________________________________
+void TReadoutBoardMOSAIC::TrimTriggerTable()
+{
+    // the records given back and whose triggers were read by all receivers are not needed anymore
+    if ( !fTriggerTable ) return;
+    uint64_t nPassed = fNRecordsGiven;
+    for ( unsigned int source = 0; (source < fSourceNEvents.size()) && (source < fSourceNChips.size()); source++ ) {
+        if ( !fSourceNChips[source] ) continue;
+        nPassed = min( nPassed, fSourceNEvents[source] / fSourceNChips[source] );
+    }
+    if ( nPassed > fTriggerTable->GetNRemoved() ) {
+        fTriggerTable->RemoveFirst( nPassed - fTriggerTable->GetNRemoved() );
+    }
+}
+
+//___________________________________________________________________
+void TReadoutBoardMOSAIC::CheckEventOrdinal( const int source, const unsigned char *buffer, const int nBytes )
+{
+    // each chip of the receiver gives one event per trigger, unless an event was lost
+    const unsigned int nChips = fSourceNChips[source] ? fSourceNChips[source] : 1;
+    fEventOrdinal = fSourceNEvents[source] / nChips;
+    // all events of a trigger have the same bunch counter, whatever their chip and receiver
+    const int bunchCounter = TAlpideDataParser::GetBunchCounter( buffer + (int)MosaicIPbus::HEADER_SIZE,
+                                                                 nBytes - (int)MosaicIPbus::HEADER_SIZE );
+    if ( bunchCounter >= 0 ) {
+        // forget the ordinals already read by all receivers
+        uint64_t minOrdinal = fEventOrdinal;
+        for ( unsigned int s = 0; (s < fSourceNEvents.size()) && (s < fSourceNChips.size()); s++ ) {
+            if ( !fSourceNChips[s] ) continue;
+            minOrdinal = min( minOrdinal, fSourceNEvents[s] / fSourceNChips[s] );
+        }
+        while ( !fOrdinalBunchCounters.empty() && (fFirstCheckedOrdinal < minOrdinal) ) {
+            fOrdinalBunchCounters.pop_front();
+            fFirstCheckedOrdinal++;
+        }
+        if ( fOrdinalBunchCounters.empty() ) {
+            fFirstCheckedOrdinal = minOrdinal;
+        }
+        const uint64_t index = fEventOrdinal - fFirstCheckedOrdinal;
+        if ( fOrdinalBunchCounters.size() < index + 2 ) {
+            fOrdinalBunchCounters.resize( index + 2 );
+        }
+        TOrdinalBunchCounter& expected = fOrdinalBunchCounters[index];
+        TOrdinalBunchCounter& next = fOrdinalBunchCounters[index + 1];
+        if ( expected.bunchCounter < 0 ) {
+            expected.bunchCounter = bunchCounter;
+            expected.source = source;
+        } else if ( expected.bunchCounter != bunchCounter ) {
+            fNOrdinalMismatches++;
+            if ( GetVerboseLevel() > kTERSE ) {
+                cout << "TReadoutBoardMOSAIC::CheckEventOrdinal() - receiver " << std::dec << source - 1
+                     << " , bunch counter " << bunchCounter << " instead of " << expected.bunchCounter
+                     << " for the trigger ordinal " << fEventOrdinal << endl;
+            }
+            // the receiver lost an event of this trigger if its event belongs to the next
+            // trigger, if another chip of this receiver gave this trigger, or if its
+            // previous event already belonged to this trigger
+            if ( (next.bunchCounter == bunchCounter)
+                || ((next.bunchCounter < 0) && ((expected.source == source)
+                                                || (fSourceBunchCounter[source] == expected.bunchCounter))) ) {
+                fEventOrdinal++;
+                fSourceNEvents[source] = fEventOrdinal * nChips;
+                if ( next.bunchCounter < 0 ) {
+                    next.bunchCounter = bunchCounter;
+                    next.source = source;
+                }
+            }
+        }
+    }
+    fSourceBunchCounter[source] = bunchCounter;
+    fSourceNEvents[source]++;
+}
+
 //___________________________________________________________________
 void TReadoutBoardMOSAIC::setPhase(const int APhase, const int ACii)
 {
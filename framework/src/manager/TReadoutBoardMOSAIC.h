@@ -39,6 +39,7 @@
 #include "mdatareceiver.h"
 #include "trgrecorderparser.h"
 #include "trgrecorder.h"
+#include "TTriggerTable.h"
 #include "TAlpideDataParser.h"
 
 #include <memory>
@@ -75,6 +76,7 @@ public:
     
 	int SendOpCode(std::uint16_t  OpCode, std::uint8_t chipId);
 	int SendOpCode(std::uint16_t  OpCode);
+    int ExecuteChipTransactions(std::uint8_t chipId);
         // Markus: changed trigger delay type from std::uint32_t to int, since changed upstream
 	int SetTriggerConfig(bool enablePulse, bool enableTrigger, int triggerDelay, int pulseDelay);
 	void SetTriggerSource(TTriggerSource triggerSource);
@@ -116,6 +118,15 @@ public:
     MCoordinator::mode_t GetCoordinatorMode() const;
     std::uint32_t GetTriggerNum() const;
     std::uint64_t GetTriggerTime() const;
+    /// table of the trigger records received since the start of the run, filled from the thread that reads the board;
+    /// the records already given back by ReadEventData() and read by all receivers are removed from it
+    std::shared_ptr<TTriggerTable> GetTriggerTable() { return fTriggerTable; }
+    /// ordinal since the start of the run, within its receiver, of the trigger of the last chip
+    /// event given back by ReadEventData() (= index of its trigger record since the start of the run,
+    /// see TTriggerTable::GetNRemoved())
+    std::uint64_t GetEventOrdinal() const { return fEventOrdinal; }
+    /// number of chip events since the start of the run whose ordinal disagreed with their bunch counter
+    unsigned long GetNOrdinalMismatches() const { return fNOrdinalMismatches; }
 
     void SendBroadcastReset();
     void SendBroadcastROReset();
@@ -126,6 +137,13 @@ private:
 	void init();
     std::string getFirmwareVersion();
 	void enableDefinedReceivers();
+    void AddDataSource( const int source, TAlpideDataParser* parser );
+    void AddDataSource( const int source, TrgRecorderParser* parser );
+    void SetReady( const int source );
+    void FindReadySources();
+    int  ReadReadySource( int &nBytes, unsigned char *buffer );
+    void TrimTriggerTable();
+    void CheckEventOrdinal( const int source, const unsigned char *buffer, const int nBytes );
 	void setPhase(const int APhase, const int ACii = 0);
 	void setSpeedMode(MosaicReceiverSpeed ASpeed);
 	void setInverted (bool AInverted, int Aindex = -1);
@@ -148,8 +166,60 @@ private:
     std::unique_ptr<ALPIDErcv>	fAlpideRcv[(int)MosaicBoardConfig::MAX_TRANRECV];
     std::unique_ptr<TrgRecorder> fTrgRecorder;
     TrgRecorderParser* fTrgDataParser;
+    std::shared_ptr<TTriggerTable> fTriggerTable;
     std::unique_ptr<MCoordinator> fCoordinator;
     TAlpideDataParser* fAlpideDataParser[(int)MosaicBoardConfig::MAX_TRANRECV];
+    
+    /// type of the parser that reads the events of a MOSAIC data source
+    enum TSourceType { kNO_PARSER, kALPIDE_PARSER, kTRG_PARSER };
+    
+    /// entry of the dispatch table of the data sources
+    struct TDataSource {
+        TSourceType type = kNO_PARSER;
+        TAlpideDataParser* alpideParser = nullptr;
+        TrgRecorderParser* trgParser = nullptr;
+        /// true if the source is in the list of ready sources
+        bool ready = false;
+    };
+    
+    /// dispatch table indexed by the MOSAIC data source id
+    std::vector<TDataSource> fDataSources;
+    
+    /// data sources with at least one complete event, in order of arrival
+    std::deque<int> fReadySources;
+
+    /// data sources enabled for the current run (they send an end of run marker)
+    std::vector<int> fRunSources;
+
+    /// number of chips read out through each data source in the current run
+    std::vector<unsigned int> fSourceNChips;
+
+    /// number of events given back by each data source since the start of the run
+    std::vector<std::uint64_t> fSourceNEvents;
+
+    /// see GetEventOrdinal()
+    std::uint64_t fEventOrdinal;
+
+    /// number of trigger records in the table when ReadEventData() last gave back a trigger record
+    std::uint64_t fNRecordsGiven;
+
+    /// bunch counter of the first chip event of a trigger ordinal, and its data source
+    struct TOrdinalBunchCounter {
+        int bunchCounter = -1;
+        int source = -1;
+    };
+
+    /// bunch counters of the trigger ordinals not yet read by all receivers
+    std::deque<TOrdinalBunchCounter> fOrdinalBunchCounters;
+
+    /// ordinal of the first entry of fOrdinalBunchCounters
+    std::uint64_t fFirstCheckedOrdinal;
+
+    /// bunch counter of the last event given back by each data source (-1 if none)
+    std::vector<int> fSourceBunchCounter;
+
+    /// see GetNOrdinalMismatches()
+    unsigned long fNOrdinalMismatches;
 	//TBoardHeader 		theHeaderOfReadData;  // This will host the info catch from Packet header/trailer YCM: FIXME, not used
     std::string fTheVersionId;  // Version properties
     int	fTheVersionMaj;
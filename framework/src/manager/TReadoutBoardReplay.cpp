@@ -0,0 +1,246 @@
+#include "TReadoutBoardReplay.h"
+#include "TBoardConfig.h"
+#include "mdictionary.h"
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+using namespace std;
+
+//___________________________________________________________________
+TReadoutBoardReplay::TReadoutBoardReplay( shared_ptr<TBoardConfig> boardConfig,
+                                          shared_ptr<TRawEventReader> aReader,
+                                          const unsigned int boardIndex ) :
+    TReadoutBoard( boardConfig ),
+    fBoardConfig( boardConfig ),
+    fReader( aReader ),
+    fBoardIndex( boardIndex ),
+    fSpeed( TReplaySpeed::kMAXIMUM ),
+    fClockPeriod( 25. ),
+    fNextEvent( 0 ),
+    fRunning( false ),
+    fNEventsRead( 0 ),
+    fTrgNum( 0 ),
+    fTrgTime( 0 ),
+    fFirstTrgTime( 0 ),
+    fTriggerTable( make_shared<TTriggerTable>() )
+{
+    if ( !fReader || !fReader->IsOpen() ) {
+        throw runtime_error( "TReadoutBoardReplay::TReadoutBoardReplay() - no raw event file open !" );
+    }
+}
+
+//___________________________________________________________________
+TReadoutBoardReplay::~TReadoutBoardReplay()
+{
+    fRegisters.clear();
+}
+
+//___________________________________________________________________
+void TReadoutBoardReplay::SetClockPeriod( const double ns )
+{
+    if ( ns <= 0 ) {
+        cerr << "TReadoutBoardReplay::SetClockPeriod() - the period must be positive !" << endl;
+        return;
+    }
+    fClockPeriod = ns;
+}
+
+//___________________________________________________________________
+string TReadoutBoardReplay::GetFwIdString() const
+{
+    const string version = fReader->GetFirmwareVersion( fBoardIndex );
+    return version.empty() ? string( "unknown" ) : version;
+}
+
+//___________________________________________________________________
+int TReadoutBoardReplay::ReadRegister( uint16_t Address, uint32_t &Value )
+{
+    (void)Address;
+    Value = 0;
+    return 0;
+}
+
+//___________________________________________________________________
+int TReadoutBoardReplay::WriteRegister( uint16_t Address, uint32_t Value )
+{
+    (void)Address;
+    (void)Value;
+    return 0;
+}
+
+//___________________________________________________________________
+int TReadoutBoardReplay::SendOpCode( uint16_t OpCode )
+{
+    (void)OpCode;
+    return 0;
+}
+
+//___________________________________________________________________
+int TReadoutBoardReplay::SendOpCode( uint16_t OpCode, uint8_t chipId )
+{
+    (void)OpCode;
+    (void)chipId;
+    return 0;
+}
+
+//___________________________________________________________________
+int TReadoutBoardReplay::ExecuteChipTransactions( uint8_t chipId )
+{
+    (void)chipId;
+    return 0;
+}
+
+//___________________________________________________________________
+int TReadoutBoardReplay::SetTriggerConfig( bool enablePulse, bool enableTrigger,
+                                           int triggerDelay, int pulseDelay )
+{
+    (void)enablePulse;
+    (void)enableTrigger;
+    (void)triggerDelay;
+    (void)pulseDelay;
+    return 0;
+}
+
+//___________________________________________________________________
+void TReadoutBoardReplay::SetTriggerSource( TTriggerSource triggerSource )
+{
+    (void)triggerSource;
+}
+
+//___________________________________________________________________
+int TReadoutBoardReplay::Trigger( int nTriggers )
+{
+    // the recorded events are given back in order, whatever the triggers sent
+    return nTriggers;
+}
+
+//___________________________________________________________________
+int TReadoutBoardReplay::ReadEventData( int &NBytes, unsigned char *Buffer )
+{
+    if ( !fRunning ) {
+        return MosaicDict::kEMPTY_EVENT;
+    }
+    const uint64_t nEvents = fReader->GetNEvents();
+    TRawEvent event;
+    while ( fNextEvent < nEvents ) {
+        fReader->GetEvent( fNextEvent, event, fBlockBuffer );
+        if ( event.boardIndex == fBoardIndex ) break;
+        fNextEvent++;
+    }
+    if ( fNextEvent >= nEvents ) {
+        return MosaicDict::kEMPTY_EVENT;
+    }
+
+    // a new trigger is announced as the trigger recorder of the MOSAIC board does
+    if ( (event.trgNum || event.trgTime)
+        && ((event.trgNum != fTrgNum) || (event.trgTime != fTrgTime)) ) {
+        if ( fSpeed == TReplaySpeed::kORIGINAL ) {
+            WaitForTriggerTime( event.trgTime );
+        }
+        fTrgNum = event.trgNum;
+        fTrgTime = event.trgTime;
+        fTriggerTable->Add( fTrgNum, fTrgTime, fBoardIndex );
+        NBytes = 0;
+        return MosaicDict::kTRGRECORDER_EVENT;
+    }
+
+    memcpy( Buffer, event.data, event.size );
+    NBytes = event.size;
+    fNextEvent++;
+    fNEventsRead++;
+    if ( GetVerboseLevel() > kULTRACHATTY ) {
+        cout << "TReadoutBoardReplay::ReadEventData() - board " << std::dec << fBoardIndex
+             << " , event " << fNextEvent-1 << " with length " << NBytes << endl;
+    }
+    return NBytes;
+}
+
+//___________________________________________________________________
+void TReadoutBoardReplay::EnableClockOutputs( const bool en )
+{
+    (void)en;
+}
+
+//___________________________________________________________________
+void TReadoutBoardReplay::SendBroadcastReset()
+{
+
+}
+
+//___________________________________________________________________
+void TReadoutBoardReplay::SendBroadcastROReset()
+{
+
+}
+
+//___________________________________________________________________
+void TReadoutBoardReplay::SendBroadcastBCReset()
+{
+
+}
+
+//___________________________________________________________________
+void TReadoutBoardReplay::StartRun()
+{
+    fRunning = true;
+    fNEventsRead = 0;
+    fTriggerTable->Clear();
+    fFirstEventTime = chrono::steady_clock::time_point();
+    if ( GetVerboseLevel() > kTERSE ) {
+        cout << "TReadoutBoardReplay::StartRun() - board " << std::dec << fBoardIndex
+             << " , replay from event " << fNextEvent << " / " << fReader->GetNEvents() << endl;
+    }
+}
+
+//___________________________________________________________________
+void TReadoutBoardReplay::StopRun()
+{
+    fRunning = false;
+    if ( GetVerboseLevel() > kSILENT ) {
+        cout << "TReadoutBoardReplay::StopRun() - board " << std::dec << fBoardIndex
+             << " , " << fNEventsRead << " events replayed" << endl;
+    }
+}
+
+//___________________________________________________________________
+void TReadoutBoardReplay::Rewind()
+{
+    fNextEvent = 0;
+    fTrgNum = 0;
+    fTrgTime = 0;
+}
+
+//___________________________________________________________________
+int TReadoutBoardReplay::WriteChipRegister( uint16_t address, uint16_t value,
+                                            uint8_t chipId, const bool doExecute )
+{
+    (void)doExecute;
+    fRegisters[ ((uint32_t)chipId << 16) | address ] = value;
+    return 0;
+}
+
+//___________________________________________________________________
+int TReadoutBoardReplay::ReadChipRegister( uint16_t address, uint16_t &value,
+                                           uint8_t chipId, const bool doExecute )
+{
+    (void)doExecute;
+    map<uint32_t, uint16_t>::const_iterator it = fRegisters.find( ((uint32_t)chipId << 16) | address );
+    value = ( it == fRegisters.end() ) ? 0 : it->second;
+    return 0;
+}
+
+//___________________________________________________________________
+void TReadoutBoardReplay::WaitForTriggerTime( const uint64_t trgTime )
+{
+    const chrono::steady_clock::time_point now = chrono::steady_clock::now();
+    if ( (fFirstEventTime == chrono::steady_clock::time_point()) || (trgTime < fFirstTrgTime) ) {
+        // first trigger of the run (or counter reset): reference for the next ones
+        fFirstEventTime = now;
+        fFirstTrgTime = trgTime;
+        return;
+    }
+    const chrono::nanoseconds delay( (long long)((trgTime - fFirstTrgTime) * fClockPeriod) );
+    this_thread::sleep_until( fFirstEventTime + delay );
+}
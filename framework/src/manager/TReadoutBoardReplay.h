@@ -0,0 +1,156 @@
+#ifndef READOUTBOARDREPLAY_H
+#define READOUTBOARDREPLAY_H
+
+/**
+ * \class TReadoutBoardReplay
+ *
+ * \brief Readout board that gives back the events of a recorded raw event file
+ *
+ * \author Andry Rakotozafindrabe
+ *
+ * This board replaces a MOSAIC board to run a scan without any hardware: the
+ * ReadEventData() method gives back, in the same order, the events recorded for this
+ * board (see TRawEventWriter and the option -r of the scans), so that the decoding,
+ * the histograms, the error counters and the storage of the hit pixels can be run and
+ * profiled with real data on any computer. The scan must be run with the same
+ * configuration as the recorded one, for the number of events read at each step of
+ * the scan to match.
+ *
+ * The events are given either as fast as they are read (default), or at the pace of
+ * the recorded trigger times (only available if the trigger recorder was enabled).
+ *
+ * The chip registers are emulated: a read gives back the last value written, so that
+ * the check of the control interface done by TDeviceBuilder succeeds.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include "TRawEventReader.h"
+#include "TReadoutBoard.h"
+#include "TTriggerTable.h"
+
+class TBoardConfig;
+
+enum class TReplaySpeed { kMAXIMUM, kORIGINAL };
+
+class TReadoutBoardReplay : public TReadoutBoard {
+
+    /// configuration of the replaced board
+    std::weak_ptr<TBoardConfig> fBoardConfig;
+
+    /// reader of the raw event file (shared by all boards of the device)
+    std::shared_ptr<TRawEventReader> fReader;
+
+    /// buffer for the decompressed blocks of the raw event file
+    TRawEventReader::TBlockBuffer fBlockBuffer;
+
+    /// index of the board in the device (only the events of this board are replayed)
+    unsigned int fBoardIndex;
+
+    /// speed of the replay
+    TReplaySpeed fSpeed;
+
+    /// period of the clock used for the trigger times (in ns)
+    double fClockPeriod;
+
+    /// index of the next event to be examined in the raw event file
+    std::uint64_t fNextEvent;
+
+    /// true between StartRun() and StopRun()
+    bool fRunning;
+
+    /// number of events given back since the start of the run
+    std::uint64_t fNEventsRead;
+
+    /// last trigger number given back
+    std::uint32_t fTrgNum;
+
+    /// last trigger time given back
+    std::uint64_t fTrgTime;
+
+    /// trigger time of the first event of the run
+    std::uint64_t fFirstTrgTime;
+
+    /// table of the trigger records given back since the start of the run
+    std::shared_ptr<TTriggerTable> fTriggerTable;
+
+    /// time of the first event of the run
+    std::chrono::steady_clock::time_point fFirstEventTime;
+
+    /// emulated chip registers (key = chip id << 16 | address)
+    std::map<std::uint32_t, std::uint16_t> fRegisters;
+
+public:
+
+    /// constructor with the configuration of the replaced board, the raw event file reader and the board index
+    TReadoutBoardReplay( std::shared_ptr<TBoardConfig> boardConfig,
+                         std::shared_ptr<TRawEventReader> aReader,
+                         const unsigned int boardIndex );
+
+    /// destructor
+    virtual ~TReadoutBoardReplay();
+
+    std::weak_ptr<TBoardConfig> GetConfig() { return fBoardConfig; }
+
+    /// set the speed of the replay (default = maximum)
+    void SetSpeed( const TReplaySpeed speed ) { fSpeed = speed; }
+
+    /// set the period of the clock used for the trigger times (default = 25 ns)
+    void SetClockPeriod( const double ns );
+
+    int  ReadRegister( std::uint16_t Address, std::uint32_t &Value );
+    int  WriteRegister( std::uint16_t Address, std::uint32_t Value );
+    int  SendOpCode( std::uint16_t OpCode );
+    int  SendOpCode( std::uint16_t OpCode, std::uint8_t chipId );
+    int  ExecuteChipTransactions( std::uint8_t chipId );
+    int  SetTriggerConfig( bool enablePulse, bool enableTrigger, int triggerDelay, int pulseDelay );
+    void SetTriggerSource( TTriggerSource triggerSource );
+    int  Trigger( int nTriggers );
+
+    /// give back the next recorded event of this board (or the trigger recorder data before it)
+    int  ReadEventData( int &NBytes, unsigned char *Buffer );
+
+    void EnableClockOutputs( const bool en );
+    void SendBroadcastReset();
+    void SendBroadcastROReset();
+    void SendBroadcastBCReset();
+
+    /// start the replay where it was stopped (at the beginning of the file for the first run)
+    void StartRun();
+
+    /// stop the replay
+    void StopRun();
+
+    /// go back to the beginning of the raw event file
+    void Rewind();
+
+    /// trigger number of the last trigger recorder data given back
+    std::uint32_t GetTriggerNum() const { return fTrgNum; }
+
+    /// trigger time of the last trigger recorder data given back
+    std::uint64_t GetTriggerTime() const { return fTrgTime; }
+
+    /// table of the trigger records given back since the start of the run, filled from the thread that reads the board
+    std::shared_ptr<TTriggerTable> GetTriggerTable() { return fTriggerTable; }
+
+    /// number of events given back since the start of the run
+    std::uint64_t GetNEventsRead() const { return fNEventsRead; }
+
+    /// firmware version of the recorded MOSAIC board ("unknown" if not in the raw event file)
+    std::string GetFwIdString() const;
+
+protected:
+
+    int WriteChipRegister( std::uint16_t address, std::uint16_t value, std::uint8_t chipId = 0, const bool doExecute = true );
+    int ReadChipRegister( std::uint16_t address, std::uint16_t &value, std::uint8_t chipId = 0, const bool doExecute = true );
+
+private:
+
+    /// wait until the time of an event in the original run
+    void WaitForTriggerTime( const std::uint64_t trgTime );
+};
+
+#endif  /* READOUTBOARDREPLAY_H */
@@ -0,0 +1,284 @@
+#include "TResultPlotter.h"
+#include "THitMapDiscordant.h"
+#include "THitMapView.h"
+#include "TPixHit.h"
+#include "TSCurveAnalysis.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <dirent.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// ROOT includes
+#include "TROOT.h"
+
+using namespace std;
+
+//___________________________________________________________________
+TResultPlotter::TResultPlotter( const TResultType type, const string fileName ) :
+TVerbosity(),
+fResultType( type ),
+fName( fileName ),
+fNInjections( 50 ),
+fMaxInjCharge( 50 )
+{
+
+}
+
+//___________________________________________________________________
+TResultPlotter::~TResultPlotter()
+{
+    fChipList.clear();
+}
+
+//___________________________________________________________________
+void TResultPlotter::SetNInjections( const unsigned int value )
+{
+    if ( value == 0 ) {
+        cerr << "TResultPlotter::SetNInjections() - zero injection is not valid !" << endl;
+        return;
+    }
+    fNInjections = value;
+}
+
+//___________________________________________________________________
+void TResultPlotter::SetMaxInjectedCharge( const unsigned int value )
+{
+    if ( value == 0 ) {
+        cerr << "TResultPlotter::SetMaxInjectedCharge() - zero value is not valid !" << endl;
+        return;
+    }
+    fMaxInjCharge = value;
+}
+
+//___________________________________________________________________
+void TResultPlotter::FindChips()
+{
+    fChipList.clear();
+
+    // the data directory is the one used by common::GetFileName()
+    common::TChipIndex dummy;
+    dummy.boardIndex = 0;
+    dummy.dataReceiver = 0;
+    dummy.deviceType = TDeviceType::kUNKNOWN;
+    dummy.deviceId = 0;
+    dummy.chipId = 0;
+    const string path = common::GetFileName( dummy, GetSuffix() );
+    const string directory = path.substr( 0, path.rfind( '/' ) + 1 );
+    const string suffix = path.substr( directory.size(), path.rfind( "-B" ) - directory.size() );
+
+    DIR* dir = opendir( directory.empty() ? "." : directory.c_str() );
+    if ( !dir ) {
+        throw runtime_error( "TResultPlotter::FindChips() - data directory " + directory + " not found." );
+    }
+    struct dirent* entry;
+    while ( (entry = readdir( dir )) != nullptr ) {
+        common::TChipIndex idx;
+        if ( common::GetChipIndexFromFileName( string( entry->d_name ), suffix, idx ) ) {
+            fChipList.push_back( idx );
+        }
+    }
+    closedir( dir );
+
+    if ( GetVerboseLevel() > kSILENT ) {
+        cout << "TResultPlotter::FindChips() - " << std::dec << fChipList.size()
+             << " chip(s) found for " << directory << suffix << endl;
+    }
+}
+
+//___________________________________________________________________
+unsigned int TResultPlotter::Go( const unsigned int nWorkers )
+{
+    if ( fChipList.empty() ) {
+        throw runtime_error( "TResultPlotter::Go() - no chip ! Please use FindChips() first." );
+    }
+    gROOT->SetBatch();
+    unsigned int nFailed = 0;
+
+    if ( nWorkers <= 1 ) {
+        for ( unsigned int i = 0; i < fChipList.size(); i++ ) {
+            try {
+                PlotChip( fChipList.at(i) );
+            } catch ( exception& err ) {
+                cerr << err.what() << endl;
+                nFailed++;
+            }
+        }
+        return nFailed;
+    }
+
+    // one worker process per chip, at most nWorkers at a time
+    map<pid_t, unsigned int> workers;
+    unsigned int next = 0;
+    while ( (next < fChipList.size()) || !workers.empty() ) {
+        if ( (workers.size() < nWorkers) && (next < fChipList.size()) ) {
+            cout << flush;
+            cerr << flush;
+            pid_t pid = fork();
+            if ( pid < 0 ) {
+                throw runtime_error( "TResultPlotter::Go() - can not start a worker process !" );
+            }
+            if ( pid == 0 ) {
+                int status = EXIT_SUCCESS;
+                try {
+                    PlotChip( fChipList.at(next) );
+                } catch ( exception& err ) {
+                    cerr << err.what() << endl;
+                    status = EXIT_FAILURE;
+                }
+                cout << flush;
+                cerr << flush;
+                _exit( status );
+            }
+            workers[pid] = next;
+            next++;
+            continue;
+        }
+        int status = 0;
+        pid_t pid = waitpid( -1, &status, 0 );
+        if ( pid < 0 ) {
+            throw runtime_error( "TResultPlotter::Go() - lost track of the worker processes !" );
+        }
+        map<pid_t, unsigned int>::iterator it = workers.find( pid );
+        if ( it == workers.end() ) {
+            continue;
+        }
+        if ( !WIFEXITED( status ) || (WEXITSTATUS( status ) != EXIT_SUCCESS) ) {
+            cerr << "TResultPlotter::Go() - failed to plot ";
+            common::DumpId( fChipList.at( it->second ) );
+            cerr << endl;
+            nFailed++;
+        }
+        workers.erase( it );
+    }
+    return nFailed;
+}
+
+//___________________________________________________________________
+string TResultPlotter::GetSuffix() const
+{
+    char fNameTemp[100];
+    snprintf( fNameTemp, sizeof(fNameTemp), "%s", fName.c_str() );
+    strtok( fNameTemp, "." );
+    return string( fNameTemp );
+}
+
+//___________________________________________________________________
+void TResultPlotter::PlotChip( const common::TChipIndex idx )
+{
+    if ( GetVerboseLevel() > kSILENT ) {
+        cout << "TResultPlotter::PlotChip() - ";
+        common::DumpId( idx );
+        cout << endl;
+    }
+    switch ( fResultType ) {
+        case TResultType::kDIGITAL_SCAN :
+            PlotDigitalScan( idx );
+            break;
+        case TResultType::kTHRESHOLD_SCAN :
+            PlotThresholdScan( idx );
+            break;
+        case TResultType::kNOISE_OCC_SCAN :
+            PlotNoiseOccScan( idx );
+            break;
+        default:
+            throw runtime_error( "TResultPlotter::PlotChip() - unknown type of scan !" );
+    }
+}
+
+//___________________________________________________________________
+void TResultPlotter::PlotDigitalScan( const common::TChipIndex idx )
+{
+    const string suffix = GetSuffix();
+    unsigned int row, column;
+    int hits;
+
+    // number of hits of each pixel, see TDeviceDigitalScan::WriteDataToFile()
+    unordered_map<unsigned int, int> pixelHits;
+    string filename = common::GetFileName( idx, suffix );
+    FILE *fp = fopen( filename.c_str(), "r" );
+    if ( !fp ) {
+        throw runtime_error( "TResultPlotter::PlotDigitalScan() - input file " + filename + " not found." );
+    }
+    while ( fscanf( fp, "%u %u %d", &row, &column, &hits ) == 3 ) {
+        pixelHits[ row * common::NPIX_PER_ROW + column ] = hits;
+    }
+    fclose( fp );
+
+    // bad pixels, see TChipErrorCounter::WriteCorruptedHitsToFile()
+    THitMapDiscordant hitMap( idx.deviceType, idx, fNInjections );
+    hitMap.SetVerboseLevel( GetVerboseLevel() );
+    hitMap.BuildCanvas();
+    const TPixFlag flags[3] = { TPixFlag::kDEAD, TPixFlag::kINEFFICIENT, TPixFlag::kHOT };
+    unsigned int nBadPixels = 0;
+    for ( unsigned int iflag = 0; iflag < 3; iflag++ ) {
+        stringstream flag_name; flag_name << "Error" << (int)flags[iflag];
+        filename = common::GetFileName( idx, suffix, flag_name.str() );
+        fp = fopen( filename.c_str(), "r" );
+        if ( !fp ) {
+            continue; // no bad pixel of this type
+        }
+        while ( fscanf( fp, "%u %u %d", &row, &column, &hits ) == 3 ) {
+            unordered_map<unsigned int, int>::const_iterator it = pixelHits.find( row * common::NPIX_PER_ROW + column );
+            const unsigned int nTimesFired = ( it == pixelHits.end() ) ? 0 : it->second;
+            switch ( (int)flags[iflag] ) {
+                case (int)TPixFlag::kDEAD :
+                    hitMap.AddDeadPixel( column, row );
+                    break;
+                case (int)TPixFlag::kINEFFICIENT :
+                    hitMap.AddInefficientPixel( column, row, nTimesFired );
+                    break;
+                default :
+                    hitMap.AddHotPixel( column, row, nTimesFired );
+                    break;
+            }
+            nBadPixels++;
+        }
+        fclose( fp );
+    }
+    if ( !nBadPixels ) {
+        if ( GetVerboseLevel() > kSILENT ) {
+            cout << "TResultPlotter::PlotDigitalScan() - ";
+            common::DumpId( idx );
+            cout << " , no bad pixel => no file will be written !" << endl;
+        }
+        return;
+    }
+    hitMap.Draw();
+    hitMap.SaveToFile( common::GetFileName( idx, suffix, "Error", ".pdf" ).c_str() );
+}
+
+//___________________________________________________________________
+void TResultPlotter::PlotThresholdScan( const common::TChipIndex idx )
+{
+    TSCurveAnalysis analyzer( idx, fNInjections, fMaxInjCharge );
+    analyzer.SetVerboseLevel( GetVerboseLevel() );
+    analyzer.Init();
+    analyzer.ReadResultsFromFile( fName.c_str() );
+    if ( GetVerboseLevel() > kTERSE ) {
+        analyzer.Dump();
+    }
+    analyzer.DrawDistributions( fName.c_str() );
+    analyzer.SaveToFile( fName.c_str() );
+}
+
+//___________________________________________________________________
+void TResultPlotter::PlotNoiseOccScan( const common::TChipIndex idx )
+{
+    THitMapView hitMap( idx.deviceType, nullptr, idx );
+    hitMap.SetVerboseLevel( GetVerboseLevel() );
+    hitMap.ReadHitsFromFile( fName.c_str() );
+    if ( !hitMap.HasData() ) {
+        return;
+    }
+    hitMap.BuildCanvas();
+    hitMap.Draw();
+    hitMap.SaveToFile( fName.c_str() );
+}
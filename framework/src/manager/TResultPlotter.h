@@ -0,0 +1,93 @@
+#ifndef TRESULT_PLOTTER_H
+#define TRESULT_PLOTTER_H
+
+/**
+ * \class TResultPlotter
+ *
+ * \brief Draw the plots of a scan from the data files that it wrote
+ *
+ * \author Andry Rakotozafindrabe
+ *
+ * A scan only needs to write its (text) data files, one or a few per chip. Drawing
+ * is an optional post-processing step: this class finds the chips for which the scan
+ * wrote data, reads the files of each chip and produces the same PDF files as the
+ * DrawAndSaveToFile() method of the scan:
+ * - digital scan: hit map and firing frequency of the dead, inefficient and hot pixels
+ * - threshold scan: threshold, noise and chi2/ndf distributions, and some S-curves
+ * - noise occupancy scan: hit map
+ *
+ * The chips are shared among several worker processes (ROOT graphics is not thread
+ * safe), each worker process drawing one chip and then exiting.
+ */
+
+#include <string>
+#include <vector>
+#include "Common.h"
+#include "TVerbosity.h"
+
+enum class TResultType {
+    kDIGITAL_SCAN,
+    kTHRESHOLD_SCAN,
+    kNOISE_OCC_SCAN
+};
+
+class TResultPlotter : public TVerbosity {
+
+    /// type of the scan that wrote the data files
+    TResultType fResultType;
+
+    /// file name given to the scan (used as the prefix of the name of the data files)
+    std::string fName;
+
+    /// number of injections per pixel in the scan
+    unsigned int fNInjections;
+
+    /// maximum value of the injected charge in the scan (in DAC units, threshold scan only)
+    unsigned int fMaxInjCharge;
+
+    /// list of the chips with a data file
+    std::vector<common::TChipIndex> fChipList;
+
+public:
+
+    /// constructor with the type of scan and the file name given to the scan
+    TResultPlotter( const TResultType type, const std::string fileName );
+
+    /// destructor
+    virtual ~TResultPlotter();
+
+    /// set the number of injections per pixel in the scan (default = 50)
+    void SetNInjections( const unsigned int value );
+
+    /// set the maximum value of the injected charge in the scan (default = 50)
+    void SetMaxInjectedCharge( const unsigned int value );
+
+    /// find the chips with a data file written by the scan
+    void FindChips();
+
+    /// number of chips found by FindChips()
+    unsigned int GetNChips() const { return fChipList.size(); }
+
+    /// draw and save the plots of all chips found, with at most nWorkers processes at a time
+    unsigned int Go( const unsigned int nWorkers );
+
+private:
+
+    /// base name of the data files (file name given to the scan without extension)
+    std::string GetSuffix() const;
+
+    /// draw and save the plots of a chip
+    void PlotChip( const common::TChipIndex idx );
+
+    /// draw and save the hit map of the bad pixels of a chip
+    void PlotDigitalScan( const common::TChipIndex idx );
+
+    /// draw and save the threshold, noise and chi2/ndf distributions of a chip
+    void PlotThresholdScan( const common::TChipIndex idx );
+
+    /// draw and save the hit map of a chip
+    void PlotNoiseOccScan( const common::TChipIndex idx );
+
+};
+
+#endif
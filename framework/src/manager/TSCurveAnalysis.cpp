@@ -1,15 +1,24 @@
 #include "TSCurveAnalysis.h"
 #include "TPixHit.h"
+#include "TSCurveHisto.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
 #include <iomanip>
 #include <iostream>
+#include <stdexcept>
+#include <unordered_map>
 
 // ROOT includes
 #include "TCanvas.h"
 #include "TGraph.h"
 #include "TH1F.h"
 #include "TF1.h"
+#include "TFile.h"
+#include "TH2F.h"
 #include "TObjArray.h"
 #include "TLine.h"
+#include "TList.h"
 #include "TPave.h"
 #include "Rtypes.h"
 #include "TStyle.h"
@@ -57,15 +66,14 @@ fCnv6( nullptr ),
 fgClone( nullptr ),
 fPaveNoise( nullptr ),
 fLineThreshold( nullptr ),
-fSaveToFileReady( false )
+fSaveToFileReady( false ),
+fFitTag( 0 )
 {
     fIdx.boardIndex = 0;
     fIdx.dataReceiver = 0;
     fIdx.deviceType = TDeviceType::kUNKNOWN;
     fIdx.deviceId = 0;
     fIdx.chipId = 0;
-    
-    SetBaseStyle();
 }
 
 //___________________________________________________________________
@@ -102,7 +110,8 @@ fCnv6( nullptr ),
 fgClone( nullptr ),
 fPaveNoise( nullptr ),
 fLineThreshold( nullptr ),
-fSaveToFileReady( false )
+fSaveToFileReady( false ),
+fFitTag( 0 )
 {
     fIdx.boardIndex = aChipIndex.boardIndex;
     fIdx.dataReceiver = aChipIndex.dataReceiver;
@@ -112,8 +121,6 @@ fSaveToFileReady( false )
     
     SetNInjections( nInjectionsPerCharge );
     SetMaxInjectedCharge( maxInjCharge );
-    
-    SetBaseStyle();
 }
 
 //___________________________________________________________________
@@ -203,9 +210,8 @@ void TSCurveAnalysis::SetPixelCoordinates( const unsigned int dcol,
 //___________________________________________________________________
 void TSCurveAnalysis::Init()
 {
+    // canvas and histos are only created if the distributions are drawn
     SetHicChipName();
-    PrepareCanvas();
-    PrepareHistos();
 }
 
 //___________________________________________________________________
@@ -233,23 +239,16 @@ void TSCurveAnalysis::ProcessPixelData()
     if ( !fX ) {
         throw runtime_error( "TSCurveAnalysis::ProcessPixelData() - undefined fX array!" );
     }
-    if ( !fHChisq ) {
-        throw runtime_error( "TSCurveAnalysis::ProcessPixelData() - undefined fHChisq histo!" );
-    }
-    if ( !fHThreshold ) {
-        throw runtime_error( "TSCurveAnalysis::ProcessPixelData() - undefined fHThreshold histo!" );
-    }
-    if ( !fHNoise ) {
-        throw runtime_error( "TSCurveAnalysis::ProcessPixelData() - undefined fHNoise histo!" );
-    }
     bool success = FitSCurve();
-    if ( success ) {
-        fHChisq->Fill( fChisq );
-        if ( fChisq < fChisqCut ) {
-            fHThreshold->Fill( fThreshold );
-            fHNoise->Fill( fNoise );
-        }
-    } else {
+    TPixelFit fit;
+    fit.row = fRow;
+    fit.column = fColumn;
+    fit.hasStart = success;
+    fit.threshold = fThreshold;
+    fit.noise = fNoise;
+    fit.chisq = fChisq;
+    fFitResults.push_back( fit );
+    if ( !success ) {
         if ( GetVerboseLevel() > kTERSE ) {
             cerr << "TSCurveAnalysis::ProcessPixelData() - fit failed, (chip "
                  << std::dec << fIdx.chipId << ") row " << fRow << " : column " << fColumn << endl;
@@ -259,40 +258,196 @@ void TSCurveAnalysis::ProcessPixelData()
 }
 
 //___________________________________________________________________
-void TSCurveAnalysis::DrawDistributions()
+void TSCurveAnalysis::ProcessSCurves( const vector<uint32_t>& pixels,
+                                      const vector<uint32_t>& counts,
+                                      const vector<uint32_t>& charges,
+                                      const unsigned int first, const unsigned int last )
 {
-    if ( !fHChisq ) {
-        throw runtime_error( "TSCurveAnalysis::DrawDistributions() - undefined fHChisq histo!" );
-    }
-    if ( !fHThreshold ) {
-        throw runtime_error( "TSCurveAnalysis::DrawDistributions() - undefined fHThreshold histo!" );
-    }
-    if ( !fHNoise ) {
-        throw runtime_error( "TSCurveAnalysis::DrawDistributions() - undefined fHNoise histo!" );
-    }
-    if ( !fCnv1 ) {
-        throw runtime_error( "TSCurveAnalysis::DrawDistributions() - undefined fCnv1 canvas!" );
-    }
-    if ( !fCnv2 ) {
-        throw runtime_error( "TSCurveAnalysis::DrawDistributions() - undefined fCnv2 canvas!" );
-    }
-    if ( !fCnv4 ) {
-        throw runtime_error( "TSCurveAnalysis::DrawDistributions() - undefined fCnv4 canvas!" );
+    const unsigned int nSteps = charges.size();
+    if ( !nSteps || (counts.size() != pixels.size() * nSteps) ) {
+        throw runtime_error( "TSCurveAnalysis::ProcessSCurves() - inconsistent number of counters !" );
+    }
+    for ( unsigned int ipix = first; (ipix < last) && (ipix < pixels.size()); ipix++ ) {
+        if ( !counts.at( (ipix+1)*nSteps - 1 ) ) {
+            // skip pixels that have no data at max charge (presumably not pulsed)
+            continue;
+        }
+        SetPixelCoordinates( TSCurveHisto::GetDoubleColumn( pixels.at(ipix) ),
+                             TSCurveHisto::GetAddress( pixels.at(ipix) ) );
+        for ( unsigned int iampl = 0; iampl < nSteps; iampl++ ) {
+            FillPixelData( iampl, charges.at( iampl ), counts.at( ipix*nSteps + iampl ) );
+        }
+        ProcessPixelData();
     }
+}
 
+//___________________________________________________________________
+void TSCurveAnalysis::Merge( const TSCurveAnalysis& other )
+{
+    fFitResults.insert( fFitResults.end(), other.fFitResults.begin(), other.fFitResults.end() );
+    fNPixels += other.fNPixels;
+    fNNostart += other.fNNostart;
+    fNChisq += other.fNChisq;
+}
+
+//___________________________________________________________________
+void TSCurveAnalysis::Dump() const
+{
+    double sumT = 0, sumT2 = 0, sumN = 0, sumN2 = 0;
+    unsigned int n = 0;
+    for ( unsigned int i = 0; i < fFitResults.size(); i++ ) {
+        const TPixelFit& fit = fFitResults.at(i);
+        if ( !fit.hasStart || (fit.chisq >= fChisqCut) ) {
+            continue;
+        }
+        sumT += fit.threshold;
+        sumT2 += fit.threshold*fit.threshold;
+        sumN += fit.noise;
+        sumN2 += fit.noise*fit.noise;
+        n++;
+    }
+    double meanT = 0, rmsT = 0, meanN = 0, rmsN = 0;
+    if ( n ) {
+        meanT = sumT/n;
+        rmsT = sqrt( fabs( sumT2/n - meanT*meanT ) );
+        meanN = sumN/n;
+        rmsN = sqrt( fabs( sumN2/n - meanN*meanN ) );
+    }
     cout << std::dec << endl;
-    cout << "------------------------------- TSCurveAnalysis::DrawDistributions() " << endl;
+    cout << "------------------------------- TSCurveAnalysis::Dump() " << endl;
     common::DumpId( fIdx );
     cout << endl;
     cout << "Start point found for:     " << fNPixels << " pixels " << endl;
     cout << "No start point found for:  " << fNNostart << " pixels " << endl;
     cout << "Chisq cut failed for:      " << fNChisq << " pixels " << endl;
     cout << "Chisq cut value:           " << fChisqCut << endl;
-    printf("Threshold : %6.3f +/- %6.3f\n",
-           fHThreshold->GetMean(), fHThreshold->GetRMS() );
-    printf("    Noise : %6.3f +/- %6.3f\n",
-           fHNoise->GetMean(), fHNoise->GetRMS() );
+    printf("Threshold : %6.3f +/- %6.3f\n", meanT, rmsT );
+    printf("    Noise : %6.3f +/- %6.3f\n", meanN, rmsN );
     cout << "-------------------------------" << endl << endl;
+}
+
+//___________________________________________________________________
+void TSCurveAnalysis::WriteResultsToFile( const char *fName )
+{
+    if ( fFitResults.empty() ) {
+        if ( GetVerboseLevel() > kSILENT ) {
+            cout << "TSCurveAnalysis::WriteResultsToFile() - ";
+            common::DumpId( fIdx );
+            cout << " : no fit result, skipped." << endl;
+        }
+        return;
+    }
+    string filename = GetFileName( fName, "FitResults" );
+    if ( GetVerboseLevel() > kSILENT ) {
+        cout << "TSCurveAnalysis::WriteResultsToFile() - Writing fit results to file "<< filename << endl;
+    }
+    FILE *fp = fopen( filename.c_str(), "w" );
+    if ( !fp ) {
+        throw runtime_error( "TSCurveAnalysis::WriteResultsToFile() - output file not found." );
+    }
+    for ( unsigned int i = 0; i < fFitResults.size(); i++ ) {
+        const TPixelFit& fit = fFitResults.at(i);
+        if ( fit.hasStart ) {
+            fprintf( fp, "%d %d %.3f %.3f %.3f\n", fit.row, fit.column,
+                     fit.threshold, fit.noise, fit.chisq );
+        } else {
+            // no start point => no fit
+            fprintf( fp, "%d %d -1 -1 -1\n", fit.row, fit.column );
+        }
+    }
+    fclose( fp );
+}
+
+//___________________________________________________________________
+void TSCurveAnalysis::ReadResultsFromFile( const char *fName )
+{
+    string filename = GetFileName( fName, "FitResults" );
+    FILE *fp = fopen( filename.c_str(), "r" );
+    if ( !fp ) {
+        throw runtime_error( "TSCurveAnalysis::ReadResultsFromFile() - input file " + filename + " not found." );
+    }
+    fFitResults.clear();
+    fNPixels = 0;
+    fNNostart = 0;
+    fNChisq = 0;
+    TPixelFit fit;
+    while ( fscanf( fp, "%u %u %f %f %f", &fit.row, &fit.column,
+                    &fit.threshold, &fit.noise, &fit.chisq ) == 5 ) {
+        fit.hasStart = ( fit.chisq >= 0 );
+        if ( fit.hasStart ) {
+            fNPixels++;
+            if ( fit.chisq > fChisqCut ) fNChisq++;
+        } else {
+            fNNostart++;
+        }
+        fFitResults.push_back( fit );
+    }
+    fclose( fp );
+    if ( GetVerboseLevel() > kSILENT ) {
+        cout << "TSCurveAnalysis::ReadResultsFromFile() - " << std::dec << fFitResults.size()
+             << " pixels read from file " << filename << endl;
+    }
+}
+
+//___________________________________________________________________
+void TSCurveAnalysis::WriteMapsToFile( const char *fName )
+{
+    if ( fFitResults.empty() ) {
+        return;
+    }
+    string filename = GetFileName( fName, "ThresholdMap", ".root" );
+    if ( GetVerboseLevel() > kSILENT ) {
+        cout << "TSCurveAnalysis::WriteMapsToFile() - Writing maps to file "<< filename << endl;
+    }
+    TFile* file = TFile::Open( filename.c_str(), "RECREATE" );
+    if ( !file || file->IsZombie() ) {
+        throw runtime_error( "TSCurveAnalysis::WriteMapsToFile() - can not open output file " + filename );
+    }
+    const string unit = fDACtoElectronsConversionIsUsed ? "[electrons]" : "[DAC units]";
+    TH2F* hThreshold = new TH2F( "hThresholdMap", ("Threshold map " + unit + ";Column;Row").c_str(),
+                                 common::NPIX_PER_ROW, -0.5, common::NPIX_PER_ROW - 0.5,
+                                 common::NLINES, -0.5, common::NLINES - 0.5 );
+    TH2F* hNoise = new TH2F( "hNoiseMap", ("Noise map " + unit + ";Column;Row").c_str(),
+                             common::NPIX_PER_ROW, -0.5, common::NPIX_PER_ROW - 0.5,
+                             common::NLINES, -0.5, common::NLINES - 0.5 );
+    TH2F* hChisq = new TH2F( "hChisqMap", "Chi2/ndf map;Column;Row",
+                             common::NPIX_PER_ROW, -0.5, common::NPIX_PER_ROW - 0.5,
+                             common::NLINES, -0.5, common::NLINES - 0.5 );
+    for ( unsigned int i = 0; i < fFitResults.size(); i++ ) {
+        const TPixelFit& fit = fFitResults.at(i);
+        if ( !fit.hasStart ) {
+            continue;
+        }
+        hThreshold->SetBinContent( fit.column + 1, fit.row + 1, fit.threshold );
+        hNoise->SetBinContent( fit.column + 1, fit.row + 1, fit.noise );
+        hChisq->SetBinContent( fit.column + 1, fit.row + 1, fit.chisq );
+    }
+    file->Write();
+    file->Close();
+    delete file; // also deletes the histograms
+}
+
+//___________________________________________________________________
+void TSCurveAnalysis::DrawDistributions( const char *fName )
+{
+    if ( IsSaveToFileReady() ) {
+        return;
+    }
+    SetBaseStyle();
+    PrepareCanvas();
+    PrepareHistos();
+    
+    for ( unsigned int i = 0; i < fFitResults.size(); i++ ) {
+        const TPixelFit& fit = fFitResults.at(i);
+        if ( !fit.hasStart ) {
+            continue;
+        }
+        fHChisq->Fill( fit.chisq );
+        if ( fit.chisq < fChisqCut ) {
+            fHThreshold->Fill( fit.threshold );
+            fHNoise->Fill( fit.noise );
+        }
+    }
 
     fCnv1->cd();
     fHThreshold->SetMarkerColor( kAzure-3 );
@@ -320,9 +475,107 @@ void TSCurveAnalysis::DrawDistributions()
     fHChisq->SetFillColor( kAzure-3 );
     fHChisq->Draw("hist");
     
+    DrawSCurves( fName );
+    
     fSaveToFileReady = true;
 }
 
+//___________________________________________________________________
+void TSCurveAnalysis::DrawSCurves( const char *fName )
+{
+    string filename = GetFileName( fName, "" );
+    FILE *fp = fopen( filename.c_str(), "r" );
+    if ( !fp ) {
+        cerr << "TSCurveAnalysis::DrawSCurves() - raw data file " << filename
+             << " not found, no S-curve drawn." << endl;
+        return;
+    }
+    // fit results by pixel
+    unordered_map<unsigned int, unsigned int> fitIndex;
+    for ( unsigned int i = 0; i < fFitResults.size(); i++ ) {
+        const TPixelFit& fit = fFitResults.at(i);
+        fitIndex[ fit.row * common::NPIX_PER_ROW + fit.column ] = i;
+    }
+    // the points of an S-curve are consecutive lines "row column charge hits" in the file
+    vector<int> x, y;
+    unsigned int row, column, lastKey = 0;
+    int charge, nhits;
+    bool done = false;
+    while ( !done ) {
+        done = ( fscanf( fp, "%u %u %d %d", &row, &column, &charge, &nhits ) != 4 );
+        const unsigned int key = row * common::NPIX_PER_ROW + column;
+        if ( !x.empty() && (done || (key != lastKey)) ) {
+            unordered_map<unsigned int, unsigned int>::const_iterator it = fitIndex.find( lastKey );
+            if ( it != fitIndex.end() ) {
+                DrawSCurve( fFitResults.at( it->second ), x, y );
+            }
+            x.clear();
+            y.clear();
+        }
+        if ( !done ) {
+            x.push_back( fDACtoElectronsConversionIsUsed ? charge * fElectronsPerDAC : charge );
+            y.push_back( nhits );
+            lastKey = key;
+        }
+    }
+    fclose( fp );
+}
+
+//___________________________________________________________________
+void TSCurveAnalysis::DrawSCurve( const TPixelFit& fit, const vector<int>& x, const vector<int>& y )
+{
+    const bool badFit = ( !fit.hasStart || (fit.chisq > fChisqCut) );
+    if ( fIsPixelCurveDrawn && !badFit ) {
+        return;
+    }
+    TGraph* g = new TGraph( (int)x.size(), x.data(), y.data() );
+    
+    // Drawing graph, fit and fit parameters for the first analyzed pixel...
+    if ( !fIsPixelCurveDrawn && fit.hasStart ) {
+        fCnv3->cd();
+        fgClone = (TGraph*) g->Clone( GetName("gClone").c_str() );
+        fgClone -> SetMarkerStyle(20);
+        fgClone->SetTitle("Response for a single pixel");
+        if ( !fDACtoElectronsConversionIsUsed ) {
+            fgClone->GetXaxis()->SetTitle("Injected charge [DAC units]");
+        } else {
+            fgClone->GetXaxis()->SetTitle("Injected charge [electrons]");
+        }
+        fgClone->GetYaxis()->SetTitle("#Hits");
+        fgClone->Draw("ap");
+        fPaveNoise = new TPave(fit.threshold-fit.noise, fgClone->GetHistogram()->GetMaximum(), fit.threshold+fit.noise, 0 );
+        fPaveNoise->SetFillColor(kYellow);
+        fPaveNoise->Draw("same");
+        fLineThreshold = new TLine( fit.threshold, 0., fit.threshold, fgClone->GetHistogram()->GetMaximum() );
+        fLineThreshold->SetLineColor(kBlue);
+        fLineThreshold->SetLineWidth(2);
+        fLineThreshold->Draw("same");
+        fgClone->Draw("psame");
+        fIsPixelCurveDrawn = true;
+    }
+    
+    if ( badFit ) {
+        TCanvas* cnv = fit.hasStart ? fCnv6 : fCnv5;
+        cnv->cd();
+        g->SetTitle( fit.hasStart ? "Refused S-curves" : "Bad S-curves" );
+        g->SetLineWidth( 1);
+        int igroup = std::floor( (float)fit.row / (common::NLINES / fNgroup) );
+        g->SetLineColor( fColorCode[igroup] );
+        if ( !fDACtoElectronsConversionIsUsed ) {
+            g->GetXaxis()->SetTitle("Injected charge [DAC units]");
+        } else {
+            g->GetXaxis()->SetTitle("Injected charge [electrons]");
+        }
+        g->GetYaxis()->SetTitle("#Hits");
+        if ( cnv->GetListOfPrimitives()->IsEmpty() ) {
+            g->DrawClone( "al" );
+        } else {
+            g->DrawClone( "l" );
+        }
+    }
+    g->Delete();
+}
+
 //___________________________________________________________________
 void TSCurveAnalysis::SaveToFile( const char *fName )
 {
@@ -416,6 +669,17 @@ string TSCurveAnalysis::GetName( const string prefix ) const
     name += std::to_string( fIdx.chipId );    return name;
 }
 
+//___________________________________________________________________
+string TSCurveAnalysis::GetFileName( const char *fName, const string optional,
+                                     const string fileExtention ) const
+{
+    char fNameTemp[100];
+    snprintf( fNameTemp, sizeof(fNameTemp), "%s", fName );
+    strtok( fNameTemp, "." );
+    string suffix( fNameTemp );
+    return common::GetFileName( fIdx, suffix, optional, fileExtention );
+}
+
 //___________________________________________________________________
 void TSCurveAnalysis::PrepareCanvas()
 {
@@ -488,103 +752,35 @@ double TSCurveAnalysis::Erf( double* xx, double* par)
 //___________________________________________________________________
 bool TSCurveAnalysis::FitSCurve()
 {
-    TGraph* g = new TGraph( fNPoints, fX, fData );
-    
-    // Drawing graph for the first analyzed pixel...
-    if ( !fIsPixelCurveDrawn ) {
-        fCnv3->cd();
-        if ( !fgClone ) {
-            fgClone = (TGraph*) g->Clone( GetName("gClone").c_str() );
-            fgClone -> SetMarkerStyle(20);
-            fgClone->SetTitle("Response for a single pixel");
-            if ( !fDACtoElectronsConversionIsUsed ) {
-                fgClone->GetXaxis()->SetTitle("Injected charge [DAC units]");
-            } else {
-                fgClone->GetXaxis()->SetTitle("Injected charge [electrons]");
-            }
-            fgClone->GetYaxis()->SetTitle("#Hits");
-            fgClone->Draw("ap");
-        }
-    }
-    
+    // no drawing here: the fits of different chips run in parallel threads
     float Start  = FindStart();
     
     if ( Start < 0 ) {
         fNNostart ++;
-        fCnv5->cd();
-        g->SetTitle( "Bad S-curves" );
-        g->SetLineWidth( 1);
-        int igroup = std::floor( (float)fRow / (common::NLINES / fNgroup) );
-        g->SetLineColor( fColorCode[igroup] );
-        if ( !fDACtoElectronsConversionIsUsed ) {
-            g->GetXaxis()->SetTitle("Injected charge [DAC units]");
-        } else {
-            g->GetXaxis()->SetTitle("Injected charge [electrons]");
-        }
-        g->GetYaxis()->SetTitle("#Hits");
-        if ( fNNostart == 1) {
-            g->DrawClone( "al" );
-        } else {
-            g->DrawClone( "l" );
-        }
-        g->Delete();
         return false;
     }
     
-    TF1* fitfcn = new TF1( "fitfcn", this, &TSCurveAnalysis::Erf, 0, 1500, 2 );
+    TGraph* g = new TGraph( fNPoints, fX, fData );
+    
+    // name unique to the chip, and fit with the pointer rather than the name:
+    // the fits of different chips can run in parallel threads
+    // (the tag distinguishes the analyzers of a same chip fitting different pixels)
+    const string fitName = GetName("fitfcn") + "_" + std::to_string( fFitTag );
+    TF1* fitfcn = new TF1( fitName.c_str(), this, &TSCurveAnalysis::Erf, 0, 1500, 2 );
     fitfcn->SetNpx(10000);
     fitfcn->SetParameter(0,Start);
     fitfcn->SetParameter(1,8);
     fitfcn->SetParName(0, "Threshold");
     fitfcn->SetParName(1, "Noise");
 
-    if ( !fgClone ) {
-        g->Fit("fitfcn","Q");
-    } else {
-        g->Fit("fitfcn","Q0");
-    }
-    
+    g->Fit( fitfcn, "Q0" );
     
     fNoise     = fitfcn->GetParameter(1);
     fThreshold = fitfcn->GetParameter(0);
     fChisq     = fitfcn->GetChisquare()/fitfcn->GetNDF();
     
-    // Drawing fit and fit parameters for the first analyzed pixel...
-    if ( !fIsPixelCurveDrawn ) {
-        fCnv3->cd();
-        if ( !fPaveNoise ) {
-            fPaveNoise = new TPave(fThreshold-fNoise, fgClone->GetHistogram()->GetMaximum(), fThreshold+fNoise, 0 );
-            fPaveNoise->SetFillColor(kYellow);
-            fPaveNoise->Draw("same");
-        }
-        if ( !fLineThreshold ) {
-            fLineThreshold = new TLine( fThreshold, 0., fThreshold, fgClone->GetHistogram()->GetMaximum() );
-            fLineThreshold->SetLineColor(kBlue);
-            fLineThreshold->SetLineWidth(2);
-            fLineThreshold->Draw("same");
-        }
-        fgClone->Draw("psame");
-        fIsPixelCurveDrawn = true;
-    }
-    
     if ( fChisq > fChisqCut ) {
         fNChisq++;
-        fCnv6->cd();
-        g->SetTitle( "Refused S-curves" );
-        g->SetLineWidth( 1);
-        int igroup = std::floor( (float)fRow / (common::NLINES / fNgroup) );
-        g->SetLineColor( fColorCode[igroup] );
-        if ( !fDACtoElectronsConversionIsUsed ) {
-            g->GetXaxis()->SetTitle("Injected charge [DAC units]");
-        } else {
-            g->GetXaxis()->SetTitle("Injected charge [electrons]");
-        }
-        g->GetYaxis()->SetTitle("#Hits");
-        if ( fNChisq == 1) {
-            g->DrawClone( "al" );
-        } else {
-            g->DrawClone( "l" );
-        }
     }
     
     g->Delete();
@@ -13,12 +13,18 @@
  * from Markus Keil from ITS team. The threshold and noise distributions of the tested
  * pixels can be drawn, as well as the chi2/ndf distribution from the fits.
  *
+ * The fits only produce numbers (one fit result per pixel), that can be written to
+ * a compact text file. Drawing is an optional later step: no canvas, histogram or
+ * graph is created before DrawDistributions(), which can also run in a separate
+ * process on the fit results and the S-curves read back from the scan output files.
  */
 
 #include "TVerbosity.h"
 #include "Common.h"
 
+#include <cstdint>
 #include <string>
+#include <vector>
 
 class TCanvas;
 class TGraph;
@@ -31,6 +37,20 @@ class TPave;
 
 class TSCurveAnalysis : public TVerbosity {
     
+    /// fit result for a pixel
+    struct TPixelFit {
+        unsigned int row;
+        unsigned int column;
+        /// false if no start point was found for the fit (threshold, noise and chisq are then meaningless)
+        bool hasStart;
+        float threshold;
+        float noise;
+        float chisq;
+    };
+    
+    /// fit results of all analyzed pixels
+    std::vector<TPixelFit> fFitResults;
+    
     /// index of the chip for which we collect errors
     common::TChipIndex fIdx;
     
@@ -130,6 +150,9 @@ class TSCurveAnalysis : public TVerbosity {
     /// boolean use to check if everything is ready to be saved to a file (default: false)
     bool fSaveToFileReady;
 
+    /// tag added to the name of the fit function (analyzers of the same chip running in parallel)
+    unsigned int fFitTag;
+
     
 public:
     
@@ -159,6 +182,9 @@ public:
     
     void SetPixelCoordinates( const unsigned int dcol, const unsigned int addr );
 
+    /// set the tag that makes the name of the fit function unique among the analyzers of a chip
+    inline void SetFitTag( const unsigned int tag ) { fFitTag = tag; }
+
     /// Return the number of injections used for each value of the injected charge
     inline unsigned int GetNinjections() const { return fNInj; }
     
@@ -175,11 +201,32 @@ public:
                        const unsigned int injectedCharge,
                        const unsigned int nhits );
     
-    /// call the fit to the S-curve and fill histograms
+    /// call the fit to the S-curve and store the fit result
     void ProcessPixelData();
+
+    /// fit the S-curves of the pixels [first, last) of a list (keys and counters as in TSCurveHisto::GetStageData())
+    void ProcessSCurves( const std::vector<std::uint32_t>& pixels,
+                         const std::vector<std::uint32_t>& counts,
+                         const std::vector<std::uint32_t>& charges,
+                         const unsigned int first, const unsigned int last );
+
+    /// append the fit results and counters of another analyzer of the same chip
+    void Merge( const TSCurveAnalysis& other );
+    
+    /// print the number of analyzed pixels and the mean threshold and noise
+    void Dump() const;
     
-    /// draw threshold and noise distribution for the tested pixels of the chip
-    void DrawDistributions();
+    /// write the fit results (one line "row column threshold noise chi2/ndf" per pixel) to a text file
+    void WriteResultsToFile( const char *fName );
+    
+    /// read back the fit results written by WriteResultsToFile() with the same file name
+    void ReadResultsFromFile( const char *fName );
+
+    /// write the threshold, noise and chi2/ndf maps of the chip to a ROOT file
+    void WriteMapsToFile( const char *fName );
+    
+    /// draw threshold, noise and chi2/ndf distributions, and some S-curves read from the raw data file
+    void DrawDistributions( const char *fName );
     
     /// save the drawing(s) to PDF file(s)
     void SaveToFile( const char *fName );
@@ -203,6 +250,12 @@ protected:
     /// create threshold, noise and chi2 histograms
     void PrepareHistos();
     
+    /// draw the S-curves of the first pixel and of the pixels with a failed or a bad fit
+    void DrawSCurves( const char *fName );
+    
+    /// draw one S-curve read from the raw data file (if it is worth drawing)
+    void DrawSCurve( const TPixelFit& fit, const std::vector<int>& x, const std::vector<int>& y );
+    
     /// Function used to fit the S-curve of each tested pixel to extract threshold and noise
     double Erf( double* xx, double* par);
     
@@ -218,6 +271,10 @@ protected:
     /// return the readiness status of the drawings for file saving
     inline bool IsSaveToFileReady() const { return fSaveToFileReady; }
     
+    /// return the name of a file from the one given to WriteResultsToFile() or DrawDistributions()
+    std::string GetFileName( const char *fName, const std::string optional,
+                             const std::string fileExtention = ".dat" ) const;
+    
 private:
     
     /// number of part in which the pixel matrix is horizontally divided
@@ -0,0 +1,77 @@
+#include "TSCurveDataFile.h"
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+using namespace std;
+
+const char TSCurveDataFile::FILE_MAGIC[8] = { 'M', 'L', 'O', 'S', 'C', 'U', 'R', 'V' };
+const uint32_t TSCurveDataFile::VERSION = 1;
+
+static_assert( sizeof(TSCurveDataFile::THeader) == 24, "unexpected padding in TSCurveDataFile::THeader" );
+
+//___________________________________________________________________
+void TSCurveDataFile::Write( const string fileName, const TData& data )
+{
+    const size_t nSteps = data.charges.size();
+    if ( data.counts.size() != data.pixels.size() * nSteps ) {
+        throw invalid_argument( "TSCurveDataFile::Write() - inconsistent number of counters for " + fileName );
+    }
+    FILE* fp = fopen( fileName.c_str(), "wb" );
+    if ( !fp ) {
+        throw runtime_error( "TSCurveDataFile::Write() - can not open output file " + fileName );
+    }
+    THeader header;
+    memcpy( header.magic, FILE_MAGIC, sizeof(header.magic) );
+    header.version = VERSION;
+    header.nSteps = nSteps;
+    header.nPixels = data.pixels.size();
+    header.nInjections = data.nInjections;
+
+    // the number of hits of a pixel at a given step never exceeds the number of injections
+    vector<uint16_t> counts( data.counts.size() );
+    for ( size_t i = 0; i < counts.size(); i++ ) {
+        counts[i] = ( data.counts[i] > numeric_limits<uint16_t>::max() ) ?
+            numeric_limits<uint16_t>::max() : data.counts[i];
+    }
+    bool success = ( fwrite( &header, sizeof(header), 1, fp ) == 1 );
+    success = success && ( fwrite( data.charges.data(), sizeof(uint32_t), nSteps, fp ) == nSteps );
+    success = success && ( fwrite( data.pixels.data(), sizeof(uint32_t), data.pixels.size(), fp ) == data.pixels.size() );
+    success = success && ( fwrite( counts.data(), sizeof(uint16_t), counts.size(), fp ) == counts.size() );
+    fclose( fp );
+    if ( !success ) {
+        throw runtime_error( "TSCurveDataFile::Write() - failed to write to " + fileName );
+    }
+}
+
+//___________________________________________________________________
+void TSCurveDataFile::Read( const string fileName, TData& data )
+{
+    FILE* fp = fopen( fileName.c_str(), "rb" );
+    if ( !fp ) {
+        throw runtime_error( "TSCurveDataFile::Read() - can not open input file " + fileName );
+    }
+    THeader header;
+    if ( (fread( &header, sizeof(header), 1, fp ) != 1)
+        || memcmp( header.magic, FILE_MAGIC, sizeof(header.magic) ) ) {
+        fclose( fp );
+        throw runtime_error( "TSCurveDataFile::Read() - " + fileName + " is not a S-curve data file." );
+    }
+    if ( header.version != VERSION ) {
+        fclose( fp );
+        throw runtime_error( "TSCurveDataFile::Read() - unknown version of the S-curve data file " + fileName );
+    }
+    data.nInjections = header.nInjections;
+    data.charges.resize( header.nSteps );
+    data.pixels.resize( header.nPixels );
+    vector<uint16_t> counts( (size_t)header.nPixels * header.nSteps );
+    bool success = ( fread( data.charges.data(), sizeof(uint32_t), header.nSteps, fp ) == header.nSteps );
+    success = success && ( fread( data.pixels.data(), sizeof(uint32_t), header.nPixels, fp ) == header.nPixels );
+    success = success && ( fread( counts.data(), sizeof(uint16_t), counts.size(), fp ) == counts.size() );
+    fclose( fp );
+    if ( !success ) {
+        throw runtime_error( "TSCurveDataFile::Read() - truncated S-curve data file " + fileName );
+    }
+    data.counts.assign( counts.begin(), counts.end() );
+}
@@ -0,0 +1,64 @@
+#ifndef TSCURVE_DATA_FILE_H
+#define TSCURVE_DATA_FILE_H
+
+/**
+ * \class TSCurveDataFile
+ *
+ * \brief Binary file with the S-curves of all the pixels of a chip
+ *
+ * \author Andry Rakotozafindrabe
+ *
+ * Written by the threshold scan next to its text data file, and read back by the
+ * offline S-curve fitter (see TSCurveFitter), without any text parsing.
+ *
+ * Layout of the file (all integers in the byte order of the writing host):
+ * - header (TSCurveDataFile::THeader)
+ * - injected charge (in DAC units) at each step, one uint32 per step
+ * - pixel keys (see TSCurveHisto::GetDoubleColumn() and GetAddress()), one uint32 per pixel
+ * - number of hits, one row of uint16 (one per step) for each pixel, same order as the keys
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class TSCurveDataFile {
+
+public:
+
+    /// identifies a S-curve data file
+    static const char FILE_MAGIC[8];
+
+    /// current version of the layout
+    static const std::uint32_t VERSION;
+
+    struct THeader {
+        char          magic[8];
+        std::uint32_t version;
+        std::uint32_t nSteps;
+        std::uint32_t nPixels;
+        /// number of injections per charge step
+        std::uint32_t nInjections;
+    };
+
+    /// S-curves of the pixels of a chip
+    struct TData {
+        /// number of injections per charge step
+        unsigned int nInjections = 0;
+        /// injected charge at each step (in DAC units)
+        std::vector<std::uint32_t> charges;
+        /// pixel keys
+        std::vector<std::uint32_t> pixels;
+        /// number of hits, one row of charges.size() counters per pixel
+        std::vector<std::uint32_t> counts;
+    };
+
+    /// write the S-curves of a chip to a file
+    static void Write( const std::string fileName, const TData& data );
+
+    /// read the S-curves of a chip from a file
+    static void Read( const std::string fileName, TData& data );
+
+};
+
+#endif
@@ -0,0 +1,174 @@
+#include "TSCurveFitter.h"
+#include "TSCurveAnalysis.h"
+#include "TSCurveDataFile.h"
+#include "TTaskPool.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <dirent.h>
+
+// ROOT includes
+#include "TROOT.h"
+
+using namespace std;
+
+//___________________________________________________________________
+TSCurveFitter::TSCurveFitter( const string fileName ) :
+TVerbosity(),
+fName( fileName ),
+fBlockSize( 4096 )
+{
+
+}
+
+//___________________________________________________________________
+TSCurveFitter::~TSCurveFitter()
+{
+    fChipList.clear();
+}
+
+//___________________________________________________________________
+void TSCurveFitter::SetBlockSize( const unsigned int nPixels )
+{
+    if ( nPixels == 0 ) {
+        cerr << "TSCurveFitter::SetBlockSize() - zero size is not valid !" << endl;
+        return;
+    }
+    fBlockSize = nPixels;
+}
+
+//___________________________________________________________________
+void TSCurveFitter::FindChips()
+{
+    fChipList.clear();
+
+    // the data directory is the one used by common::GetFileName()
+    common::TChipIndex dummy;
+    dummy.boardIndex = 0;
+    dummy.dataReceiver = 0;
+    dummy.deviceType = TDeviceType::kUNKNOWN;
+    dummy.deviceId = 0;
+    dummy.chipId = 0;
+    const string path = common::GetFileName( dummy, GetSuffix() );
+    const string directory = path.substr( 0, path.rfind( '/' ) + 1 );
+    const string suffix = path.substr( directory.size(), path.rfind( "-B" ) - directory.size() );
+
+    DIR* dir = opendir( directory.empty() ? "." : directory.c_str() );
+    if ( !dir ) {
+        throw runtime_error( "TSCurveFitter::FindChips() - data directory " + directory + " not found." );
+    }
+    struct dirent* entry;
+    while ( (entry = readdir( dir )) != nullptr ) {
+        common::TChipIndex idx;
+        if ( common::GetChipIndexFromFileName( string( entry->d_name ), suffix, idx, ".scurve" ) ) {
+            fChipList.push_back( idx );
+        }
+    }
+    closedir( dir );
+
+    if ( GetVerboseLevel() > kSILENT ) {
+        cout << "TSCurveFitter::FindChips() - " << std::dec << fChipList.size()
+             << " chip(s) found for " << directory << suffix << endl;
+    }
+}
+
+//___________________________________________________________________
+unsigned int TSCurveFitter::Go( const unsigned int nThreads )
+{
+    if ( fChipList.empty() ) {
+        throw runtime_error( "TSCurveFitter::Go() - no chip ! Please use FindChips() first." );
+    }
+    gROOT->SetBatch();
+    ROOT::EnableThreadSafety();
+    TTaskPool pool( nThreads );
+    if ( GetVerboseLevel() > kTERSE ) {
+        cout << "TSCurveFitter::Go() - " << std::dec << pool.GetNThreads()
+             << " thread(s) for the S-curve fits" << endl;
+    }
+
+    // one analyzer per block of pixels, the data of a chip are released after its last block
+    vector<vector<shared_ptr<TSCurveAnalysis>>> blocks( fChipList.size() );
+    vector<unique_ptr<atomic<bool>>> failed;
+    unsigned int lane = 0;
+    for ( unsigned int ichip = 0; ichip < fChipList.size(); ichip++ ) {
+        const common::TChipIndex idx = fChipList.at( ichip );
+        failed.push_back( unique_ptr<atomic<bool>>( new atomic<bool>( false ) ) );
+        auto data = make_shared<TSCurveDataFile::TData>();
+        try {
+            TSCurveDataFile::Read( common::GetFileName( idx, GetSuffix(), "", ".scurve" ), *data );
+        } catch ( exception& err ) {
+            cerr << err.what() << endl;
+            failed.back()->store( true );
+            continue;
+        }
+        if ( data->charges.empty() || !data->nInjections ) {
+            cerr << "TSCurveFitter::Go() - empty S-curve data file for ";
+            common::DumpId( idx );
+            cerr << endl;
+            failed.back()->store( true );
+            continue;
+        }
+        const unsigned int maxCharge = *max_element( data->charges.begin(), data->charges.end() );
+        atomic<bool>* chipFailed = failed.back().get();
+        for ( unsigned int first = 0; first < data->pixels.size(); first += fBlockSize ) {
+            auto analyzer = make_shared<TSCurveAnalysis>( idx, data->nInjections, maxCharge );
+            analyzer->SetVerboseLevel( GetVerboseLevel() );
+            analyzer->Init();
+            analyzer->SetFitTag( blocks.at( ichip ).size() );
+            blocks.at( ichip ).push_back( analyzer );
+            const unsigned int last = min( first + fBlockSize, (unsigned int)data->pixels.size() );
+            pool.Submit( lane++, [analyzer, data, first, last, chipFailed]() {
+                try {
+                    analyzer->ProcessSCurves( data->pixels, data->counts, data->charges, first, last );
+                } catch ( exception& err ) {
+                    cerr << err.what() << endl;
+                    chipFailed->store( true );
+                }
+            } );
+        }
+        if ( GetVerboseLevel() > kTERSE ) {
+            cout << "TSCurveFitter::Go() - ";
+            common::DumpId( idx );
+            cout << " : " << std::dec << data->pixels.size() << " pixels in "
+                 << blocks.at( ichip ).size() << " block(s)" << endl;
+        }
+    }
+    pool.Wait();
+
+    // merge the blocks of each chip in the order of the pixels
+    unsigned int nFailed = 0;
+    for ( unsigned int ichip = 0; ichip < fChipList.size(); ichip++ ) {
+        if ( failed.at( ichip )->load() || blocks.at( ichip ).empty() ) {
+            nFailed++;
+            continue;
+        }
+        shared_ptr<TSCurveAnalysis> analyzer = blocks.at( ichip ).front();
+        for ( unsigned int ib = 1; ib < blocks.at( ichip ).size(); ib++ ) {
+            analyzer->Merge( *(blocks.at( ichip ).at( ib )) );
+        }
+        blocks.at( ichip ).resize( 1 );
+        try {
+            analyzer->WriteResultsToFile( fName.c_str() );
+            analyzer->WriteMapsToFile( fName.c_str() );
+        } catch ( exception& err ) {
+            cerr << err.what() << endl;
+            nFailed++;
+            continue;
+        }
+        if ( GetVerboseLevel() > kSILENT ) {
+            analyzer->Dump();
+        }
+    }
+    return nFailed;
+}
+
+//___________________________________________________________________
+string TSCurveFitter::GetSuffix() const
+{
+    char fNameTemp[100];
+    snprintf( fNameTemp, sizeof(fNameTemp), "%s", fName.c_str() );
+    strtok( fNameTemp, "." );
+    return string( fNameTemp );
+}
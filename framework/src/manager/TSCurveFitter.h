@@ -0,0 +1,69 @@
+#ifndef TSCURVE_FITTER_H
+#define TSCURVE_FITTER_H
+
+/**
+ * \class TSCurveFitter
+ *
+ * \brief Offline fit of the S-curves written by a threshold scan
+ *
+ * \author Andry Rakotozafindrabe
+ *
+ * This class finds the chips for which a threshold scan wrote a binary S-curve data
+ * file (see TSCurveDataFile), and fits again the S-curve of each pixel with the same
+ * code as the scan (TSCurveAnalysis), e.g. to refit a full ladder dataset without
+ * the hardware.
+ *
+ * The pixels of each chip are split in blocks, and the blocks of all chips are fitted
+ * in parallel threads, each block with its own analyzer. The results of the blocks
+ * of a chip are then merged in the order of the pixels, so that the fit results
+ * written (same text file as the scan) do not depend on the number of threads. The
+ * threshold, noise and chi2/ndf maps of each chip are also written to a ROOT file.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "Common.h"
+#include "TVerbosity.h"
+
+class TSCurveAnalysis;
+
+class TSCurveFitter : public TVerbosity {
+
+    /// file name given to the scan (used as the prefix of the name of the data files)
+    std::string fName;
+
+    /// number of pixels fitted by a single task
+    unsigned int fBlockSize;
+
+    /// list of the chips with a S-curve data file
+    std::vector<common::TChipIndex> fChipList;
+
+public:
+
+    /// constructor with the file name given to the scan
+    TSCurveFitter( const std::string fileName );
+
+    /// destructor
+    virtual ~TSCurveFitter();
+
+    /// set the number of pixels fitted by a single task (default = 4096)
+    void SetBlockSize( const unsigned int nPixels );
+
+    /// find the chips with a S-curve data file written by the scan
+    void FindChips();
+
+    /// number of chips found by FindChips()
+    unsigned int GetNChips() const { return fChipList.size(); }
+
+    /// fit the S-curves of all chips found with nThreads threads, return the number of failed chips
+    unsigned int Go( const unsigned int nThreads );
+
+private:
+
+    /// base name of the data files (file name given to the scan without extension)
+    std::string GetSuffix() const;
+
+};
+
+#endif
@@ -0,0 +1,227 @@
+#include "TSCurveHisto.h"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+using namespace std;
+
+#pragma mark - constructors / destructor
+
+//___________________________________________________________________
+TSCurveHisto::TSCurveHisto() : TVerbosity(),
+fNChargeSteps( 0 ),
+fCurrentStep( 0 ),
+fNPixPerStage( 0 )
+{
+
+}
+
+//___________________________________________________________________
+TSCurveHisto::~TSCurveHisto()
+{
+    Clear();
+}
+
+#pragma mark - setters
+
+//___________________________________________________________________
+void TSCurveHisto::AddChip( const common::TChipIndex idx )
+{
+    if ( IsValidChipIndex( idx ) ) {
+        return;
+    }
+    if ( GetVerboseLevel() > kULTRACHATTY ) {
+        cout << "TSCurveHisto::AddChip() - " << std::dec;
+        common::DumpId( idx );
+        cout << endl;
+    }
+    fChipList.push_back( idx );
+    const int int_index = common::GetMapIntIndex( idx );
+    fStage[int_index] = TChipSCurves();
+    fStore[int_index] = TChipSCurves();
+}
+
+//___________________________________________________________________
+void TSCurveHisto::SetNChargeSteps( const unsigned int nSteps )
+{
+    if ( !nSteps ) {
+        throw domain_error( "TSCurveHisto::SetNChargeSteps() - need at least one step !" );
+    }
+    fNChargeSteps = nSteps;
+    fCurrentStep = 0;
+    for ( map<int, TChipSCurves>::iterator it = fStage.begin(); it != fStage.end(); ++it ) {
+        it->second = TChipSCurves();
+    }
+    for ( map<int, TChipSCurves>::iterator it = fStore.begin(); it != fStore.end(); ++it ) {
+        it->second = TChipSCurves();
+    }
+}
+
+//___________________________________________________________________
+void TSCurveHisto::SetChargeStep( const unsigned int istep )
+{
+    if ( istep >= fNChargeSteps ) {
+        throw out_of_range( "TSCurveHisto::SetChargeStep() - bad step of the injected charge" );
+    }
+    fCurrentStep = istep;
+}
+
+#pragma mark - getters
+
+//___________________________________________________________________
+unsigned int TSCurveHisto::GetHits( const common::TChipIndex idx,
+                                   const unsigned int dcol,
+                                   const unsigned int addr,
+                                   const unsigned int istep ) const
+{
+    if ( istep >= fNChargeSteps ) {
+        throw out_of_range( "TSCurveHisto::GetHits() - bad step of the injected charge" );
+    }
+    const TChipSCurves& curves = fStore.at( common::GetMapIntIndex( idx ) );
+    const uint32_t key = dcol * (common::MAX_ADDR+1) + addr;
+    unordered_map<uint32_t, uint32_t>::const_iterator it = curves.slots.find( key );
+    if ( it == curves.slots.end() ) {
+        return 0;
+    }
+    return curves.counts.at( it->second * fNChargeSteps + istep );
+}
+
+//___________________________________________________________________
+void TSCurveHisto::GetPixelList( const common::TChipIndex idx, vector<uint32_t>& keys ) const
+{
+    const TChipSCurves& curves = fStore.at( common::GetMapIntIndex( idx ) );
+    keys = curves.pixels;
+    sort( keys.begin(), keys.end() );
+}
+
+//___________________________________________________________________
+void TSCurveHisto::GetStageData( const common::TChipIndex idx,
+                                 vector<uint32_t>& keys,
+                                 vector<uint32_t>& counts ) const
+{
+    const TChipSCurves& curves = fStage.at( common::GetMapIntIndex( idx ) );
+    keys = curves.pixels;
+    sort( keys.begin(), keys.end() );
+    counts.resize( keys.size() * fNChargeSteps );
+    for ( unsigned int ipix = 0; ipix < keys.size(); ipix++ ) {
+        const uint32_t slot = curves.slots.at( keys.at(ipix) );
+        copy( curves.counts.begin() + slot * fNChargeSteps,
+              curves.counts.begin() + (slot + 1) * fNChargeSteps,
+              counts.begin() + ipix * fNChargeSteps );
+    }
+}
+
+//___________________________________________________________________
+unsigned int TSCurveHisto::GetChipNEntries( const common::TChipIndex idx ) const
+{
+    const int int_index = common::GetMapIntIndex( idx );
+    return fStore.at( int_index ).nEntries + fStage.at( int_index ).nEntries;
+}
+
+//___________________________________________________________________
+unsigned int TSCurveHisto::GetNEntries() const
+{
+    unsigned int nEntries = 0;
+    for ( unsigned int i = 0; i < fChipList.size(); i++ ) {
+        nEntries += GetChipNEntries( fChipList.at(i) );
+    }
+    return nEntries;
+}
+
+//___________________________________________________________________
+bool TSCurveHisto::HasData( const common::TChipIndex idx ) const
+{
+    return ( fStore.at( common::GetMapIntIndex( idx ) ).nEntries > 0 );
+}
+
+//___________________________________________________________________
+bool TSCurveHisto::IsValidChipIndex( const common::TChipIndex idx ) const
+{
+    for ( unsigned int i = 0; i < fChipList.size(); i++ ) {
+        if ( common::SameChipIndex( idx, fChipList.at(i) ) ) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#pragma mark - other
+
+//___________________________________________________________________
+void TSCurveHisto::StartStage( const unsigned int nPixPerStage )
+{
+    fNPixPerStage = nPixPerStage;
+    fCurrentStep = 0;
+    for ( map<int, TChipSCurves>::iterator it = fStage.begin(); it != fStage.end(); ++it ) {
+        TChipSCurves& curves = it->second;
+        curves.pixels.clear();
+        curves.counts.clear();
+        curves.slots.clear();
+        curves.nEntries = 0;
+        curves.pixels.reserve( fNPixPerStage );
+        curves.counts.reserve( fNPixPerStage * fNChargeSteps );
+        curves.slots.reserve( fNPixPerStage );
+    }
+}
+
+//___________________________________________________________________
+void TSCurveHisto::Incr( const common::TChipIndex idx, const unsigned int dcol, const unsigned int addr )
+{
+    if ( (dcol > common::MAX_DCOL) || (addr > common::MAX_ADDR) ) {
+        return;
+    }
+    if ( GetVerboseLevel() > kULTRACHATTY ) {
+        cout << "TSCurveHisto::Incr() - " << std::dec;
+        common::DumpId( idx );
+        cout << endl;
+    }
+    Add( fStage.at( common::GetMapIntIndex( idx ) ),
+         dcol * (common::MAX_ADDR+1) + addr, fCurrentStep, 1 );
+}
+
+//___________________________________________________________________
+void TSCurveHisto::EndStage()
+{
+    for ( map<int, TChipSCurves>::iterator it = fStage.begin(); it != fStage.end(); ++it ) {
+        TChipSCurves& stage = it->second;
+        TChipSCurves& store = fStore.at( it->first );
+        for ( unsigned int ipix = 0; ipix < stage.pixels.size(); ipix++ ) {
+            for ( unsigned int istep = 0; istep < fNChargeSteps; istep++ ) {
+                const uint32_t n = stage.counts.at( ipix * fNChargeSteps + istep );
+                if ( n ) Add( store, stage.pixels.at(ipix), istep, n );
+            }
+        }
+        stage.pixels.clear();
+        stage.counts.clear();
+        stage.slots.clear();
+        stage.nEntries = 0;
+    }
+}
+
+//___________________________________________________________________
+void TSCurveHisto::Clear()
+{
+    fStage.clear();
+    fStore.clear();
+    fChipList.clear();
+    fCurrentStep = 0;
+}
+
+//___________________________________________________________________
+void TSCurveHisto::Add( TChipSCurves& curves, const uint32_t key,
+                        const unsigned int istep, const uint32_t n )
+{
+    uint32_t slot;
+    unordered_map<uint32_t, uint32_t>::const_iterator it = curves.slots.find( key );
+    if ( it == curves.slots.end() ) {
+        // first hit on this pixel: new row of counters
+        slot = curves.pixels.size();
+        curves.slots.insert( pair<uint32_t, uint32_t>( key, slot ) );
+        curves.pixels.push_back( key );
+        curves.counts.resize( curves.counts.size() + fNChargeSteps, 0 );
+    } else {
+        slot = it->second;
+    }
+    curves.counts[ slot * fNChargeSteps + istep ] += n;
+    curves.nEntries += n;
+}
@@ -0,0 +1,139 @@
+#ifndef TSCURVE_HISTO_H
+#define TSCURVE_HISTO_H
+
+/**
+ * \class TSCurveHisto
+ *
+ * \brief Sparse storage of the number of hits vs injected charge for the pulsed pixels
+ *
+ * \author Andry Rakotozafindrabe
+ *
+ * During a mask stage of the threshold scan, hits are accumulated in a small per-stage
+ * buffer: one row of counters (one per charge step) for each pixel that was hit during
+ * the stage, i.e. essentially the pulsed pixels of the stage. At the end of the stage,
+ * the buffer is merged into the final store of the S-curves, and cleared.
+ *
+ * Memory and fill cost thus scale with the number of pulsed pixels, instead of one
+ * full 512 x 1024 histogram per chip and per charge step.
+ *
+ * Pixels are identified by the key dcol * (common::MAX_ADDR+1) + address.
+ */
+
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include "Common.h"
+#include "TVerbosity.h"
+
+class TSCurveHisto : public TVerbosity {
+
+    /// hit counters of the pixels of one chip
+    struct TChipSCurves {
+        /// pixel keys, in order of first hit
+        std::vector<std::uint32_t> pixels;
+        /// counters, one row of fNChargeSteps per pixel, same order as pixels
+        std::vector<std::uint32_t> counts;
+        /// position of each pixel key in the vector of pixels
+        std::unordered_map<std::uint32_t, std::uint32_t> slots;
+        /// total number of hits
+        unsigned int nEntries = 0;
+    };
+
+    /// number of steps of the injected charge
+    unsigned int fNChargeSteps;
+
+    /// current step of the injected charge
+    unsigned int fCurrentStep;
+
+    /// expected number of pulsed pixels per chip in a mask stage (used to reserve memory)
+    unsigned int fNPixPerStage;
+
+    /// hits of the current mask stage (key = map int index of the chip)
+    std::map<int, TChipSCurves> fStage;
+
+    /// merged hits of all the finished mask stages (key = map int index of the chip)
+    std::map<int, TChipSCurves> fStore;
+
+    /// list of chip indices
+    std::vector<common::TChipIndex> fChipList;
+
+public:
+
+#pragma mark - constructors / destructor
+
+    /// default constructor
+    TSCurveHisto();
+
+    /// destructor
+    ~TSCurveHisto();
+
+#pragma mark - setters
+
+    /// add a chip to be filled
+    void AddChip( const common::TChipIndex idx );
+
+    /// set the number of steps of the injected charge (clears all data)
+    void SetNChargeSteps( const unsigned int nSteps );
+
+    /// set the current step of the injected charge
+    void SetChargeStep( const unsigned int istep );
+
+#pragma mark - getters
+
+    /// number of hits for a given chip, double column, address and step of the injected charge
+    unsigned int GetHits( const common::TChipIndex idx,
+                          const unsigned int dcol,
+                          const unsigned int addr,
+                          const unsigned int istep ) const;
+
+    /// sorted list of the keys of the pixels with at least one hit (finished stages only)
+    void GetPixelList( const common::TChipIndex idx, std::vector<std::uint32_t>& keys ) const;
+
+    /// sorted keys and counters (one row of fNChargeSteps per pixel) of the current mask stage
+    void GetStageData( const common::TChipIndex idx,
+                       std::vector<std::uint32_t>& keys,
+                       std::vector<std::uint32_t>& counts ) const;
+
+    /// total number of hits for a given chip (finished stages and current stage)
+    unsigned int GetChipNEntries( const common::TChipIndex idx ) const;
+
+    /// total number of hits for all chips (finished stages and current stage)
+    unsigned int GetNEntries() const;
+
+    /// check if there is any hit for a given chip (finished stages only)
+    bool HasData( const common::TChipIndex idx ) const;
+
+    bool IsValidChipIndex( const common::TChipIndex idx ) const;
+    inline unsigned int GetChipListSize() const { return fChipList.size(); }
+    common::TChipIndex GetChipIndex( const unsigned int i ) const { return fChipList.at(i); }
+    inline unsigned int GetNChargeSteps() const { return fNChargeSteps; }
+
+    /// double column from the key of a pixel
+    static unsigned int GetDoubleColumn( const std::uint32_t key ) { return key / (common::MAX_ADDR+1); }
+
+    /// address from the key of a pixel
+    static unsigned int GetAddress( const std::uint32_t key ) { return key % (common::MAX_ADDR+1); }
+
+#pragma mark - other
+
+    /// start a new mask stage, with the expected number of pulsed pixels per chip
+    void StartStage( const unsigned int nPixPerStage );
+
+    /// increment the counter of a pixel for the current step of the injected charge
+    void Incr( const common::TChipIndex idx, const unsigned int dcol, const unsigned int addr );
+
+    /// merge the hits of the current mask stage into the final store
+    void EndStage();
+
+    /// remove all data
+    void Clear();
+
+private:
+
+    /// add n hits to a pixel at a given step
+    void Add( TChipSCurves& curves, const std::uint32_t key,
+              const unsigned int istep, const std::uint32_t n );
+};
+
+#endif
@@ -14,6 +14,7 @@
 #include "TDeviceBuilderOBSingleDAQ.h"
 #include "TDeviceBuilderOBSingleMosaic.h"
 #include "TDeviceBuilderTelescopeDAQ.h"
+#include "TReadoutBoardReplay.h"
 #include "TScanConfig.h"
 
 using namespace std;
@@ -27,6 +28,12 @@ TSetup::TSetup() : TVerbosity(),
     fConfigFileName( "../config/ConfigSingleChipMOSAIC.cfg" ),
     fDeviceNickName( "" ),
     fdeviceId( 0 ),
+    fPlotting( true ),
+    fRecordRawEvents( false ),
+    fBuildEvents( false ),
+    fMonitorSegmentName( "" ),
+    fReplayFileName( "" ),
+    fReplayAtOriginalSpeed( false ),
     fConfigFile( nullptr ),
     fDeviceBuilder( nullptr ),
     fDevice( nullptr ),
@@ -67,15 +74,21 @@ void TSetup::DecodeCommandParameters(int argc, char **argv)
 {
     int c;
     
-    while ((c = getopt (argc, argv, "hv:c:n:l:")) != -1)
+    while ((c = getopt (argc, argv, "hv:c:n:l:p:r:b:m:R:O")) != -1)
         switch (c) {
             case 'h':  // prints the Help of usage
-                cout << "Usage : " << argv[0] << " -h -v <level> -c <configuration_file> -l <ladder_id> -n <nick_name>"<< endl;
+                cout << "Usage : " << argv[0] << " -h -v <level> -c <configuration_file> -l <ladder_id> -n <nick_name> -p <plots> -r <raw> -b <build> -m <segment> -R <raw_file> -O"<< endl;
                 cout << "-h  :  Display this message" << endl;
                 cout << "-v <level> : Sets the verbosity level (integer)" << endl;
                 cout << "-c <configuration_file> : Sets the configuration file used" << endl << endl;
                 cout << "-n <nick_name> : Sets the nick name of the single chip on carrier board" << endl << endl;
                 cout << "-l <ladder_id> : Sets the ladder id (unsigned integer)" << endl;
+                cout << "-p <plots> : Draw the plots at the end of the scan (1 = default) or only write the data files (0), see test_plotresults" << endl;
+                cout << "-r <raw> : Record all raw events in a binary file (1) or not (0 = default), see TRawEventReader" << endl;
+                cout << "-b <build> : Assemble the events of all boards by trigger number (1) or not (0 = default), see TEventBuilder" << endl;
+                cout << "-m <segment> : Publish live snapshots of the hit maps and error counters in a shared memory segment (e.g. /mlo-monitor), see test_monitor" << endl;
+                cout << "-R <raw_file> : Replay a recorded raw event file instead of reading the MOSAIC boards (no hardware needed)" << endl;
+                cout << "-O : Replay the raw event file at the speed of the recorded run (trigger times needed) instead of the maximum speed" << endl;
                 exit( EXIT_FAILURE );
                 break;
             case 'v':  // sets the verbose level
@@ -89,13 +102,31 @@ void TSetup::DecodeCommandParameters(int argc, char **argv)
                 strncpy(ConfigurationFileName, optarg, 1023);
                 SetConfigFileName( string(ConfigurationFileName) );
                 break;
+            case 'p':  // enables or disables the plots at the end of the scan
+                fPlotting = ( atoi(optarg) != 0 );
+                break;
+            case 'r':  // enables or disables the recording of the raw events
+                fRecordRawEvents = ( atoi(optarg) != 0 );
+                break;
+            case 'b':  // enables or disables the building of the multi-board events
+                fBuildEvents = ( atoi(optarg) != 0 );
+                break;
+            case 'm':  // enables the live monitoring in a shared memory segment
+                fMonitorSegmentName = string( optarg );
+                break;
+            case 'R':  // replays a raw event file instead of reading the boards
+                fReplayFileName = string( optarg );
+                break;
+            case 'O':  // replays the raw event file at the original speed
+                fReplayAtOriginalSpeed = true;
+                break;
             case 'n':  // sets device name, only useful if single chip on carrier board
                 char DeviceName[1024];
                 strncpy(DeviceName, optarg, 1023);
                 SetDeviceNickName( string(DeviceName) );
                 break;
             case '?':
-                if ( (optopt == 'c') | (optopt == 'v') | (optopt == 'n') | (optopt == 'l') ) {
+                if ( (optopt == 'c') | (optopt == 'v') | (optopt == 'n') | (optopt == 'l') | (optopt == 'p') | (optopt == 'r') | (optopt == 'b') | (optopt == 'm') | (optopt == 'R') ) {
                     cerr << "Option -" << optopt << " requires an argument." << endl;
                 } else {
                     if (isprint (optopt)) {
@@ -356,6 +387,15 @@ void TSetup::InitDeviceBuilder( TDeviceType dt )
             return;
     }
     fDeviceBuilder->SetVerboseLevel( this->GetVerboseLevel() );
+    if ( !fReplayFileName.empty() ) {
+        try {
+            fDeviceBuilder->SetReplayFile( fReplayFileName,
+                fReplayAtOriginalSpeed ? TReplaySpeed::kORIGINAL : TReplaySpeed::kMAXIMUM );
+        } catch ( std::runtime_error &err ) {
+            cerr << err.what() << endl;
+            exit( EXIT_FAILURE );
+        }
+    }
     fDeviceBuilder->CreateDevice();
     try {
         fDeviceBuilder->SetDeviceType( dt );
@@ -53,6 +53,10 @@ public:
     #pragma mark - getters
     std::shared_ptr<TDevice> GetDevice() { return fDevice; }
     std::shared_ptr<TScanConfig> GetScanConfig() { return fScanConfig; }
+    bool IsPlottingEnabled() const { return fPlotting; }
+    bool IsRawEventRecordingEnabled() const { return fRecordRawEvents; }
+    bool IsEventBuildingEnabled() const { return fBuildEvents; }
+    std::string GetMonitorSegmentName() const { return fMonitorSegmentName; }
     
     #pragma mark - other public methods
     void DecodeCommandParameters( int argc, char **argv );
@@ -76,6 +80,12 @@ private:
     std::string fConfigFileName;
     std::string fDeviceNickName;
     unsigned int fdeviceId;
+    bool fPlotting;
+    bool fRecordRawEvents;
+    bool fBuildEvents;
+    std::string fMonitorSegmentName;
+    std::string fReplayFileName;
+    bool fReplayAtOriginalSpeed;
     FILE* fConfigFile;
     std::shared_ptr<TDeviceBuilder> fDeviceBuilder;
     std::shared_ptr<TDevice> fDevice;
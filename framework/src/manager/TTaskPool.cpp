@@ -0,0 +1,110 @@
+#include "TTaskPool.h"
+#include <iostream>
+#include <stdexcept>
+
+using namespace std;
+
+//___________________________________________________________________
+TTaskPool::TTaskPool( const unsigned int nThreads ) : TVerbosity(),
+fStop( false ),
+fError( "" )
+{
+    unsigned int n = nThreads ? nThreads : thread::hardware_concurrency();
+    if ( !n ) {
+        n = 1;
+    }
+    for ( unsigned int i = 0; i < n; i++ ) {
+        fWorkers.push_back( unique_ptr<TWorker>( new TWorker() ) );
+    }
+    for ( unsigned int i = 0; i < n; i++ ) {
+        fWorkers.at(i)->thread = thread( &TTaskPool::Run, this, i );
+    }
+}
+
+//___________________________________________________________________
+TTaskPool::~TTaskPool()
+{
+    {
+        unique_lock<mutex> lock( fMutex );
+        fDoneCondition.wait( lock, [this]{ return IsIdle(); } );
+        fStop = true;
+    }
+    fTaskCondition.notify_all();
+    for ( unsigned int i = 0; i < fWorkers.size(); i++ ) {
+        if ( fWorkers.at(i)->thread.joinable() ) {
+            fWorkers.at(i)->thread.join();
+        }
+    }
+    if ( !fError.empty() ) {
+        cerr << "TTaskPool::~TTaskPool() - unchecked task failure: " << fError << endl;
+    }
+}
+
+//___________________________________________________________________
+void TTaskPool::Submit( const unsigned int lane, function<void()> task )
+{
+    {
+        lock_guard<mutex> lock( fMutex );
+        fWorkers.at( lane % fWorkers.size() )->tasks.push_back( move(task) );
+    }
+    fTaskCondition.notify_all();
+}
+
+//___________________________________________________________________
+void TTaskPool::Wait()
+{
+    string error;
+    {
+        unique_lock<mutex> lock( fMutex );
+        fDoneCondition.wait( lock, [this]{ return IsIdle(); } );
+        error.swap( fError );
+    }
+    if ( !error.empty() ) {
+        cerr << error << endl;
+        throw runtime_error( "TTaskPool::Wait() - at least one task failed !" );
+    }
+}
+
+//___________________________________________________________________
+void TTaskPool::Run( const unsigned int iworker )
+{
+    TWorker& worker = *(fWorkers.at( iworker ));
+    while ( true ) {
+        function<void()> task;
+        {
+            unique_lock<mutex> lock( fMutex );
+            fTaskCondition.wait( lock, [this, &worker]{ return fStop || !worker.tasks.empty(); } );
+            if ( worker.tasks.empty() ) {
+                return; // stop requested and nothing left to do
+            }
+            task = move( worker.tasks.front() );
+            worker.tasks.pop_front();
+            worker.busy = true;
+        }
+        string error;
+        try {
+            task();
+        } catch ( exception& err ) {
+            error = err.what();
+        }
+        {
+            lock_guard<mutex> lock( fMutex );
+            worker.busy = false;
+            if ( !error.empty() && fError.empty() ) {
+                fError = error;
+            }
+        }
+        fDoneCondition.notify_all();
+    }
+}
+
+//___________________________________________________________________
+bool TTaskPool::IsIdle() const
+{
+    for ( unsigned int i = 0; i < fWorkers.size(); i++ ) {
+        if ( fWorkers.at(i)->busy || !fWorkers.at(i)->tasks.empty() ) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,82 @@
+#ifndef TTASK_POOL_H
+#define TTASK_POOL_H
+
+/**
+ * \class TTaskPool
+ *
+ * \brief Small pool of worker threads running tasks in the background
+ *
+ * \author Andry Rakotozafindrabe
+ *
+ * Each task is submitted to a lane. All tasks of a given lane are run by the same
+ * worker thread, in the order of submission: objects that are not thread-safe (e.g.
+ * an analyzer with its ROOT histograms) can be used by the tasks of a single lane
+ * without any lock. Different lanes run in parallel if there are enough workers.
+ *
+ * Wait() blocks until all submitted tasks are done, and throws if any task failed.
+ */
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "TVerbosity.h"
+
+class TTaskPool : public TVerbosity {
+
+    /// a worker thread and its queue of tasks
+    struct TWorker {
+        std::thread thread;
+        std::deque<std::function<void()>> tasks;
+        bool busy = false;
+    };
+
+    /// worker threads
+    std::vector<std::unique_ptr<TWorker>> fWorkers;
+
+    /// protect the queues of tasks, the busy flags and the error message
+    std::mutex fMutex;
+
+    /// signal a new task (or the stop request) to the workers
+    std::condition_variable fTaskCondition;
+
+    /// signal the completion of a task
+    std::condition_variable fDoneCondition;
+
+    /// stop request for the workers
+    bool fStop;
+
+    /// message of the first exception thrown by a task
+    std::string fError;
+
+public:
+
+    /// constructor with the number of worker threads (0 = number of hardware threads)
+    TTaskPool( const unsigned int nThreads = 0 );
+
+    /// destructor, waits for all tasks to be done
+    ~TTaskPool();
+
+    /// queue a task on a given lane
+    void Submit( const unsigned int lane, std::function<void()> task );
+
+    /// wait for all submitted tasks to be done
+    void Wait();
+
+    /// number of worker threads
+    inline unsigned int GetNThreads() const { return fWorkers.size(); }
+
+private:
+
+    /// loop of the i-th worker thread
+    void Run( const unsigned int iworker );
+
+    /// check if all queues are empty and all workers are idle (fMutex must be locked)
+    bool IsIdle() const;
+};
+
+#endif
@@ -35,6 +35,7 @@
 #include "mboard.h"
 #include "mexception.h"
 #include "TAlpideDataParser.h"
+#include "THotTrace.h"
 
 using namespace std;
 
@@ -66,27 +67,21 @@ long TAlpideDataParser::checkEvent(unsigned char *dBuffer, unsigned char *evFlag
             closed=1;
             int d = h&0x0f;
             int fsd = *p;
-            if ( GetVerboseLevel() >= kCHATTY ) {
-                cout << endl << std::dec << "Board " << GetBoardId() <<  " RCV " << "Board " << GetBoardId() <<  " RCV " << GetReceiverId() << " Trigger " << GetTriggerNum() << " @ " << GetTriggerTime() << " Trigger " << GetTriggerNum() << " @ " << GetTriggerTime() << " TAlpideDataParser::checkEvent() - CHIP_EMPTY_FRAME ID:" << d << "  Frame Start Data:" << std::hex << fsd << endl;
-            }
+            HOT_TRACE( HotTrace::kPARSER_EMPTYFRAME, GetBoardId(), GetReceiverId(), GetTriggerNum(), d, fsd );
             lastRegion = -1;
             lastDataField = -1;
 		} else if ( (h >> DSHIFT_CHIP_HEADER) == DCODE_CHIP_HEADER ) {
             p++;
             int d = h&0x0f;
             int fsd = *p;
-            if ( GetVerboseLevel() >= kCHATTY ) {
-                cout << endl << std::dec << "Board " << GetBoardId() <<  " RCV " << "Board " << GetBoardId() <<  " RCV " << GetReceiverId() << " Trigger " << GetTriggerNum() << " @ " << GetTriggerTime() << " Trigger " << GetTriggerNum() << " @ " << GetTriggerTime() << " TAlpideDataParser::checkEvent() - CHIP_HEADER ID:" << d << " frame start data:" << std::hex << fsd << endl;
-            }
+            HOT_TRACE( HotTrace::kPARSER_CHIPHEADER, GetBoardId(), GetReceiverId(), GetTriggerNum(), d, fsd );
 		} else if ((h >> DSHIFT_CHIP_TRAILER) == DCODE_CHIP_TRAILER ) {
             int d = h&0x0f;
-            if ( GetVerboseLevel() >= kCHATTY ) {
-                cout << std::dec << "Board " << GetBoardId() <<  " RCV " << "Board " << GetBoardId() <<  " RCV " << GetReceiverId() << " Trigger " << GetTriggerNum() << " @ " << GetTriggerTime() << " Trigger " << GetTriggerNum() << " @ " << GetTriggerTime() << " TAlpideDataParser::checkEvent() - CHIP_TRAILER Flags:" << d << endl;
-            }
 			closed = 1;
 			// additional trailer
 			*evFlagsPtr = *p++;
             uint16_t fsd = *evFlagsPtr;
+            HOT_TRACE( HotTrace::kPARSER_CHIPTRAILER, GetBoardId(), GetReceiverId(), GetTriggerNum(), d, fsd );
             if (fsd && (GetVerboseLevel() > kTERSE) ){
                 cout << std::dec << "Board " << GetBoardId() <<  " RCV " << "Board " << GetBoardId() <<  " RCV " << GetReceiverId() << " Trigger " << GetTriggerNum() << " @ " << GetTriggerTime() << " Trigger " << GetTriggerNum() << " @ " << GetTriggerTime() << " =================== Event with flags != 0 (0x" << std::hex << fsd << ")" << endl;
                 if (fsd & 0x01)
@@ -96,8 +91,7 @@ long TAlpideDataParser::checkEvent(unsigned char *dBuffer, unsigned char *evFlag
             }
 		} else if ((h >> DSHIFT_REGION_HEADER) == DCODE_REGION_HEADER ) {
             int d = h&0x1f;
-            if ( GetVerboseLevel() >= kCHATTY )
-                cout << std::dec << "Board " << GetBoardId() <<  " RCV " << GetReceiverId() << " Trigger " << GetTriggerNum() << " @ " << GetTriggerTime() << " TAlpideDataParser::checkEvent() - REGION_HEADER Region:" << d << endl;
+            HOT_TRACE( HotTrace::kPARSER_REGIONHEADER, GetBoardId(), GetReceiverId(), GetTriggerNum(), d, lastRegion );
             if ( (d <= lastRegion) && (GetVerboseLevel() >= kCHATTY) ){
                 cout << std::dec << "Board " << GetBoardId() <<  " RCV " << GetReceiverId() << " Trigger " << GetTriggerNum() << " @ " << GetTriggerTime() << " =================== REGION_HEADER ERROR" << endl;
             }
@@ -106,8 +100,7 @@ long TAlpideDataParser::checkEvent(unsigned char *dBuffer, unsigned char *evFlag
 		} else if ((h >> DSHIFT_DATA_SHORT) == DCODE_DATA_SHORT ) {
 			p++;
             uint16_t dShort = ((h&0x3f) << 8) | *p;
-            if ( GetVerboseLevel() >= kCHATTY )
-                cout << std::dec << "Board " << GetBoardId() <<  " RCV " << GetReceiverId() << " Trigger " << GetTriggerNum() << " @ " << GetTriggerTime() << "  DATA_SHORT Data:" << std::hex << dShort << endl;
+            HOT_TRACE( HotTrace::kPARSER_DATASHORT, GetBoardId(), GetReceiverId(), GetTriggerNum(), dShort, lastDataField, lastRegion );
             if ((lastRegion < 0) && (GetVerboseLevel() >= kCHATTY)){
                 cout << std::dec << "Board " << GetBoardId() <<  " RCV " << GetReceiverId() << " Trigger " << GetTriggerNum() << " @ " << GetTriggerTime() << " =================== DATA_SHORT Without Region header" << endl;
                 lastRegion = 0;
@@ -122,10 +115,7 @@ long TAlpideDataParser::checkEvent(unsigned char *dBuffer, unsigned char *evFlag
             // TODO: check incrementation done by next 2 lines <=> line above
             uint16_t dShort = ((h&0x3f) << 8) | *p++;
             uint16_t hitMap = *p++;
-            if ( GetVerboseLevel() >= kCHATTY ){
-                cout << std::dec << "Board " << GetBoardId() <<  " RCV " << GetReceiverId() << " Trigger " << GetTriggerNum() << " @ " << GetTriggerTime() << "  DATA_LONG  Data:" << std::hex << dShort;
-                cout << " hit_map:" << std::hex << hitMap << endl;
-            }
+            HOT_TRACE( HotTrace::kPARSER_DATALONG, GetBoardId(), GetReceiverId(), GetTriggerNum(), dShort, hitMap, lastDataField, lastRegion );
             if ((lastRegion < 0) && (GetVerboseLevel() >= kCHATTY)){
                 cout << std::dec << "Board " << GetBoardId() <<  " RCV " << GetReceiverId() << " Trigger " << GetTriggerNum() << " @ " << GetTriggerTime() << " =================== DATA_LONG Without Region header" << endl;
                 lastRegion = 0;
@@ -137,6 +127,7 @@ long TAlpideDataParser::checkEvent(unsigned char *dBuffer, unsigned char *evFlag
             lastDataField = dShort;
 		} else {
 			int d = h;
+            HOT_TRACE( HotTrace::kPARSER_UNKNOWN, GetBoardId(), GetReceiverId(), GetTriggerNum(), d, p - 1 - dBuffer );
 			cout << std::dec << "Board " << GetBoardId() <<  " RCV " << GetReceiverId() << " Trigger " << GetTriggerNum() << " @ " << GetTriggerTime() << " TAlpideDataParser::checkEvent() - Unknow data header: " << std::hex << d << endl;
 		}
 	}	
@@ -144,6 +135,17 @@ long TAlpideDataParser::checkEvent(unsigned char *dBuffer, unsigned char *evFlag
 	return(p - dBuffer);
 }
 
+// the bunch counter (bits 10:3) follows the chip id in the chip header and in the empty frame
+int TAlpideDataParser::GetBunchCounter(const unsigned char *data, int nBytes)
+{
+	if (nBytes < 2)
+		return -1;
+	unsigned char h = data[0];
+	if ( ((h >> DSHIFT_CHIP_HEADER) != DCODE_CHIP_HEADER) && ((h >> DSHIFT_CHIP_EMPTY) != DCODE_CHIP_EMPTY) )
+		return -1;
+	return data[1];
+}
+
 // parse all data starting from begin of buffer
 long TAlpideDataParser::parse(int numClosed)
 {
@@ -52,6 +52,9 @@ public:
 	int GetReceiverId() const { return fReceiverId; }
 	int GetBoardId() const { return fBoardId; }
 
+	// bunch counter of the chip header (or empty frame) that starts the chip data, -1 if none
+	static int GetBunchCounter(const unsigned char *data, int nBytes);
+
 protected:
 	long parse(int numClosed);
 
@@ -117,6 +117,7 @@ void MBoard::flushDataReceivers()
 	for (int i = 0; i < numReceivers; i++)
 		if ( receivers[i] !=NULL ) {
 			receivers[i]->dataBufferUsed = 0;
+			receivers[i]->numClosedData = 0;
 			receivers[i]->flush();
 		}	
 }
@@ -321,6 +322,52 @@ long MBoard::pollTCP(int timeout, MDataReceiver **drPtr)
 
 
 
+//
+//	Read the data left in the TCP socket after the end of run into the receivers
+//	buffers, until every given source (enabled receivers, trigger recorder) got
+//	its CLOSE_RUN block or no data came during <timeout> ms. The disabled
+//	receivers never send CLOSE_RUN and must not be given.
+//	Return the number of closed data received.
+//
+long MBoard::drainTCP(int timeout, const std::vector<int> &sources)
+{
+	MDataReceiver *dr;
+	long numClosed = 0;
+	int numOpen = 0;
+	std::vector<bool> waited(numReceivers, false);
+
+	if (tcp_sockfd == -1)
+		return 0;
+
+	for (size_t i = 0; i < sources.size(); i++) {
+		int src = sources[i];
+		if (src >= 0 && src < numReceivers && receivers[src] != NULL && !waited[src]) {
+			waited[src] = true;
+			numOpen++;
+		}
+	}
+
+	for (int i = 0; i < numReceivers; i++)
+		if (receivers[i] != NULL)
+			numClosed -= receivers[i]->numClosedData;
+
+	while (numOpen > 0) {
+		if (pollTCP(timeout, &dr) == 0)
+			break;		// timeout: nothing more from the board
+		if (dr != NULL && (dr->blockFlags & flagCloseRun) && waited[dr->blockSrc]) {
+			waited[dr->blockSrc] = false;
+			numOpen--;
+		}
+	}
+
+	for (int i = 0; i < numReceivers; i++)
+		if (receivers[i] != NULL)
+			numClosed += receivers[i]->numClosedData;
+	return numClosed;
+}
+
+
+
 //
 //	Read data from the TCP socket and send it to the receivers
 //
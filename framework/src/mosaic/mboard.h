@@ -60,6 +60,7 @@ public:
     void connectTCP(int port = (int)MosaicIPbus::DEFAULT_TCP_PORT, int rcvBufferSize = (int)MosaicIPbus::DEFAULT_TCP_BUFFER_SIZE);
 	void closeTCP();
 	long pollTCP(int timeout, MDataReceiver **dr);
+	long drainTCP(int timeout, const std::vector<int> &sources);
 	long pollData(int timeout);
 	void addDataReceiver(int id, MDataReceiver *dc);
 	void flushDataReceivers();
@@ -48,6 +48,7 @@ public:
 	MDataReceiver();
 	virtual ~MDataReceiver();
 	bool hasData() { return (numClosedData!=0); }
+	long getBlockSource() const { return blockSrc; }
 
 protected:
 
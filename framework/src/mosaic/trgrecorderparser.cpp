@@ -41,11 +41,22 @@ TrgRecorderParser::TrgRecorderParser() : MDataReceiver(), TVerbosity()
 {
 	fTrgNum = 0;
 	fTrgTime = 0;
+	fTable = nullptr;
+	fBoard = 0;
+	fNInTable = 0;
 	dataReceiverType = kTrgRecorderParser;
 }
 
 void TrgRecorderParser::flush()
 {
+	fNInTable = 0;
+}
+
+void TrgRecorderParser::SetTriggerTable(std::shared_ptr<TTriggerTable> table, uint16_t board)
+{
+	fTable = table;
+	fBoard = board;
+	fNInTable = 0;
 }
 
 uint32_t TrgRecorderParser::buf2uint32(unsigned char *buf)
@@ -104,6 +115,8 @@ long TrgRecorderParser::parse(int numClosed)
 	while (numClosed) {
 		fTrgNum = buf2uint32(p);	
 		fTrgTime = buf2uint64(p + 4);
+		if (fTable)
+			fTable->Add(fTrgNum, fTrgTime, fBoard);
 
 		if ( GetVerboseLevel() > TVerbosity::kTERSE )
 			printf("TrgRecorderParser::parse() - Trigger %d @ %ld\n", fTrgNum, fTrgTime);
@@ -134,6 +147,14 @@ long TrgRecorderParser::ReadEventData(int &nBytes, unsigned char *buffer)
 	if (numClosedData == 0)	
 		return 0;
 
+	// add all the records received since the last call to the table at once
+	if (fTable && fNInTable < numClosedData) {
+		unsigned char *q = dBuffer + fNInTable * evSize;
+		for (long i = fNInTable; i < numClosedData; i++, q += evSize)
+			fTable->Add(buf2uint32(q), buf2uint64(q + 4), fBoard);
+		fNInTable = numClosedData;
+	}
+
 	fTrgNum = buf2uint32(p);	
 	fTrgTime = buf2uint64(p + 4);
 
@@ -153,6 +174,8 @@ long TrgRecorderParser::ReadEventData(int &nBytes, unsigned char *buffer)
 
 	dataBufferUsed -= evSize;
 	numClosedData--;
+	if (fNInTable > 0)
+		fNInTable--;
 	//return evSize;
 	return MosaicDict::kTRGRECORDER_EVENT;
 }
@@ -32,7 +32,9 @@
 #define TRGRECORDERPARSER_H
 
 #include "mdatareceiver.h"
+#include <memory>
 #include <stdint.h>
+#include "TTriggerTable.h"
 #include "TVerbosity.h"
 #include "mdictionary.h"
 
@@ -44,6 +46,7 @@ public:
 	uint32_t GetTriggerNum() const { return fTrgNum; }
 	uint64_t GetTriggerTime() const { return fTrgTime; }
 	long ReadEventData(int &nBytes, unsigned char *buffer);
+	void SetTriggerTable(std::shared_ptr<TTriggerTable> table, uint16_t board);
 
 protected:
 	long parse(int numClosed);
@@ -54,6 +57,15 @@ protected:
 	/// value of the trigger time (in unit of clock) read with parse of received trigger data
 	uint64_t fTrgTime;
 
+	/// table filled with all the trigger records received (if any)
+	std::shared_ptr<TTriggerTable> fTable;
+
+	/// board id written in the table
+	uint16_t fBoard;
+
+	/// number of records at the begin of the buffer already added to the table
+	long fNInTable;
+
 	
 private:
 	uint32_t buf2uint32(unsigned char *buf);